@@ -15,7 +15,28 @@
       ],
       'sources': [
           'src/bindings.cc',
+          'src/culling.cc',
+          'src/debug_output.cc',
+          'src/gl_objects.cc',
+          'src/glb_loader.cc',
+          'src/headless_context.cc',
           'src/image.cc',
+          'src/mapped_file.cc',
+          'src/matrix_batch.cc',
+          'src/mesh_optimizer.cc',
+          'src/mesh_simplifier.cc',
+          'src/mipmap.cc',
+          'src/obj_loader.cc',
+          'src/parallel.cc',
+          'src/render_queue.cc',
+          'src/render_state.cc',
+          'src/sampler_cache.cc',
+          'src/texture_container.cc',
+          'src/texture_encoder.cc',
+          'src/texture_loader.cc',
+          'src/texture_residency.cc',
+          'src/trace.cc',
+          'src/vertex_packing.cc',
           'src/webgl.cc',
       ],
       'include_dirs': [
@@ -32,7 +53,7 @@
         ],
         ['OS=="linux"', {
           'libraries': [
-            '-lfreeimage','-lGLEW','-lGL']
+            '-lfreeimage','-lGLEW','-lGL','-lEGL']
           }
         ],
         ['OS=="win"',
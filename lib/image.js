@@ -11,8 +11,92 @@ Object.defineProperty(Image.prototype, 'onload', {
 
 inherits(Image, events.EventEmitter);
 
+// Maps (a window of) a file into a Buffer without reading it. The pages are shared with every
+// other mapping of the file and only faulted in when touched; writes stay private to the Buffer.
+// Slices can go to Image.fromBuffer() or gl.texImageFromFile() to decode assets out of a bundle.
+// options: {offset, length, advice: 'normal' | 'sequential' | 'random' | 'willneed'}
+var mapAdvice = { normal: 0, sequential: 1, random: 2, willneed: 3 };
+var _mapFile = Image.mapFile;
+Image.mapFile = function mapFile(path, options) {
+  options = options || {};
+  var advice = mapAdvice[options.advice || 'normal'];
+  if (typeof path !== 'string' || advice === undefined) {
+    throw new TypeError("Expected Image.mapFile(string path, [{offset, length, advice: 'normal' | 'sequential' | 'random' | 'willneed'}])");
+  }
+  return _mapFile(path, options.offset || 0, options.length || 0, advice);
+}
+
 // extend prototype
 function inherits(target, source) {
   for (var k in source.prototype)
     target.prototype[k] = source.prototype[k];
 }
+
+// Image.saveAsync(path, buffer, width, height, [options]) -> Promise
+// Encodes and writes on the thread pool. options: pitch, bpp, redMask, greenMask, blueMask (as for
+// save()), compression (PNG zlib level 0-9), quality (JPEG 1-100), copy (default true; false pins the
+// caller's buffer instead, which must then stay untouched until the Promise settles), and
+// dropIfBusy (resolve to false instead of waiting when the queue is full).
+//
+// At most saveQueue.concurrency saves encode at once and at most saveQueue.maxQueued are accepted
+// (each holding a copy of its pixels). Further calls wait for a slot before taking their copy, so
+// a producer that awaits saveAsync() is throttled to the encoder's pace instead of running out of
+// memory.
+var saveQueue = Image.saveQueue = { concurrency: 2, maxQueued: 8 };
+var savesAccepted = 0, savesRunning = 0;
+var slotWaiters = [], runWaiters = [];
+
+Object.defineProperty(Image, 'pendingSaves', {
+  get: function() { return savesAccepted + slotWaiters.length; }
+});
+
+function releaseSlot(queue) {
+  var next = queue.shift();
+  if (next) next();
+}
+
+var _saveAsync = Image.saveAsync;
+Image.saveAsync = async function saveAsync(path, buffer, width, height, options) {
+  options = options || {};
+  if (!(typeof path === 'string' && ArrayBuffer.isView(buffer) && typeof width === 'number' && typeof height === 'number')) {
+    throw new TypeError('Expected Image.saveAsync(string path, ArrayBufferView buffer, number width, number height, [object options])');
+  }
+
+  while (savesAccepted >= saveQueue.maxQueued) {
+    if (options.dropIfBusy) return false;
+    await new Promise(function(resolve) { slotWaiters.push(resolve); });
+  }
+  savesAccepted++;
+
+  try {
+    // copy on acceptance, so the caller can reuse its buffer while this waits to run
+    var pixels = options.copy === false ? buffer : new Uint8Array(buffer.buffer, buffer.byteOffset, buffer.byteLength).slice();
+
+    while (savesRunning >= saveQueue.concurrency) {
+      await new Promise(function(resolve) { runWaiters.push(resolve); });
+    }
+    savesRunning++;
+    try {
+      return await new Promise(function(resolve, reject) {
+        _saveAsync(path, pixels, width, height,
+          options.pitch === undefined ? width * 4 : options.pitch,
+          options.bpp === undefined ? 32 : options.bpp,
+          options.redMask === undefined ? 0xFF000000 : options.redMask,
+          options.greenMask === undefined ? 0x00FF0000 : options.greenMask,
+          options.blueMask === undefined ? 0x0000FF00 : options.blueMask,
+          options.compression === undefined ? -1 : options.compression,
+          options.quality === undefined ? 0 : options.quality,
+          function(err, result) {
+            if (err) reject(err);
+            else resolve(result);
+          });
+      });
+    } finally {
+      savesRunning--;
+      releaseSlot(runWaiters);
+    }
+  } finally {
+    savesAccepted--;
+    releaseSlot(slotWaiters);
+  }
+}
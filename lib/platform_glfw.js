@@ -54,6 +54,7 @@ module.exports = function () {
 		setIcon: function () {},
 		flip: function () {
 			GLFW.SwapBuffers(window);
+			WebGL.traceFrame();
 		},
 		getElementById: function (name) {
 			return this.createElement(name);
@@ -199,6 +200,7 @@ module.exports = function () {
 			timer(function () {
 				callback(GLFW.GetTime() * 1000.0);
 				GLFW.SwapBuffers(window);
+				WebGL.traceFrame();
 			}, delay);
 		},
 		destroy() {
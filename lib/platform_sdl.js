@@ -17,7 +17,10 @@ module.exports = function () {
     loadTexture: loadTexture,
     setTitle: setTitle,
     setIcon: setIcon,
-    flip: SDL.GL.swapBuffers,
+    flip: function() {
+      SDL.GL.swapBuffers();
+      WebGL.traceFrame();
+    },
     getElementById: function(name) {
       return this;
     },
@@ -46,6 +49,7 @@ module.exports = function () {
     },
     requestAnimationFrame: function (callback, delay) {
       SDL.GL.swapBuffers();
+      WebGL.traceFrame();
       var timer= (delay==0) ? process.nextTick : setTimeout;
       var d= (delay==undefined || delay<0) ? 16 : delay;
       timer(function(){
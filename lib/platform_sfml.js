@@ -18,8 +18,10 @@ module.exports = function () {
       // TODO
     },
     flip: function() {
-      if(window)
+      if(window) {
         window.Display();
+        WebGL.traceFrame();
+      }
     },
     getElementById: function(name) {
       return null;//this;
@@ -101,6 +103,7 @@ module.exports = function () {
       if(!window) return;
       
       window.Display();
+      WebGL.traceFrame();
       var timer= (delay==0) ? process.nextTick : setTimeout;
       var d= (delay==undefined || delay<0) ? 16 : delay;
       timer(function(){
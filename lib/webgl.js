@@ -1,4 +1,6 @@
 var gl = module.exports = require('bindings')('webgl');
+// before anything below captures a native, see "Tracing"
+if (process.env.NODE_WEBGL_TRACE) traceNatives(process.env.NODE_WEBGL_TRACE);
 var Image = require('./image');
 
 module.exports = gl;
@@ -12,9 +14,141 @@ global.WebGLRenderbuffer=gl.WebGLRenderbuffer=function (_) { this._ = _; }
 global.WebGLTexture=gl.WebGLTexture=function (_) { this._ = _; }
 global.WebGLSampler=gl.WebGLSampler=function (_) { this._ = _; }
 global.WebGLTransformFeedback=gl.WebGLTransformFeedback=function (_) { this._ = _; }
+global.WebGLVertexArrayObject=gl.WebGLVertexArrayObject=function (_) { this._ = _; }
 global.WebGLActiveInfo=gl.WebGLActiveInfo=function (_) { this._=_; this.size=_.size; this.type=_.type; this.name=_.name; }
 global.WebGLUniformLocation=gl.WebGLUniformLocation=function (_) { this._ = _; }
 
+// unchecked counterparts of the wrappers below, see "Fast mode" at the end
+var fast = {};
+
+////////////////////////////////////////////////////////////////////////////////
+// Automatic deletion
+//
+// Opt in with NODE_WEBGL_AUTO_DELETE=1 (or gl.autoDelete = true before
+// creating objects). The wrappers returned by the create* functions then own
+// their GL object: once a wrapper is garbage collected, its object is queued
+// for deletion and the queue is processed on the next turn of the event loop
+// (or explicitly by gl.processDeletes()). Wrappers made by getParameter don't
+// own anything. It is off by default because WebGL code commonly binds an
+// object and drops the wrapper: with it on, keep a reference to every object
+// you use, as an object only reachable through GL state (still bound,
+// attached to a framebuffer, in a binding group) is deleted as well.
+
+// must match GLObjectType in src/gl_objects.h
+var objectTypes = {
+  buffer: 0,
+  framebuffer: 1,
+  program: 2,
+  renderbuffer: 3,
+  shader: 4,
+  texture: 5,
+  sampler: 6,
+  transformFeedback: 7,
+  vertexArray: 8
+};
+
+var _glObjectSerial = gl.glObjectSerial;
+var _queueObjectDelete = gl.queueObjectDelete;
+var _processObjectDeletes = gl.processObjectDeletes;
+
+gl.autoDelete = process.env.NODE_WEBGL_AUTO_DELETE === '1';
+
+var deletesScheduled = false;
+var reclaimed = new FinalizationRegistry(function(held) {
+  _queueObjectDelete(held[0], held[1], held[2]);
+  if (!deletesScheduled) {
+    deletesScheduled = true;
+    setImmediate(gl.processDeletes);
+  }
+});
+
+// Deletes the GL objects of collected wrappers, returns how many were deleted.
+// Must run on the GL thread with the context current.
+gl.processDeletes = function processDeletes() {
+  deletesScheduled = false;
+  return _processObjectDeletes();
+}
+
+function owned(wrapper, type) {
+  var name = wrapper._;
+  if (gl.autoDelete && name)
+    reclaimed.register(wrapper, [type, name, _glObjectSerial(type, name)], wrapper);
+  return wrapper;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Memory accounting
+//
+// The binding estimates the GPU memory of every object it created from the
+// dimensions, levels and internal format of its storage (see
+// src/gl_objects.cc). Estimates, not driver figures: padding, alignment and
+// driver-side copies are not included.
+
+var typeNames = Object.keys(objectTypes);
+var _getObjectBytes = gl.getObjectBytes;
+var _getMemoryStats = gl.getMemoryStats;
+var _setMemoryBudget = gl.setMemoryBudget;
+
+function objectType(object) {
+  if (object instanceof gl.WebGLBuffer) return objectTypes.buffer;
+  if (object instanceof gl.WebGLFramebuffer) return objectTypes.framebuffer;
+  if (object instanceof gl.WebGLProgram) return objectTypes.program;
+  if (object instanceof gl.WebGLRenderbuffer) return objectTypes.renderbuffer;
+  if (object instanceof gl.WebGLShader) return objectTypes.shader;
+  if (object instanceof gl.WebGLTexture) return objectTypes.texture;
+  if (object instanceof gl.WebGLSampler) return objectTypes.sampler;
+  if (object instanceof gl.WebGLTransformFeedback) return objectTypes.transformFeedback;
+  if (object instanceof gl.WebGLVertexArrayObject) return objectTypes.vertexArray;
+  return -1;
+}
+
+// Estimated bytes of one WebGL object, 0 for objects without storage.
+gl.getObjectBytes = function getObjectBytes(object) {
+  var type = objectType(object);
+  return type < 0 ? 0 : _getObjectBytes(type, object._);
+}
+
+// {totalBytes, objectCount, budget, byType: {texture: {count, bytes}, ...},
+//  top: [{type, name, bytes}, ...]} with the topN (default 10) largest
+// objects, largest first.
+gl.getMemoryStats = function getMemoryStats(topN) {
+  var stats = _getMemoryStats(topN === undefined ? 10 : topN);
+  var byType = {};
+  stats.types.forEach(function(entry, type) {
+    byType[typeNames[type]] = entry;
+  });
+  return {
+    totalBytes: stats.totalBytes,
+    objectCount: stats.objectCount,
+    budget: stats.budget,
+    byType: byType,
+    top: stats.top.map(function(entry) {
+      return { type: typeNames[entry.type], name: entry.name, bytes: entry.bytes };
+    })
+  };
+}
+
+// Calls callback(stats) on the next turn of the event loop whenever the
+// estimated total grows past bytes; once per crossing, it fires again only
+// after the total has dropped back under the budget. 0 removes the budget.
+gl.setMemoryBudget = function setMemoryBudget(bytes, callback) {
+  if (!(typeof bytes === "number" && bytes >= 0 && (callback === undefined || typeof callback === "function"))) {
+    throw new TypeError('Expected setMemoryBudget(number bytes, [function callback])');
+  }
+  var pending = false;
+  _setMemoryBudget(bytes, callback && function(totalBytes, budget, type, name) {
+    if (pending)
+      return;
+    pending = true;
+    setImmediate(function() {
+      pending = false;
+      var stats = gl.getMemoryStats();
+      stats.exceededBy = { type: typeNames[type] || null, name: name };
+      callback(stats);
+    });
+  });
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 var _getSupportedExtensions = gl.getSupportedExtensions;
@@ -22,7 +156,7 @@ gl.getSupportedExtensions = function getSupportedExtensions() {
   return _getSupportedExtensions().split(" ");
 }
 
-var _getExtension = gl.getExtension;
+var _getExtension = fast.getExtension = gl.getExtension;
 gl.getExtension = function getExtension(name) {
   if (!(arguments.length === 1 && typeof name === "string")) {
     throw new TypeError('Expected getExtension(string name)');
@@ -30,7 +164,7 @@ gl.getExtension = function getExtension(name) {
   return _getExtension(name);
 }
 
-var _activeTexture = gl.activeTexture;
+var _activeTexture = fast.activeTexture = gl.activeTexture;
 gl.activeTexture = function activeTexture(texture) {
   if (!(arguments.length === 1 && typeof texture === "number")) {
     throw new TypeError('Expected activeTexture(number texture)');
@@ -39,112 +173,428 @@ gl.activeTexture = function activeTexture(texture) {
 }
 
 var _attachShader = gl.attachShader;
+fast.attachShader = function attachShader(program, shader) {
+  return _attachShader(program ? program._ : 0, shader ? shader._ : 0);
+}
 gl.attachShader = function attachShader(program, shader) {
   if (!(arguments.length === 2 && (program === null || program instanceof gl.WebGLProgram) && (shader === null || shader instanceof gl.WebGLShader))) {
     throw new TypeError('Expected attachShader(WebGLProgram program, WebGLShader shader)');
   }
-  return _attachShader(program ? program._ : 0, shader ? shader._ : 0);
+  return fast.attachShader(program, shader);
 }
 
 var _bindAttribLocation = gl.bindAttribLocation;
+fast.bindAttribLocation = function bindAttribLocation(program, index, name) {
+  return _bindAttribLocation(program ? program._ : 0, index, name);
+}
 gl.bindAttribLocation = function bindAttribLocation(program, index, name) {
   if (!(arguments.length === 3 && (program === null || program instanceof gl.WebGLProgram) && typeof index === "number" && typeof name === "string")) {
     throw new TypeError('Expected bindAttribLocation(WebGLProgram program, number index, string name)');
   }
-  return _bindAttribLocation(program ? program._ : 0, index, name);
+  return fast.bindAttribLocation(program, index, name);
 }
 
 var _bindBuffer = gl.bindBuffer;
+fast.bindBuffer = function bindBuffer(target, buffer) {
+  return _bindBuffer(target, buffer ? buffer._ : 0);
+}
 gl.bindBuffer = function bindBuffer(target, buffer) {
-  if (!(arguments.length === 2 && typeof target === "number" && (buffer === null || buffer instanceof gl.WebGLBuffer))) {    
-    console.log('bindBuffer: ', [target, buffer])
+  if (!(arguments.length === 2 && typeof target === "number" && (buffer === null || buffer instanceof gl.WebGLBuffer))) {
     throw new TypeError('Expected bindBuffer(number target, WebGLBuffer buffer)');
   }
-  return _bindBuffer(target, buffer ? buffer._ : 0);
+  return fast.bindBuffer(target, buffer);
 }
 
 var _bindBufferBase = gl.bindBufferBase;
+fast.bindBufferBase = function bindBufferBase(target, index, buffer) {
+  return _bindBufferBase(target, index, buffer ? buffer._ : 0);
+}
 gl.bindBufferBase = function bindBufferBase(target, index, buffer) {
-  if (!(arguments.length === 3 && typeof index === "number" && typeof target === "number" && (buffer === null || buffer instanceof gl.WebGLBuffer))) {    
-    console.log('bindBufferBase: ', [target, index, buffer])
+  if (!(arguments.length === 3 && typeof index === "number" && typeof target === "number" && (buffer === null || buffer instanceof gl.WebGLBuffer))) {
     throw new TypeError('Expected bindBufferBase(number target, number index, WebGLBuffer buffer)');
   }
-  return _bindBufferBase(target, index, buffer ? buffer._ : 0);
+  return fast.bindBufferBase(target, index, buffer);
 }
 var _bindBufferRange = gl.bindBufferRange;
+fast.bindBufferRange = function bindBufferRange(target, index, buffer, offset, size) {
+  return _bindBufferRange(target, index, buffer ? buffer._ : 0, offset, size);
+}
 gl.bindBufferRange = function bindBufferRange(target, index, buffer, offset, size) {
-  if (!(arguments.length === 5 && typeof offset === "number" && typeof size === "number" && typeof index === "number" && typeof target === "number" && (buffer === null || buffer instanceof gl.WebGLBuffer))) {    
-    console.log('bindBufferRange: ', [target, index, buffer])
+  if (!(arguments.length === 5 && typeof offset === "number" && typeof size === "number" && typeof index === "number" && typeof target === "number" && (buffer === null || buffer instanceof gl.WebGLBuffer))) {
     throw new TypeError('Expected bindBufferRange(number target, number index, WebGLBuffer buffer, number offset, number size)');
   }
-  return _bindBufferRange(target, index, buffer ? buffer._ : 0, offset, size);
+  return fast.bindBufferRange(target, index, buffer, offset, size);
 }
 
 var _bindFramebuffer = gl.bindFramebuffer;
+fast.bindFramebuffer = function bindFramebuffer(target, framebuffer) {
+  return _bindFramebuffer(target, framebuffer ? framebuffer._ : 0);
+}
 gl.bindFramebuffer = function bindFramebuffer(target, framebuffer) {
   if (!(arguments.length === 2 && typeof target === "number" && (framebuffer === null || framebuffer instanceof gl.WebGLFramebuffer))) {
     throw new TypeError('Expected bindFramebuffer(number target, WebGLFramebuffer framebuffer)');
   }
-  return _bindFramebuffer(target, framebuffer ? framebuffer._ : 0);
+  return fast.bindFramebuffer(target, framebuffer);
 }
 
 var _bindRenderbuffer = gl.bindRenderbuffer;
+fast.bindRenderbuffer = function bindRenderbuffer(target, renderbuffer) {
+  return _bindRenderbuffer(target, renderbuffer ? renderbuffer._ : 0);
+}
 gl.bindRenderbuffer = function bindRenderbuffer(target, renderbuffer) {
   if (!(arguments.length === 2 && typeof target === "number" && (renderbuffer === null || renderbuffer instanceof gl.WebGLRenderbuffer))) {
     throw new TypeError('Expected bindRenderbuffer(number target, WebGLRenderbuffer renderbuffer)');
   }
-  return _bindRenderbuffer(target, renderbuffer ? renderbuffer._ : 0);
+  return fast.bindRenderbuffer(target, renderbuffer);
 }
 
 var _bindTexture = gl.bindTexture;
+fast.bindTexture = function bindTexture(target, texture) {
+  return _bindTexture(target, texture ? texture._ : 0);
+}
 gl.bindTexture = function bindTexture(target, texture) {
   if (!(arguments.length === 2 && typeof target === "number" && (texture === null || texture instanceof gl.WebGLTexture))) {
-    console.log([target, texture, texture instanceof gl.WebGLTexture])
     throw new TypeError('Expected bindTexture(number target, WebGLTexture texture)');
   }
-  return _bindTexture(target, texture ? texture._ : 0);
+  return fast.bindTexture(target, texture);
+}
+
+// Multi-bind: one native call per group of consecutive binding points. objects are a
+// Uint32Array of names, an array of WebGL objects (or nulls), or null to unbind count points.
+// offsets and sizes are Float64Arrays (exact up to 2^53), BigInt64Arrays or arrays of numbers.
+var multiBindScratch = new Uint32Array(64);
+function multiBindNames(objects, count) {
+  if (objects === null || objects === undefined || objects instanceof Uint32Array) return objects || null;
+  // the native call consumes the names before returning, so the scratch array can be reused
+  var names = count <= multiBindScratch.length ? multiBindScratch : new Uint32Array(count);
+  for (var i = 0; i < count; i++) names[i] = objects[i] ? objects[i]._ : 0;
+  return names;
+}
+function multiBindOffsets(values) {
+  return ArrayBuffer.isView(values) ? values : Float64Array.from(values || []);
+}
+function isMultiBindObjects(objects, type) {
+  return objects === null || objects instanceof Uint32Array ||
+    (Array.isArray(objects) && objects.every(function(o) { return o === null || o instanceof type; }));
+}
+
+var _bindTextures = gl.bindTextures;
+fast.bindTextures = function bindTextures(first, count, textures) {
+  return _bindTextures(first, count, multiBindNames(textures, count));
+}
+gl.bindTextures = function bindTextures(first, count, textures) {
+  if (!(arguments.length === 3 && typeof first === "number" && typeof count === "number" && isMultiBindObjects(textures, gl.WebGLTexture))) {
+    throw new TypeError('Expected bindTextures(number first, number count, (Uint32Array | WebGLTexture[]) textures)');
+  }
+  return fast.bindTextures(first, count, textures);
+}
+
+var _bindSamplers = gl.bindSamplers;
+fast.bindSamplers = function bindSamplers(first, count, samplers) {
+  return _bindSamplers(first, count, multiBindNames(samplers, count));
+}
+gl.bindSamplers = function bindSamplers(first, count, samplers) {
+  if (!(arguments.length === 3 && typeof first === "number" && typeof count === "number" && isMultiBindObjects(samplers, gl.WebGLSampler))) {
+    throw new TypeError('Expected bindSamplers(number first, number count, (Uint32Array | WebGLSampler[]) samplers)');
+  }
+  return fast.bindSamplers(first, count, samplers);
+}
+
+var _bindImageTextures = gl.bindImageTextures;
+fast.bindImageTextures = function bindImageTextures(first, count, textures) {
+  return _bindImageTextures(first, count, multiBindNames(textures, count));
+}
+gl.bindImageTextures = function bindImageTextures(first, count, textures) {
+  if (!(arguments.length === 3 && typeof first === "number" && typeof count === "number" && isMultiBindObjects(textures, gl.WebGLTexture))) {
+    throw new TypeError('Expected bindImageTextures(number first, number count, (Uint32Array | WebGLTexture[]) textures)');
+  }
+  return fast.bindImageTextures(first, count, textures);
+}
+
+var _bindBuffersBase = gl.bindBuffersBase;
+fast.bindBuffersBase = function bindBuffersBase(target, first, count, buffers) {
+  return _bindBuffersBase(target, first, count, multiBindNames(buffers, count));
+}
+gl.bindBuffersBase = function bindBuffersBase(target, first, count, buffers) {
+  if (!(arguments.length === 4 && typeof target === "number" && typeof first === "number" && typeof count === "number" && isMultiBindObjects(buffers, gl.WebGLBuffer))) {
+    throw new TypeError('Expected bindBuffersBase(number target, number first, number count, (Uint32Array | WebGLBuffer[]) buffers)');
+  }
+  return fast.bindBuffersBase(target, first, count, buffers);
+}
+
+var _bindBuffersRange = gl.bindBuffersRange;
+fast.bindBuffersRange = function bindBuffersRange(target, first, count, buffers, offsets, sizes) {
+  return _bindBuffersRange(target, first, count, multiBindNames(buffers, count), multiBindOffsets(offsets), multiBindOffsets(sizes));
+}
+gl.bindBuffersRange = function bindBuffersRange(target, first, count, buffers, offsets, sizes) {
+  if (!(arguments.length === 6 && typeof target === "number" && typeof first === "number" && typeof count === "number" && isMultiBindObjects(buffers, gl.WebGLBuffer) && (buffers === null || (offsets && sizes && offsets.length >= count && sizes.length >= count)))) {
+    throw new TypeError('Expected bindBuffersRange(number target, number first, number count, (Uint32Array | WebGLBuffer[]) buffers, Float64Array offsets, Float64Array sizes)');
+  }
+  return fast.bindBuffersRange(target, first, count, buffers, offsets, sizes);
+}
+
+var _bindVertexBuffers = gl.bindVertexBuffers;
+fast.bindVertexBuffers = function bindVertexBuffers(first, count, buffers, offsets, strides) {
+  return _bindVertexBuffers(first, count, multiBindNames(buffers, count), multiBindOffsets(offsets), strides instanceof Int32Array ? strides : Int32Array.from(strides || []));
+}
+gl.bindVertexBuffers = function bindVertexBuffers(first, count, buffers, offsets, strides) {
+  if (!(arguments.length === 5 && typeof first === "number" && typeof count === "number" && isMultiBindObjects(buffers, gl.WebGLBuffer) && (buffers === null || (offsets && strides && offsets.length >= count && strides.length >= count)))) {
+    throw new TypeError('Expected bindVertexBuffers(number first, number count, (Uint32Array | WebGLBuffer[]) buffers, Float64Array offsets, Int32Array strides)');
+  }
+  return fast.bindVertexBuffers(first, count, buffers, offsets, strides);
 }
 
 var _clearTexImage = gl.clearTexImage;
+fast.clearTexImage = function clearTexImage(texture, level, format, type, data) {
+  return _clearTexImage(texture ? texture._ : 0, level, format, type, data);
+}
 gl.clearTexImage = function clearTexImage(texture, level, format, type, data) {
   if (!(arguments.length === 5 && (texture === null || texture instanceof gl.WebGLTexture))) {
     //console.log([target, texture, texture instanceof gl.WebGLTexture])
     throw new TypeError('Expected clearTexImage(WebGLTexture texture, level, format, type, value)');
   }
-  return _clearTexImage(texture ? texture._ : 0, level, format, type, data);
+  return fast.clearTexImage(texture, level, format, type, data);
 }
 
 var _textureStorage2D = gl.textureStorage2D;
+fast.textureStorage2D = function textureStorage2D(texture, levels, internalFormat, width, height) {
+  return _textureStorage2D(texture._, levels, internalFormat, width, height);
+}
 gl.textureStorage2D = function textureStorage2D(texture, levels, internalFormat, width, height) {
   if (!(arguments.length === 5 && (texture instanceof gl.WebGLTexture) && typeof levels === 'number' && typeof internalFormat === 'number' && typeof width === 'number' && typeof height === 'number')) {
     //console.log([target, texture, texture instanceof gl.WebGLTexture])
     throw new TypeError('Expected textureStorage2D(WebGLTexture texture, number levels, number internalFormat, number width, number height)');
   }
-  return _textureStorage2D(texture._, levels, internalFormat, width, height);
+  return fast.textureStorage2D(texture, levels, internalFormat, width, height);
 }
 var _textureStorage3D = gl.textureStorage3D;
+fast.textureStorage3D = function textureStorage3D(texture, levels, internalFormat, width, height, depth) {
+  return _textureStorage3D(texture._, levels, internalFormat, width, height, depth);
+}
 gl.textureStorage3D = function textureStorage3D(texture, levels, internalFormat, width, height, depth) {
   if (!(arguments.length === 6 && (texture instanceof gl.WebGLTexture) && typeof levels === 'number' && typeof internalFormat === 'number' && typeof width === 'number' && typeof height === 'number' && typeof depth === 'number')) {
     //console.log([target, texture, texture instanceof gl.WebGLTexture])
     throw new TypeError('Expected textureStorage3D(WebGLTexture texture, number levels, number internalFormat, number width, number height, number depth)');
   }
-  return _textureStorage3D(texture._, levels, internalFormat, width, height, depth);
+  return fast.textureStorage3D(texture, levels, internalFormat, width, height, depth);
 }
 var _textureSubImage2D = gl.textureSubImage2D;
+fast.textureSubImage2D = function textureSubImage2D(texture, level, xoff, yoff, width, height, format, type, pixels) {
+  return _textureSubImage2D(texture._, level, xoff, yoff, width, height, format, type, pixels);
+}
 gl.textureSubImage2D = function textureSubImage2D(texture, level, xoff, yoff, width, height, format, type, pixels) {
   if (!(arguments.length === 9 && (texture instanceof gl.WebGLTexture) && typeof level === 'number' && typeof format === 'number' && typeof width === 'number' && typeof height === 'number')) {
     //console.log([target, texture, texture instanceof gl.WebGLTexture])
     throw new TypeError('Expected textureSubImage2D(WebGLTexture texture, number level, number xoff, number yoff, number width, number height, number format, number type, pixels)');
   }
-  return _textureSubImage2D(texture._, level, xoff, yoff, width, height, format, type, pixels);
+  return fast.textureSubImage2D(texture, level, xoff, yoff, width, height, format, type, pixels);
+}
+
+// Block compression formats the CPU encoder can produce, as [linear, sRGB] internal formats.
+var textureEncodeFormats = {
+  bc1: [0x83F0 /* COMPRESSED_RGB_S3TC_DXT1_EXT */, 0x8C4C /* COMPRESSED_SRGB_S3TC_DXT1_EXT */],
+  bc3: [0x83F3 /* COMPRESSED_RGBA_S3TC_DXT5_EXT */, 0x8C4F /* COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT */],
+  bc7: [0x8E8C /* COMPRESSED_RGBA_BPTC_UNORM */, 0x8E8D /* COMPRESSED_SRGB_ALPHA_BPTC_UNORM */],
+  etc2: [0x9274 /* COMPRESSED_RGB8_ETC2 */, 0x9275 /* COMPRESSED_SRGB8_ETC2 */]
+};
+function textureEncodeFormat(format, srgb) {
+  if (typeof format === 'number') return format;
+  var formats = textureEncodeFormats[String(format).toLowerCase()];
+  if (!formats) throw new TypeError('Unknown texture compression format ' + format + ', expected one of ' + Object.keys(textureEncodeFormats).join(', '));
+  return formats[srgb ? 1 : 0];
+}
+gl.defaultTextureCacheDir = require('path').join(require('os').tmpdir(), 'node-opengl-texture-cache');
+
+// options.mipmaps -> native MipmapMode (src/texture_loader.cc)
+var mipmapModes = { none: 0, gpu: 1, box: 2, kaiser: 3 };
+function mipmapMode(mipmaps) {
+  if (!mipmaps) return mipmapModes.none;
+  if (mipmaps === true) return mipmapModes.box;
+  var mode = mipmapModes[mipmaps];
+  if (mode === undefined) throw new TypeError('Unknown mipmaps option ' + mipmaps + ", expected true, 'box', 'kaiser' or 'gpu'");
+  return mode;
+}
+
+// Decodes an image file (or an encoded Buffer) off the main thread and uploads it into texture.
+// Pixel data never goes through JS. Resolves to {width, height, levels}.
+// options.mipmaps builds the mip chain on worker threads: true or 'box' (2x2 average), 'kaiser'
+// (sharper), or 'gpu' for glGenerateTextureMipmap after the upload. The CPU filters work in linear
+// light for sRGB textures; override with options.gammaCorrect.
+// With options.compress ('bc1', 'bc3', 'bc7', 'etc2' or a GL enum) the image is block compressed
+// on worker threads instead and cached in options.cacheDir (default gl.defaultTextureCacheDir,
+// false disables the cache); the result then also carries {internalFormat, cached}.
+var _texImageFromFile = gl.texImageFromFile;
+var _compressTexImageFromFile = gl.compressTexImageFromFile;
+gl.texImageFromFile = function texImageFromFile(texture, source, options={}) {
+  if (!((arguments.length === 2 || arguments.length === 3) && (texture instanceof gl.WebGLTexture) && (typeof source === 'string' || ArrayBuffer.isView(source)))) {
+    throw new TypeError('Expected texImageFromFile(WebGLTexture texture, (string path | Buffer data), [object options])');
+  }
+  const mipmaps = mipmapMode(options.mipmaps);
+  if (options.compress) {
+    if (mipmaps === mipmapModes.gpu) throw new TypeError("texImageFromFile: compressed textures can't be mipmapped on the GPU, use mipmaps: 'box' or 'kaiser'");
+    const compressedFormat = textureEncodeFormat(options.compress, options.srgb);
+    const gammaCorrect = options.gammaCorrect === undefined ? !!options.srgb : !!options.gammaCorrect;
+    let cacheDir = options.cacheDir === undefined ? gl.defaultTextureCacheDir : options.cacheDir;
+    if (cacheDir) require('fs').mkdirSync(cacheDir, {recursive: true});
+    else cacheDir = '';
+    return new Promise(function(resolve, reject) {
+      _compressTexImageFromFile(texture._, source, compressedFormat, mipmaps, gammaCorrect, cacheDir, options.threads|0, function(err, result) {
+        if(err) reject(err);
+        else resolve(result);
+      });
+    });
+  }
+  const internalFormat = options.internalFormat === undefined ? 0x8058 /* RGBA8 */ : options.internalFormat;
+  const gammaCorrect = options.gammaCorrect === undefined ?
+    (internalFormat === 0x8C41 /* SRGB8 */ || internalFormat === 0x8C43 /* SRGB8_ALPHA8 */) : !!options.gammaCorrect;
+  return new Promise(function(resolve, reject) {
+    _texImageFromFile(texture._, source, internalFormat, mipmaps, gammaCorrect, function(err, result) {
+      if(err) reject(err);
+      else resolve(result);
+    });
+  });
+}
+
+// Synchronous CPU block compression of RGBA8 pixels; returns a Buffer for compressedTexImage2D.
+var _encodeTexture = gl.encodeTexture;
+fast.encodeTexture = function encodeTexture(pixels, width, height, format, threads) {
+  return _encodeTexture(pixels, width, height, textureEncodeFormat(format), threads|0);
+}
+gl.encodeTexture = function encodeTexture(pixels, width, height, format, threads) {
+  if (!((arguments.length === 4 || arguments.length === 5) && ArrayBuffer.isView(pixels) && typeof width === 'number' && typeof height === 'number')) {
+    throw new TypeError('Expected encodeTexture(ArrayBufferView pixels, number width, number height, (string | number) format, [number threads])');
+  }
+  return fast.encodeTexture(pixels, width, height, format, threads);
+}
+
+// Inverse of encodeTexture, to measure compression quality.
+var _decodeTexture = gl.decodeTexture;
+fast.decodeTexture = function decodeTexture(data, width, height, format) {
+  return _decodeTexture(data, width, height, textureEncodeFormat(format));
+}
+gl.decodeTexture = function decodeTexture(data, width, height, format) {
+  if (!(arguments.length === 4 && ArrayBuffer.isView(data) && typeof width === 'number' && typeof height === 'number')) {
+    throw new TypeError('Expected decodeTexture(ArrayBufferView data, number width, number height, (string | number) format)');
+  }
+  return fast.decodeTexture(data, width, height, format);
+}
+
+var _compressedTextureSubImage2D = gl.compressedTextureSubImage2D;
+fast.compressedTextureSubImage2D = function compressedTextureSubImage2D(texture, level, xoff, yoff, width, height, format, data) {
+  return _compressedTextureSubImage2D(texture._, level, xoff, yoff, width, height, format, data);
+}
+gl.compressedTextureSubImage2D = function compressedTextureSubImage2D(texture, level, xoff, yoff, width, height, format, data) {
+  if (!(arguments.length === 8 && (texture instanceof gl.WebGLTexture) && typeof level === 'number' && typeof width === 'number' && typeof height === 'number' && typeof format === 'number' && ArrayBuffer.isView(data))) {
+    throw new TypeError('Expected compressedTextureSubImage2D(WebGLTexture texture, number level, number xoff, number yoff, number width, number height, number format, ArrayBufferView data)');
+  }
+  return fast.compressedTextureSubImage2D(texture, level, xoff, yoff, width, height, format, data);
+}
+
+// Maps a KTX2 or DDS file and uploads all of its levels without decoding.
+// Allocates immutable storage unless the texture already has some.
+// Resolves to {width, height, levels, internalFormat}.
+var _compressedTexImageFromFile = gl.compressedTexImageFromFile;
+fast.compressedTexImageFromFile = function compressedTexImageFromFile(texture, path) {
+  return new Promise(function(resolve, reject) {
+    _compressedTexImageFromFile(texture._, path, function(err, result) {
+      if(err) reject(err);
+      else resolve(result);
+    });
+  });
+}
+gl.compressedTexImageFromFile = function compressedTexImageFromFile(texture, path) {
+  if (!(arguments.length === 2 && (texture instanceof gl.WebGLTexture) && typeof path === 'string')) {
+    throw new TypeError('Expected compressedTexImageFromFile(WebGLTexture texture, string path)');
+  }
+  return fast.compressedTexImageFromFile(texture, path);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Texture residency
+//
+// Managed textures are kept within gl.setTextureBudget(): at gl.endTextureFrame() the finest
+// levels of the least recently bound ones are evicted, and binding an evicted texture streams
+// them back in from its file. Evicting or streaming in reallocates the texture, so its name
+// changes; the wrapper is updated, but names captured elsewhere (texture units, framebuffer
+// attachments) are not: bind managed textures every frame and don't render into them.
+var _manageTexture = gl.manageTexture;
+var _unmanageTexture = gl.unmanageTexture;
+var _setTextureResidency = gl.setTextureResidency;
+var _endTextureFrame = gl.endTextureFrame;
+var _getTextureResidencyStats = gl.getTextureResidencyStats;
+
+// id -> wrapper; managed wrappers are owned by the residency manager until unmanaged
+var managedTextures = new Map();
+function textureRenamed(id, name) {
+  var texture = managedTextures.get(id);
+  if (texture) texture._ = name;
+}
+var textureResidency = { budget: 0, minSize: 32, maxPendingStreams: 4 };
+_setTextureResidency(0, textureResidency.minSize, textureResidency.maxPendingStreams, textureRenamed);
+
+// Budget in bytes (0 disables eviction). options.minSize: no texture is evicted below this
+// many texels on its longer side (default 32); options.maxPendingStreams: concurrent
+// stream-ins (default 4), further bindings of evicted textures wait for a slot.
+gl.setTextureBudget = function setTextureBudget(bytes, options={}) {
+  if (!(typeof bytes === 'number' && bytes >= 0 && typeof options === 'object')) {
+    throw new TypeError('Expected setTextureBudget(number bytes, [object options])');
+  }
+  textureResidency.budget = bytes;
+  if (options.minSize !== undefined) textureResidency.minSize = Math.max(1, options.minSize|0);
+  if (options.maxPendingStreams !== undefined) textureResidency.maxPendingStreams = Math.max(0, options.maxPendingStreams|0);
+  _setTextureResidency(bytes, textureResidency.minSize, textureResidency.maxPendingStreams, textureRenamed);
+}
+
+// texture must have been loaded from path with immutable storage (texImageFromFile,
+// compressedTexImageFromFile); pass the same mipmaps/gammaCorrect options so streamed in levels
+// match. Returns the texture.
+gl.manageTexture = function manageTexture(texture, path, options={}) {
+  if (!((arguments.length === 2 || arguments.length === 3) && (texture instanceof gl.WebGLTexture) && typeof path === 'string')) {
+    throw new TypeError('Expected manageTexture(WebGLTexture texture, string path, [object options])');
+  }
+  const mipmaps = mipmapMode(options.mipmaps);
+  const gammaCorrect = options.gammaCorrect === undefined ? !!options.srgb : !!options.gammaCorrect;
+  const id = _manageTexture(texture._, path, mipmaps, gammaCorrect);
+  if (!texture._resident) {
+    reclaimed.unregister(texture);
+    managedTextures.set(id, texture);
+    texture._resident = id;
+  }
+  return texture;
+}
+
+// Stops managing texture, which keeps the levels that are resident.
+gl.unmanageTexture = function unmanageTexture(texture) {
+  if (!(arguments.length === 1 && (texture instanceof gl.WebGLTexture))) {
+    throw new TypeError('Expected unmanageTexture(WebGLTexture texture)');
+  }
+  if (!texture._resident) return;
+  _unmanageTexture(texture._resident);
+  managedTextures.delete(texture._resident);
+  texture._resident = 0;
+  owned(texture, objectTypes.texture);
+}
+
+// Call once per frame, after the frame's draw calls. Returns the number of textures evicted.
+gl.endTextureFrame = function endTextureFrame() {
+  return _endTextureFrame();
+}
+
+// {textures, residentBytes, fullBytes, budget, frame, evictedTextures, evictedLevels,
+//  evictedBytes, streamIns, streamedBytes, pendingStreams, streamErrors}
+gl.getTextureResidencyStats = function getTextureResidencyStats() {
+  return _getTextureResidencyStats();
 }
 
 var _copyImageSubData = gl.copyImageSubData;
+fast.copyImageSubData = function copyImageSubData(srcTex, srcTarget, srcLevel, srcX, srcY, srcZ, dstTex, dstTarget, dstLevel, dstX, dstY, dstZ, sizeX, sizeY, sizeZ) {
+  return _copyImageSubData(srcTex._, srcTarget, srcLevel, srcX, srcY, srcZ, dstTex._, dstTarget, dstLevel, dstX, dstY, dstZ, sizeX, sizeY, sizeZ);
+}
 gl.copyImageSubData = function copyImageSubData(srcTex, srcTarget, srcLevel, srcX, srcY, srcZ, dstTex, dstTarget, dstLevel, dstX, dstY, dstZ, sizeX, sizeY, sizeZ) {
   if (!(arguments.length === 15 && (srcTex instanceof gl.WebGLTexture) && (dstTex instanceof gl.WebGLTexture))) {
     throw new TypeError('Expected copyImageSubData(WebGLTexture srcTex, srcTarget, srcLevel, srcX, srcY, srcZ, WebGLTexture dstTex, dstLevel, dstTarget, dstLevel, dstX, dstY, dstZ, sizeX, sizeY, sizeZ)');
   }
-  return _copyImageSubData(srcTex._, srcTarget, srcLevel, srcX, srcY, srcZ, dstTex._, dstTarget, dstLevel, dstX, dstY, dstZ, sizeX, sizeY, sizeZ);
+  return fast.copyImageSubData(srcTex, srcTarget, srcLevel, srcX, srcY, srcZ, dstTex, dstTarget, dstLevel, dstX, dstY, dstZ, sizeX, sizeY, sizeZ);
 }
 
 var _bindImageTexture = gl.bindImageTexture;
@@ -156,7 +606,7 @@ gl.bindImageTexture = function bindImageTexture(unit, texture, level, layered, l
   return _bindImageTexture(unit, texture ? texture._ : 0, level, layered, layer, access, internalFormat);
 }
 
-var _blendColor = gl.blendColor;
+var _blendColor = fast.blendColor = gl.blendColor;
 gl.blendColor = function blendColor(red, green, blue, alpha) {
   if (!(arguments.length === 4 && typeof red === "number" && typeof green === "number" && typeof blue === "number" && typeof alpha === "number")) {
     throw new TypeError('Expected blendColor(number red, number green, number blue, number alpha)');
@@ -164,7 +614,7 @@ gl.blendColor = function blendColor(red, green, blue, alpha) {
   return _blendColor(red, green, blue, alpha);
 }
 
-var _blendEquation = gl.blendEquation;
+var _blendEquation = fast.blendEquation = gl.blendEquation;
 gl.blendEquation = function blendEquation(mode) {
   if (!(arguments.length === 1 && typeof mode === "number")) {
     throw new TypeError('Expected blendEquation(number mode)');
@@ -172,7 +622,7 @@ gl.blendEquation = function blendEquation(mode) {
   return _blendEquation(mode);
 }
 
-var _blendEquationSeparate = gl.blendEquationSeparate;
+var _blendEquationSeparate = fast.blendEquationSeparate = gl.blendEquationSeparate;
 gl.blendEquationSeparate = function blendEquationSeparate(modeRGB, modeAlpha) {
   if (!(arguments.length === 2 && typeof modeRGB === "number" && typeof modeAlpha === "number")) {
     throw new TypeError('Expected blendEquationSeparate(number modeRGB, number modeAlpha)');
@@ -180,7 +630,7 @@ gl.blendEquationSeparate = function blendEquationSeparate(modeRGB, modeAlpha) {
   return _blendEquationSeparate(modeRGB, modeAlpha);
 }
 
-var _blendFunc = gl.blendFunc;
+var _blendFunc = fast.blendFunc = gl.blendFunc;
 gl.blendFunc = function blendFunc(sfactor, dfactor) {
   if (!(arguments.length === 2 && typeof sfactor === "number" && typeof dfactor === "number")) {
     throw new TypeError('Expected blendFunc(number sfactor, number dfactor)');
@@ -188,7 +638,7 @@ gl.blendFunc = function blendFunc(sfactor, dfactor) {
   return _blendFunc(sfactor, dfactor);
 }
 
-var _blendFuncSeparate = gl.blendFuncSeparate;
+var _blendFuncSeparate = fast.blendFuncSeparate = gl.blendFuncSeparate;
 gl.blendFuncSeparate = function blendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha) {
   if (!(arguments.length === 4 && typeof srcRGB === "number" && typeof dstRGB === "number" && typeof srcAlpha === "number" && typeof dstAlpha === "number")) {
     throw new TypeError('Expected blendFuncSeparate(number srcRGB, number dstRGB, number srcAlpha, number dstAlpha)');
@@ -197,66 +647,79 @@ gl.blendFuncSeparate = function blendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstA
 }
 
 var _bufferData = gl.bufferData;
+fast.bufferData = function bufferData(target, data, usage, srcOffset=0, length=0) {
+  return _bufferData(target, data, usage, srcOffset, length);
+}
 gl.bufferData = function bufferData(target, data, usage, srcOffset=0, length=0) {
   if (!((arguments.length === 3 || arguments.length === 5) && typeof target === "number" && 
       (typeof data === "object" || typeof data === "number") && typeof usage === "number")) {
     throw new TypeError('Expected bufferData(number target, ArrayBuffer data, number usage) or bufferData(number target, number size, number usage) or bufferData(number target, ArrayBufferView srcData, number usage, number srcOffset, number length)');
   }
-  return _bufferData(target, data, usage, srcOffset, length);
+  return fast.bufferData(target, data, usage, srcOffset, length);
 }
 
 var _clearNamedBufferData = gl.clearNamedBufferData;
+fast.clearNamedBufferData = function clearNamedBufferData(buf, internalFormat, format, type, data) {
+  return _clearNamedBufferData(buf._, internalFormat, format, type, data);
+}
 gl.clearNamedBufferData = function clearNamedBufferData(buf, internalFormat, format, type, data) {
   if (!((arguments.length === 5) && buf instanceof gl.WebGLBuffer && 
       (typeof data === "object" || typeof data === "number" || data == null) && typeof format === "number" && typeof internalFormat === 'number' && typeof type === 'number')) {
-    console.log(arguments)
     throw new TypeError('Expected clearNamedBufferData(WebGLBuffer buf, number internalFormat, number format, number type, ArrayBuffer data)');
   }
-  return _clearNamedBufferData(buf._, internalFormat, format, type, data);
+  return fast.clearNamedBufferData(buf, internalFormat, format, type, data);
 }
 
 var _namedBufferSubData = gl.namedBufferSubData;
+fast.namedBufferSubData = function namedBufferSubData(buf, srcOffset, data, dstOffset=0, length=0) {
+  return _namedBufferSubData(buf._, srcOffset, data, dstOffset, length);
+}
 gl.namedBufferSubData = function namedBufferSubData(buf, srcOffset, data, dstOffset=0, length=0) {
   if (!((arguments.length <= 5 && arguments.length >= 3) && buf instanceof gl.WebGLBuffer && 
       (typeof data === "object" || typeof data === "number") && typeof srcOffset === "number" && typeof dstOffset === 'number' && typeof length === 'number')) {
-    console.log(arguments)
     throw new TypeError('Expected namedBufferSubData(WebGLBuffer buf, number srcOffset, ArrayBuffer data, number dstOffset, number length)');
   }
-  return _namedBufferSubData(buf._, srcOffset, data, dstOffset, length);
+  return fast.namedBufferSubData(buf, srcOffset, data, dstOffset, length);
 }
 var _getNamedBufferSubData = gl.getNamedBufferSubData;
+fast.getNamedBufferSubData = function getNamedBufferSubData(buf, offset, data, srcOffset=0, length=0) {
+  return _getNamedBufferSubData(buf._, offset, data, srcOffset, length);
+}
 gl.getNamedBufferSubData = function getNamedBufferSubData(buf, offset, data, srcOffset=0, length=0) {
   if (!((arguments.length <= 5 && arguments.length >= 3) && buf instanceof gl.WebGLBuffer && 
       (typeof data === "object" || typeof data === "number") && typeof srcOffset === "number" && typeof offset === 'number' && typeof length === 'number')) {
-    console.log(arguments)
     throw new TypeError('Expected getNamedBufferSubData(WebGLBuffer buf, number offset, ArrayBuffer data, number sourceOffset, number length)');
   }
-  return _getNamedBufferSubData(buf._, offset, data, srcOffset, length);
+  return fast.getNamedBufferSubData(buf, offset, data, srcOffset, length);
 }
 
 var _namedBufferStorage = gl.namedBufferStorage;
+fast.namedBufferStorage = function namedBufferStorage(buf, byteSize, data=null, flags=0) {
+  return _namedBufferStorage(buf._, byteSize, data, flags);
+}
 gl.namedBufferStorage = function namedBufferStorage(buf, byteSize, data=null, flags=0) {
   if (!((arguments.length >= 2 && arguments.length <= 4) && buf instanceof gl.WebGLBuffer && 
       (typeof data === "object" || typeof data === "number" || data==null) && typeof byteSize === "number" && typeof flags === 'number')) {
-    console.log(arguments)
     throw new TypeError('Expected namedBufferStorage(WebGLBuffer buf, number byteSize, ArrayBuffer data=null, number flags=0)');
   }
-  return _namedBufferStorage(buf._, byteSize, data, flags);
+  return fast.namedBufferStorage(buf, byteSize, data, flags);
 }
 
 var _bufferSubData = gl.bufferSubData;
-gl.bufferSubData = function bufferSubData(target, offset, data, srcOffset=0, length=0) {
-  if (!(arguments.length >= 3 && arguments.length <=5 && typeof target === "number" && typeof offset === "number" && typeof data === "object")) {
-    console.log([target, offset, data])
-    throw new TypeError('Expected bufferSubData(number target, number offset, ArrayBuffer data, srcOffset=0, length=0)');
-  }
+fast.bufferSubData = function bufferSubData(target, offset, data, srcOffset=0, length=0) {
   const bytesPerElement = (data.byteLength/data.length)
   const srcOffsetBytes = srcOffset * bytesPerElement;
   const lengthBytes = length * bytesPerElement;
   return _bufferSubData(target, offset, data, srcOffsetBytes, lengthBytes);
 }
+gl.bufferSubData = function bufferSubData(target, offset, data, srcOffset=0, length=0) {
+  if (!(arguments.length >= 3 && arguments.length <=5 && typeof target === "number" && typeof offset === "number" && typeof data === "object")) {
+    throw new TypeError('Expected bufferSubData(number target, number offset, ArrayBuffer data, srcOffset=0, length=0)');
+  }
+  return fast.bufferSubData(target, offset, data, srcOffset, length);
+}
 
-var _checkFramebufferStatus = gl.checkFramebufferStatus;
+var _checkFramebufferStatus = fast.checkFramebufferStatus = gl.checkFramebufferStatus;
 gl.checkFramebufferStatus = function checkFramebufferStatus(target) {
   if (!(arguments.length === 1 && typeof target === "number")) {
     throw new TypeError('Expected checkFramebufferStatus(number target)');
@@ -264,7 +727,7 @@ gl.checkFramebufferStatus = function checkFramebufferStatus(target) {
   return _checkFramebufferStatus(target);
 }
 
-var _clear = gl.clear;
+var _clear = fast.clear = gl.clear;
 gl.clear = function clear(mask) {
   if (!(arguments.length === 1 && typeof mask === "number")) {
     throw new TypeError('Expected clear(number mask)');
@@ -272,7 +735,7 @@ gl.clear = function clear(mask) {
   return _clear(mask);
 }
 
-var _clearColor = gl.clearColor;
+var _clearColor = fast.clearColor = gl.clearColor;
 gl.clearColor = function clearColor(red, green, blue, alpha) {
   if (!(arguments.length === 4 && typeof red === "number" && typeof green === "number" && typeof blue === "number" && typeof alpha === "number")) {
     throw new TypeError('Expected clearColor(number red, number green, number blue, number alpha)');
@@ -280,7 +743,7 @@ gl.clearColor = function clearColor(red, green, blue, alpha) {
   return _clearColor(red, green, blue, alpha);
 }
 
-var _clearDepth = gl.clearDepth;
+var _clearDepth = fast.clearDepth = gl.clearDepth;
 gl.clearDepth = function clearDepth(depth) {
   if (!(arguments.length === 1 && typeof depth === "number")) {
     throw new TypeError('Expected clearDepth(number depth)');
@@ -288,7 +751,7 @@ gl.clearDepth = function clearDepth(depth) {
   return _clearDepth(depth);
 }
 
-var _clearStencil = gl.clearStencil;
+var _clearStencil = fast.clearStencil = gl.clearStencil;
 gl.clearStencil = function clearStencil(s) {
   if (!(arguments.length === 1 && typeof s === "number")) {
     throw new TypeError('Expected clearStencil(number s)');
@@ -296,7 +759,7 @@ gl.clearStencil = function clearStencil(s) {
   return _clearStencil(s);
 }
 
-var _colorMask = gl.colorMask;
+var _colorMask = fast.colorMask = gl.colorMask;
 gl.colorMask = function colorMask(red, green, blue, alpha) {
   if (!(arguments.length === 4 && typeof red === "boolean" && typeof green === "boolean" && typeof blue === "boolean" && typeof alpha === "boolean")) {
     throw new TypeError('Expected colorMask(boolean red, boolean green, boolean blue, boolean alpha)');
@@ -305,14 +768,17 @@ gl.colorMask = function colorMask(red, green, blue, alpha) {
 }
 
 var _compileShader = gl.compileShader;
+fast.compileShader = function compileShader(shader) {
+  return _compileShader(shader ? shader._ : 0);
+}
 gl.compileShader = function compileShader(shader) {
   if (!(arguments.length === 1 && (shader === null || shader instanceof gl.WebGLShader))) {
     throw new TypeError('Expected compileShader(WebGLShader shader)');
   }
-  return _compileShader(shader ? shader._ : 0);
+  return fast.compileShader(shader);
 }
 
-var _copyTexImage2D = gl.copyTexImage2D;
+var _copyTexImage2D = fast.copyTexImage2D = gl.copyTexImage2D;
 gl.copyTexImage2D = function copyTexImage2D(target, level, internalformat, x, y, width, height, border) {
   if (!(arguments.length === 8 && typeof target === "number" && typeof level === "number" && typeof internalformat === "number" && typeof x === "number" && typeof y === "number" && typeof width === "number" && typeof height === "number" && typeof border === "number")) {
     throw new TypeError('Expected copyTexImage2D(number target, number level, number internalformat, number x, number y, number width, number height, number border)');
@@ -320,7 +786,7 @@ gl.copyTexImage2D = function copyTexImage2D(target, level, internalformat, x, y,
   return _copyTexImage2D(target, level, internalformat, x, y, width, height, border);
 }
 
-var _copyTexSubImage2D = gl.copyTexSubImage2D;
+var _copyTexSubImage2D = fast.copyTexSubImage2D = gl.copyTexSubImage2D;
 gl.copyTexSubImage2D = function copyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, height) {
   if (!(arguments.length === 8 && typeof target === "number" && typeof level === "number" && typeof xoffset === "number" && typeof yoffset === "number" && typeof x === "number" && typeof y === "number" && typeof width === "number" && typeof height === "number")) {
     throw new TypeError('Expected copyTexSubImage2D(number target, number level, number xoffset, number yoffset, number x, number y, number width, number height)');
@@ -329,113 +795,1408 @@ gl.copyTexSubImage2D = function copyTexSubImage2D(target, level, xoffset, yoffse
 }
 
 var _createBuffer = gl.createBuffer;
+fast.createBuffer = function createBuffer() {
+  return owned(new gl.WebGLBuffer(_createBuffer()), objectTypes.buffer);
+}
 gl.createBuffer = function createBuffer() {
   if (!(arguments.length === 0)) {
     throw new TypeError('Expected createBuffer()');
   }
-  //console.log('calling _createBuffer')
-  const buf = _createBuffer();
-  //console.log('calling gl.WebGLBuffer(buf)')
-  return new gl.WebGLBuffer(buf);
+  return fast.createBuffer();
 }
 
 var _createFramebuffer = gl.createFramebuffer;
-gl.createFramebuffer = function () {
+fast.createFramebuffer = function createFramebuffer() {
+  return owned(new gl.WebGLFramebuffer(_createFramebuffer()), objectTypes.framebuffer);
+}
+gl.createFramebuffer = function createFramebuffer() {
   if (!(arguments.length === 0)) {
     throw new TypeError('Expected createFramebuffer()');
   }
-  return new gl.WebGLFramebuffer(_createFramebuffer());
+  return fast.createFramebuffer();
 }
 
 var _createProgram = gl.createProgram;
+fast.createProgram = function createProgram() {
+  return owned(new gl.WebGLProgram(_createProgram()), objectTypes.program);
+}
 gl.createProgram = function createProgram() {
   if (!(arguments.length === 0)) {
     throw new TypeError('Expected createProgram()');
   }
-  return new gl.WebGLProgram(_createProgram());
+  return fast.createProgram();
 }
 
 var _createRenderbuffer = gl.createRenderbuffer;
+fast.createRenderbuffer = function createRenderbuffer() {
+  return owned(new gl.WebGLRenderbuffer(_createRenderbuffer()), objectTypes.renderbuffer);
+}
 gl.createRenderbuffer = function createRenderbuffer() {
   if (!(arguments.length === 0)) {
     throw new TypeError('Expected createRenderbuffer()');
   }
-  return new gl.WebGLRenderbuffer(_createRenderbuffer());
+  return fast.createRenderbuffer();
 }
 
 var _createShader = gl.createShader;
+fast.createShader = function createShader(type) {
+  return owned(new gl.WebGLShader(_createShader(type)), objectTypes.shader);
+}
 gl.createShader = function createShader(type) {
   if (!(arguments.length === 1 && typeof type === "number")) {
     throw new TypeError('Expected createShader(number type)');
   }
-  return new gl.WebGLShader(_createShader(type));
+  return fast.createShader(type);
 }
 
 var _createTexture = gl.createTexture;
+fast.createTexture = function createTexture(typeTarget) {
+  return owned(new gl.WebGLTexture(_createTexture(typeTarget)), objectTypes.texture);
+}
 gl.createTexture = function createTexture(typeTarget) {
   if (!(arguments.length === 1)) {
     throw new TypeError('Expected createTexture(typeTarget)');
   }
-  return new gl.WebGLTexture(_createTexture(typeTarget));
+  return fast.createTexture(typeTarget);
 }
 var _createSampler = gl.createSampler;
+fast.createSampler = function createSampler() {
+  return owned(new gl.WebGLSampler(_createSampler()), objectTypes.sampler);
+}
 gl.createSampler = function createSampler() {
   if (!(arguments.length === 0)) {
     throw new TypeError('Expected createSampler()');
   }
-  return new gl.WebGLSampler(_createSampler());
+  return fast.createSampler();
 }
 var _createTransformFeedback = gl.createTransformFeedback;
+fast.createTransformFeedback = function createTransformFeedback() {
+  return owned(new gl.WebGLTransformFeedback(_createTransformFeedback()), objectTypes.transformFeedback);
+}
 gl.createTransformFeedback = function createTransformFeedback() {
   if (!(arguments.length === 0)) {
     throw new TypeError('Expected createTransformFeedback()');
   }
-  return new gl.WebGLTransformFeedback(_createTransformFeedback());
+  return fast.createTransformFeedback();
 }
 var _bindTransformFeedback = gl.bindTransformFeedback;
+fast.bindTransformFeedback = function bindTransformFeedback(target, tf) {
+  return _bindTransformFeedback(target, tf?tf._:0);
+}
 gl.bindTransformFeedback = function bindTransformFeedback(target, tf) {
   if (!(arguments.length === 2)) {
     throw new TypeError('Expected bindTransformFeedback(number target, WebGLTransformFeedback tf)');
   }
-  return _bindTransformFeedback(target, tf?tf._:0);
+  return fast.bindTransformFeedback(target, tf);
 }
 var _transformFeedbackVaryings = gl.transformFeedbackVaryings;
+fast.transformFeedbackVaryings = function transformFeedbackVaryings(program, varyingNames, bufferMode) {
+  return _transformFeedbackVaryings(program?program._:0, varyingNames, bufferMode);
+}
 gl.transformFeedbackVaryings = function transformFeedbackVaryings(program, varyingNames, bufferMode) {
   if (!(arguments.length === 3)) {
     throw new TypeError('Expected transformFeedbackVaryings(WebGLProgram program, array varyingNames, number bufferMode)');
   }
-  return _transformFeedbackVaryings(program?program._:0, varyingNames, bufferMode);
+  return fast.transformFeedbackVaryings(program, varyingNames, bufferMode);
 }
 var _getTransformFeedbackVarying = gl.getTransformFeedbackVarying;
+fast.getTransformFeedbackVarying = function getTransformFeedbackVarying(program, index) {
+  return _getTransformFeedbackVarying(program?program._:0, index);
+}
 gl.getTransformFeedbackVarying = function getTransformFeedbackVarying(program, index) {
   if (!(arguments.length === 2)) {
     throw new TypeError('Expected getTransformFeedbackVarying(WebGLProgram program, number index)');
   }
-  return _getTransformFeedbackVarying(program?program._:0, index);
+  return fast.getTransformFeedbackVarying(program, index);
 }
 var _samplerParameteri = gl.samplerParameteri;
-gl.samplerParameteri = function samplerParameteri(sampler, pname, param){
-  if (!(arguments.length === 3) || typeof(sampler._) !== 'number') {
+fast.samplerParameteri = function samplerParameteri(sampler, pname, param) {
+  return _samplerParameteri(sampler._, pname, param);
+}
+gl.samplerParameteri = function samplerParameteri(sampler, pname, param) {
+  if (!(arguments.length === 3 && (sampler instanceof gl.WebGLSampler) && typeof pname === "number" && typeof param === "number")) {
     throw new TypeError('Expected samplerParameteri(WebGLSampler sampler, number pname, number param)');
   }
-  return _samplerParameteri(sampler._, pname, param);
+  if (sampler._cached) {
+    throw new TypeError('samplerParameteri: samplers returned by getSampler are shared and immutable');
+  }
+  return fast.samplerParameteri(sampler, pname, param);
+}
+var _samplerParameterf = gl.samplerParameterf;
+fast.samplerParameterf = function samplerParameterf(sampler, pname, param) {
+  return _samplerParameterf(sampler._, pname, param);
+}
+gl.samplerParameterf = function samplerParameterf(sampler, pname, param) {
+  if (!(arguments.length === 3 && (sampler instanceof gl.WebGLSampler) && typeof pname === "number" && typeof param === "number")) {
+    throw new TypeError('Expected samplerParameterf(WebGLSampler sampler, number pname, number param)');
+  }
+  if (sampler._cached) {
+    throw new TypeError('samplerParameterf: samplers returned by getSampler are shared and immutable');
+  }
+  return fast.samplerParameterf(sampler, pname, param);
 }
 var _bindSampler = gl.bindSampler;
-gl.bindSampler = function bindSampler(unit, sampler){
-  if (!(arguments.length === 2) || typeof(unit) !== 'number') {
+fast.bindSampler = function bindSampler(unit, sampler) {
+  return _bindSampler(unit, sampler ? sampler._ : 0);
+}
+gl.bindSampler = function bindSampler(unit, sampler) {
+  if (!(arguments.length === 2 && typeof unit === "number" && (sampler === null || sampler instanceof gl.WebGLSampler))) {
     throw new TypeError('Expected bindSampler(number unit, WebGLSampler sampler)');
   }
-  return _bindSampler(unit, sampler?sampler._:0);
+  return fast.bindSampler(unit, sampler);
 }
 var _deleteSampler = gl.deleteSampler;
-gl.deleteSampler = function deleteSampler(sampler, pname, param){
-  if (!(arguments.length === 1) || typeof(sampler._) !== 'number') {
+fast.deleteSampler = function deleteSampler(sampler) {
+  if (sampler && sampler._cached) {
+    // drops every reference, the sampler is gone for all its users
+    releaseCachedSampler(sampler, Infinity);
+    return;
+  }
+  return _deleteSampler(sampler ? sampler._ : 0);
+}
+gl.deleteSampler = function deleteSampler(sampler) {
+  if (!(arguments.length === 1 && (sampler === null || sampler instanceof gl.WebGLSampler))) {
     throw new TypeError('Expected deleteSampler(WebGLSampler sampler)');
   }
-  return _deleteSampler(sampler._);
+  return fast.deleteSampler(sampler);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Sampler cache
+//
+// gl.getSampler(desc) returns a shared sampler for a set of sampling
+// parameters: equal descriptors get the same GL sampler and, while it is
+// alive, the same wrapper, so code can skip bindSampler when the bound
+// sampler is already the one it wants. Cached samplers are immutable and
+// reference counted. Every getSampler takes a reference, gl.releaseSampler
+// drops one; the references still held by a collected wrapper are dropped
+// with it.
+
+var _getSampler = gl.getSampler;
+var _releaseSampler = gl.releaseSampler;
+var _getSamplerCacheStats = gl.getSamplerCacheStats;
+
+// must match SamplerDescField in src/sampler_cache.cc
+var samplerDescFields = ['minFilter', 'magFilter', 'wrapS', 'wrapT', 'wrapR',
+  'compareMode', 'compareFunc', 'anisotropy', 'minLod', 'maxLod', 'lodBias'];
+var samplerDefaults = {
+  minFilter: 0x2702, // NEAREST_MIPMAP_LINEAR
+  magFilter: 0x2601, // LINEAR
+  wrapS: 0x2901, wrapT: 0x2901, wrapR: 0x2901, // REPEAT
+  compareMode: 0, compareFunc: 0x0203, // NONE, LEQUAL
+  anisotropy: 1, minLod: -1000, maxLod: 1000, lodBias: 0
+};
+var samplerDesc = new Float64Array(samplerDescFields.length + 4);
+
+// name -> WeakRef to the live wrapper of a cached sampler
+var cachedSamplers = new Map();
+var cachedSamplerRefs = new FinalizationRegistry(function(cached) {
+  if (cachedSamplers.get(cached.name) && !cachedSamplers.get(cached.name).deref())
+    cachedSamplers.delete(cached.name);
+  if (cached.refs > 0) _releaseSampler(cached.name, cached.refs);
+});
+
+function releaseCachedSampler(sampler, count) {
+  var cached = sampler._cached;
+  count = Math.min(count, cached.refs);
+  cached.refs -= count;
+  _releaseSampler(cached.name, count);
+  if (cached.refs === 0) {
+    cachedSamplerRefs.unregister(sampler);
+    cachedSamplers.delete(cached.name);
+    sampler._cached = null;
+    sampler._ = 0;
+  }
+}
+
+// desc: {minFilter, magFilter, wrap (all three), wrapS, wrapT, wrapR,
+// compare (the compare function, turns on COMPARE_REF_TO_TEXTURE), compareMode,
+// compareFunc, anisotropy, minLod, maxLod, lodBias, borderColor: [r, g, b, a]}.
+// Anything left out has its GL default.
+gl.getSampler = function getSampler(desc) {
+  if (!(arguments.length === 1 && desc !== null && typeof desc === 'object')) {
+    throw new TypeError('Expected getSampler(object desc)');
+  }
+  var wrap = desc.wrap;
+  for (var i = 0; i < samplerDescFields.length; i++) {
+    var field = samplerDescFields[i];
+    var value = desc[field];
+    if (value === undefined && wrap !== undefined && (field === 'wrapS' || field === 'wrapT' || field === 'wrapR')) value = wrap;
+    if (value === undefined && desc.compare !== undefined) {
+      if (field === 'compareMode') value = 0x884E; // COMPARE_REF_TO_TEXTURE
+      else if (field === 'compareFunc') value = desc.compare;
+    }
+    if (value === undefined) value = samplerDefaults[field];
+    if (typeof value !== 'number') {
+      throw new TypeError('getSampler: ' + field + ' must be a number');
+    }
+    samplerDesc[i] = value;
+  }
+  var border = desc.borderColor || [0, 0, 0, 0];
+  for (var i = 0; i < 4; i++) samplerDesc[samplerDescFields.length + i] = +border[i] || 0;
+
+  var name = _getSampler(samplerDesc);
+  var ref = cachedSamplers.get(name);
+  var sampler = ref && ref.deref();
+  if (sampler && sampler._cached) {
+    sampler._cached.refs++;
+    return sampler;
+  }
+  // the sampler isn't reclaimed like created ones, its references are
+  sampler = new gl.WebGLSampler(name);
+  sampler._cached = { name: name, refs: 1 };
+  cachedSamplers.set(name, new WeakRef(sampler));
+  cachedSamplerRefs.register(sampler, sampler._cached, sampler);
+  return sampler;
+}
+
+// Drops one reference to a sampler returned by getSampler; the last one
+// deletes it.
+gl.releaseSampler = function releaseSampler(sampler) {
+  if (!(arguments.length === 1 && (sampler instanceof gl.WebGLSampler))) {
+    throw new TypeError('Expected releaseSampler(WebGLSampler sampler)');
+  }
+  if (sampler._cached) releaseCachedSampler(sampler, 1);
+}
+
+// Returns {samplers, references, hits, misses}.
+gl.getSamplerCacheStats = function getSamplerCacheStats() {
+  return _getSamplerCacheStats();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Render states
+//
+// gl.createRenderState(desc) bundles blend, depth, stencil, cull, color mask,
+// polygon offset and scissor state into an immutable block;
+// gl.applyRenderState(state) switches to it, issuing only the GL calls for
+// what differs from the block applied before. Equal descriptors share a
+// block, which is freed (and its slot reused) once every state created for it
+// has gone through gl.deleteRenderState or been collected. Setting any of that
+// state directly (gl.enable, gl.blendFunc, ...) is fine, the next
+// applyRenderState then sets everything.
+
+var _createRenderState = gl.createRenderState;
+var _applyRenderState = gl.applyRenderState;
+var _invalidateRenderState = gl.invalidateRenderState;
+var _deleteRenderState = gl.deleteRenderState;
+
+gl.WebGLRenderState = function WebGLRenderState(_) { this._ = _; }
+
+var renderStates = new FinalizationRegistry(function(name) {
+  _deleteRenderState(name);
+});
+
+// must match RenderStateField in src/render_state.cc
+var renderStateFields = 44;
+var renderStateDesc = new Float64Array(renderStateFields);
+var stencilDefaults = { func: 0x0207, ref: 0, readMask: 0xFFFFFFFF, writeMask: 0xFFFFFFFF, fail: 0x1E00, zfail: 0x1E00, zpass: 0x1E00 }; // ALWAYS, KEEP
+
+function renderStateValue(value, fallback, what) {
+  if (value === undefined) return fallback;
+  if (typeof value === 'boolean') return +value;
+  if (typeof value !== 'number') throw new TypeError('createRenderState: ' + what + ' must be a number');
+  return value;
+}
+
+function packStencilFace(offset, stencil, face) {
+  face = face || {};
+  var keys = ['func', 'ref', 'readMask', 'writeMask', 'fail', 'zfail', 'zpass'];
+  for (var i = 0; i < keys.length; i++) {
+    var value = face[keys[i]] !== undefined ? face[keys[i]] : stencil[keys[i]];
+    renderStateDesc[offset + i] = renderStateValue(value, stencilDefaults[keys[i]], 'stencil.' + keys[i]);
+  }
+}
+
+// desc (anything left out has its GL default, false/absent disables a test):
+//   blend: true | {src, dst, srcRGB, dstRGB, srcAlpha, dstAlpha, equation, equationRGB, equationAlpha, color: [r, g, b, a]}
+//   depth: true | {func, write}
+//   stencil: true | {func, ref, readMask, writeMask, fail, zfail, zpass, front: {...}, back: {...}}
+//   cull: true | face | {face}, frontFace
+//   colorMask: [r, g, b, a]
+//   polygonOffset: {factor, units}
+//   scissor: [x, y, width, height]
+gl.createRenderState = function createRenderState(desc) {
+  if (!(arguments.length === 1 && desc !== null && typeof desc === 'object')) {
+    throw new TypeError('Expected createRenderState(object desc)');
+  }
+  var d = renderStateDesc, v = renderStateValue;
+
+  var blend = desc.blend === true ? {} : desc.blend;
+  d[0] = blend ? 1 : 0;
+  blend = blend || {};
+  d[1] = v(blend.equationRGB, v(blend.equation, 0x8006, 'blend.equation'), 'blend.equationRGB'); // FUNC_ADD
+  d[2] = v(blend.equationAlpha, d[1], 'blend.equationAlpha');
+  d[3] = v(blend.srcRGB, v(blend.src, 1, 'blend.src'), 'blend.srcRGB'); // ONE
+  d[4] = v(blend.dstRGB, v(blend.dst, 0, 'blend.dst'), 'blend.dstRGB'); // ZERO
+  d[5] = v(blend.srcAlpha, d[3], 'blend.srcAlpha');
+  d[6] = v(blend.dstAlpha, d[4], 'blend.dstAlpha');
+  var color = blend.color || [0, 0, 0, 0];
+  for (var i = 0; i < 4; i++) d[7 + i] = +color[i] || 0;
+
+  var depth = desc.depth === true ? {} : desc.depth;
+  d[11] = depth ? 1 : 0;
+  depth = depth || {};
+  d[12] = v(depth.func, 0x0201, 'depth.func'); // LESS
+  d[13] = v(depth.write, 1, 'depth.write');
+
+  var stencil = desc.stencil === true ? {} : desc.stencil;
+  d[14] = stencil ? 1 : 0;
+  stencil = stencil || {};
+  packStencilFace(15, stencil, stencil.front);
+  packStencilFace(22, stencil, stencil.back);
+
+  var cull = desc.cull === true ? {} : typeof desc.cull === 'number' ? { face: desc.cull } : desc.cull;
+  d[29] = cull ? 1 : 0;
+  d[30] = v((cull || {}).face, 0x0405, 'cull.face'); // BACK
+  d[31] = v(desc.frontFace, 0x0901, 'frontFace'); // CCW
+
+  var colorMask = desc.colorMask || [true, true, true, true];
+  for (var i = 0; i < 4; i++) d[32 + i] = colorMask[i] ? 1 : 0;
+
+  var offset = desc.polygonOffset;
+  d[36] = offset ? 1 : 0;
+  d[37] = v((offset || {}).factor, 0, 'polygonOffset.factor');
+  d[38] = v((offset || {}).units, 0, 'polygonOffset.units');
+
+  var scissor = desc.scissor;
+  d[39] = scissor ? 1 : 0;
+  for (var i = 0; i < 4; i++) d[40 + i] = scissor ? scissor[i] | 0 : 0;
+
+  var name = _createRenderState(d);
+  var state = new gl.WebGLRenderState(name);
+  renderStates.register(state, name, state);
+  return state;
+}
+
+gl.deleteRenderState = function deleteRenderState(state) {
+  if (!(arguments.length === 1 && (state instanceof gl.WebGLRenderState))) {
+    throw new TypeError('Expected deleteRenderState(WebGLRenderState state)');
+  }
+  if (!state._) return;
+  renderStates.unregister(state);
+  _deleteRenderState(state._);
+  state._ = 0;
+}
+
+// Returns the number of GL calls it issued.
+fast.applyRenderState = function applyRenderState(state) {
+  return _applyRenderState(state._);
+}
+gl.applyRenderState = function applyRenderState(state) {
+  if (!(arguments.length === 1 && (state instanceof gl.WebGLRenderState))) {
+    throw new TypeError('Expected applyRenderState(WebGLRenderState state)');
+  }
+  return fast.applyRenderState(state);
+}
+
+// For GL state changed outside the bindings: the next applyRenderState sets
+// everything.
+gl.invalidateRenderState = function invalidateRenderState() {
+  return _invalidateRenderState();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Render queue
+//
+// A gl.RenderQueue records draws into a typed array instead of issuing them;
+// queue.submit() sorts them by a 64-bit key in native code and issues them
+// changing only the vertex array, program, render state and binding group
+// that differ from the previous draw. The key is made of a 32-bit sort key
+// (e.g. program << 20 | material) and the view depth: 'opaque' queues sort
+// by sort key, then front to back; 'transparent' queues back to front, then
+// by sort key; 'none' keeps the recording order.
+
+var _createBindingGroup = gl.createBindingGroup;
+var _deleteBindingGroup = gl.deleteBindingGroup;
+var _executeRenderQueue = gl.executeRenderQueue;
+
+// objects keeps the wrappers, so they aren't reclaimed while the group uses them
+gl.WebGLBindingGroup = function WebGLBindingGroup(_, objects) { this._ = _; this.objects = objects; }
+
+var bindingGroups = new FinalizationRegistry(function(name) {
+  _deleteBindingGroup(name);
+});
+
+function bindingGroupNames(list, type, what) {
+  if (!list) return null;
+  return Uint32Array.from(list, function(object) {
+    if (!(object === null || object instanceof type)) throw new TypeError('createBindingGroup: ' + what + ' must be an array of ' + type.name);
+    return object ? object._ : 0;
+  });
+}
+
+// buffers: [WebGLBuffer] to bind whole buffers, or [{buffer, offset, size}]
+function bindingGroupBuffers(list, what) {
+  if (!list) return [null, null];
+  var ranged = list.length > 0 && list[0] !== null && !(list[0] instanceof gl.WebGLBuffer);
+  var names = new Uint32Array(list.length);
+  var ranges = ranged ? new Float64Array(list.length * 2) : null;
+  list.forEach(function(entry, i) {
+    var buffer = ranged ? entry && entry.buffer : entry;
+    if (!(buffer === null || buffer instanceof gl.WebGLBuffer) || (ranged && !(entry && typeof entry.size === 'number'))) {
+      throw new TypeError('createBindingGroup: ' + what + ' must be an array of WebGLBuffer or of {buffer, offset, size}');
+    }
+    names[i] = buffer ? buffer._ : 0;
+    if (ranged) {
+      ranges[i * 2] = entry.offset || 0;
+      ranges[i * 2 + 1] = entry.size;
+    }
+  });
+  return [names, ranges];
+}
+
+// desc: {textures, samplers, uniformBuffers, storageBuffers}, bound from
+// unit (binding point) 0 up. The group keeps the names it was created with,
+// so textures under gl.manageTexture (which change names) are refused.
+gl.createBindingGroup = function createBindingGroup(desc) {
+  if (!(arguments.length === 1 && desc !== null && typeof desc === 'object')) {
+    throw new TypeError('Expected createBindingGroup(object desc)');
+  }
+  if (desc.textures && desc.textures.some(function(texture) { return texture && texture._resident; })) {
+    throw new TypeError('createBindingGroup: textures under gl.manageTexture change names, bind them with bindTexture');
+  }
+  var uniforms = bindingGroupBuffers(desc.uniformBuffers, 'uniformBuffers');
+  var storage = bindingGroupBuffers(desc.storageBuffers, 'storageBuffers');
+  var name = _createBindingGroup(bindingGroupNames(desc.textures, gl.WebGLTexture, 'textures'),
+                                 bindingGroupNames(desc.samplers, gl.WebGLSampler, 'samplers'),
+                                 uniforms[0], uniforms[1], storage[0], storage[1]);
+  var group = new gl.WebGLBindingGroup(name, [desc.textures, desc.samplers, desc.uniformBuffers, desc.storageBuffers]);
+  bindingGroups.register(group, name, group);
+  return group;
+}
+
+gl.deleteBindingGroup = function deleteBindingGroup(group) {
+  if (!(arguments.length === 1 && (group instanceof gl.WebGLBindingGroup))) {
+    throw new TypeError('Expected deleteBindingGroup(WebGLBindingGroup group)');
+  }
+  if (!group._) return;
+  bindingGroups.unregister(group);
+  _deleteBindingGroup(group._);
+  group._ = 0;
+  group.objects = null;
+}
+
+// must match RenderQueueField in src/render_queue.cc
+var renderQueueStride = 16;
+var renderQueueSorts = { opaque: true, transparent: true, none: false };
+var depthFloat = new Float32Array(1);
+var depthBits = new Uint32Array(depthFloat.buffer);
+
+// the bits of a non-negative float sort like the float
+function depthKey(depth) {
+  depthFloat[0] = depth > 0 ? depth : 0;
+  return depthBits[0];
+}
+
+gl.RenderQueue = function RenderQueue(sort, capacity) {
+  this.sort = sort;
+  this.records = new Uint32Array(Math.max(1, capacity) * renderQueueStride);
+  this.count = 0;
+}
+
+gl.RenderQueue.prototype.clear = function clear() {
+  this.count = 0;
+}
+
+// Appends the part of a record shared by both draw types, returns its offset.
+gl.RenderQueue.prototype.record = function record(sortKey, depth, vertexArray, program, state, group) {
+  if (this.count * renderQueueStride === this.records.length) {
+    var grown = new Uint32Array(this.records.length * 2);
+    grown.set(this.records);
+    this.records = grown;
+  }
+  if (vertexArray instanceof gl.WebGLVertexLayout) {
+    // attach the buffers set since the layout was last bound
+    if (vertexArray.buffersChanged || vertexArray.pendingElementBuffer >= 0) fast.bindVertexLayout(vertexArray);
+    vertexArray = vertexArray.vertexArray;
+  }
+
+  var r = this.records, o = this.count++ * renderQueueStride;
+  if (this.sort === 'transparent') {
+    r[o + 1] = ~depthKey(depth);
+    r[o] = sortKey;
+  } else if (this.sort === 'opaque') {
+    r[o + 1] = sortKey;
+    r[o] = depthKey(depth);
+  } else {
+    r[o + 1] = r[o] = 0;
+  }
+  r[o + 2] = vertexArray ? vertexArray._ : 0;
+  r[o + 3] = program ? program._ : 0;
+  r[o + 4] = state ? state._ : 0;
+  r[o + 5] = group ? group._ : 0;
+  return o;
+}
+
+gl.RenderQueue.prototype.drawArrays = function drawArrays(sortKey, depth, vertexArray, program, state, group, mode, first, count, instanceCount=1, baseInstance=0) {
+  var o = this.record(sortKey, depth, vertexArray, program, state, group), r = this.records;
+  r[o + 6] = mode;
+  r[o + 7] = count;
+  r[o + 8] = 0;
+  r[o + 9] = first;
+  r[o + 10] = instanceCount;
+  r[o + 11] = 0;
+  r[o + 12] = baseInstance;
+  r[o + 13] = 0;
+  return this;
+}
+
+gl.RenderQueue.prototype.drawElements = function drawElements(sortKey, depth, vertexArray, program, state, group, mode, count, type, offset, instanceCount=1, baseVertex=0, baseInstance=0) {
+  var o = this.record(sortKey, depth, vertexArray, program, state, group), r = this.records;
+  r[o + 6] = mode;
+  r[o + 7] = count;
+  r[o + 8] = type;
+  // offsets past 4 GiB take a high word
+  r[o + 9] = offset % 0x100000000;
+  r[o + 10] = instanceCount;
+  r[o + 11] = baseVertex;
+  r[o + 12] = baseInstance;
+  r[o + 13] = Math.floor(offset / 0x100000000);
+  return this;
+}
+
+// Issues the recorded draws (the queue keeps them, clear() empties it), returns
+// {draws, stateChangesUnsorted, stateChangesSorted, glCalls}.
+gl.RenderQueue.prototype.submit = function submit() {
+  return _executeRenderQueue(this.records, this.count, renderQueueSorts[this.sort]);
+}
+
+// options: {sort: 'opaque' | 'transparent' | 'none', capacity: draws}
+gl.createRenderQueue = function createRenderQueue(options={}) {
+  var sort = options.sort === undefined ? 'opaque' : options.sort;
+  if (!(sort in renderQueueSorts)) {
+    throw new TypeError("createRenderQueue: sort must be 'opaque', 'transparent' or 'none'");
+  }
+  return new gl.RenderQueue(sort, options.capacity || 256);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Culling
+//
+// gl.cullSpheres / gl.cullBoxes test arrays of bounding volumes against a
+// frustum in native code (4 objects per SSE2 iteration, optionally on
+// several threads) and return the number of visible objects.
+
+var _cullSpheres = gl.cullSpheres;
+var _cullBoxes = gl.cullBoxes;
+
+// Extracts the 6 normalized planes (left, right, bottom, top, near, far) of a
+// column major view projection matrix into out, for the cull functions.
+gl.frustumPlanes = function frustumPlanes(viewProjection, out=new Float32Array(24)) {
+  var m = viewProjection;
+  for (var p = 0; p < 6; p++) {
+    var row = p >> 1, sign = p & 1 ? -1 : 1;
+    var a = m[3] + sign * m[row], b = m[7] + sign * m[4 + row], c = m[11] + sign * m[8 + row], d = m[15] + sign * m[12 + row];
+    var length = Math.sqrt(a * a + b * b + c * c) || 1;
+    out[p * 4] = a / length;
+    out[p * 4 + 1] = b / length;
+    out[p * 4 + 2] = c / length;
+    out[p * 4 + 3] = d / length;
+  }
+  return out;
+}
+
+var lodParams = new Float32Array(4 + 8);
+
+// options: {indices: Uint32Array, the visible objects' indices are written
+// to its start; lod: Uint8Array, a LOD level per object, which needs camera:
+// [x, y, z], projScale: viewport height / 2 / tan(fovy / 2), and
+// lodSizes: up to 8 descending pixel diameters, the level being the number
+// of them the object is smaller than; threads: 1 by default, 0 for every
+// core}
+function cullVolumes(cull, what, floats, planes, bounds, visible, options) {
+  if (!(planes instanceof Float32Array && planes.length >= 24 && bounds instanceof Float32Array && visible instanceof Uint8Array)) {
+    throw new TypeError('Expected ' + what + '(Float32Array planes, Float32Array bounds, Uint8Array visible, [object options])');
+  }
+  if (visible.length * floats < bounds.length) {
+    throw new RangeError(what + ': visible needs a byte per object');
+  }
+  var params = null;
+  if (options.lod) {
+    var camera = options.camera || [0, 0, 0], sizes = options.lodSizes || [];
+    if (sizes.length > 8) throw new RangeError(what + ': at most 8 lodSizes');
+    params = lodParams.subarray(0, 4 + sizes.length);
+    params[0] = camera[0]; params[1] = camera[1]; params[2] = camera[2];
+    params[3] = options.projScale || 1;
+    params.set(sizes, 4);
+  }
+  return cull(planes, bounds, visible, options.indices || null, options.lod || null, params,
+              options.threads === undefined ? 1 : options.threads);
 }
 
-var _cullFace = gl.cullFace;
+// spheres: x, y, z, radius per object
+gl.cullSpheres = function cullSpheres(planes, spheres, visible, options={}) {
+  return cullVolumes(_cullSpheres, 'cullSpheres', 4, planes, spheres, visible, options);
+}
+
+// boxes: min x, y, z, max x, y, z per object
+gl.cullBoxes = function cullBoxes(planes, boxes, visible, options={}) {
+  return cullVolumes(_cullBoxes, 'cullBoxes', 6, planes, boxes, visible, options);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Batched matrices
+//
+// Column major mat4 math over whole Float32Arrays in native code (SSE2
+// products, optionally on several threads). Inputs are tightly packed;
+// options.stride is the number of floats between output matrices, so they
+// can be written into interleaved instance or uniform data (a subarray picks
+// the offset). options.count defaults to the number of matrices in the
+// inputs, options.threads to 1 (0 for every core).
+
+var _multiplyMat4 = gl.multiplyMat4;
+var _composeMat4 = gl.composeMat4;
+var _propagateMat4 = gl.propagateMat4;
+var _normalMatrices = gl.normalMatrices;
+var _invertMat4 = gl.invertMat4;
+
+function matrixCount(options, length, floats) {
+  return options.count === undefined ? Math.floor(length / floats) : options.count;
+}
+
+// out[i] = a[i] * b[i]; a or b can be a single matrix used for every i.
+gl.multiplyMat4 = function multiplyMat4(out, a, b, options={}) {
+  return _multiplyMat4(out, a, b, matrixCount(options, Math.max(a.length, b.length), 16), options.stride, options.threads);
+}
+
+// out[i] = translate * rotate * scale from vec3 translations, quaternion
+// (x, y, z, w) rotations and vec3 scales (or null).
+gl.composeMat4 = function composeMat4(out, translations, rotations, scales=null, options={}) {
+  return _composeMat4(out, translations, rotations, scales, matrixCount(options, translations.length, 3), options.stride, options.threads);
+}
+
+// world[i] = world[parents[i]] * local[i], local[i] for roots (parents[i] < 0),
+// in one pass: parents must come before their children.
+gl.propagateMat4 = function propagateMat4(world, local, parents, options={}) {
+  return _propagateMat4(world, local, parents, matrixCount(options, parents.length, 1), options.stride);
+}
+
+// The inverse transposes of the matrices' upper 3x3, as 3 columns of 4 floats
+// (a std140 mat3; with stride 16 into mat4 slots, leaving the last column).
+gl.normalMatrices = function normalMatrices(out, matrices, options={}) {
+  return _normalMatrices(out, matrices, matrixCount(options, matrices.length, 16), options.stride, options.threads);
+}
+
+// Returns the number of singular matrices, which get zeros.
+gl.invertMat4 = function invertMat4(out, matrices, options={}) {
+  return _invertMat4(out, matrices, matrixCount(options, matrices.length, 16), options.stride, options.threads);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// OBJ loading
+//
+// Wavefront OBJ files (and their MTL libraries) are parsed on worker threads
+// into deduplicated, interleaved vertices: position, then texcoord and normal
+// when any face has them (zeros for the faces that don't). Polygons are
+// triangulated as fans; the triangles are sorted by material into groups.
+//
+//   gl.loadObj('model.obj', {onProgress: function(fraction) {...}, upload: true})
+//     .then(function(mesh) {
+//       var layout = gl.createVertexLayout(mesh.layout);
+//       layout.setBuffer(0, mesh.vertexBuffer).setElementBuffer(mesh.indexBuffer);
+//       gl.bindVertexLayout(layout);
+//       mesh.groups.forEach(function(g) { gl.drawElements(gl.TRIANGLES, g.count, mesh.indexType, g.start * mesh.indexBytes); });
+//     });
+//
+// Options: upload (create the buffers and drop the arrays), index32 (no
+// Uint16 indices even below 65537 vertices), optimize (run the mesh
+// optimizer below on every group, on the worker thread; the result gets
+// optimization: {before, after}), threads (default every core) and
+// onProgress. Texture paths in the materials are relative to the working
+// directory; unreadable material libraries end up in mesh.warnings.
+
+var _loadObj = gl.loadObj;
+
+gl.loadObj = function loadObj(path, options={}) {
+  if (!((arguments.length === 1 || arguments.length === 2) && typeof path === 'string')) {
+    throw new TypeError('Expected loadObj(string path, [object options])');
+  }
+  var progress = typeof options.onProgress === 'function' ? options.onProgress : null;
+  return new Promise(function(resolve, reject) {
+    _loadObj(path, !!options.index32, !!options.upload, options.threads|0, progress, function(err, mesh) {
+      if(err) return reject(err);
+      var attributes = [{location: 0, size: 3, offset: 0}];
+      if (mesh.texcoordOffset >= 0) attributes.push({location: 1, size: 2, offset: mesh.texcoordOffset});
+      if (mesh.normalOffset >= 0) attributes.push({location: 2, size: 3, offset: mesh.normalOffset});
+      mesh.layout = { attributes: attributes, bindings: [{stride: mesh.stride}] };
+      mesh.indexBytes = mesh.indexType === 0x1405 /* UNSIGNED_INT */ ? 4 : 2;
+      if (mesh.vertices) {
+        mesh.vertices = new Float32Array(mesh.vertices.buffer, mesh.vertices.byteOffset, mesh.vertices.length / 4);
+        mesh.indices = mesh.indexBytes === 4 ? new Uint32Array(mesh.indices.buffer, mesh.indices.byteOffset, mesh.indices.length / 4) :
+                                               new Uint16Array(mesh.indices.buffer, mesh.indices.byteOffset, mesh.indices.length / 2);
+      }
+      else {
+        mesh.vertexBuffer = owned(new gl.WebGLBuffer(mesh.vertexBuffer), objectTypes.buffer);
+        mesh.indexBuffer = owned(new gl.WebGLBuffer(mesh.indexBuffer), objectTypes.buffer);
+      }
+      resolve(mesh);
+    }, !!options.optimize);
+  });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Mesh optimization
+//
+// In place reordering of indexed triangle lists (Uint16Array or
+// Uint32Array indices): optimizeVertexCache orders the triangles for the
+// post-transform cache, optimizeOverdraw then reorders clusters of them
+// front to back (threshold 1.05 lets the cache efficiency drop by 5%), and
+// optimizeVertexFetch moves the vertices into the order the indices use them
+// and returns how many are used. analyzeVertexCache simulates a FIFO cache
+// (16 entries by default) and returns {misses, acmr, atvr}.
+
+var _analyzeVertexCache = gl.analyzeVertexCache;
+var _optimizeVertexCache = gl.optimizeVertexCache;
+var _optimizeOverdraw = gl.optimizeOverdraw;
+var _optimizeVertexFetch = gl.optimizeVertexFetch;
+
+gl.analyzeVertexCache = function analyzeVertexCache(indices, vertexCount, cacheSize) {
+  return _analyzeVertexCache(indices, vertexCount, cacheSize);
+}
+
+gl.optimizeVertexCache = function optimizeVertexCache(indices, vertexCount) {
+  return _optimizeVertexCache(indices, vertexCount);
+}
+
+// positions: a Float32Array with a position every positionStride floats
+// (default 3), e.g. the interleaved vertices themselves.
+gl.optimizeOverdraw = function optimizeOverdraw(indices, positions, positionStride=3, threshold=1.05) {
+  return _optimizeOverdraw(indices, positions, positionStride, Math.floor(positions.length / positionStride), threshold);
+}
+
+// vertices: any ArrayBufferView, vertexSize bytes per vertex.
+gl.optimizeVertexFetch = function optimizeVertexFetch(vertices, vertexSize, indices) {
+  return _optimizeVertexFetch(vertices, vertexSize, indices);
+}
+
+// All three on a mesh like gl.loadObj's: {vertices, indices, stride (bytes),
+// [groups]} with the positions as the first three floats of each vertex.
+// Groups are optimized separately and keep their ranges; returns
+// {before, after} stats.
+gl.optimizeMesh = function optimizeMesh(mesh, options={}) {
+  if (!(mesh && ArrayBuffer.isView(mesh.vertices) && ArrayBuffer.isView(mesh.indices) && mesh.stride > 0)) {
+    throw new TypeError('Expected optimizeMesh({vertices, indices, stride, [groups]}, [object options])');
+  }
+  var vertexCount = Math.floor(mesh.vertices.byteLength / mesh.stride);
+  var positions = new Float32Array(mesh.vertices.buffer, mesh.vertices.byteOffset, Math.floor(mesh.vertices.byteLength / 4));
+  var groups = mesh.groups || [{start: 0, count: mesh.indices.length}];
+  var floatStride = mesh.stride / 4;
+  var before = _analyzeVertexCache(mesh.indices, vertexCount, options.cacheSize);
+  // like loadObj, every group's vertices are renumbered from 0 so the
+  // optimizers' per vertex arrays only cover the group
+  var local = new Int32Array(vertexCount).fill(-1);
+  groups.forEach(function(g) {
+    if (!g.count) return;
+    var indices = mesh.indices.subarray(g.start, g.start + g.count);
+    var groupIndices = new Uint32Array(indices.length);
+    var global = new Uint32Array(Math.min(indices.length, vertexCount));
+    var used = 0;
+    for (var i = 0; i < indices.length; i++) {
+      var v = indices[i];
+      if (!(v < vertexCount)) throw new RangeError('optimizeMesh: index ' + v + ' out of range');
+      if (local[v] < 0) {
+        local[v] = used;
+        global[used++] = v;
+      }
+      groupIndices[i] = local[v];
+    }
+    var groupPositions = new Float32Array(used * 3);
+    for (var j = 0; j < used; j++)
+      groupPositions.set(positions.subarray(global[j] * floatStride, global[j] * floatStride + 3), j * 3);
+    _optimizeVertexCache(groupIndices, used);
+    if (options.overdraw !== false)
+      _optimizeOverdraw(groupIndices, groupPositions, 3, used, options.threshold === undefined ? 1.05 : options.threshold);
+    for (var i = 0; i < indices.length; i++)
+      indices[i] = global[groupIndices[i]];
+    for (var j = 0; j < used; j++)
+      local[global[j]] = -1;
+  });
+  mesh.vertexCount = _optimizeVertexFetch(mesh.vertices, mesh.stride, mesh.indices);
+  return { before: before, after: _analyzeVertexCache(mesh.indices, mesh.vertexCount, options.cacheSize) };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Vertex packing
+//
+// Interleaves per attribute Float32Arrays (size floats per vertex) into
+// compact formats in native code, and describes the result for
+// gl.createVertexLayout:
+//
+//   var packed = gl.packVertices({attributes: [
+//     {location: 0, data: positions, size: 3, format: 'half'},
+//     {location: 1, data: normals, size: 3, format: 'octahedral'},
+//     {location: 2, data: uvs, size: 2, format: 'unorm16'},
+//     {location: 3, data: joints, size: 4, format: 'uint8'}]});
+//   gl.bufferData(gl.ARRAY_BUFFER, packed.data, gl.STATIC_DRAW);
+//   var layout = gl.createVertexLayout(packed.layout);
+//
+// Every attribute is padded to 4 bytes, in the order given unless it has an
+// offset. 'snorm10' and 'octahedral' take 3 or 4 components (the sign of the
+// 4th, e.g. a tangent's handedness, goes to w); octahedral normals have to
+// be decoded in the shader:
+//
+//   vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+//   n.xy = n.z < 0.0 ? (1.0 - abs(n.yx)) * sign(n.xy) : n.xy;
+//   n = normalize(n);
+//
+// 'uint8' and 'uint16' round to integer attributes (VertexAttribIPointer).
+// Options: count (default from the first attribute), stride, out (an
+// ArrayBufferView to pack into), threads (default 1, 0 for every core).
+
+// [format in src/vertex_packing.h, GL type, normalized, integer]
+var packFormats = {
+  float: [0, 0x1406, false, false],
+  half: [1, 0x140B, false, false],
+  unorm8: [2, 0x1401, true, false],
+  snorm8: [3, 0x1400, true, false],
+  unorm16: [4, 0x1403, true, false],
+  snorm16: [5, 0x1402, true, false],
+  uint8: [6, 0x1401, false, true],
+  uint16: [7, 0x1403, false, true],
+  snorm10: [8, 0x8D9F /* INT_2_10_10_10_REV */, true, false],
+  octahedral: [9, 0x8D9F, true, false],
+};
+
+function packedAttributeBytes(format, size) {
+  switch (format) {
+    case 'float': return size * 4;
+    case 'half': case 'unorm16': case 'snorm16': case 'uint16': return Math.ceil(size / 2) * 4;
+    default: return 4;
+  }
+}
+
+var _packVertices = gl.packVertices;
+
+gl.packVertices = function packVertices(desc) {
+  if (!(arguments.length === 1 && desc && Array.isArray(desc.attributes) && desc.attributes.length)) {
+    throw new TypeError('Expected packVertices({attributes: [...], [count], [stride], [out], [threads]})');
+  }
+  var attributes = desc.attributes;
+  var first = attributes[0];
+  var count = desc.count === undefined ? Math.floor(first.data.length / first.size) : desc.count;
+  var packed = new Int32Array(attributes.length * 3);
+  var layout = [];
+  var offset = 0, end = 0;
+  attributes.forEach(function(a, i) {
+    var format = packFormats[a.format];
+    if (!format) throw new TypeError("packVertices: unknown format '" + a.format + "'");
+    if (format[1] === 0x8D9F && !(a.size === 3 || a.size === 4)) {
+      throw new RangeError("packVertices: '" + a.format + "' takes 3 or 4 components");
+    }
+    if (a.offset !== undefined) offset = a.offset;
+    packed.set([format[0], a.size, offset], i * 3);
+    layout.push({
+      location: a.location,
+      size: format[1] === 0x8D9F ? 4 : a.size,
+      type: format[1],
+      normalized: format[2],
+      integer: format[3],
+      offset: offset,
+    });
+    offset += packedAttributeBytes(a.format, a.size);
+    end = Math.max(end, offset);
+  });
+  var stride = desc.stride === undefined ? end : desc.stride;
+  var out = desc.out || new Uint8Array(count * stride);
+  _packVertices(out, count, stride, packed, attributes.map(function(a) { return a.data; }), desc.threads);
+  return {
+    data: out,
+    stride: stride,
+    vertexCount: count,
+    layout: { attributes: layout, bindings: [{stride: stride}] },
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Mesh simplification
+//
+// Builds a chain of levels of detail on a worker thread by collapsing edges
+// in order of quadric error. Every level keeps the source vertices, so all
+// of them go into one index buffer after the source triangles and share
+// the vertex buffer:
+//
+//   var lod = await gl.simplifyLods(mesh.indices, mesh.vertices, {
+//     positionStride: mesh.stride / 4, ratios: [0.5, 0.25, 0.1],
+//     attributes: mesh.vertices, attributeStride: mesh.stride / 4,
+//     attributeOffset: mesh.texcoordOffset / 4, attributeWeights: [1, 1]});
+//   var level = lod.levels[2];
+//   gl.drawElementsBaseVertex(gl.TRIANGLES, level.count, type, level.offset, 0);
+//
+// Level 0 is the source mesh; each level has ratio (of the source triangle
+// count), first and count (in indices), offset (in bytes) and error, the
+// largest distance a collapse moved the surface relative to the mesh's
+// extent. Options: positionStride (default 3 floats), ratios (default
+// [0.5, 0.25, 0.125]), attributes, attributeStride, attributeOffset and
+// attributeWeights (one weight per float compared, e.g. texcoords and
+// normals, so seams stay put), lockBorder (keep open borders exactly),
+// maxError (stop collapsing at this error, attribute differences
+// included) and vertexCount.
+
+var _simplifyLods = gl.simplifyLods;
+
+gl.simplifyLods = function simplifyLods(indices, positions, options={}) {
+  if (!((indices instanceof Uint16Array || indices instanceof Uint32Array) && positions instanceof Float32Array)) {
+    return Promise.reject(new TypeError('Expected simplifyLods(Uint16Array|Uint32Array indices, Float32Array positions, [object options])'));
+  }
+  var positionStride = options.positionStride || 3;
+  var vertexCount = options.vertexCount === undefined ? Math.floor(positions.length / positionStride) : options.vertexCount;
+  var ratios = new Float64Array(options.ratios || [0.5, 0.25, 0.125]);
+  var weights = null, attributes = null, attributeStride = 0;
+  if (options.attributes) {
+    weights = new Float32Array(options.attributeWeights);
+    attributeStride = options.attributeStride || weights.length;
+    attributes = options.attributes.subarray(options.attributeOffset || 0);
+  }
+  var maxError = options.maxError === undefined ? Infinity : options.maxError;
+  var indexBytes = indices.BYTES_PER_ELEMENT;
+  return new Promise(function(resolve, reject) {
+    _simplifyLods(indices, positions, positionStride, vertexCount, ratios, attributes, attributeStride, weights,
+                  !!options.lockBorder, maxError, function(err, result) {
+      if (err) return reject(err);
+      result.indices = indexBytes === 4 ? new Uint32Array(result.indices.buffer, result.indices.byteOffset, result.indices.length / 4) :
+                                          new Uint16Array(result.indices.buffer, result.indices.byteOffset, result.indices.length / 2);
+      result.levels.forEach(function(level) { level.offset = level.first * indexBytes; });
+      resolve(result);
+    });
+  });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// GLB loading
+//
+// Loads a binary glTF 2.0 file: the native side maps it, parses the JSON
+// chunk and uploads every vertex and index bufferView once into an immutable
+// buffer straight from the mapping; here the accessors become vertex layouts
+// and the images textures, decoded from the mapping on worker threads.
+//
+//   var scene = await gl.loadGlb('model.glb');
+//   scene.meshes[0].primitives.forEach(function(p) {
+//     gl.bindVertexLayout(p.layout);
+//     if (p.indexType) gl.drawElements(p.mode, p.count, p.indexType, p.offset);
+//     else gl.drawArrays(p.mode, 0, p.count);
+//   });
+//
+// The scene is {meshes: [{name, primitives: [{layout, mode, count,
+// indexType, offset, material, min, max}]}], materials, textures: [{texture,
+// sampler, srgb, error}], nodes: [{name, mesh, children, matrix}], scenes,
+// scene, buffers, ready, warnings, json}. Materials are the metallic
+// roughness parameters with texture indices (or -1) into textures. The
+// promise resolves once the geometry is uploaded; ready resolves when every
+// texture is too (failures end up in the texture's error and in warnings).
+// Options: locations (semantic -> attribute location, default
+// glbAttributeLocations), textures (false skips them) and mipmaps, compress
+// and cacheDir as for texImageFromFile (mipmaps default true).
+
+var glbAttributeLocations = {
+  POSITION: 0, NORMAL: 1, TEXCOORD_0: 2, TANGENT: 3, COLOR_0: 4, JOINTS_0: 5, WEIGHTS_0: 6, TEXCOORD_1: 7,
+};
+gl.glbAttributeLocations = glbAttributeLocations;
+
+var glbTypeSizes = { SCALAR: 1, VEC2: 2, VEC3: 3, VEC4: 4 };
+
+// the local transform of a glTF node, column major
+function glbNodeMatrix(node) {
+  if (node.matrix) return new Float32Array(node.matrix);
+  var t = node.translation || [0, 0, 0], q = node.rotation || [0, 0, 0, 1], s = node.scale || [1, 1, 1];
+  var x = q[0], y = q[1], z = q[2], w = q[3];
+  return new Float32Array([
+    (1 - 2 * (y * y + z * z)) * s[0], 2 * (x * y + z * w) * s[0], 2 * (x * z - y * w) * s[0], 0,
+    2 * (x * y - z * w) * s[1], (1 - 2 * (x * x + z * z)) * s[1], 2 * (y * z + x * w) * s[1], 0,
+    2 * (x * z + y * w) * s[2], 2 * (y * z - x * w) * s[2], (1 - 2 * (x * x + y * y)) * s[2], 0,
+    t[0], t[1], t[2], 1]);
+}
+
+function glbTextureIndex(info) {
+  return info && typeof info.index === 'number' ? info.index : -1;
+}
+
+var _loadGlb = gl.loadGlb;
+
+gl.loadGlb = function loadGlb(path, options={}) {
+  if (!(typeof path === 'string')) {
+    return Promise.reject(new TypeError('Expected loadGlb(string path, [object options])'));
+  }
+  return new Promise(function(resolve, reject) {
+    _loadGlb(path, function(err, result) {
+      if (err) return reject(err);
+      try {
+        resolve(glbScene(path, result, options));
+      }
+      catch (e) {
+        reject(e);
+      }
+    });
+  });
+}
+
+function glbScene(path, result, options) {
+  var json = result.json, binary = result.binary;
+  var dir = require('path').dirname(path);
+  var locations = options.locations || glbAttributeLocations;
+  var warnings = [];
+  var gltfBuffers = json.buffers || [], views = json.bufferViews || [], accessors = json.accessors || [];
+
+  // buffers outside the file (uri) are read here, the binary chunk is mapped
+  var bufferData = [];
+  function bufferBytes(index) {
+    if (bufferData[index] === undefined) {
+      var uri = gltfBuffers[index] && gltfBuffers[index].uri;
+      if (uri === undefined) bufferData[index] = binary;
+      else if (uri.startsWith('data:')) bufferData[index] = Buffer.from(uri.slice(uri.indexOf(',') + 1), 'base64');
+      else bufferData[index] = require('fs').readFileSync(require('path').join(dir, decodeURIComponent(uri)));
+    }
+    return bufferData[index];
+  }
+  function viewBytes(index) {
+    var view = views[index];
+    var bytes = bufferBytes(view.buffer);
+    if (!bytes) throw new Error('loadGlb: bufferView ' + index + ' has no data');
+    return bytes.subarray(view.byteOffset || 0, (view.byteOffset || 0) + view.byteLength);
+  }
+  var buffers = result.buffers.map(function(name) {
+    return name ? owned(new gl.WebGLBuffer(name), objectTypes.buffer) : null;
+  });
+  function viewBuffer(index) {
+    if (!buffers[index]) {
+      var bytes = viewBytes(index);
+      buffers[index] = fast.createBuffer();
+      fast.namedBufferStorage(buffers[index], bytes.byteLength, bytes, 0);
+    }
+    return buffers[index];
+  }
+
+  // Attributes interleaved in a view share a binding at the start of their
+  // vertex, so relative offsets stay below the stride.
+  function primitiveLayout(primitive, name) {
+    var attributes = [], bindings = [], sources = [], bindingKeys = {};
+    Object.keys(primitive.attributes || {}).forEach(function(semantic) {
+      var location = locations[semantic];
+      if (location === undefined) return;
+      var accessor = accessors[primitive.attributes[semantic]];
+      if (!accessor || accessor.bufferView === undefined || accessor.sparse) {
+        warnings.push(name + ': ' + semantic + ' has no (dense) data, skipped');
+        return;
+      }
+      var size = glbTypeSizes[accessor.type];
+      var view = views[accessor.bufferView];
+      var stride = view.byteStride || size * vertexTypeBytes(accessor.componentType);
+      var offset = accessor.byteOffset || 0;
+      var base = offset - offset % stride;
+      var key = accessor.bufferView + ':' + base + ':' + stride;
+      var binding = bindingKeys[key];
+      if (binding === undefined) {
+        binding = bindingKeys[key] = bindings.length;
+        bindings.push({stride: stride});
+        sources.push([viewBuffer(accessor.bufferView), base]);
+      }
+      attributes.push({
+        location: location,
+        size: size,
+        type: accessor.componentType,
+        normalized: !!accessor.normalized,
+        integer: semantic.startsWith('JOINTS_'),
+        offset: offset - base,
+        binding: binding,
+      });
+    });
+    var layout = gl.createVertexLayout({attributes: attributes, bindings: bindings});
+    sources.forEach(function(source, i) { layout.setBuffer(i, source[0], source[1]); });
+    return layout;
+  }
+
+  var meshes = (json.meshes || []).map(function(mesh, m) {
+    var name = mesh.name || 'mesh ' + m;
+    return {
+      name: mesh.name,
+      primitives: (mesh.primitives || []).map(function(primitive) {
+        var layout = primitiveLayout(primitive, name);
+        var position = accessors[(primitive.attributes || {}).POSITION] || {};
+        var p = {
+          layout: layout,
+          mode: primitive.mode === undefined ? 4 /* TRIANGLES */ : primitive.mode,
+          count: position.count || 0,
+          indexType: 0,
+          offset: 0,
+          material: primitive.material === undefined ? -1 : primitive.material,
+          min: position.min,
+          max: position.max,
+        };
+        var indices = primitive.indices === undefined ? null : accessors[primitive.indices];
+        if (indices && indices.bufferView !== undefined) {
+          layout.setElementBuffer(viewBuffer(indices.bufferView));
+          p.count = indices.count;
+          p.indexType = indices.componentType;
+          p.offset = indices.byteOffset || 0;
+        }
+        return p;
+      }),
+    };
+  });
+
+  var materials = (json.materials || []).map(function(material) {
+    var pbr = material.pbrMetallicRoughness || {};
+    return {
+      name: material.name,
+      baseColorFactor: pbr.baseColorFactor || [1, 1, 1, 1],
+      baseColorTexture: glbTextureIndex(pbr.baseColorTexture),
+      metallicFactor: pbr.metallicFactor === undefined ? 1 : pbr.metallicFactor,
+      roughnessFactor: pbr.roughnessFactor === undefined ? 1 : pbr.roughnessFactor,
+      metallicRoughnessTexture: glbTextureIndex(pbr.metallicRoughnessTexture),
+      normalTexture: glbTextureIndex(material.normalTexture),
+      normalScale: material.normalTexture && material.normalTexture.scale !== undefined ? material.normalTexture.scale : 1,
+      occlusionTexture: glbTextureIndex(material.occlusionTexture),
+      occlusionStrength: material.occlusionTexture && material.occlusionTexture.strength !== undefined ? material.occlusionTexture.strength : 1,
+      emissiveTexture: glbTextureIndex(material.emissiveTexture),
+      emissiveFactor: material.emissiveFactor || [0, 0, 0],
+      alphaMode: material.alphaMode || 'OPAQUE',
+      alphaCutoff: material.alphaCutoff === undefined ? 0.5 : material.alphaCutoff,
+      doubleSided: !!material.doubleSided,
+    };
+  });
+
+  // color textures are sRGB, data textures (normals, roughness) linear
+  var srgb = [];
+  materials.forEach(function(material) {
+    srgb[material.baseColorTexture] = srgb[material.emissiveTexture] = true;
+  });
+  var mipmaps = options.mipmaps === undefined ? true : options.mipmaps;
+  var loads = [];
+  var textures = options.textures === false ? [] : (json.textures || []).map(function(t, i) {
+    var texture = { texture: fast.createTexture(0x0DE1 /* TEXTURE_2D */), sampler: null, srgb: !!srgb[i], error: null };
+    var s = json.samplers && t.sampler !== undefined ? json.samplers[t.sampler] : {};
+    texture.sampler = gl.getSampler({
+      minFilter: s.minFilter || (mipmaps ? 0x2703 /* LINEAR_MIPMAP_LINEAR */ : 0x2601 /* LINEAR */),
+      magFilter: s.magFilter || 0x2601,
+      wrapS: s.wrapS || 0x2901 /* REPEAT */,
+      wrapT: s.wrapT || 0x2901,
+    });
+    var image = json.images && json.images[t.source];
+    var source = null;
+    try {
+      if (!image) throw new Error('no image');
+      if (image.bufferView !== undefined) source = viewBytes(image.bufferView);
+      else if (image.uri.startsWith('data:')) source = Buffer.from(image.uri.slice(image.uri.indexOf(',') + 1), 'base64');
+      else source = require('path').join(dir, decodeURIComponent(image.uri));
+    }
+    catch (e) {
+      texture.error = e;
+      warnings.push('texture ' + i + ': ' + e.message);
+      return texture;
+    }
+    loads.push(gl.texImageFromFile(texture.texture, source, {
+      mipmaps: mipmaps,
+      internalFormat: texture.srgb ? 0x8C43 /* SRGB8_ALPHA8 */ : 0x8058 /* RGBA8 */,
+      srgb: texture.srgb,
+      compress: options.compress,
+      cacheDir: options.cacheDir,
+    }).catch(function(e) {
+      texture.error = e;
+      warnings.push('texture ' + i + ': ' + e.message);
+    }));
+    return texture;
+  });
+
+  var nodes = (json.nodes || []).map(function(node) {
+    return {
+      name: node.name,
+      mesh: node.mesh === undefined ? -1 : node.mesh,
+      children: node.children || [],
+      matrix: glbNodeMatrix(node),
+    };
+  });
+
+  return {
+    meshes: meshes,
+    materials: materials,
+    textures: textures,
+    nodes: nodes,
+    scenes: (json.scenes || []).map(function(scene) { return { name: scene.name, nodes: scene.nodes || [] }; }),
+    scene: json.scene === undefined ? 0 : json.scene,
+    buffers: buffers,
+    ready: Promise.all(loads).then(function() {}),
+    warnings: warnings,
+    json: json,
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Debug output
+//
+// KHR_debug messages are collected natively and delivered in batches on the
+// event loop, so a driver calling back from its own thread never enters JS:
+//
+//   gl.debugOutput(function(messages, dropped) {
+//     messages.forEach(function(m) { console.warn(gl.formatDebugMessage(m)); });
+//   }, {severity: 'medium'});
+//
+// Messages are {source, type, id, severity, message}; dropped counts those
+// lost while the event loop was busy. options.severity is the lowest one
+// delivered ('notification', 'low' (default), 'medium' or 'high'), filtered
+// by the driver; gl.debugMessageControl narrows it further.
+// options.synchronous makes the driver report on the thread and in the call
+// that caused the message (slower, but a native debugger can break there).
+// Most drivers only report much in a debug context. gl.debugOutput(null)
+// turns it off, which costs nothing.
+//
+// Debug groups and object labels show up in captures and in the messages:
+//
+//   gl.debugGroup('shadows', function() { ... });
+//   gl.objectLabel(texture, 'shadow map');
+
+var debugSeverities = ['notification', 'low', 'medium', 'high'];
+var debugSeverityEnums = [0x826B, 0x9148, 0x9147, 0x9146];
+var debugSourceNames = {
+  0x8246: 'API', 0x8247: 'window system', 0x8248: 'shader compiler', 0x8249: 'third party', 0x824A: 'application', 0x824B: 'other',
+};
+var debugTypeNames = {
+  0x824C: 'error', 0x824D: 'deprecated', 0x824E: 'undefined behavior', 0x824F: 'portability', 0x8250: 'performance',
+  0x8268: 'marker', 0x8269: 'push group', 0x826A: 'pop group', 0x8251: 'other',
+};
+
+// glObjectLabel identifiers, by objectTypes
+var objectLabelIdentifiers = [0x82E0 /* BUFFER */, 0x8D40 /* FRAMEBUFFER */, 0x82E2 /* PROGRAM */, 0x8D41 /* RENDERBUFFER */,
+                              0x82E1 /* SHADER */, 0x1702 /* TEXTURE */, 0x82E6 /* SAMPLER */, 0x8E22 /* TRANSFORM_FEEDBACK */,
+                              0x8074 /* VERTEX_ARRAY */];
+
+var _debugOutput = gl.debugOutput;
+var _debugMessageControl = gl.debugMessageControl;
+var _debugMessageInsert = gl.debugMessageInsert;
+var _pushDebugGroup = fast.pushDebugGroup = gl.pushDebugGroup;
+var _popDebugGroup = fast.popDebugGroup = gl.popDebugGroup;
+var _objectLabel = gl.objectLabel;
+
+gl.debugOutput = function debugOutput(callback, options={}) {
+  if (!(callback === null || typeof callback === 'function')) {
+    throw new TypeError('Expected debugOutput(function callback | null, [object options])');
+  }
+  if (!callback) return _debugOutput(null, false);
+  var lowest = debugSeverities.indexOf(options.severity || 'low');
+  if (lowest < 0) throw new TypeError("debugOutput: unknown severity '" + options.severity + "'");
+  _debugOutput(callback, !!options.synchronous);
+  _debugMessageControl(0x1100 /* DONT_CARE */, 0x1100, 0x1100, null, true);
+  for (var i = 0; i < lowest; i++)
+    _debugMessageControl(0x1100, 0x1100, debugSeverityEnums[i], null, false);
+}
+
+// ids (an array or Uint32Array) need a specific source and type, and
+// severity DONT_CARE.
+gl.debugMessageControl = function debugMessageControl(source, type, severity, ids, enabled) {
+  if (!(arguments.length === 5 && typeof source === 'number' && typeof type === 'number' && typeof severity === 'number')) {
+    throw new TypeError('Expected debugMessageControl(number source, number type, number severity, (Uint32Array | number[]) ids, boolean enabled)');
+  }
+  return _debugMessageControl(source, type, severity, ids ? Uint32Array.from(ids) : null, !!enabled);
+}
+
+gl.debugMessageInsert = function debugMessageInsert(message, id=0, type=0x8268 /* DEBUG_TYPE_MARKER */, severity=0x826B /* NOTIFICATION */) {
+  if (!(typeof message === 'string' && typeof id === 'number' && typeof type === 'number' && typeof severity === 'number')) {
+    throw new TypeError('Expected debugMessageInsert(string message, [number id], [number type], [number severity])');
+  }
+  return _debugMessageInsert(0x824A /* DEBUG_SOURCE_APPLICATION */, type, id, severity, message);
+}
+
+gl.pushDebugGroup = function pushDebugGroup(message, id=0) {
+  if (!(typeof message === 'string' && typeof id === 'number')) {
+    throw new TypeError('Expected pushDebugGroup(string message, [number id])');
+  }
+  return _pushDebugGroup(0x824A, id, message);
+}
+
+gl.popDebugGroup = function popDebugGroup() {
+  return _popDebugGroup();
+}
+
+// Calls fn inside a debug group, which is popped even if fn throws.
+gl.debugGroup = function debugGroup(message, fn) {
+  gl.pushDebugGroup(message);
+  try {
+    return fn();
+  }
+  finally {
+    _popDebugGroup();
+  }
+}
+
+gl.objectLabel = function objectLabel(object, label) {
+  if (object instanceof gl.WebGLVertexLayout) object = object.vertexArray;
+  var type = objectType(object);
+  if (!(arguments.length === 2 && type >= 0 && typeof label === 'string')) {
+    throw new TypeError('Expected objectLabel(WebGL object, string label)');
+  }
+  return _objectLabel(objectLabelIdentifiers[type], object._, label);
+}
+
+gl.formatDebugMessage = function formatDebugMessage(m) {
+  var severity = debugSeverities[debugSeverityEnums.indexOf(m.severity)] || m.severity;
+  return '[' + severity + '] ' + (debugSourceNames[m.source] || m.source) + ' ' + (debugTypeNames[m.type] || m.type) +
+         ' ' + m.id + ': ' + m.message;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Tracing
+//
+// To reproduce a performance problem away from the application, record it:
+//
+//   NODE_WEBGL_TRACE=slow.trace node app.js
+//
+// and replay it, as fast as the driver goes, in a headless context:
+//
+//   node tools/replay.js slow.trace [--json times.json] [--no-finish]
+//
+// Every native call is logged from startup with its arguments (typed array
+// contents once per distinct content), so the replay reaches the same state
+// through the same binding code and driver calls, without the application's
+// JS. The platforms mark a frame after each swap; without one, call
+// gl.traceFrame() where a frame ends. gl.traceEnd() stops recording early
+// and returns {calls, frames, blobs, blobBytes, bytes}. Without the variable
+// nothing is wrapped and both are no-ops.
+
+var _traceFrame = gl.traceFrame;
+var _traceClose = gl.traceClose;
+
+gl.traceFrame = function traceFrame() {
+  _traceFrame();
+}
+
+gl.traceEnd = function traceEnd() {
+  return _traceClose();
+}
+
+// Replaces every native with one that logs the call, its return value if
+// that is a primitive, and every invocation of a callback argument.
+function traceNatives(path) {
+  var traceCall = gl.traceCall, traceReturn = gl.traceReturn, traceCallback = gl.traceCallback;
+  if (!gl.traceOpen(path)) throw new Error('NODE_WEBGL_TRACE: cannot create ' + path);
+  var id = 0;
+  Object.keys(gl).forEach(function(name) {
+    var native = gl[name];
+    // Image is a class, it doesn't touch GL
+    if (typeof native !== 'function' || name === 'Image' || name.startsWith('trace')) return;
+    var callId = id++;
+    gl.traceDefine(callId, name);
+    gl[name] = function() {
+      var index = traceCall(callId, arguments);
+      var args = Array.prototype.slice.call(arguments);
+      for (var i = 0; i < args.length; i++) {
+        if (typeof args[i] === 'function') args[i] = tracedCallback(args[i], index, i);
+      }
+      var result = native.apply(this, args);
+      var type = typeof result;
+      if (type === 'number' || type === 'boolean' || type === 'string') traceReturn(index, result);
+      return result;
+    };
+  });
+  process.on('exit', function() { gl.traceClose(); });
+}
+
+function tracedCallback(callback, index, argument) {
+  return function() {
+    gl.traceCallback(index, argument);
+    return callback.apply(this, arguments);
+  };
+}
+
+var _cullFace = fast.cullFace = gl.cullFace;
 gl.cullFace = function cullFace(mode) {
   if (!(arguments.length === 1 && typeof mode === "number")) {
     throw new TypeError('Expected cullFace(number mode)');
@@ -444,54 +2205,76 @@ gl.cullFace = function cullFace(mode) {
 }
 
 var _deleteBuffer = gl.deleteBuffer;
+fast.deleteBuffer = function deleteBuffer(buffer) {
+  return _deleteBuffer(buffer ? buffer._ : 0);
+}
 gl.deleteBuffer = function deleteBuffer(buffer) {
   if (!(arguments.length === 1 && (buffer === null || buffer instanceof gl.WebGLBuffer))) {
     throw new TypeError('Expected deleteBuffer(WebGLBuffer buffer)');
   }
-  return _deleteBuffer(buffer ? buffer._ : 0);
+  return fast.deleteBuffer(buffer);
 }
 
 var _deleteFramebuffer = gl.deleteFramebuffer;
+fast.deleteFramebuffer = function deleteFramebuffer(framebuffer) {
+  return _deleteFramebuffer(framebuffer ? framebuffer._ : 0);
+}
 gl.deleteFramebuffer = function deleteFramebuffer(framebuffer) {
   if (!(arguments.length === 1 && (framebuffer === null || framebuffer instanceof gl.WebGLFramebuffer))) {
     throw new TypeError('Expected deleteFramebuffer(WebGLFramebuffer framebuffer)');
   }
-  return _deleteFramebuffer(framebuffer ? framebuffer._ : 0);
+  return fast.deleteFramebuffer(framebuffer);
 }
 
 var _deleteProgram = gl.deleteProgram;
+fast.deleteProgram = function deleteProgram(program) {
+  return _deleteProgram(program ? program._ : 0);
+}
 gl.deleteProgram = function deleteProgram(program) {
   if (!(arguments.length === 1 && (program === null || program instanceof gl.WebGLProgram))) {
     throw new TypeError('Expected deleteProgram(WebGLProgram program)');
   }
-  return _deleteProgram(program ? program._ : 0);
+  return fast.deleteProgram(program);
 }
 
 var _deleteRenderbuffer = gl.deleteRenderbuffer;
+fast.deleteRenderbuffer = function deleteRenderbuffer(renderbuffer) {
+  return _deleteRenderbuffer(renderbuffer ? renderbuffer._ : 0);
+}
 gl.deleteRenderbuffer = function deleteRenderbuffer(renderbuffer) {
   if (!(arguments.length === 1 && (renderbuffer === null || renderbuffer instanceof gl.WebGLRenderbuffer))) {
     throw new TypeError('Expected deleteRenderbuffer(WebGLRenderbuffer renderbuffer)');
   }
-  return _deleteRenderbuffer(renderbuffer ? renderbuffer._ : 0);
+  return fast.deleteRenderbuffer(renderbuffer);
 }
 
 var _deleteShader = gl.deleteShader;
+fast.deleteShader = function deleteShader(shader) {
+  return _deleteShader(shader ? shader._ : 0);
+}
 gl.deleteShader = function deleteShader(shader) {
   if (!(arguments.length === 1 && (shader === null || shader instanceof gl.WebGLShader))) {
     throw new TypeError('Expected deleteShader(WebGLShader shader)');
   }
-  return _deleteShader(shader ? shader._ : 0);
+  return fast.deleteShader(shader);
 }
 
 var _deleteTexture = gl.deleteTexture;
+fast.deleteTexture = function deleteTexture(texture) {
+  if (texture && texture._resident) {
+    managedTextures.delete(texture._resident);
+    texture._resident = 0;
+  }
+  return _deleteTexture(texture ? texture._ : 0);
+}
 gl.deleteTexture = function deleteTexture(texture) {
   if (!(arguments.length === 1 && (texture === null || texture instanceof gl.WebGLTexture))) {
     throw new TypeError('Expected deleteTexture(WebGLTexture texture)');
   }
-  return _deleteTexture(texture ? texture._ : 0);
+  return fast.deleteTexture(texture);
 }
 
-var _depthFunc = gl.depthFunc;
+var _depthFunc = fast.depthFunc = gl.depthFunc;
 gl.depthFunc = function depthFunc(func) {
   if (!(arguments.length === 1 && typeof func === "number")) {
     throw new TypeError('Expected depthFunc(number func)');
@@ -499,7 +2282,7 @@ gl.depthFunc = function depthFunc(func) {
   return _depthFunc(func);
 }
 
-var _depthMask = gl.depthMask;
+var _depthMask = fast.depthMask = gl.depthMask;
 gl.depthMask = function depthMask(flag) {
   if (!(arguments.length === 1 && typeof flag === "boolean")) {
     throw new TypeError('Expected depthMask(boolean flag)');
@@ -507,7 +2290,7 @@ gl.depthMask = function depthMask(flag) {
   return _depthMask(flag);
 }
 
-var _depthRange = gl.depthRange;
+var _depthRange = fast.depthRange = gl.depthRange;
 gl.depthRange = function depthRange(zNear, zFar) {
   if (!(arguments.length === 2 && typeof zNear === "number" && typeof zFar === "number")) {
     throw new TypeError('Expected depthRange(number zNear, number zFar)');
@@ -516,14 +2299,17 @@ gl.depthRange = function depthRange(zNear, zFar) {
 }
 
 var _detachShader = gl.detachShader;
+fast.detachShader = function detachShader(program, shader) {
+  return _detachShader(program ? program._ : 0, shader ? shader._ : 0);
+}
 gl.detachShader = function detachShader(program, shader) {
   if (!(arguments.length === 2 && (program === null || program instanceof gl.WebGLProgram) && (shader === null || shader instanceof gl.WebGLShader))) {
     throw new TypeError('Expected detachShader(WebGLProgram program, WebGLShader shader)');
   }
-  return _detachShader(program ? program._ : 0, shader ? shader._ : 0);
+  return fast.detachShader(program, shader);
 }
 
-var _disable = gl.disable;
+var _disable = fast.disable = gl.disable;
 gl.disable = function disable(cap) {
   if (!(arguments.length === 1 && typeof cap === "number")) {
     throw new TypeError('Expected disable(number cap)');
@@ -531,7 +2317,7 @@ gl.disable = function disable(cap) {
   return _disable(cap);
 }
 
-var _disableVertexAttribArray = gl.disableVertexAttribArray;
+var _disableVertexAttribArray = fast.disableVertexAttribArray = gl.disableVertexAttribArray;
 gl.disableVertexAttribArray = function disableVertexAttribArray(index) {
   if (!(arguments.length === 1 && typeof index === "number")) {
     throw new TypeError('Expected disableVertexAttribArray(number index)');
@@ -539,7 +2325,7 @@ gl.disableVertexAttribArray = function disableVertexAttribArray(index) {
   return _disableVertexAttribArray(index);
 }
 
-var _drawArrays = gl.drawArrays;
+var _drawArrays = fast.drawArrays = gl.drawArrays;
 gl.drawArrays = function drawArrays(mode, first, count) {
   if (!(arguments.length === 3 && typeof mode === "number" && typeof first === "number" && typeof count === "number")) {
     throw new TypeError('Expected drawArrays(number mode, number first, number count)');
@@ -547,7 +2333,7 @@ gl.drawArrays = function drawArrays(mode, first, count) {
   return _drawArrays(mode, first, count);
 }
 
-var _drawElements = gl.drawElements;
+var _drawElements = fast.drawElements = gl.drawElements;
 gl.drawElements = function drawElements(mode, count, type, offset) {
   if (!(arguments.length === 4 && typeof mode === "number" && typeof count === "number" && typeof type === "number" && typeof offset === "number")) {
     throw new TypeError('Expected drawElements(number mode, number count, number type, number offset)');
@@ -555,7 +2341,15 @@ gl.drawElements = function drawElements(mode, count, type, offset) {
   return _drawElements(mode, count, type, offset);
 }
 
-var _enable = gl.enable;
+var _drawElementsBaseVertex = fast.drawElementsBaseVertex = gl.drawElementsBaseVertex;
+gl.drawElementsBaseVertex = function drawElementsBaseVertex(mode, count, type, offset, baseVertex) {
+  if (!(arguments.length === 5 && typeof mode === "number" && typeof count === "number" && typeof type === "number" && typeof offset === "number" && typeof baseVertex === "number")) {
+    throw new TypeError('Expected drawElementsBaseVertex(number mode, number count, number type, number offset, number baseVertex)');
+  }
+  return _drawElementsBaseVertex(mode, count, type, offset, baseVertex);
+}
+
+var _enable = fast.enable = gl.enable;
 gl.enable = function enable(cap) {
   if (!(arguments.length === 1 && typeof cap === "number")) {
     throw new TypeError('Expected enable(number cap)');
@@ -563,7 +2357,7 @@ gl.enable = function enable(cap) {
   return _enable(cap);
 }
 
-var _enableVertexAttribArray = gl.enableVertexAttribArray;
+var _enableVertexAttribArray = fast.enableVertexAttribArray = gl.enableVertexAttribArray;
 gl.enableVertexAttribArray = function enableVertexAttribArray(index) {
   if (!(arguments.length === 1 && typeof index === "number")) {
     throw new TypeError('Expected enableVertexAttribArray(number index)');
@@ -571,7 +2365,7 @@ gl.enableVertexAttribArray = function enableVertexAttribArray(index) {
   return _enableVertexAttribArray(index);
 }
 
-var _finish = gl.finish;
+var _finish = fast.finish = gl.finish;
 gl.finish = function finish() {
   if (!(arguments.length === 0)) {
     throw new TypeError('Expected finish()');
@@ -579,7 +2373,7 @@ gl.finish = function finish() {
   return _finish();
 }
 
-var _flush = gl.flush;
+var _flush = fast.flush = gl.flush;
 gl.flush = function flush() {
   if (!(arguments.length === 0)) {
     throw new TypeError('Expected flush()');
@@ -588,30 +2382,39 @@ gl.flush = function flush() {
 }
 
 var _framebufferRenderbuffer = gl.framebufferRenderbuffer;
+fast.framebufferRenderbuffer = function framebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer) {
+  return _framebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer ? renderbuffer._ : 0);
+}
 gl.framebufferRenderbuffer = function framebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer) {
   if (!(arguments.length === 4 && typeof target === "number" && typeof attachment === "number" && typeof renderbuffertarget === "number" && (renderbuffer === null || renderbuffer instanceof gl.WebGLRenderbuffer))) {
     throw new TypeError('Expected framebufferRenderbuffer(number target, number attachment, number renderbuffertarget, WebGLRenderbuffer renderbuffer)');
   }
-  return _framebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer ? renderbuffer._ : 0);
+  return fast.framebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
 }
 
 var _framebufferTexture2D = gl.framebufferTexture2D;
+fast.framebufferTexture2D = function framebufferTexture2D(target, attachment, textarget, texture, level) {
+  return _framebufferTexture2D(target, attachment, textarget, texture ? texture._ : 0, level);
+}
 gl.framebufferTexture2D = function framebufferTexture2D(target, attachment, textarget, texture, level) {
   if (!(arguments.length === 5 && typeof target === "number" && typeof attachment === "number" && typeof textarget === "number" && (texture === null || texture instanceof gl.WebGLTexture) && typeof level === "number")) {
     throw new TypeError('Expected framebufferTexture2D(number target, number attachment, number textarget, WebGLTexture texture, number level)');
   }
-  return _framebufferTexture2D(target, attachment, textarget, texture ? texture._ : 0, level);
+  return fast.framebufferTexture2D(target, attachment, textarget, texture, level);
 }
 
 var _framebufferTextureLayer = gl.framebufferTextureLayer;
+fast.framebufferTextureLayer = function framebufferTextureLayer(target, attachment, texture, level, layer) {
+  return _framebufferTextureLayer(target, attachment, texture ? texture._ : 0, level, layer);
+}
 gl.framebufferTextureLayer = function framebufferTextureLayer(target, attachment, texture, level, layer) {
   if (!(arguments.length === 5 && typeof target === "number" && typeof attachment === "number" && typeof layer === "number" && (texture === null || texture instanceof gl.WebGLTexture) && typeof level === "number")) {
     throw new TypeError('Expected framebufferTextureLayer(number target, number attachment, WebGLTexture texture, number level, number layer)');
   }
-  return _framebufferTextureLayer(target, attachment, texture ? texture._ : 0, level, layer);
+  return fast.framebufferTextureLayer(target, attachment, texture, level, layer);
 }
 
-var _frontFace = gl.frontFace;
+var _frontFace = fast.frontFace = gl.frontFace;
 gl.frontFace = function frontFace(mode) {
   if (!(arguments.length === 1 && typeof mode === "number")) {
     throw new TypeError('Expected frontFace(number mode)');
@@ -619,7 +2422,7 @@ gl.frontFace = function frontFace(mode) {
   return _frontFace(mode);
 }
 
-var _generateMipmap = gl.generateMipmap;
+var _generateMipmap = fast.generateMipmap = gl.generateMipmap;
 gl.generateMipmap = function generateMipmap(target) {
   if (!(arguments.length === 1 && typeof target === "number")) {
     throw new TypeError('Expected generateMipmap(number target)');
@@ -628,35 +2431,47 @@ gl.generateMipmap = function generateMipmap(target) {
 }
 
 var _getActiveAttrib = gl.getActiveAttrib;
+fast.getActiveAttrib = function getActiveAttrib(program, index) {
+  return new gl.WebGLActiveInfo(_getActiveAttrib(program ? program._ : 0, index));
+}
 gl.getActiveAttrib = function getActiveAttrib(program, index) {
   if (!(arguments.length === 2 && (program === null || program instanceof gl.WebGLProgram) && typeof index === "number")) {
     throw new TypeError('Expected getActiveAttrib(WebGLProgram program, number index)');
   }
-  return new gl.WebGLActiveInfo(_getActiveAttrib(program ? program._ : 0, index));
+  return fast.getActiveAttrib(program, index);
 }
 
 var _getActiveUniform = gl.getActiveUniform;
+fast.getActiveUniform = function getActiveUniform(program, index) {
+  return new gl.WebGLActiveInfo(_getActiveUniform(program ? program._ : 0, index));
+}
 gl.getActiveUniform = function getActiveUniform(program, index) {
   if (!(arguments.length === 2 && (program === null || program instanceof gl.WebGLProgram) && typeof index === "number")) {
     throw new TypeError('Expected getActiveUniform(WebGLProgram program, number index)');
   }
-  return new gl.WebGLActiveInfo(_getActiveUniform(program ? program._ : 0, index));
+  return fast.getActiveUniform(program, index);
 }
 
 var _getAttachedShaders = gl.getAttachedShaders;
+fast.getAttachedShaders = function getAttachedShaders(program) {
+  return _getAttachedShaders(program ? program._ : 0);
+}
 gl.getAttachedShaders = function getAttachedShaders(program) {
   if (!(arguments.length === 1 && (program === null || program instanceof gl.WebGLProgram))) {
     throw new TypeError('Expected getAttachedShaders(WebGLProgram program)');
   }
-  return _getAttachedShaders(program ? program._ : 0);
+  return fast.getAttachedShaders(program);
 }
 
 var _getAttribLocation = gl.getAttribLocation;
+fast.getAttribLocation = function getAttribLocation(program, name) {
+  return _getAttribLocation(program ? program._ : 0, name);
+}
 gl.getAttribLocation = function getAttribLocation(program, name) {
   if (!(arguments.length === 2 && (program === null || program instanceof gl.WebGLProgram) && typeof name === "string")) {
     throw new TypeError('Expected getAttribLocation(WebGLProgram program, string name)');
   }
-  return _getAttribLocation(program ? program._ : 0, name);
+  return fast.getAttribLocation(program, name);
 }
 
 var _getParameter = gl.getParameter;
@@ -672,7 +2487,8 @@ const specialParameters = {
   elementArrayBuffer: 0x8895,
   copyRead: 0x8F36,
   copyWrite: 0x8F37,
-  transformFeedback: 0x8C8F
+  transformFeedback: 0x8C8F,
+  vertexArray: 0x85B5
 }
 const specialParametersSet = new Set(Object.values(specialParameters))
 const bufferParams = new Set([specialParameters.pixelUnpack, specialParameters.pixelPack, specialParameters.arrayBuffer, specialParameters.elementArrayBuffer, specialParameters.copyRead, specialParameters.copyWrite])
@@ -690,6 +2506,8 @@ gl.getParameter = function getParameter(pname) {
       return new gl.WebGLFramebuffer(result)
     }else if(bufferParams.has(pname)){
       return new gl.WebGLBuffer(result)
+    }else if(pname === specialParameters.vertexArray){
+      return new gl.WebGLVertexArrayObject(result)
     }
     throw new Error('TODO: wrap parameter value')
   }
@@ -697,7 +2515,7 @@ gl.getParameter = function getParameter(pname) {
   return result;
 }
 
-var _getBufferParameter = gl.getBufferParameter;
+var _getBufferParameter = fast.getBufferParameter = gl.getBufferParameter;
 gl.getBufferParameter = function getBufferParameter(target, pname) {
   if (!(arguments.length === 2 && typeof target === "number" && typeof pname === "number")) {
     throw new TypeError('Expected getBufferParameter(number target, number pname)');
@@ -705,7 +2523,7 @@ gl.getBufferParameter = function getBufferParameter(target, pname) {
   return _getBufferParameter(target, pname);
 }
 
-var _getError = gl.getError;
+var _getError = fast.getError = gl.getError;
 gl.getError = function getError() {
   if (!(arguments.length === 0)) {
     throw new TypeError('Expected getError()');
@@ -713,7 +2531,7 @@ gl.getError = function getError() {
   return _getError();
 }
 
-var _getFramebufferAttachmentParameter = gl.getFramebufferAttachmentParameter;
+var _getFramebufferAttachmentParameter = fast.getFramebufferAttachmentParameter = gl.getFramebufferAttachmentParameter;
 gl.getFramebufferAttachmentParameter = function getFramebufferAttachmentParameter(target, attachment, pname) {
   if (!(arguments.length === 3 && typeof target === "number" && typeof attachment === "number" && typeof pname === "number")) {
     throw new TypeError('Expected getFramebufferAttachmentParameter(number target, number attachment, number pname)');
@@ -722,22 +2540,28 @@ gl.getFramebufferAttachmentParameter = function getFramebufferAttachmentParamete
 }
 
 var _getProgramParameter = gl.getProgramParameter;
+fast.getProgramParameter = function getProgramParameter(program, pname) {
+  return _getProgramParameter(program ? program._ : 0, pname);
+}
 gl.getProgramParameter = function getProgramParameter(program, pname) {
   if (!(arguments.length === 2 && (program === null || program instanceof gl.WebGLProgram) && typeof pname === "number")) {
     throw new TypeError('Expected getProgramParameter(WebGLProgram program, number pname)');
   }
-  return _getProgramParameter(program ? program._ : 0, pname);
+  return fast.getProgramParameter(program, pname);
 }
 
 var _getProgramInfoLog = gl.getProgramInfoLog;
+fast.getProgramInfoLog = function getProgramInfoLog(program) {
+  return _getProgramInfoLog(program ? program._ : 0);
+}
 gl.getProgramInfoLog = function getProgramInfoLog(program) {
   if (!(arguments.length === 1 && (program === null || program instanceof gl.WebGLProgram))) {
     throw new TypeError('Expected getProgramInfoLog(WebGLProgram program)');
   }
-  return _getProgramInfoLog(program ? program._ : 0);
+  return fast.getProgramInfoLog(program);
 }
 
-var _getRenderbufferParameter = gl.getRenderbufferParameter;
+var _getRenderbufferParameter = fast.getRenderbufferParameter = gl.getRenderbufferParameter;
 gl.getRenderbufferParameter = function getRenderbufferParameter(target, pname) {
   if (!(arguments.length === 2 && typeof target === "number" && typeof pname === "number")) {
     throw new TypeError('Expected getRenderbufferParameter(number target, number pname)');
@@ -746,30 +2570,39 @@ gl.getRenderbufferParameter = function getRenderbufferParameter(target, pname) {
 }
 
 var _getShaderParameter = gl.getShaderParameter;
+fast.getShaderParameter = function getShaderParameter(shader, pname) {
+  return _getShaderParameter(shader ? shader._ : 0, pname);
+}
 gl.getShaderParameter = function getShaderParameter(shader, pname) {
   if (!(arguments.length === 2 && (shader === null || shader instanceof gl.WebGLShader) && typeof pname === "number")) {
     throw new TypeError('Expected getShaderParameter(WebGLShader shader, number pname)');
   }
-  return _getShaderParameter(shader ? shader._ : 0, pname);
+  return fast.getShaderParameter(shader, pname);
 }
 
 var _getShaderInfoLog = gl.getShaderInfoLog;
+fast.getShaderInfoLog = function getShaderInfoLog(shader) {
+  return _getShaderInfoLog(shader ? shader._ : 0);
+}
 gl.getShaderInfoLog = function getShaderInfoLog(shader) {
   if (!(arguments.length === 1 && (shader === null || shader instanceof gl.WebGLShader))) {
     throw new TypeError('Expected getShaderInfoLog(WebGLShader shader)');
   }
-  return _getShaderInfoLog(shader ? shader._ : 0);
+  return fast.getShaderInfoLog(shader);
 }
 
 var _getShaderSource = gl.getShaderSource;
+fast.getShaderSource = function getShaderSource(shader) {
+  return _getShaderSource(shader ? shader._ : 0);
+}
 gl.getShaderSource = function getShaderSource(shader) {
   if (!(arguments.length === 1 && (shader === null || shader instanceof gl.WebGLShader))) {
     throw new TypeError('Expected getShaderSource(WebGLShader shader)');
   }
-  return _getShaderSource(shader ? shader._ : 0);
+  return fast.getShaderSource(shader);
 }
 
-var _getTexParameter = gl.getTexParameter;
+var _getTexParameter = fast.getTexParameter = gl.getTexParameter;
 gl.getTexParameter = function getTexParameter(target, pname) {
   if (!(arguments.length === 2 && typeof target === "number" && typeof pname === "number")) {
     throw new TypeError('Expected getTexParameter(number target, number pname)');
@@ -778,22 +2611,28 @@ gl.getTexParameter = function getTexParameter(target, pname) {
 }
 
 var _getUniform = gl.getUniform;
+fast.getUniform = function getUniform(program, location) {
+  return _getUniform(program ? program._ : 0, location ? location._ : 0);
+}
 gl.getUniform = function getUniform(program, location) {
   if (!(arguments.length === 2 && (program === null || program instanceof gl.WebGLProgram) && (location === null || location instanceof gl.WebGLUniformLocation))) {
     throw new TypeError('Expected getUniform(WebGLProgram program, WebGLUniformLocation location)');
   }
-  return _getUniform(program ? program._ : 0, location ? location._ : 0);
+  return fast.getUniform(program, location);
 }
 
 var _getUniformLocation = gl.getUniformLocation;
+fast.getUniformLocation = function getUniformLocation(program, name) {
+  return new gl.WebGLUniformLocation(_getUniformLocation(program ? program._ : 0, name));
+}
 gl.getUniformLocation = function getUniformLocation(program, name) {
   if (!(arguments.length === 2 && (program === null || program instanceof gl.WebGLProgram) && typeof name === "string")) {
     throw new TypeError('Expected getUniformLocation(WebGLProgram program, string name)');
   }
-  return new gl.WebGLUniformLocation(_getUniformLocation(program ? program._ : 0, name));
+  return fast.getUniformLocation(program, name);
 }
 
-var _getVertexAttrib = gl.getVertexAttrib;
+var _getVertexAttrib = fast.getVertexAttrib = gl.getVertexAttrib;
 gl.getVertexAttrib = function getVertexAttrib(index, pname) {
   if (!(arguments.length === 2 && typeof index === "number" && typeof pname === "number")) {
     throw new TypeError('Expected getVertexAttrib(number index, number pname)');
@@ -802,19 +2641,21 @@ gl.getVertexAttrib = function getVertexAttrib(index, pname) {
 }
 
 var _getVertexAttribOffset = gl.getVertexAttribOffset;
-gl.getVertexAttribOffset = function getVertexAttribOffset(index, pname) {
-  if (!(arguments.length === 2 && typeof index === "number" && typeof pname === "number")) {
-    throw new TypeError('Expected getVertexAttribOffset(number index, number pname)');
-  }
-  
+fast.getVertexAttribOffset = function getVertexAttribOffset(index, pname) {
   if(pname === gl.CURRENT_VERTEX_ATTRIB) {
     var buf=_getVertexAttribOffset(index, pname);
     return new Float32Array(buf);
   }
   return _getVertexAttribOffset(index, pname);
 }
+gl.getVertexAttribOffset = function getVertexAttribOffset(index, pname) {
+  if (!(arguments.length === 2 && typeof index === "number" && typeof pname === "number")) {
+    throw new TypeError('Expected getVertexAttribOffset(number index, number pname)');
+  }
+  return fast.getVertexAttribOffset(index, pname);
+}
 
-var _hint = gl.hint;
+var _hint = fast.hint = gl.hint;
 gl.hint = function hint(target, mode) {
   if (!(arguments.length === 2 && typeof target === "number" && typeof mode === "number")) {
     throw new TypeError('Expected hint(number target, number mode)');
@@ -823,14 +2664,17 @@ gl.hint = function hint(target, mode) {
 }
 
 var _isBuffer = gl.isBuffer;
+fast.isBuffer = function isBuffer(buffer) {
+  return _isBuffer(buffer ? buffer._ : 0);
+}
 gl.isBuffer = function isBuffer(buffer) {
   if (!(arguments.length === 1 && (buffer === null || buffer instanceof gl.WebGLBuffer))) {
     throw new TypeError('Expected isBuffer(WebGLBuffer buffer)');
   }
-  return _isBuffer(buffer ? buffer._ : 0);
+  return fast.isBuffer(buffer);
 }
 
-var _isEnabled = gl.isEnabled;
+var _isEnabled = fast.isEnabled = gl.isEnabled;
 gl.isEnabled = function isEnabled(cap) {
   if (!(arguments.length === 1 && typeof cap === "number")) {
     throw new TypeError('Expected isEnabled(number cap)');
@@ -839,46 +2683,61 @@ gl.isEnabled = function isEnabled(cap) {
 }
 
 var _isFramebuffer = gl.isFramebuffer;
+fast.isFramebuffer = function isFramebuffer(framebuffer) {
+  return _isFramebuffer(framebuffer ? framebuffer._ : 0);
+}
 gl.isFramebuffer = function isFramebuffer(framebuffer) {
   if (!(arguments.length === 1 && (framebuffer === null || framebuffer instanceof gl.WebGLFramebuffer))) {
     throw new TypeError('Expected isFramebuffer(WebGLFramebuffer framebuffer)');
   }
-  return _isFramebuffer(framebuffer ? framebuffer._ : 0);
+  return fast.isFramebuffer(framebuffer);
 }
 
 var _isProgram = gl.isProgram;
+fast.isProgram = function isProgram(program) {
+  return _isProgram(program ? program._ : 0);
+}
 gl.isProgram = function isProgram(program) {
   if (!(arguments.length === 1 && (program === null || program instanceof gl.WebGLProgram))) {
     throw new TypeError('Expected isProgram(WebGLProgram program)');
   }
-  return _isProgram(program ? program._ : 0);
+  return fast.isProgram(program);
 }
 
 var _isRenderbuffer = gl.isRenderbuffer;
+fast.isRenderbuffer = function isRenderbuffer(renderbuffer) {
+  return _isRenderbuffer(renderbuffer ? renderbuffer._ : 0);
+}
 gl.isRenderbuffer = function isRenderbuffer(renderbuffer) {
   if (!(arguments.length === 1 && (renderbuffer === null || renderbuffer instanceof gl.WebGLRenderbuffer))) {
     throw new TypeError('Expected isRenderbuffer(WebGLRenderbuffer renderbuffer)');
   }
-  return _isRenderbuffer(renderbuffer ? renderbuffer._ : 0);
+  return fast.isRenderbuffer(renderbuffer);
 }
 
 var _isShader = gl.isShader;
+fast.isShader = function isShader(shader) {
+  return _isShader(shader ? shader._ : 0);
+}
 gl.isShader = function isShader(shader) {
   if (!(arguments.length === 1 && (shader === null || shader instanceof gl.WebGLShader))) {
     throw new TypeError('Expected isShader(WebGLShader shader)');
   }
-  return _isShader(shader ? shader._ : 0);
+  return fast.isShader(shader);
 }
 
 var _isTexture = gl.isTexture;
+fast.isTexture = function isTexture(texture) {
+  return _isTexture(texture ? texture._ : 0);
+}
 gl.isTexture = function isTexture(texture) {
   if (!(arguments.length === 1 && (texture === null || texture instanceof gl.WebGLTexture))) {
     throw new TypeError('Expected isTexture(WebGLTexture texture)');
   }
-  return _isTexture(texture ? texture._ : 0);
+  return fast.isTexture(texture);
 }
 
-var _lineWidth = gl.lineWidth;
+var _lineWidth = fast.lineWidth = gl.lineWidth;
 gl.lineWidth = function lineWidth(width) {
   if (!(arguments.length === 1 && typeof width === "number")) {
     throw new TypeError('Expected lineWidth(number width)');
@@ -887,25 +2746,30 @@ gl.lineWidth = function lineWidth(width) {
 }
 
 var _linkProgram = gl.linkProgram;
+fast.linkProgram = function linkProgram(program) {
+  return _linkProgram(program ? program._ : 0);
+}
 gl.linkProgram = function linkProgram(program) {
   if (!(arguments.length === 1 && (program === null || program instanceof gl.WebGLProgram))) {
     throw new TypeError('Expected linkProgram(WebGLProgram program)');
   }
-  return _linkProgram(program ? program._ : 0);
+  return fast.linkProgram(program);
 }
 
 var _pixelStorei = gl.pixelStorei;
+fast.pixelStorei = function pixelStorei(pname, param) {
+  if(typeof param === "boolean")
+    param= param ? 1 : 0;
+  return _pixelStorei(pname, param);
+}
 gl.pixelStorei = function pixelStorei(pname, param) {
   if (!(arguments.length === 2 && typeof pname === "number" && (typeof param === "number") || typeof param === "boolean")) {
     throw new TypeError('Expected pixelStorei(number pname, number param)');
   }
-  
-  if(typeof param === "boolean")
-    param= param ? 1 : 0;
-  return _pixelStorei(pname, param);
+  return fast.pixelStorei(pname, param);
 }
 
-var _polygonOffset = gl.polygonOffset;
+var _polygonOffset = fast.polygonOffset = gl.polygonOffset;
 gl.polygonOffset = function polygonOffset(factor, units) {
   if (!(arguments.length === 2 && typeof factor === "number" && typeof units === "number")) {
     throw new TypeError('Expected polygonOffset(number factor, number units)');
@@ -914,16 +2778,22 @@ gl.polygonOffset = function polygonOffset(factor, units) {
 }
 
 var _readPixels = gl.readPixels;
+fast.readPixels = function readPixels(x, y, width, height, format, type, pixels, dstOffset=0) {
+  return _readPixels(x, y, width, height, format, type, pixels, dstOffset);
+}
 gl.readPixels = function readPixels(x, y, width, height, format, type, pixels, dstOffset=0) {
   if (!((arguments.length === 7 || arguments.length === 8) && typeof x === "number" && typeof y === "number" && typeof width === "number" && typeof height === "number" && typeof format === "number" && 
     typeof type === "number" && 
     ((typeof pixels === "object") || typeof(pixels === "number")))) {
     throw new TypeError('Expected readPixels(number x, number y, number width, number height, number format, number type, (ArrayBufferView pixels | number offset), [number dstOffset])');
   }
-  return _readPixels(x, y, width, height, format, type, pixels, dstOffset);
+  return fast.readPixels(x, y, width, height, format, type, pixels, dstOffset);
 }
 
 var _getTextureImage = gl.getTextureImage;
+fast.getTextureImage = function getTextureImage(tex, level, format, type, bufSize, pixels) {
+  return _getTextureImage(tex._, level, format, type, bufSize, pixels);
+}
 gl.getTextureImage = function getTextureImage(tex, level, format, type, bufSize, pixels) {
   if (!((arguments.length === 6) &&
     ((typeof pixels === "object") || typeof(pixels === "number")))) {
@@ -932,10 +2802,10 @@ gl.getTextureImage = function getTextureImage(tex, level, format, type, bufSize,
   if(typeof(tex._) !== 'number'){
     throw new Error('tex is not a valid texture?')
   }
-  return _getTextureImage(tex._, level, format, type, bufSize, pixels);
+  return fast.getTextureImage(tex, level, format, type, bufSize, pixels);
 }
 
-var _renderbufferStorage = gl.renderbufferStorage;
+var _renderbufferStorage = fast.renderbufferStorage = gl.renderbufferStorage;
 gl.renderbufferStorage = function renderbufferStorage(target, internalformat, width, height) {
   if (!(arguments.length === 4 && typeof target === "number" && typeof internalformat === "number" && typeof width === "number" && typeof height === "number")) {
     throw new TypeError('Expected renderbufferStorage(number target, number internalformat, number width, number height)');
@@ -943,7 +2813,7 @@ gl.renderbufferStorage = function renderbufferStorage(target, internalformat, wi
   return _renderbufferStorage(target, internalformat, width, height);
 }
 
-var _sampleCoverage = gl.sampleCoverage;
+var _sampleCoverage = fast.sampleCoverage = gl.sampleCoverage;
 gl.sampleCoverage = function sampleCoverage(value, invert) {
   if (!(arguments.length === 2 && typeof value === "number" && typeof invert === "boolean")) {
     throw new TypeError('Expected sampleCoverage(number value, boolean invert)');
@@ -951,7 +2821,7 @@ gl.sampleCoverage = function sampleCoverage(value, invert) {
   return _sampleCoverage(value, invert);
 }
 
-var _scissor = gl.scissor;
+var _scissor = fast.scissor = gl.scissor;
 gl.scissor = function scissor(x, y, width, height) {
   if (!(arguments.length === 4 && typeof x === "number" && typeof y === "number" && typeof width === "number" && typeof height === "number")) {
     throw new TypeError('Expected scissor(number x, number y, number width, number height)');
@@ -960,14 +2830,17 @@ gl.scissor = function scissor(x, y, width, height) {
 }
 
 var _shaderSource = gl.shaderSource;
+fast.shaderSource = function shaderSource(shader, source) {
+  return _shaderSource(shader ? shader._ : 0, source);
+}
 gl.shaderSource = function shaderSource(shader, source) {
   if (!(arguments.length === 2 && (shader === null || shader instanceof gl.WebGLShader) && typeof source === "string")) {
     throw new TypeError('Expected shaderSource(WebGLShader shader, string source)');
   }
-  return _shaderSource(shader ? shader._ : 0, source);
+  return fast.shaderSource(shader, source);
 }
 
-var _stencilFunc = gl.stencilFunc;
+var _stencilFunc = fast.stencilFunc = gl.stencilFunc;
 gl.stencilFunc = function stencilFunc(func, ref, mask) {
   if (!(arguments.length === 3 && typeof func === "number" && typeof ref === "number" && typeof mask === "number")) {
     throw new TypeError('Expected stencilFunc(number func, number ref, number mask)');
@@ -975,7 +2848,7 @@ gl.stencilFunc = function stencilFunc(func, ref, mask) {
   return _stencilFunc(func, ref, mask);
 }
 
-var _stencilFuncSeparate = gl.stencilFuncSeparate;
+var _stencilFuncSeparate = fast.stencilFuncSeparate = gl.stencilFuncSeparate;
 gl.stencilFuncSeparate = function stencilFuncSeparate(face, func, ref, mask) {
   if (!(arguments.length === 4 && typeof face === "number" && typeof func === "number" && typeof ref === "number" && typeof mask === "number")) {
     throw new TypeError('Expected stencilFuncSeparate(number face, number func, number ref, number mask)');
@@ -983,7 +2856,7 @@ gl.stencilFuncSeparate = function stencilFuncSeparate(face, func, ref, mask) {
   return _stencilFuncSeparate(face, func, ref, mask);
 }
 
-var _stencilMask = gl.stencilMask;
+var _stencilMask = fast.stencilMask = gl.stencilMask;
 gl.stencilMask = function stencilMask(mask) {
   if (!(arguments.length === 1 && typeof mask === "number")) {
     throw new TypeError('Expected stencilMask(number mask)');
@@ -991,7 +2864,7 @@ gl.stencilMask = function stencilMask(mask) {
   return _stencilMask(mask);
 }
 
-var _stencilMaskSeparate = gl.stencilMaskSeparate;
+var _stencilMaskSeparate = fast.stencilMaskSeparate = gl.stencilMaskSeparate;
 gl.stencilMaskSeparate = function stencilMaskSeparate(face, mask) {
   if (!(arguments.length === 2 && typeof face === "number" && typeof mask === "number")) {
     throw new TypeError('Expected stencilMaskSeparate(number face, number mask)');
@@ -999,7 +2872,7 @@ gl.stencilMaskSeparate = function stencilMaskSeparate(face, mask) {
   return _stencilMaskSeparate(face, mask);
 }
 
-var _stencilOp = gl.stencilOp;
+var _stencilOp = fast.stencilOp = gl.stencilOp;
 gl.stencilOp = function stencilOp(fail, zfail, zpass) {
   if (!(arguments.length === 3 && typeof fail === "number" && typeof zfail === "number" && typeof zpass === "number")) {
     throw new TypeError('Expected stencilOp(number fail, number zfail, number zpass)');
@@ -1007,7 +2880,7 @@ gl.stencilOp = function stencilOp(fail, zfail, zpass) {
   return _stencilOp(fail, zfail, zpass);
 }
 
-var _stencilOpSeparate = gl.stencilOpSeparate;
+var _stencilOpSeparate = fast.stencilOpSeparate = gl.stencilOpSeparate;
 gl.stencilOpSeparate = function stencilOpSeparate(face, fail, zfail, zpass) {
   if (!(arguments.length === 4 && typeof face === "number" && typeof fail === "number" && typeof zfail === "number" && typeof zpass === "number")) {
     throw new TypeError('Expected stencilOpSeparate(number face, number fail, number zfail, number zpass)');
@@ -1050,7 +2923,7 @@ gl.texImage2D = function texImage2D(target, level, internalformat, width, height
   }
 }
 
-var _texParameterf = gl.texParameterf;
+var _texParameterf = fast.texParameterf = gl.texParameterf;
 gl.texParameterf = function texParameterf(target, pname, param) {
   if (!(arguments.length === 3 && typeof target === "number" && typeof pname === "number" && typeof param === "number")) {
     throw new TypeError('Expected texParameterf(number target, number pname, number param)');
@@ -1058,7 +2931,7 @@ gl.texParameterf = function texParameterf(target, pname, param) {
   return _texParameterf(target, pname, param);
 }
 
-var _texParameteri = gl.texParameteri;
+var _texParameteri = fast.texParameteri = gl.texParameteri;
 gl.texParameteri = function texParameteri(target, pname, param) {
   if (!(arguments.length === 3 && typeof target === "number" && typeof pname === "number" && typeof param === "number")) {
     throw new TypeError('Expected texParameteri(number target, number pname, number param)');
@@ -1067,20 +2940,26 @@ gl.texParameteri = function texParameteri(target, pname, param) {
 }
 
 var _textureParameteri = gl.textureParameteri;
+fast.textureParameteri = function textureParameteri(texture, pname, param) {
+  return _textureParameteri(texture._, pname, param);
+}
 gl.textureParameteri = function textureParameteri(texture, pname, param) {
   if (!(arguments.length === 3 && texture instanceof gl.WebGLTexture && typeof pname === "number" && typeof param === "number")) {
     throw new TypeError('Expected textureParameteri(WebGLTexture texture, number pname, number param)');
   }
-  return _textureParameteri(texture._, pname, param);
+  return fast.textureParameteri(texture, pname, param);
 }
 var _textureParameterf = gl.textureParameterf;
+fast.textureParameterf = function textureParameterf(texture, pname, param) {
+  return _textureParameterf(texture._, pname, param);
+}
 gl.textureParameterf = function textureParameterf(texture, pname, param) {
   if (!(arguments.length === 3 && texture instanceof gl.WebGLTexture && typeof pname === "number" && typeof param === "number")) {
     throw new TypeError('Expected textureParameterf(WebGLTexture texture, number pname, number param)');
   }
-  return _textureParameterf(texture._, pname, param);
+  return fast.textureParameterf(texture, pname, param);
 }
-var _texSubImage2D = gl.texSubImage2D;
+var _texSubImage2D = fast.texSubImage2D = gl.texSubImage2D;
 gl.texSubImage2D = function texSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels) {
   if (!(arguments.length === 9 && typeof target === "number" && typeof level === "number" && 
       typeof xoffset === "number" && typeof yoffset === "number" && 
@@ -1092,185 +2971,271 @@ gl.texSubImage2D = function texSubImage2D(target, level, xoffset, yoffset, width
   return _texSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
 }
 
+var _compressedTexImage2D = fast.compressedTexImage2D = gl.compressedTexImage2D;
+gl.compressedTexImage2D = function compressedTexImage2D(target, level, internalformat, width, height, border, data) {
+  if (!(arguments.length === 7 && typeof target === "number" && typeof level === "number" &&
+      typeof internalformat === "number" && typeof width === "number" &&
+      typeof height === "number" && typeof border === "number" && ArrayBuffer.isView(data))) {
+    throw new TypeError('Expected compressedTexImage2D(number target, number level, number internalformat, number width, number height, number border, ArrayBufferView data)');
+  }
+  return _compressedTexImage2D(target, level, internalformat, width, height, border, data);
+}
+
+var _compressedTexSubImage2D = fast.compressedTexSubImage2D = gl.compressedTexSubImage2D;
+gl.compressedTexSubImage2D = function compressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, data) {
+  if (!(arguments.length === 8 && typeof target === "number" && typeof level === "number" &&
+      typeof xoffset === "number" && typeof yoffset === "number" &&
+      typeof width === "number" && typeof height === "number" &&
+      typeof format === "number" && ArrayBuffer.isView(data))) {
+    throw new TypeError('Expected compressedTexSubImage2D(number target, number level, number xoffset, number yoffset, number width, number height, number format, ArrayBufferView data)');
+  }
+  return _compressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, data);
+}
+
 var _uniform1f = gl.uniform1f;
+fast.uniform1f = function uniform1f(location, x) {
+  return _uniform1f(location ? location._ : 0, x);
+}
 gl.uniform1f = function uniform1f(location, x) {
   if (!(arguments.length === 2 && (location === null || location instanceof gl.WebGLUniformLocation) && (typeof x === "number" || typeof x === "boolean"))) {
-    console.log([location, x])
     throw new TypeError('Expected uniform1f(WebGLUniformLocation location, number x)');
   }
-  return _uniform1f(location ? location._ : 0, x);
+  return fast.uniform1f(location, x);
 }
 
 var _uniform1fv = gl.uniform1fv;
+fast.uniform1fv = function uniform1fv(location, v) {
+  return _uniform1fv(location ? location._ : 0, v);
+}
 gl.uniform1fv = function uniform1fv(location, v) {
   if (!(arguments.length === 2 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof v === "object")) {
     throw new TypeError('Expected uniform1fv(WebGLUniformLocation location, FloatArray v)');
   }
-  return _uniform1fv(location ? location._ : 0, v);
+  return fast.uniform1fv(location, v);
 }
 
 var _uniform1i = gl.uniform1i;
+fast.uniform1i = function uniform1i(location, x) {
+  if(typeof x === "boolean")
+    x= x ? 1 : 0;
+  return _uniform1i(location ? location._ : 0, x);
+}
 gl.uniform1i = function uniform1i(location, x) {
   if (!(arguments.length === 2 && (location === null || location instanceof gl.WebGLUniformLocation) && (typeof x === "number" || typeof x ==="boolean"))) {
     throw new TypeError('Expected uniform1i(WebGLUniformLocation location, number x)');
   }
-  if(typeof x === "boolean")
-    x= x ? 1 : 0;
-  return _uniform1i(location ? location._ : 0, x);
+  return fast.uniform1i(location, x);
 }
 
 var _uniform1iv = gl.uniform1iv;
+fast.uniform1iv = function uniform1iv(location, v) {
+  return _uniform1iv(location ? location._ : 0, v);
+}
 gl.uniform1iv = function uniform1iv(location, v) {
   if (!(arguments.length === 2 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof v === "object")) {
     throw new TypeError('Expected uniform1iv(WebGLUniformLocation location, Int32Array v)');
   }
-  return _uniform1iv(location ? location._ : 0, v);
+  return fast.uniform1iv(location, v);
 }
 
 var _uniform2f = gl.uniform2f;
+fast.uniform2f = function uniform2f(location, x, y) {
+  return _uniform2f(location ? location._ : 0, x, y);
+}
 gl.uniform2f = function uniform2f(location, x, y) {
   if (!(arguments.length === 3 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof x === "number" && typeof y === "number")) {
     throw new TypeError('Expected uniform2f(WebGLUniformLocation location, number x, number y)');
   }
-  return _uniform2f(location ? location._ : 0, x, y);
+  return fast.uniform2f(location, x, y);
 }
 
 var _uniform2fv = gl.uniform2fv;
+fast.uniform2fv = function uniform2fv(location, v) {
+  return _uniform2fv(location ? location._ : 0, v);
+}
 gl.uniform2fv = function uniform2fv(location, v) {
   if (!(arguments.length === 2 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof v === "object")) {
     throw new TypeError('Expected uniform2fv(WebGLUniformLocation location, FloatArray v)');
   }
-  return _uniform2fv(location ? location._ : 0, v);
+  return fast.uniform2fv(location, v);
 }
 
 var _uniform2i = gl.uniform2i;
+fast.uniform2i = function uniform2i(location, x, y) {
+  return _uniform2i(location ? location._ : 0, x, y);
+}
 gl.uniform2i = function uniform2i(location, x, y) {
   if (!(arguments.length === 3 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof x === "number" && typeof y === "number")) {
     throw new TypeError('Expected uniform2i(WebGLUniformLocation location, number x, number y)');
   }
-  return _uniform2i(location ? location._ : 0, x, y);
+  return fast.uniform2i(location, x, y);
 }
 var _uniform2ui = gl.uniform2ui;
+fast.uniform2ui = function uniform2ui(location, x, y) {
+  return _uniform2ui(location ? location._ : 0, x, y);
+}
 gl.uniform2ui = function uniform2ui(location, x, y) {
   if (!(arguments.length === 3 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof x === "number" && typeof y === "number")) {
     throw new TypeError('Expected uniform2i(WebGLUniformLocation location, number x, number y)');
   }
-  return _uniform2ui(location ? location._ : 0, x, y);
+  return fast.uniform2ui(location, x, y);
 }
 
 var _uniform2iv = gl.uniform2iv;
+fast.uniform2iv = function uniform2iv(location, v) {
+  return _uniform2iv(location ? location._ : 0, v);
+}
 gl.uniform2iv = function uniform2iv(location, v) {
   if (!(arguments.length === 2 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof v === "object")) {
     throw new TypeError('Expected uniform2iv(WebGLUniformLocation location, Int32Array v)');
   }
-  return _uniform2iv(location ? location._ : 0, v);
+  return fast.uniform2iv(location, v);
 }
 
 var _uniform3f = gl.uniform3f;
+fast.uniform3f = function uniform3f(location, x, y, z) {
+  return _uniform3f(location ? location._ : 0, x, y, z);
+}
 gl.uniform3f = function uniform3f(location, x, y, z) {
   if (!(arguments.length === 4 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof x === "number" && typeof y === "number" && typeof z === "number")) {
     throw new TypeError('Expected uniform3f(WebGLUniformLocation location, number x, number y, number z)');
   }
-  return _uniform3f(location ? location._ : 0, x, y, z);
+  return fast.uniform3f(location, x, y, z);
 }
 
 var _uniform3fv = gl.uniform3fv;
+fast.uniform3fv = function uniform3fv(location, v) {
+  return _uniform3fv(location ? location._ : 0, v);
+}
 gl.uniform3fv = function uniform3fv(location, v) {
   if (!(arguments.length === 2 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof v === "object")) {
     throw new TypeError('Expected uniform3fv(WebGLUniformLocation location, FloatArray v)');
   }
-  return _uniform3fv(location ? location._ : 0, v);
+  return fast.uniform3fv(location, v);
 }
 
 var _uniform3i = gl.uniform3i;
+fast.uniform3i = function uniform3i(location, x, y, z) {
+  return _uniform3i(location ? location._ : 0, x, y, z);
+}
 gl.uniform3i = function uniform3i(location, x, y, z) {
   if (!(arguments.length === 4 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof x === "number" && typeof y === "number" && typeof z === "number")) {
     throw new TypeError('Expected uniform3i(WebGLUniformLocation location, number x, number y, number z)');
   }
-  return _uniform3i(location ? location._ : 0, x, y, z);
+  return fast.uniform3i(location, x, y, z);
 }
 
 var _uniform3iv = gl.uniform3iv;
+fast.uniform3iv = function uniform3iv(location, x) {
+  return _uniform3iv(location ? location._ : 0, x);
+}
 gl.uniform3iv = function uniform3iv(location, x) {
   if (!(arguments.length === 2 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof x === "object")) {
     throw new TypeError('Expected uniform3iv(WebGLUniformLocation location, Int32Array x)');
   }
-  return _uniform3iv(location ? location._ : 0, x);
+  return fast.uniform3iv(location, x);
 }
 
 var _uniform4f = gl.uniform4f;
+fast.uniform4f = function uniform4f(location, x, y, z, w) {
+  return _uniform4f(location ? location._ : 0, x, y, z, w);
+}
 gl.uniform4f = function uniform4f(location, x, y, z, w) {
   if (!(arguments.length === 5 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof x === "number" && typeof y === "number" && typeof z === "number" && typeof w === "number")) {
     throw new TypeError('Expected uniform4f(WebGLUniformLocation location, number x, number y, number z, number w)');
   }
-  return _uniform4f(location ? location._ : 0, x, y, z, w);
+  return fast.uniform4f(location, x, y, z, w);
 }
 
 var _uniform4fv = gl.uniform4fv;
+fast.uniform4fv = function uniform4fv(location, v) {
+  return _uniform4fv(location ? location._ : 0, v);
+}
 gl.uniform4fv = function uniform4fv(location, v) {
   if (!(arguments.length === 2 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof v === "object")) {
     throw new TypeError('Expected uniform4fv(WebGLUniformLocation location, FloatArray v)');
   }
-  return _uniform4fv(location ? location._ : 0, v);
+  return fast.uniform4fv(location, v);
 }
 
 var _uniform4i = gl.uniform4i;
+fast.uniform4i = function uniform4i(location, x, y, z, w) {
+  return _uniform4i(location ? location._ : 0, x, y, z, w);
+}
 gl.uniform4i = function uniform4i(location, x, y, z, w) {
   if (!(arguments.length === 5 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof x === "number" && typeof y === "number" && typeof z === "number" && typeof w === "number")) {
     throw new TypeError('Expected uniform4i(WebGLUniformLocation location, number x, number y, number z, number w)');
   }
-  return _uniform4i(location ? location._ : 0, x, y, z, w);
+  return fast.uniform4i(location, x, y, z, w);
 }
 
 var _uniform4iv = gl.uniform4iv;
+fast.uniform4iv = function uniform4iv(location, x) {
+  return _uniform4iv(location ? location._ : 0, x);
+}
 gl.uniform4iv = function uniform4iv(location, x) {
   if (!(arguments.length === 2 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof x === "object")) {
     throw new TypeError('Expected uniform4iv(WebGLUniformLocation location, Int32Array x)');
   }
-  return _uniform4iv(location ? location._ : 0, x);
+  return fast.uniform4iv(location, x);
 }
 
 var _uniformMatrix2fv = gl.uniformMatrix2fv;
+fast.uniformMatrix2fv = function uniformMatrix2fv(location, transpose, value) {
+  return _uniformMatrix2fv(location ? location._ : 0, transpose, value);
+}
 gl.uniformMatrix2fv = function uniformMatrix2fv(location, transpose, value) {
   if (!(arguments.length === 3 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof transpose === "boolean" && typeof value === "object")) {
     throw new TypeError('Expected uniformMatrix2fv(WebGLUniformLocation location, boolean transpose, FloatArray value)');
   }
-  return _uniformMatrix2fv(location ? location._ : 0, transpose, value);
+  return fast.uniformMatrix2fv(location, transpose, value);
 }
 
 var _uniformMatrix3fv = gl.uniformMatrix3fv;
+fast.uniformMatrix3fv = function uniformMatrix3fv(location, transpose, value) {
+  return _uniformMatrix3fv(location ? location._ : 0, transpose, value);
+}
 gl.uniformMatrix3fv = function uniformMatrix3fv(location, transpose, value) {
   if (!(arguments.length === 3 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof transpose === "boolean" && typeof value === "object")) {
     throw new TypeError('Expected uniformMatrix3fv(WebGLUniformLocation location, boolean transpose, FloatArray value)');
   }
-  return _uniformMatrix3fv(location ? location._ : 0, transpose, value);
+  return fast.uniformMatrix3fv(location, transpose, value);
 }
 
 var _uniformMatrix4fv = gl.uniformMatrix4fv;
+fast.uniformMatrix4fv = function uniformMatrix4fv(location, transpose, value) {
+  return _uniformMatrix4fv(location ? location._ : 0, transpose, value);
+}
 gl.uniformMatrix4fv = function uniformMatrix4fv(location, transpose, value) {
   if (!(arguments.length === 3 && (location === null || location instanceof gl.WebGLUniformLocation) && typeof transpose === "boolean" && typeof value === "object")) {
     throw new TypeError('Expected uniformMatrix4fv(WebGLUniformLocation location, boolean transpose, FloatArray value)');
   }
-  return _uniformMatrix4fv(location ? location._ : 0, transpose, value);
+  return fast.uniformMatrix4fv(location, transpose, value);
 }
 
 var _useProgram = gl.useProgram;
+fast.useProgram = function useProgram(program) {
+  return _useProgram(program ? program._ : 0);
+}
 gl.useProgram = function useProgram(program) {
   if (!(arguments.length === 1 && (program === null || program instanceof gl.WebGLProgram))) {
     throw new TypeError('Expected useProgram(WebGLProgram program)');
   }
-  return _useProgram(program ? program._ : 0);
+  return fast.useProgram(program);
 }
 
 var _validateProgram = gl.validateProgram;
+fast.validateProgram = function validateProgram(program) {
+  return _validateProgram(program ? program._ : 0);
+}
 gl.validateProgram = function validateProgram(program) {
   if (!(arguments.length === 1 && (program === null || program instanceof gl.WebGLProgram))) {
     throw new TypeError('Expected validateProgram(WebGLProgram program)');
   }
-  return _validateProgram(program ? program._ : 0);
+  return fast.validateProgram(program);
 }
 
-var _vertexAttrib1f = gl.vertexAttrib1f;
+var _vertexAttrib1f = fast.vertexAttrib1f = gl.vertexAttrib1f;
 gl.vertexAttrib1f = function vertexAttrib1f(indx, x) {
   if (!(arguments.length === 2 && typeof indx === "number" && typeof x === "number")) {
     throw new TypeError('Expected vertexAttrib1f(number indx, number x)');
@@ -1278,7 +3243,7 @@ gl.vertexAttrib1f = function vertexAttrib1f(indx, x) {
   return _vertexAttrib1f(indx, x);
 }
 
-var _vertexAttrib1fv = gl.vertexAttrib1fv;
+var _vertexAttrib1fv = fast.vertexAttrib1fv = gl.vertexAttrib1fv;
 gl.vertexAttrib1fv = function vertexAttrib1fv(indx, values) {
   if (!(arguments.length === 2 && typeof indx === "number" && typeof values === "object")) {
     throw new TypeError('Expected vertexAttrib1fv(number indx, FloatArray values)');
@@ -1286,7 +3251,7 @@ gl.vertexAttrib1fv = function vertexAttrib1fv(indx, values) {
   return _vertexAttrib1fv(indx, values);
 }
 
-var _vertexAttrib2f = gl.vertexAttrib2f;
+var _vertexAttrib2f = fast.vertexAttrib2f = gl.vertexAttrib2f;
 gl.vertexAttrib2f = function vertexAttrib2f(indx, x, y) {
   if (!(arguments.length === 3 && typeof indx === "number" && typeof x === "number" && typeof y === "number")) {
     throw new TypeError('Expected vertexAttrib2f(number indx, number x, number y)');
@@ -1294,7 +3259,7 @@ gl.vertexAttrib2f = function vertexAttrib2f(indx, x, y) {
   return _vertexAttrib2f(indx, x, y);
 }
 
-var _vertexAttrib2fv = gl.vertexAttrib2fv;
+var _vertexAttrib2fv = fast.vertexAttrib2fv = gl.vertexAttrib2fv;
 gl.vertexAttrib2fv = function vertexAttrib2fv(indx, values) {
   if (!(arguments.length === 2 && typeof indx === "number" && typeof values === "object")) {
     throw new TypeError('Expected vertexAttrib2fv(number indx, FloatArray values)');
@@ -1302,7 +3267,7 @@ gl.vertexAttrib2fv = function vertexAttrib2fv(indx, values) {
   return _vertexAttrib2fv(indx, values);
 }
 
-var _vertexAttrib3f = gl.vertexAttrib3f;
+var _vertexAttrib3f = fast.vertexAttrib3f = gl.vertexAttrib3f;
 gl.vertexAttrib3f = function vertexAttrib3f(indx, x, y, z) {
   if (!(arguments.length === 4 && typeof indx === "number" && typeof x === "number" && typeof y === "number" && typeof z === "number")) {
     throw new TypeError('Expected vertexAttrib3f(number indx, number x, number y, number z)');
@@ -1310,7 +3275,7 @@ gl.vertexAttrib3f = function vertexAttrib3f(indx, x, y, z) {
   return _vertexAttrib3f(indx, x, y, z);
 }
 
-var _vertexAttrib3fv = gl.vertexAttrib3fv;
+var _vertexAttrib3fv = fast.vertexAttrib3fv = gl.vertexAttrib3fv;
 gl.vertexAttrib3fv = function vertexAttrib3fv(indx, values) {
   if (!(arguments.length === 2 && typeof indx === "number" && typeof values === "object")) {
     throw new TypeError('Expected vertexAttrib3fv(number indx, FloatArray values)');
@@ -1318,7 +3283,7 @@ gl.vertexAttrib3fv = function vertexAttrib3fv(indx, values) {
   return _vertexAttrib3fv(indx, values);
 }
 
-var _vertexAttrib4f = gl.vertexAttrib4f;
+var _vertexAttrib4f = fast.vertexAttrib4f = gl.vertexAttrib4f;
 gl.vertexAttrib4f = function vertexAttrib4f(indx, x, y, z, w) {
   if (!(arguments.length === 5 && typeof indx === "number" && typeof x === "number" && typeof y === "number" && typeof z === "number" && typeof w === "number")) {
     throw new TypeError('Expected vertexAttrib4f(number indx, number x, number y, number z, number w)');
@@ -1326,7 +3291,7 @@ gl.vertexAttrib4f = function vertexAttrib4f(indx, x, y, z, w) {
   return _vertexAttrib4f(indx, x, y, z, w);
 }
 
-var _vertexAttrib4fv = gl.vertexAttrib4fv;
+var _vertexAttrib4fv = fast.vertexAttrib4fv = gl.vertexAttrib4fv;
 gl.vertexAttrib4fv = function vertexAttrib4fv(indx, values) {
   if (!(arguments.length === 2 && typeof indx === "number" && typeof values === "object")) {
     throw new TypeError('Expected vertexAttrib4fv(number indx, FloatArray values)');
@@ -1334,16 +3299,283 @@ gl.vertexAttrib4fv = function vertexAttrib4fv(indx, values) {
   return _vertexAttrib4fv(indx, values);
 }
 
-var _vertexAttribPointer = gl.vertexAttribPointer;
+var _vertexAttribPointer = fast.vertexAttribPointer = gl.vertexAttribPointer;
 gl.vertexAttribPointer = function vertexAttribPointer(indx, size, type, normalized, stride, offset) {
   if (!(arguments.length === 6 && typeof indx === "number" && typeof size === "number" && typeof type === "number" && (typeof normalized === "boolean" || typeof normalized === "number") && typeof stride === "number" && typeof offset === "number")) {
-    console.log('vertexAttribPointer: ', [indx, size, type, normalized, stride, offset])
     throw new TypeError('Expected vertexAttribPointer(number indx, number size, number type, boolean normalized, number stride, number offset)');
   }
   return _vertexAttribPointer(indx, size, type, normalized, stride, offset);
 }
 
-var _viewport = gl.viewport;
+////////////////////////////////////////////////////////////////////////////////
+// Vertex array objects
+//
+// The DSA entry points (vertexArray*) set up a VAO without binding it. Offsets may exceed 2^32.
+
+var _createVertexArray = gl.createVertexArray;
+fast.createVertexArray = function createVertexArray() {
+  return owned(new gl.WebGLVertexArrayObject(_createVertexArray()), objectTypes.vertexArray);
+}
+gl.createVertexArray = function createVertexArray() {
+  if (!(arguments.length === 0)) {
+    throw new TypeError('Expected createVertexArray()');
+  }
+  return fast.createVertexArray();
+}
+
+var _deleteVertexArray = gl.deleteVertexArray;
+fast.deleteVertexArray = function deleteVertexArray(vao) {
+  return _deleteVertexArray(vao ? vao._ : 0);
+}
+gl.deleteVertexArray = function deleteVertexArray(vao) {
+  if (!(arguments.length === 1 && (vao === null || vao instanceof gl.WebGLVertexArrayObject))) {
+    throw new TypeError('Expected deleteVertexArray(WebGLVertexArrayObject vao)');
+  }
+  return fast.deleteVertexArray(vao);
+}
+
+var _bindVertexArray = gl.bindVertexArray;
+fast.bindVertexArray = function bindVertexArray(vao) {
+  return _bindVertexArray(vao ? vao._ : 0);
+}
+gl.bindVertexArray = function bindVertexArray(vao) {
+  if (!(arguments.length === 1 && (vao === null || vao instanceof gl.WebGLVertexArrayObject))) {
+    throw new TypeError('Expected bindVertexArray(WebGLVertexArrayObject vao)');
+  }
+  return fast.bindVertexArray(vao);
+}
+
+var _isVertexArray = gl.isVertexArray;
+fast.isVertexArray = function isVertexArray(vao) {
+  return _isVertexArray(vao ? vao._ : 0);
+}
+gl.isVertexArray = function isVertexArray(vao) {
+  if (!(arguments.length === 1 && (vao === null || vao instanceof gl.WebGLVertexArrayObject))) {
+    throw new TypeError('Expected isVertexArray(WebGLVertexArrayObject vao)');
+  }
+  return fast.isVertexArray(vao);
+}
+
+var _enableVertexArrayAttrib = gl.enableVertexArrayAttrib;
+fast.enableVertexArrayAttrib = function enableVertexArrayAttrib(vao, index) {
+  return _enableVertexArrayAttrib(vao ? vao._ : 0, index);
+}
+gl.enableVertexArrayAttrib = function enableVertexArrayAttrib(vao, index) {
+  if (!(arguments.length === 2 && (vao instanceof gl.WebGLVertexArrayObject) && typeof index === "number")) {
+    throw new TypeError('Expected enableVertexArrayAttrib(WebGLVertexArrayObject vao, number index)');
+  }
+  return fast.enableVertexArrayAttrib(vao, index);
+}
+
+var _disableVertexArrayAttrib = gl.disableVertexArrayAttrib;
+fast.disableVertexArrayAttrib = function disableVertexArrayAttrib(vao, index) {
+  return _disableVertexArrayAttrib(vao ? vao._ : 0, index);
+}
+gl.disableVertexArrayAttrib = function disableVertexArrayAttrib(vao, index) {
+  if (!(arguments.length === 2 && (vao instanceof gl.WebGLVertexArrayObject) && typeof index === "number")) {
+    throw new TypeError('Expected disableVertexArrayAttrib(WebGLVertexArrayObject vao, number index)');
+  }
+  return fast.disableVertexArrayAttrib(vao, index);
+}
+
+var _vertexArrayAttribFormat = gl.vertexArrayAttribFormat;
+fast.vertexArrayAttribFormat = function vertexArrayAttribFormat(vao, index, size, type, normalized, relativeOffset) {
+  return _vertexArrayAttribFormat(vao ? vao._ : 0, index, size, type, normalized, relativeOffset);
+}
+gl.vertexArrayAttribFormat = function vertexArrayAttribFormat(vao, index, size, type, normalized, relativeOffset) {
+  if (!(arguments.length === 6 && (vao instanceof gl.WebGLVertexArrayObject) && typeof index === "number" && typeof size === "number" && typeof type === "number" && (typeof normalized === "boolean" || typeof normalized === "number") && typeof relativeOffset === "number")) {
+    throw new TypeError('Expected vertexArrayAttribFormat(WebGLVertexArrayObject vao, number index, number size, number type, boolean normalized, number relativeOffset)');
+  }
+  return fast.vertexArrayAttribFormat(vao, index, size, type, normalized, relativeOffset);
+}
+
+var _vertexArrayAttribIFormat = gl.vertexArrayAttribIFormat;
+fast.vertexArrayAttribIFormat = function vertexArrayAttribIFormat(vao, index, size, type, relativeOffset) {
+  return _vertexArrayAttribIFormat(vao ? vao._ : 0, index, size, type, relativeOffset);
+}
+gl.vertexArrayAttribIFormat = function vertexArrayAttribIFormat(vao, index, size, type, relativeOffset) {
+  if (!(arguments.length === 5 && (vao instanceof gl.WebGLVertexArrayObject) && typeof index === "number" && typeof size === "number" && typeof type === "number" && typeof relativeOffset === "number")) {
+    throw new TypeError('Expected vertexArrayAttribIFormat(WebGLVertexArrayObject vao, number index, number size, number type, number relativeOffset)');
+  }
+  return fast.vertexArrayAttribIFormat(vao, index, size, type, relativeOffset);
+}
+
+var _vertexArrayAttribLFormat = gl.vertexArrayAttribLFormat;
+fast.vertexArrayAttribLFormat = function vertexArrayAttribLFormat(vao, index, size, type, relativeOffset) {
+  return _vertexArrayAttribLFormat(vao ? vao._ : 0, index, size, type, relativeOffset);
+}
+gl.vertexArrayAttribLFormat = function vertexArrayAttribLFormat(vao, index, size, type, relativeOffset) {
+  if (!(arguments.length === 5 && (vao instanceof gl.WebGLVertexArrayObject) && typeof index === "number" && typeof size === "number" && typeof type === "number" && typeof relativeOffset === "number")) {
+    throw new TypeError('Expected vertexArrayAttribLFormat(WebGLVertexArrayObject vao, number index, number size, number type, number relativeOffset)');
+  }
+  return fast.vertexArrayAttribLFormat(vao, index, size, type, relativeOffset);
+}
+
+var _vertexArrayAttribBinding = gl.vertexArrayAttribBinding;
+fast.vertexArrayAttribBinding = function vertexArrayAttribBinding(vao, index, binding) {
+  return _vertexArrayAttribBinding(vao ? vao._ : 0, index, binding);
+}
+gl.vertexArrayAttribBinding = function vertexArrayAttribBinding(vao, index, binding) {
+  if (!(arguments.length === 3 && (vao instanceof gl.WebGLVertexArrayObject) && typeof index === "number" && typeof binding === "number")) {
+    throw new TypeError('Expected vertexArrayAttribBinding(WebGLVertexArrayObject vao, number index, number binding)');
+  }
+  return fast.vertexArrayAttribBinding(vao, index, binding);
+}
+
+var _vertexArrayBindingDivisor = gl.vertexArrayBindingDivisor;
+fast.vertexArrayBindingDivisor = function vertexArrayBindingDivisor(vao, binding, divisor) {
+  return _vertexArrayBindingDivisor(vao ? vao._ : 0, binding, divisor);
+}
+gl.vertexArrayBindingDivisor = function vertexArrayBindingDivisor(vao, binding, divisor) {
+  if (!(arguments.length === 3 && (vao instanceof gl.WebGLVertexArrayObject) && typeof binding === "number" && typeof divisor === "number")) {
+    throw new TypeError('Expected vertexArrayBindingDivisor(WebGLVertexArrayObject vao, number binding, number divisor)');
+  }
+  return fast.vertexArrayBindingDivisor(vao, binding, divisor);
+}
+
+var _vertexArrayVertexBuffer = gl.vertexArrayVertexBuffer;
+fast.vertexArrayVertexBuffer = function vertexArrayVertexBuffer(vao, binding, buffer, offset, stride) {
+  return _vertexArrayVertexBuffer(vao ? vao._ : 0, binding, buffer ? buffer._ : 0, offset, stride);
+}
+gl.vertexArrayVertexBuffer = function vertexArrayVertexBuffer(vao, binding, buffer, offset, stride) {
+  if (!(arguments.length === 5 && (vao instanceof gl.WebGLVertexArrayObject) && typeof binding === "number" && (buffer === null || buffer instanceof gl.WebGLBuffer) && (typeof offset === "number" || typeof offset === "bigint") && typeof stride === "number")) {
+    throw new TypeError('Expected vertexArrayVertexBuffer(WebGLVertexArrayObject vao, number binding, WebGLBuffer buffer, number offset, number stride)');
+  }
+  return fast.vertexArrayVertexBuffer(vao, binding, buffer, offset, stride);
+}
+
+var _vertexArrayElementBuffer = gl.vertexArrayElementBuffer;
+fast.vertexArrayElementBuffer = function vertexArrayElementBuffer(vao, buffer) {
+  return _vertexArrayElementBuffer(vao ? vao._ : 0, buffer ? buffer._ : 0);
+}
+gl.vertexArrayElementBuffer = function vertexArrayElementBuffer(vao, buffer) {
+  if (!(arguments.length === 2 && (vao instanceof gl.WebGLVertexArrayObject) && (buffer === null || buffer instanceof gl.WebGLBuffer))) {
+    throw new TypeError('Expected vertexArrayElementBuffer(WebGLVertexArrayObject vao, WebGLBuffer buffer)');
+  }
+  return fast.vertexArrayElementBuffer(vao, buffer);
+}
+
+// Vertex layouts: a complete vertex format built into a VAO with one native call, whose
+// buffers can be swapped and which is bound with one native call per draw (the buffer
+// bindings are only sent again after they changed).
+//
+//   var layout = gl.createVertexLayout({
+//     attributes: [{location: 0, size: 3, type: gl.FLOAT, offset: 0},
+//                  {location: 1, size: 4, type: gl.INT_2_10_10_10_REV, normalized: true, offset: 12}],
+//     bindings: [{stride: 16}]
+//   });
+//   layout.setBuffer(0, vertexBuffer);
+//   layout.setElementBuffer(indexBuffer);
+//   gl.bindVertexLayout(layout);
+//
+// Attributes take binding (default 0), normalized, and integer or double for the
+// IFormat/LFormat variants; bindings take stride (default: tightly packed) and divisor.
+
+// must match VertexLayoutKind in src/webgl.cc
+var vertexLayoutKinds = { float: 0, integer: 1, double: 2 };
+
+function vertexTypeBytes(type) {
+  switch (type) {
+    case 0x1400: case 0x1401: return 1;                     // BYTE, UNSIGNED_BYTE
+    case 0x1402: case 0x1403: case 0x140B: return 2;        // SHORT, UNSIGNED_SHORT, HALF_FLOAT
+    case 0x140A: return 8;                                  // DOUBLE
+    default: return 4;
+  }
+}
+function vertexAttribBytes(attrib) {
+  var type = attrib.type === undefined ? 0x1406 /* FLOAT */ : attrib.type;
+  // INT_2_10_10_10_REV, UNSIGNED_INT_2_10_10_10_REV and UNSIGNED_INT_10F_11F_11F_REV pack all components
+  if (type === 0x8D9F || type === 0x8368 || type === 0x8C3B) return 4;
+  return attrib.size * vertexTypeBytes(type);
+}
+
+var _createVertexLayout = gl.createVertexLayout;
+var _bindVertexLayout = gl.bindVertexLayout;
+
+gl.WebGLVertexLayout = function WebGLVertexLayout(vertexArray, strides) {
+  this.vertexArray = vertexArray;
+  this.strides = strides;
+  this.buffers = new Uint32Array(strides.length);
+  this.offsets = new Float64Array(strides.length);
+  // the wrappers, so the buffers aren't reclaimed while the layout uses them
+  this.bufferObjects = new Array(strides.length).fill(null);
+  this.elementBufferObject = null;
+  this.buffersChanged = false;
+  // name to attach at the next bind, -1 for none
+  this.pendingElementBuffer = -1;
+}
+gl.WebGLVertexLayout.prototype.setBuffer = function setBuffer(binding, buffer, offset) {
+  if (!(binding >= 0 && binding < this.buffers.length && (buffer === null || buffer instanceof gl.WebGLBuffer))) {
+    throw new TypeError('Expected setBuffer(number binding < ' + this.buffers.length + ', WebGLBuffer buffer, [number offset])');
+  }
+  this.bufferObjects[binding] = buffer;
+  this.buffers[binding] = buffer ? buffer._ : 0;
+  this.offsets[binding] = offset || 0;
+  this.buffersChanged = true;
+  return this;
+}
+gl.WebGLVertexLayout.prototype.setElementBuffer = function setElementBuffer(buffer) {
+  if (!(buffer === null || buffer instanceof gl.WebGLBuffer)) {
+    throw new TypeError('Expected setElementBuffer(WebGLBuffer buffer)');
+  }
+  this.elementBufferObject = buffer;
+  this.pendingElementBuffer = buffer ? buffer._ : 0;
+  return this;
+}
+
+gl.createVertexLayout = function createVertexLayout(desc) {
+  if (!(arguments.length === 1 && desc && Array.isArray(desc.attributes))) {
+    throw new TypeError('Expected createVertexLayout({attributes: [...], [bindings: [...]]})');
+  }
+  var bindings = desc.bindings || [];
+  var bindingCount = bindings.length;
+  desc.attributes.forEach(function(a) {
+    bindingCount = Math.max(bindingCount, (a.binding|0) + 1);
+  });
+
+  var attribs = new Int32Array(desc.attributes.length * 7);
+  var packed = new Int32Array(bindingCount);
+  desc.attributes.forEach(function(a, i) {
+    if (typeof a.location !== 'number' || typeof a.size !== 'number') {
+      throw new TypeError('createVertexLayout: every attribute needs a location and a size');
+    }
+    var binding = a.binding|0, offset = a.offset|0;
+    attribs.set([a.location, a.size, a.type === undefined ? 0x1406 /* FLOAT */ : a.type, a.normalized ? 1 : 0, offset, binding,
+                 a.double ? vertexLayoutKinds.double : a.integer ? vertexLayoutKinds.integer : vertexLayoutKinds.float], i * 7);
+    packed[binding] = Math.max(packed[binding], offset + vertexAttribBytes(a));
+  });
+
+  var strides = new Int32Array(bindingCount);
+  var divisors = new Int32Array(bindingCount * 2);
+  for (var i = 0; i < bindingCount; i++) {
+    var b = bindings[i] || {};
+    strides[i] = b.stride === undefined ? packed[i] : b.stride;
+    divisors[i * 2] = strides[i];
+    divisors[i * 2 + 1] = b.divisor|0;
+  }
+
+  var vertexArray = owned(new gl.WebGLVertexArrayObject(_createVertexLayout(attribs, divisors)), objectTypes.vertexArray);
+  return new gl.WebGLVertexLayout(vertexArray, strides);
+}
+
+fast.bindVertexLayout = function bindVertexLayout(layout) {
+  if (!layout) return _bindVertexArray(0);
+  if (layout.buffersChanged || layout.pendingElementBuffer >= 0) {
+    _bindVertexLayout(layout.vertexArray._, layout.buffersChanged ? layout.buffers : null, layout.offsets, layout.strides, layout.pendingElementBuffer);
+    layout.buffersChanged = false;
+    layout.pendingElementBuffer = -1;
+  }
+  else
+    _bindVertexArray(layout.vertexArray._);
+}
+gl.bindVertexLayout = function bindVertexLayout(layout) {
+  if (!(arguments.length === 1 && (layout === null || layout instanceof gl.WebGLVertexLayout))) {
+    throw new TypeError('Expected bindVertexLayout(WebGLVertexLayout layout)');
+  }
+  return fast.bindVertexLayout(layout);
+}
+
+var _viewport = fast.viewport = gl.viewport;
 gl.viewport = function viewport(x, y, width, height) {
   if (!(arguments.length === 4 && typeof x === "number" && typeof y === "number" && typeof width === "number" && typeof height === "number")) {
     throw new TypeError('Expected viewport(number x, number y, number width, number height)');
@@ -1352,7 +3584,10 @@ gl.viewport = function viewport(x, y, width, height) {
 }
 
 var _clearBufferfv = gl.clearBufferfv;
-gl.clearBufferfv = function viewport(buffer, drawBuffer, values, srcOffset=0) {
+fast.clearBufferfv = function clearBufferfv(buffer, drawBuffer, values, srcOffset=0) {
+  return _clearBufferfv(buffer, drawBuffer, values, srcOffset);
+}
+gl.clearBufferfv = function clearBufferfv(buffer, drawBuffer, values, srcOffset=0) {
   if (!((arguments.length <= 4 && arguments.length >= 3) && typeof buffer === "number" && typeof drawBuffer === "number" && typeof srcOffset === "number")) {
     throw new TypeError('Expected clearBufferfv(number buffer, number drawBuffer, FloatArray values, number srcOffset=0)');
   }
@@ -1362,6 +3597,27 @@ gl.clearBufferfv = function viewport(buffer, drawBuffer, values, srcOffset=0) {
   if(values.constructor !== Float32Array){
     throw new Error('values must be a Float32Array, is: ' + values.constructor.name)
   }
-  return _clearBufferfv(buffer, drawBuffer, values, srcOffset);
+  return fast.clearBufferfv(buffer, drawBuffer, values, srcOffset);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Fast mode
+//
+// Every checked wrapper above validates its arguments and then calls its
+// counterpart in `fast`, which only unwraps WebGL objects (or is the native
+// binding itself when there is nothing to unwrap). The checked set is the
+// default, as a debug mode; NODE_WEBGL_FAST=1 installs the fast set on gl
+// instead. Both stay reachable as gl.checked and gl.fast, which share gl's
+// constants and remaining functions.
+
+var checked = {};
+Object.keys(fast).forEach(function(name) {
+  checked[name] = gl[name];
+});
+
+gl.checked = Object.assign(Object.create(gl), checked);
+gl.fast = Object.assign(Object.create(gl), fast);
+
+gl.isFastMode = !!process.env.NODE_WEBGL_FAST && process.env.NODE_WEBGL_FAST !== '0';
+if (gl.isFastMode)
+  Object.assign(gl, fast);
@@ -8,6 +8,22 @@
 
 #include "webgl.h"
 #include "image.h"
+#include "texture_loader.h"
+#include "gl_objects.h"
+#include "texture_residency.h"
+#include "sampler_cache.h"
+#include "render_state.h"
+#include "render_queue.h"
+#include "culling.h"
+#include "matrix_batch.h"
+#include "obj_loader.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "glb_loader.h"
+#include "debug_output.h"
+#include "trace.h"
+#include "headless_context.h"
+#include "vertex_packing.h"
 #include <cstdlib>
 
 v8::PropertyAttribute constant_attributes = 
@@ -25,10 +41,76 @@ void init(Local<Object> target)
 {
   atexit(webgl::AtExit);
   atexit(Image::AtExit);
+  atexit(webgl::DebugOutputAtExit);
+  atexit(webgl::TraceAtExit);
 
   Image::Initialize(target);
 
   Nan::SetMethod(target,"Init",webgl::Init);
+
+  Nan::SetMethod(target, "glObjectSerial", webgl::GLObjectSerial);
+  Nan::SetMethod(target, "queueObjectDelete", webgl::QueueObjectDelete);
+  Nan::SetMethod(target, "processObjectDeletes", webgl::ProcessObjectDeletes);
+  Nan::SetMethod(target, "getObjectBytes", webgl::GetObjectBytes);
+  Nan::SetMethod(target, "getMemoryStats", webgl::GetMemoryStats);
+  Nan::SetMethod(target, "setMemoryBudget", webgl::SetMemoryBudget);
+
+  Nan::SetMethod(target, "manageTexture", webgl::ManageTexture);
+  Nan::SetMethod(target, "unmanageTexture", webgl::UnmanageTexture);
+  Nan::SetMethod(target, "setTextureResidency", webgl::SetTextureResidency);
+  Nan::SetMethod(target, "endTextureFrame", webgl::EndTextureFrame);
+  Nan::SetMethod(target, "getTextureResidencyStats", webgl::GetTextureResidencyStats);
+
+  Nan::SetMethod(target, "getSampler", webgl::GetSampler);
+  Nan::SetMethod(target, "releaseSampler", webgl::ReleaseSampler);
+  Nan::SetMethod(target, "getSamplerCacheStats", webgl::GetSamplerCacheStats);
+
+  Nan::SetMethod(target, "createRenderState", webgl::CreateRenderState);
+  Nan::SetMethod(target, "applyRenderState", webgl::ApplyRenderState);
+  Nan::SetMethod(target, "invalidateRenderState", webgl::InvalidateRenderState);
+  Nan::SetMethod(target, "deleteRenderState", webgl::DeleteRenderState);
+
+  Nan::SetMethod(target, "createBindingGroup", webgl::CreateBindingGroup);
+  Nan::SetMethod(target, "deleteBindingGroup", webgl::DeleteBindingGroup);
+  Nan::SetMethod(target, "executeRenderQueue", webgl::ExecuteRenderQueue);
+
+  Nan::SetMethod(target, "cullSpheres", webgl::CullSpheres);
+  Nan::SetMethod(target, "cullBoxes", webgl::CullBoxes);
+
+  Nan::SetMethod(target, "multiplyMat4", webgl::MultiplyMat4);
+  Nan::SetMethod(target, "composeMat4", webgl::ComposeMat4);
+  Nan::SetMethod(target, "propagateMat4", webgl::PropagateMat4);
+  Nan::SetMethod(target, "normalMatrices", webgl::NormalMatrices);
+  Nan::SetMethod(target, "invertMat4", webgl::InvertMat4);
+
+  Nan::SetMethod(target, "loadObj", webgl::LoadObj);
+
+  Nan::SetMethod(target, "analyzeVertexCache", webgl::AnalyzeVertexCache);
+  Nan::SetMethod(target, "optimizeVertexCache", webgl::OptimizeVertexCache);
+  Nan::SetMethod(target, "optimizeOverdraw", webgl::OptimizeOverdraw);
+  Nan::SetMethod(target, "optimizeVertexFetch", webgl::OptimizeVertexFetch);
+
+  Nan::SetMethod(target, "packVertices", webgl::PackVertices);
+
+  Nan::SetMethod(target, "simplifyLods", webgl::SimplifyLods);
+
+  Nan::SetMethod(target, "loadGlb", webgl::LoadGlb);
+
+  Nan::SetMethod(target, "debugOutput", webgl::DebugOutput);
+  Nan::SetMethod(target, "debugMessageControl", webgl::DebugMessageControl);
+  Nan::SetMethod(target, "debugMessageInsert", webgl::DebugMessageInsert);
+  Nan::SetMethod(target, "pushDebugGroup", webgl::PushDebugGroup);
+  Nan::SetMethod(target, "popDebugGroup", webgl::PopDebugGroup);
+  Nan::SetMethod(target, "objectLabel", webgl::ObjectLabel);
+
+  Nan::SetMethod(target, "traceOpen", webgl::TraceOpen);
+  Nan::SetMethod(target, "traceClose", webgl::TraceClose);
+  Nan::SetMethod(target, "traceDefine", webgl::TraceDefine);
+  Nan::SetMethod(target, "traceCall", webgl::TraceCall);
+  Nan::SetMethod(target, "traceReturn", webgl::TraceReturn);
+  Nan::SetMethod(target, "traceCallback", webgl::TraceCallback);
+  Nan::SetMethod(target, "traceFrame", webgl::TraceFrame);
+  Nan::SetMethod(target, "createHeadlessContext", webgl::CreateHeadlessContext);
  
   Nan::SetMethod(target, "uniform1f", webgl::Uniform1f);
   Nan::SetMethod(target, "uniform2f", webgl::Uniform2f);
@@ -102,6 +184,7 @@ void init(Local<Object> target)
   Nan::SetMethod(target, "vertexAttribPointer", webgl::VertexAttribPointer);
   Nan::SetMethod(target, "activeTexture", webgl::ActiveTexture);
   Nan::SetMethod(target, "drawElements", webgl::DrawElements);
+  Nan::SetMethod(target, "drawElementsBaseVertex", webgl::DrawElementsBaseVertex);
   Nan::SetMethod(target, "flush", webgl::Flush);
   Nan::SetMethod(target, "finish", webgl::Finish);
 
@@ -162,6 +245,8 @@ void init(Local<Object> target)
   Nan::SetMethod(target, "validateProgram", webgl::ValidateProgram);
 
   Nan::SetMethod(target, "texSubImage2D", webgl::TexSubImage2D);
+  Nan::SetMethod(target, "compressedTexImage2D", webgl::CompressedTexImage2D);
+  Nan::SetMethod(target, "compressedTexSubImage2D", webgl::CompressedTexSubImage2D);
   Nan::SetMethod(target, "readPixels", webgl::ReadPixels);
   Nan::SetMethod(target, "getTexParameter", webgl::GetTexParameter);
   Nan::SetMethod(target, "getActiveAttrib", webgl::GetActiveAttrib);
@@ -186,6 +271,7 @@ void init(Local<Object> target)
   Nan::SetMethod(target, "deleteTransformFeedback", webgl::DeleteTransformFeedback);
   Nan::SetMethod(target, "createSampler", webgl::CreateSampler);
   Nan::SetMethod(target, "samplerParameteri", webgl::SamplerParameteri);
+  Nan::SetMethod(target, "samplerParameterf", webgl::SamplerParameterf);
   Nan::SetMethod(target, "blitFramebuffer", webgl::BlitFramebuffer);
   Nan::SetMethod(target, "bindSampler", webgl::BindSampler);
   Nan::SetMethod(target, "transformFeedbackVaryings", webgl::TransformFeedbackVaryings);
@@ -229,9 +315,39 @@ Nan::SetMethod(target, "namedBufferSubData", webgl::NamedBufferSubData);
 Nan::SetMethod(target, "textureStorage2D", webgl::TextureStorage2D);
 Nan::SetMethod(target, "textureStorage3D", webgl::TextureStorage3D);
 Nan::SetMethod(target, "textureSubImage2D", webgl::TextureSubImage2D);
+Nan::SetMethod(target, "compressedTextureSubImage2D", webgl::CompressedTextureSubImage2D);
 
 Nan::SetMethod(target, "textureParameteri", webgl::TextureParameteri);
 Nan::SetMethod(target, "textureParameterf", webgl::TextureParameterf);
+
+Nan::SetMethod(target, "bindTextures", webgl::BindTextures);
+Nan::SetMethod(target, "bindSamplers", webgl::BindSamplers);
+Nan::SetMethod(target, "bindImageTextures", webgl::BindImageTextures);
+Nan::SetMethod(target, "bindBuffersBase", webgl::BindBuffersBase);
+Nan::SetMethod(target, "bindBuffersRange", webgl::BindBuffersRange);
+Nan::SetMethod(target, "bindVertexBuffers", webgl::BindVertexBuffers);
+
+Nan::SetMethod(target, "createVertexArray", webgl::CreateVertexArray);
+Nan::SetMethod(target, "deleteVertexArray", webgl::DeleteVertexArray);
+Nan::SetMethod(target, "bindVertexArray", webgl::BindVertexArray);
+Nan::SetMethod(target, "isVertexArray", webgl::IsVertexArray);
+Nan::SetMethod(target, "enableVertexArrayAttrib", webgl::EnableVertexArrayAttrib);
+Nan::SetMethod(target, "disableVertexArrayAttrib", webgl::DisableVertexArrayAttrib);
+Nan::SetMethod(target, "vertexArrayAttribFormat", webgl::VertexArrayAttribFormat);
+Nan::SetMethod(target, "vertexArrayAttribIFormat", webgl::VertexArrayAttribIFormat);
+Nan::SetMethod(target, "vertexArrayAttribLFormat", webgl::VertexArrayAttribLFormat);
+Nan::SetMethod(target, "vertexArrayAttribBinding", webgl::VertexArrayAttribBinding);
+Nan::SetMethod(target, "vertexArrayBindingDivisor", webgl::VertexArrayBindingDivisor);
+Nan::SetMethod(target, "vertexArrayVertexBuffer", webgl::VertexArrayVertexBuffer);
+Nan::SetMethod(target, "vertexArrayElementBuffer", webgl::VertexArrayElementBuffer);
+Nan::SetMethod(target, "createVertexLayout", webgl::CreateVertexLayout);
+Nan::SetMethod(target, "bindVertexLayout", webgl::BindVertexLayout);
+
+Nan::SetMethod(target, "texImageFromFile", webgl::TexImageFromFile);
+Nan::SetMethod(target, "compressedTexImageFromFile", webgl::CompressedTexImageFromFile);
+Nan::SetMethod(target, "compressTexImageFromFile", webgl::CompressTexImageFromFile);
+Nan::SetMethod(target, "encodeTexture", webgl::EncodeTexture);
+Nan::SetMethod(target, "decodeTexture", webgl::DecodeTexture);
   
 /*** END OF NEW WRAPPERS ADDED BY LIAM ***/
 
@@ -435,6 +551,11 @@ Nan::SetMethod(target, "textureParameterf", webgl::TextureParameterf);
   JS_GL_CONSTANT(INT);
   JS_GL_CONSTANT(UNSIGNED_INT);
   JS_GL_CONSTANT(FLOAT);
+  JS_GL_CONSTANT(HALF_FLOAT);
+  JS_GL_CONSTANT(DOUBLE);
+  JS_GL_CONSTANT(INT_2_10_10_10_REV);
+  JS_GL_CONSTANT(UNSIGNED_INT_2_10_10_10_REV);
+  JS_GL_CONSTANT(UNSIGNED_INT_10F_11F_11F_REV);
 #ifndef __APPLE__
   JS_GL_CONSTANT(FIXED);
 #endif
@@ -700,6 +821,98 @@ Nan::SetMethod(target, "textureParameterf", webgl::TextureParameterf);
   JS_GL_SET_CONSTANT("PIXEL_UNPACK_BUFFER" , 0x88EC);
   JS_GL_SET_CONSTANT("PIXEL_PACK_BUFFER_BINDING" , 0x88ED);
   JS_GL_SET_CONSTANT("PIXEL_UNPACK_BUFFER_BINDING", 0x88EF);
+
+  // block compressed texture formats (S3TC/RGTC/BPTC/ETC2/EAC/ASTC)
+  JS_GL_SET_CONSTANT("COMPRESSED_RGB_S3TC_DXT1_EXT" , 0x83F0);
+  JS_GL_SET_CONSTANT("COMPRESSED_RGBA_S3TC_DXT1_EXT" , 0x83F1);
+  JS_GL_SET_CONSTANT("COMPRESSED_RGBA_S3TC_DXT3_EXT" , 0x83F2);
+  JS_GL_SET_CONSTANT("COMPRESSED_RGBA_S3TC_DXT5_EXT" , 0x83F3);
+  JS_GL_SET_CONSTANT("COMPRESSED_SRGB_S3TC_DXT1_EXT" , 0x8C4C);
+  JS_GL_SET_CONSTANT("COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT" , 0x8C4D);
+  JS_GL_SET_CONSTANT("COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT" , 0x8C4E);
+  JS_GL_SET_CONSTANT("COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT" , 0x8C4F);
+  JS_GL_SET_CONSTANT("COMPRESSED_RED_RGTC1" , 0x8DBB);
+  JS_GL_SET_CONSTANT("COMPRESSED_SIGNED_RED_RGTC1" , 0x8DBC);
+  JS_GL_SET_CONSTANT("COMPRESSED_RG_RGTC2" , 0x8DBD);
+  JS_GL_SET_CONSTANT("COMPRESSED_SIGNED_RG_RGTC2" , 0x8DBE);
+  JS_GL_SET_CONSTANT("COMPRESSED_RGBA_BPTC_UNORM" , 0x8E8C);
+  JS_GL_SET_CONSTANT("COMPRESSED_SRGB_ALPHA_BPTC_UNORM" , 0x8E8D);
+  JS_GL_SET_CONSTANT("COMPRESSED_RGB_BPTC_SIGNED_FLOAT" , 0x8E8E);
+  JS_GL_SET_CONSTANT("COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT" , 0x8E8F);
+  JS_GL_SET_CONSTANT("COMPRESSED_R11_EAC" , 0x9270);
+  JS_GL_SET_CONSTANT("COMPRESSED_SIGNED_R11_EAC" , 0x9271);
+  JS_GL_SET_CONSTANT("COMPRESSED_RG11_EAC" , 0x9272);
+  JS_GL_SET_CONSTANT("COMPRESSED_SIGNED_RG11_EAC" , 0x9273);
+  JS_GL_SET_CONSTANT("COMPRESSED_RGB8_ETC2" , 0x9274);
+  JS_GL_SET_CONSTANT("COMPRESSED_SRGB8_ETC2" , 0x9275);
+  JS_GL_SET_CONSTANT("COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2" , 0x9276);
+  JS_GL_SET_CONSTANT("COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2", 0x9277);
+  JS_GL_SET_CONSTANT("COMPRESSED_RGBA8_ETC2_EAC" , 0x9278);
+  JS_GL_SET_CONSTANT("COMPRESSED_SRGB8_ALPHA8_ETC2_EAC" , 0x9279);
+  JS_GL_SET_CONSTANT("COMPRESSED_RGBA_ASTC_4x4_KHR" , 0x93B0);
+  JS_GL_SET_CONSTANT("COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR" , 0x93D0);
+
+  /* Vertex array objects */
+  JS_GL_CONSTANT(VERTEX_ARRAY_BINDING);
+  JS_GL_CONSTANT(MAX_VERTEX_ATTRIB_BINDINGS);
+  JS_GL_CONSTANT(MAX_VERTEX_ATTRIB_RELATIVE_OFFSET);
+  JS_GL_CONSTANT(MAX_VERTEX_ATTRIB_STRIDE);
+  JS_GL_CONSTANT(VERTEX_ATTRIB_BINDING);
+  JS_GL_CONSTANT(VERTEX_ATTRIB_RELATIVE_OFFSET);
+  JS_GL_CONSTANT(VERTEX_BINDING_DIVISOR);
+  JS_GL_CONSTANT(VERTEX_BINDING_OFFSET);
+  JS_GL_CONSTANT(VERTEX_BINDING_STRIDE);
+  JS_GL_CONSTANT(VERTEX_BINDING_BUFFER);
+
+  /* Samplers */
+  JS_GL_CONSTANT(SAMPLER_BINDING);
+  JS_GL_CONSTANT(TEXTURE_WRAP_R);
+  JS_GL_CONSTANT(TEXTURE_MIN_LOD);
+  JS_GL_CONSTANT(TEXTURE_MAX_LOD);
+  JS_GL_CONSTANT(TEXTURE_LOD_BIAS);
+  JS_GL_CONSTANT(TEXTURE_BORDER_COLOR);
+  JS_GL_CONSTANT(TEXTURE_COMPARE_MODE);
+  JS_GL_CONSTANT(TEXTURE_COMPARE_FUNC);
+  JS_GL_CONSTANT(COMPARE_REF_TO_TEXTURE);
+  JS_GL_CONSTANT(CLAMP_TO_BORDER);
+  JS_GL_CONSTANT(MIRROR_CLAMP_TO_EDGE);
+  JS_GL_SET_CONSTANT("TEXTURE_MAX_ANISOTROPY_EXT" , 0x84FE);
+  JS_GL_SET_CONSTANT("MAX_TEXTURE_MAX_ANISOTROPY_EXT" , 0x84FF);
+
+  /* Debug output */
+  JS_GL_CONSTANT(DEBUG_OUTPUT);
+  JS_GL_CONSTANT(DEBUG_OUTPUT_SYNCHRONOUS);
+  JS_GL_CONSTANT(DONT_CARE);
+  JS_GL_CONSTANT(DEBUG_SOURCE_API);
+  JS_GL_CONSTANT(DEBUG_SOURCE_WINDOW_SYSTEM);
+  JS_GL_CONSTANT(DEBUG_SOURCE_SHADER_COMPILER);
+  JS_GL_CONSTANT(DEBUG_SOURCE_THIRD_PARTY);
+  JS_GL_CONSTANT(DEBUG_SOURCE_APPLICATION);
+  JS_GL_CONSTANT(DEBUG_SOURCE_OTHER);
+  JS_GL_CONSTANT(DEBUG_TYPE_ERROR);
+  JS_GL_CONSTANT(DEBUG_TYPE_DEPRECATED_BEHAVIOR);
+  JS_GL_CONSTANT(DEBUG_TYPE_UNDEFINED_BEHAVIOR);
+  JS_GL_CONSTANT(DEBUG_TYPE_PORTABILITY);
+  JS_GL_CONSTANT(DEBUG_TYPE_PERFORMANCE);
+  JS_GL_CONSTANT(DEBUG_TYPE_MARKER);
+  JS_GL_CONSTANT(DEBUG_TYPE_PUSH_GROUP);
+  JS_GL_CONSTANT(DEBUG_TYPE_POP_GROUP);
+  JS_GL_CONSTANT(DEBUG_TYPE_OTHER);
+  JS_GL_CONSTANT(DEBUG_SEVERITY_HIGH);
+  JS_GL_CONSTANT(DEBUG_SEVERITY_MEDIUM);
+  JS_GL_CONSTANT(DEBUG_SEVERITY_LOW);
+  JS_GL_CONSTANT(DEBUG_SEVERITY_NOTIFICATION);
+  JS_GL_CONSTANT(MAX_DEBUG_MESSAGE_LENGTH);
+  JS_GL_CONSTANT(MAX_DEBUG_GROUP_STACK_DEPTH);
+  JS_GL_CONSTANT(MAX_LABEL_LENGTH);
+  JS_GL_CONSTANT(BUFFER);
+  JS_GL_CONSTANT(SHADER);
+  JS_GL_CONSTANT(PROGRAM);
+  JS_GL_CONSTANT(VERTEX_ARRAY);
+  JS_GL_CONSTANT(QUERY);
+  JS_GL_CONSTANT(PROGRAM_PIPELINE);
+  JS_GL_CONSTANT(SAMPLER);
+  JS_GL_CONSTANT(TRANSFORM_FEEDBACK);
 }
 
 NODE_MODULE(webgl, init)
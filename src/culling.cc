@@ -0,0 +1,255 @@
+/*
+ * culling.cc
+ *
+ * gl.cullSpheres(planes, spheres, visible, indices, lod, lodParams, threads) -> visible count
+ * gl.cullBoxes(planes, boxes, visible, indices, lod, lodParams, threads) -> visible count
+ *
+ * planes: 6 normalized planes a, b, c, d, inside where ax + by + cz + d >= 0.
+ * lodParams: camera x, y, z, projection scale (viewport height / 2 /
+ * tan(fovy / 2)), then up to 8 descending pixel sizes; an object's LOD is
+ * the number of sizes its projected diameter is smaller than.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define WEBGL_CULLING_SSE2
+  #include <emmintrin.h>
+#endif
+
+#include <cmath>
+#include <cstring>
+
+#include "culling.h"
+#include "marshal.h"
+#include "parallel.h"
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+static const int MAX_LOD_SIZES = 8;
+// objects per task when culling on several threads
+static const int CULL_CHUNK = 4096;
+
+struct CullJob {
+  float planes[6][4];
+  float absPlanes[6][3];
+  const float *bounds;
+  bool boxes;
+  uint8_t *visible;
+  uint8_t *lod;
+  float camera[3];
+  float projScale;
+  // squared and halved: an object is smaller than size when
+  // (radius * projScale)^2 < (size / 2)^2 * distance^2
+  float lodSizes[MAX_LOD_SIZES];
+  int lodSizeCount;
+};
+
+static inline uint8_t lodLevel(const CullJob &job, float x, float y, float z, float radius) {
+  float dx = x - job.camera[0], dy = y - job.camera[1], dz = z - job.camera[2];
+  float distance2 = dx * dx + dy * dy + dz * dz;
+  float size2 = radius * job.projScale;
+  size2 *= size2;
+  uint8_t level = 0;
+  for(int i = 0; i < job.lodSizeCount; i++)
+    level += size2 < job.lodSizes[i] * distance2;
+  return level;
+}
+
+// center and radius of object i; for boxes the radius is the bounding
+// sphere's, the plane tests use the extents
+static inline void objectSphere(const CullJob &job, size_t i, float *center, float *extent, float *radius) {
+  if(job.boxes) {
+    const float *b = job.bounds + i * 6;
+    for(int k = 0; k < 3; k++) {
+      center[k] = (b[k] + b[k + 3]) * 0.5f;
+      extent[k] = (b[k + 3] - b[k]) * 0.5f;
+    }
+    *radius = sqrtf(extent[0] * extent[0] + extent[1] * extent[1] + extent[2] * extent[2]);
+  } else {
+    const float *s = job.bounds + i * 4;
+    for(int k = 0; k < 3; k++)
+      center[k] = s[k];
+    *radius = s[3];
+  }
+}
+
+static void cullScalar(const CullJob &job, size_t begin, size_t end) {
+  for(size_t i = begin; i < end; i++) {
+    float c[3], e[3], radius;
+    objectSphere(job, i, c, e, &radius);
+    bool inside = true;
+    for(int p = 0; p < 6 && inside; p++) {
+      const float *plane = job.planes[p];
+      float r = radius;
+      if(job.boxes)
+        r = job.absPlanes[p][0] * e[0] + job.absPlanes[p][1] * e[1] + job.absPlanes[p][2] * e[2];
+      inside = plane[0] * c[0] + plane[1] * c[1] + plane[2] * c[2] + plane[3] >= -r;
+    }
+    job.visible[i] = inside;
+    if(job.lod)
+      job.lod[i] = inside ? lodLevel(job, c[0], c[1], c[2], radius) : 0;
+  }
+}
+
+#ifdef WEBGL_CULLING_SSE2
+static inline __m128 planeDistance(const float *plane, __m128 x, __m128 y, __m128 z) {
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[0]), x), _mm_mul_ps(_mm_set1_ps(plane[1]), y)),
+                    _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane[2]), z), _mm_set1_ps(plane[3])));
+}
+
+static inline __m128 dot3(const float *v, __m128 x, __m128 y, __m128 z) {
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(v[0]), x), _mm_mul_ps(_mm_set1_ps(v[1]), y)),
+                    _mm_mul_ps(_mm_set1_ps(v[2]), z));
+}
+
+// Four objects at a time, transposed to one register per component.
+static void cullSSE2(const CullJob &job, size_t begin, size_t end) {
+  size_t i = begin;
+  for(; i + 4 <= end; i += 4) {
+    __m128 x, y, z, radius, ex, ey, ez;
+    if(job.boxes) {
+      const float *b = job.bounds + i * 6;
+      __m128 minX = _mm_setr_ps(b[0], b[6], b[12], b[18]), maxX = _mm_setr_ps(b[3], b[9], b[15], b[21]);
+      __m128 minY = _mm_setr_ps(b[1], b[7], b[13], b[19]), maxY = _mm_setr_ps(b[4], b[10], b[16], b[22]);
+      __m128 minZ = _mm_setr_ps(b[2], b[8], b[14], b[20]), maxZ = _mm_setr_ps(b[5], b[11], b[17], b[23]);
+      __m128 half = _mm_set1_ps(0.5f);
+      x = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+      y = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+      z = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+      ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+      ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+      ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+      radius = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ex, ex), _mm_mul_ps(ey, ey)), _mm_mul_ps(ez, ez)));
+    } else {
+      const float *s = job.bounds + i * 4;
+      x = _mm_loadu_ps(s);
+      y = _mm_loadu_ps(s + 4);
+      z = _mm_loadu_ps(s + 8);
+      radius = _mm_loadu_ps(s + 12);
+      _MM_TRANSPOSE4_PS(x, y, z, radius);
+      ex = ey = ez = _mm_setzero_ps();
+    }
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for(int p = 0; p < 6; p++) {
+      __m128 r = job.boxes ? dot3(job.absPlanes[p], ex, ey, ez) : radius;
+      __m128 distance = planeDistance(job.planes[p], x, y, z);
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_sub_ps(_mm_setzero_ps(), r)));
+      if(!_mm_movemask_ps(inside))
+        break;
+    }
+
+    int mask = _mm_movemask_ps(inside);
+    for(int k = 0; k < 4; k++)
+      job.visible[i + k] = (mask >> k) & 1;
+
+    if(job.lod) {
+      __m128 dx = _mm_sub_ps(x, _mm_set1_ps(job.camera[0]));
+      __m128 dy = _mm_sub_ps(y, _mm_set1_ps(job.camera[1]));
+      __m128 dz = _mm_sub_ps(z, _mm_set1_ps(job.camera[2]));
+      __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+      __m128 size2 = _mm_mul_ps(radius, _mm_set1_ps(job.projScale));
+      size2 = _mm_mul_ps(size2, size2);
+      // each smaller-than mask is -1 per lane, so subtracting counts them
+      __m128i level = _mm_setzero_si128();
+      for(int s = 0; s < job.lodSizeCount; s++) {
+        __m128 smaller = _mm_cmplt_ps(size2, _mm_mul_ps(_mm_set1_ps(job.lodSizes[s]), distance2));
+        level = _mm_sub_epi32(level, _mm_castps_si128(smaller));
+      }
+      level = _mm_and_si128(level, _mm_castps_si128(inside));
+      int32_t levels[4];
+      _mm_storeu_si128((__m128i *) levels, level);
+      for(int k = 0; k < 4; k++)
+        job.lod[i + k] = (uint8_t) levels[k];
+    }
+  }
+  cullScalar(job, i, end);
+}
+#endif
+
+static void cullRange(const CullJob &job, size_t begin, size_t end) {
+#ifdef WEBGL_CULLING_SSE2
+  cullSSE2(job, begin, end);
+#else
+  cullScalar(job, begin, end);
+#endif
+}
+
+// Shared by CullSpheres and CullBoxes, floats is 4 or 6 per object.
+static void cull(const Nan::FunctionCallbackInfo<v8::Value> &info, int floats, const char *name) {
+  size_t planesLength = 0, boundsLength = 0, visibleLength = 0;
+  const float *planes = marshal::ArrayData<float>(info[0], &planesLength);
+  const float *bounds = marshal::ArrayData<float>(info[1], &boundsLength);
+  uint8_t *visible = marshal::ArrayData<uint8_t>(info[2], &visibleLength);
+  size_t count = boundsLength / (floats * sizeof(float));
+  if(!planes || planesLength < 24 * sizeof(float) || !visible || visibleLength < count) {
+    Nan::ThrowTypeError((string(name) + ": expected 24 plane floats and a visibility byte per object").c_str());
+    return;
+  }
+
+  size_t indicesLength = 0, lodLength = 0, lodParamsLength = 0;
+  uint32_t *indices = info[3]->IsNullOrUndefined() ? NULL : marshal::ArrayData<uint32_t>(info[3], &indicesLength);
+  uint8_t *lod = info[4]->IsNullOrUndefined() ? NULL : marshal::ArrayData<uint8_t>(info[4], &lodLength);
+  const float *lodParams = info[5]->IsNullOrUndefined() ? NULL : marshal::ArrayData<float>(info[5], &lodParamsLength);
+  int threads = info[6]->IsUndefined() ? 1 : Nan::To<int>(info[6]).FromJust();
+  if((indices && indicesLength < count * sizeof(uint32_t)) || (lod && (lodLength < count || !lodParams || lodParamsLength < 4 * sizeof(float)))) {
+    Nan::ThrowRangeError((string(name) + ": indices and lod need an entry per object, lod needs lodParams").c_str());
+    return;
+  }
+
+  CullJob job;
+  memcpy(job.planes, planes, sizeof(job.planes));
+  for(int p = 0; p < 6; p++) {
+    for(int k = 0; k < 3; k++)
+      job.absPlanes[p][k] = fabsf(job.planes[p][k]);
+  }
+  job.bounds = bounds;
+  job.boxes = floats == 6;
+  job.visible = visible;
+  job.lod = lod;
+  job.lodSizeCount = 0;
+  if(lod) {
+    memcpy(job.camera, lodParams, sizeof(job.camera));
+    job.projScale = lodParams[3];
+    job.lodSizeCount = (int) min<size_t>(lodParamsLength / sizeof(float) - 4, MAX_LOD_SIZES);
+    for(int i = 0; i < job.lodSizeCount; i++) {
+      float half = lodParams[4 + i] * 0.5f;
+      job.lodSizes[i] = half * half;
+    }
+  }
+
+  int chunks = (int) ((count + CULL_CHUNK - 1) / CULL_CHUNK);
+  if(threads == 1 || chunks <= 1) {
+    cullRange(job, 0, count);
+  } else {
+    PooledParallelFor(chunks, threads, [&](int chunk) {
+      size_t begin = (size_t) chunk * CULL_CHUNK;
+      cullRange(job, begin, min(count, begin + CULL_CHUNK));
+    });
+  }
+
+  uint32_t visibleCount = 0;
+  if(indices) {
+    for(size_t i = 0; i < count; i++) {
+      indices[visibleCount] = (uint32_t) i;
+      visibleCount += visible[i];
+    }
+  } else {
+    for(size_t i = 0; i < count; i++)
+      visibleCount += visible[i];
+  }
+  info.GetReturnValue().Set(visibleCount);
+}
+
+NAN_METHOD(CullSpheres) {
+  cull(info, 4, "cullSpheres");
+}
+
+NAN_METHOD(CullBoxes) {
+  cull(info, 6, "cullBoxes");
+}
+
+} // end namespace webgl
@@ -0,0 +1,25 @@
+/*
+ * culling.h
+ *
+ * Frustum culling and LOD selection over arrays of bounding volumes, so a
+ * scene of tens of thousands of objects is culled in one call instead of a
+ * JS loop. Spheres are packed as x, y, z, radius and boxes as min x, y, z,
+ * max x, y, z. Both write a visibility byte per object and, optionally, the
+ * compacted indices of the visible objects (ready to upload as per instance
+ * data for an indirect draw, or to walk when filling a render queue) and a
+ * LOD level per object from its projected size.
+ */
+
+#ifndef CULLING_H_
+#define CULLING_H_
+
+#include "common.h"
+
+namespace webgl {
+
+NAN_METHOD(CullSpheres);
+NAN_METHOD(CullBoxes);
+
+}
+
+#endif /* CULLING_H_ */
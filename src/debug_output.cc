@@ -0,0 +1,185 @@
+/*
+ * debug_output.cc
+ *
+ * gl.debugOutput(callback, synchronous)
+ *   callback(messages, dropped) on the event loop, messages being
+ *   [{source, type, id, severity, message}] and dropped the count lost to a
+ *   full ring since the last batch; null turns debug output off
+ * gl.debugMessageControl(source, type, severity, ids, enabled)
+ *   ids: Uint32Array or null
+ * gl.debugMessageInsert(source, type, id, severity, message)
+ * gl.pushDebugGroup(source, id, message)
+ * gl.popDebugGroup()
+ * gl.objectLabel(identifier, name, label)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "debug_output.h"
+#include "marshal.h"
+#include <GL/glew.h>
+#include <uv.h>
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+// slots in the ring, a power of two
+static const size_t DEBUG_RING_SIZE = 256;
+// longer messages are cut
+static const size_t DEBUG_MESSAGE_BYTES = 1024;
+
+struct DebugMessage {
+  // the ring position this slot is free for (pos) or holds a message of (pos + 1)
+  atomic<size_t> sequence;
+  GLenum source, type, severity;
+  GLuint id;
+  size_t length;
+  char text[DEBUG_MESSAGE_BYTES];
+};
+
+// Bounded multi producer queue (Vyukov): producers claim a position with a
+// CAS and publish the slot through its sequence, the event loop is the only
+// consumer.
+static DebugMessage ring[DEBUG_RING_SIZE];
+static atomic<size_t> enqueuePos(0);
+static size_t dequeuePos = 0;
+static atomic<size_t> dropped(0);
+
+static atomic<bool> delivering(false);
+static uv_async_t *async = NULL;
+static Nan::Callback *debugCallback = NULL;
+
+static void GLAPIENTRY onDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                      const GLchar *message, const void *) {
+  if(!delivering.load(memory_order_acquire))
+    return;
+  size_t pos = enqueuePos.load(memory_order_relaxed);
+  DebugMessage *slot;
+  for(;;) {
+    slot = &ring[pos & (DEBUG_RING_SIZE - 1)];
+    size_t sequence = slot->sequence.load(memory_order_acquire);
+    intptr_t difference = (intptr_t) sequence - (intptr_t) pos;
+    if(difference == 0) {
+      if(enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+        break;
+    } else if(difference < 0) {
+      // full: the event loop is behind
+      dropped.fetch_add(1, memory_order_relaxed);
+      return;
+    } else {
+      pos = enqueuePos.load(memory_order_relaxed);
+    }
+  }
+  slot->source = source;
+  slot->type = type;
+  slot->id = id;
+  slot->severity = severity;
+  size_t bytes = length >= 0 ? (size_t) length : strlen(message);
+  slot->length = min(bytes, DEBUG_MESSAGE_BYTES);
+  memcpy(slot->text, message, slot->length);
+  slot->sequence.store(pos + 1, memory_order_release);
+  // coalesced by libuv, one callback drains many messages
+  uv_async_send(async);
+}
+
+static void deliverMessages(uv_async_t *) {
+  Nan::HandleScope scope;
+  Local<Array> messages = Nan::New<Array>();
+  uint32_t count = 0;
+  for(;;) {
+    DebugMessage *slot = &ring[dequeuePos & (DEBUG_RING_SIZE - 1)];
+    if(slot->sequence.load(memory_order_acquire) != dequeuePos + 1)
+      break;
+    if(debugCallback) {
+      Local<Object> message = Nan::New<Object>();
+      Nan::Set(message, JS_STR("source"), JS_INT(slot->source));
+      Nan::Set(message, JS_STR("type"), JS_INT(slot->type));
+      Nan::Set(message, JS_STR("id"), Nan::New<Uint32>(slot->id));
+      Nan::Set(message, JS_STR("severity"), JS_INT(slot->severity));
+      Nan::Set(message, JS_STR("message"), JS_STR(slot->text, (int) slot->length));
+      Nan::Set(messages, count++, message);
+    }
+    slot->sequence.store(dequeuePos + DEBUG_RING_SIZE, memory_order_release);
+    dequeuePos++;
+  }
+  size_t lost = dropped.exchange(0, memory_order_relaxed);
+  if(!debugCallback || (!count && !lost))
+    return;
+  Local<Value> argv[] = { messages, JS_FLOAT((double) lost) };
+  Nan::AsyncResource resource("webgl:debugOutput");
+  debugCallback->Call(2, argv, &resource);
+}
+
+NAN_METHOD(DebugOutput) {
+  if(!async) {
+    for(size_t i = 0; i < DEBUG_RING_SIZE; i++)
+      ring[i].sequence.store(i, memory_order_relaxed);
+    async = new uv_async_t;
+    uv_async_init(Nan::GetCurrentEventLoop(), async, deliverMessages);
+    // pending messages don't keep the process alive
+    uv_unref((uv_handle_t *) async);
+  }
+  delete debugCallback;
+  debugCallback = NULL;
+
+  if(!info[0]->IsFunction()) {
+    delivering.store(false, memory_order_release);
+    glDebugMessageCallback(NULL, NULL);
+    glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDisable(GL_DEBUG_OUTPUT);
+    return;
+  }
+  debugCallback = new Nan::Callback(info[0].As<Function>());
+  delivering.store(true, memory_order_release);
+  if(Nan::To<bool>(info[1]).FromJust())
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  else
+    glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  glDebugMessageCallback(onDebugMessage, NULL);
+  glEnable(GL_DEBUG_OUTPUT);
+}
+
+NAN_METHOD(DebugMessageControl) {
+  GLenum source = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLenum type = marshal::Arg<GLenum>::Unbox(info[1]);
+  GLenum severity = marshal::Arg<GLenum>::Unbox(info[2]);
+  GLboolean enabled = Nan::To<bool>(info[4]).FromJust();
+  size_t byteLength = 0;
+  const GLuint *ids = NULL;
+  if(info[3]->IsUint32Array())
+    ids = marshal::ArrayData<GLuint>(info[3], &byteLength);
+  glDebugMessageControl(source, type, severity, (GLsizei) (byteLength / sizeof(GLuint)), ids, enabled);
+}
+
+NAN_METHOD(DebugMessageInsert) {
+  Nan::Utf8String message(info[4]);
+  glDebugMessageInsert(marshal::Arg<GLenum>::Unbox(info[0]), marshal::Arg<GLenum>::Unbox(info[1]),
+                       marshal::Arg<GLuint>::Unbox(info[2]), marshal::Arg<GLenum>::Unbox(info[3]),
+                       message.length(), *message);
+}
+
+NAN_METHOD(PushDebugGroup) {
+  Nan::Utf8String message(info[2]);
+  glPushDebugGroup(marshal::Arg<GLenum>::Unbox(info[0]), marshal::Arg<GLuint>::Unbox(info[1]), message.length(), *message);
+}
+
+NAN_METHOD(PopDebugGroup) {
+  glPopDebugGroup();
+}
+
+NAN_METHOD(ObjectLabel) {
+  Nan::Utf8String label(info[2]);
+  glObjectLabel(marshal::Arg<GLenum>::Unbox(info[0]), marshal::Arg<GLuint>::Unbox(info[1]), label.length(), *label);
+}
+
+void DebugOutputAtExit() {
+  if(delivering.exchange(false))
+    glDebugMessageCallback(NULL, NULL);
+}
+
+} // end namespace webgl
@@ -0,0 +1,32 @@
+/*
+ * debug_output.h
+ *
+ * KHR_debug: glDebugMessageCallback messages go into a fixed lock-free ring
+ * (drivers may call back from their own threads) and reach JS in batches
+ * from a uv_async handle on the event loop. Filtering is left to
+ * glDebugMessageControl, so unwanted messages never leave the driver. Debug
+ * groups and object labels name scopes and objects for captures and
+ * profilers. Nothing here is on a draw path: with debug output off the only
+ * cost is the driver's own.
+ */
+
+#ifndef DEBUG_OUTPUT_H_
+#define DEBUG_OUTPUT_H_
+
+#include "common.h"
+
+namespace webgl {
+
+NAN_METHOD(DebugOutput);
+NAN_METHOD(DebugMessageControl);
+NAN_METHOD(DebugMessageInsert);
+NAN_METHOD(PushDebugGroup);
+NAN_METHOD(PopDebugGroup);
+NAN_METHOD(ObjectLabel);
+
+// stops the driver calling back into the ring
+void DebugOutputAtExit();
+
+}
+
+#endif /* DEBUG_OUTPUT_H_ */
@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "gl_objects.h"
+#include "marshal.h"
+#include "texture_container.h"
+#include "webgl.h"
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+struct GLObj {
+  GLObjectType type;
+  GLuint obj;
+  uint32_t serial;
+  size_t bytes;
+};
+
+struct QueuedDelete {
+  GLObjectType type;
+  GLuint obj;
+  uint32_t serial;
+};
+
+static inline uint64_t objKey(GLObjectType type, GLuint obj) {
+  return ((uint64_t) type << 32) | obj;
+}
+
+static unordered_map<uint64_t, GLObj> globjs;
+static vector<QueuedDelete> deleteQueue;
+static uint32_t serialCounter = 0;
+static bool atExit = false;
+
+// running totals, so stats and budget checks don't walk the registry
+static size_t typeBytes[GLOBJECT_TYPE_COUNT];
+static size_t typeCount[GLOBJECT_TYPE_COUNT];
+static size_t totalBytes = 0;
+
+// 0: no budget. overBudget is set when the total crosses the budget and
+// cleared once it drops back under it, so the callback fires once per
+// crossing rather than on every allocation past it.
+static size_t memoryBudget = 0;
+static bool overBudget = false;
+static Nan::Callback *budgetCallback = NULL;
+
+static void adjustExternalMemory(int64_t delta) {
+  // AtExit runs after the isolate is gone
+  Isolate *isolate = Isolate::GetCurrent();
+  if(delta && isolate && !atExit)
+    isolate->AdjustAmountOfExternalAllocatedMemory(delta);
+}
+
+static void checkBudget(GLObjectType type, GLuint obj) {
+  if(!memoryBudget || atExit)
+    return;
+  if(totalBytes <= memoryBudget) {
+    overBudget = false;
+    return;
+  }
+  if(overBudget)
+    return;
+  overBudget = true;
+  if(budgetCallback) {
+    // the JS side defers the user's callback, so it can't reenter the
+    // binding that caused the allocation
+    Nan::HandleScope scope;
+    Local<Value> argv[] = {
+      JS_FLOAT((double) totalBytes),
+      JS_FLOAT((double) memoryBudget),
+      Nan::New<Int32>(type),
+      Nan::New<Uint32>(obj)
+    };
+    Nan::AsyncResource resource("webgl:memoryBudget");
+    budgetCallback->Call(4, argv, &resource);
+  }
+}
+
+// adds delta to obj's size, its type's and the total
+static void accountBytes(GLObjectType type, int64_t delta) {
+  typeBytes[type] += delta;
+  totalBytes += delta;
+  adjustExternalMemory(delta);
+}
+
+void registerGLObj(GLObjectType type, GLuint obj) {
+  if(!obj)
+    return;
+  auto inserted = globjs.emplace(objKey(type, obj), GLObj());
+  GLObj &globj = inserted.first->second;
+  // a stale entry (an object deleted behind the bindings' back) is replaced
+  if(inserted.second)
+    typeCount[type]++;
+  else
+    accountBytes(type, -(int64_t) globj.bytes);
+  globj.type = type;
+  globj.obj = obj;
+  globj.serial = ++serialCounter;
+  globj.bytes = 0;
+}
+
+void unregisterGLObj(GLObjectType type, GLuint obj) {
+  if(atExit)
+    return;
+  auto it = globjs.find(objKey(type, obj));
+  if(it == globjs.end())
+    return;
+  accountBytes(type, -(int64_t) it->second.bytes);
+  typeCount[type]--;
+  globjs.erase(it);
+  checkBudget(type, obj);
+}
+
+void setGLObjBytes(GLObjectType type, GLuint obj, size_t bytes) {
+  auto it = globjs.find(objKey(type, obj));
+  if(it == globjs.end())
+    return;
+  accountBytes(type, (int64_t) bytes - (int64_t) it->second.bytes);
+  it->second.bytes = bytes;
+  checkBudget(type, obj);
+}
+
+size_t getGLObjBytes(GLObjectType type, GLuint obj) {
+  auto it = globjs.find(objKey(type, obj));
+  return it == globjs.end() ? 0 : it->second.bytes;
+}
+
+/*
+ * Bound names
+ */
+
+GLuint boundBuffer(GLenum target) {
+  GLenum binding;
+  switch(target) {
+  case GL_ARRAY_BUFFER: binding = GL_ARRAY_BUFFER_BINDING; break;
+  case GL_ELEMENT_ARRAY_BUFFER: binding = GL_ELEMENT_ARRAY_BUFFER_BINDING; break;
+  case GL_UNIFORM_BUFFER: binding = GL_UNIFORM_BUFFER_BINDING; break;
+  case GL_SHADER_STORAGE_BUFFER: binding = GL_SHADER_STORAGE_BUFFER_BINDING; break;
+  case GL_PIXEL_PACK_BUFFER: binding = GL_PIXEL_PACK_BUFFER_BINDING; break;
+  case GL_PIXEL_UNPACK_BUFFER: binding = GL_PIXEL_UNPACK_BUFFER_BINDING; break;
+  case GL_COPY_READ_BUFFER: binding = GL_COPY_READ_BUFFER_BINDING; break;
+  case GL_COPY_WRITE_BUFFER: binding = GL_COPY_WRITE_BUFFER_BINDING; break;
+  case GL_TRANSFORM_FEEDBACK_BUFFER: binding = GL_TRANSFORM_FEEDBACK_BUFFER_BINDING; break;
+  case GL_DRAW_INDIRECT_BUFFER: binding = GL_DRAW_INDIRECT_BUFFER_BINDING; break;
+  case GL_DISPATCH_INDIRECT_BUFFER: binding = GL_DISPATCH_INDIRECT_BUFFER_BINDING; break;
+  case GL_ATOMIC_COUNTER_BUFFER: binding = GL_ATOMIC_COUNTER_BUFFER_BINDING; break;
+  case GL_TEXTURE_BUFFER: binding = GL_TEXTURE_BUFFER_BINDING; break;
+  case GL_QUERY_BUFFER: binding = GL_QUERY_BUFFER_BINDING; break;
+  default: return 0;
+  }
+  GLint name = 0;
+  glGetIntegerv(binding, &name);
+  return name;
+}
+
+GLuint boundTexture(GLenum target) {
+  GLenum binding;
+  switch(target) {
+  case GL_TEXTURE_1D: binding = GL_TEXTURE_BINDING_1D; break;
+  case GL_TEXTURE_2D: binding = GL_TEXTURE_BINDING_2D; break;
+  case GL_TEXTURE_3D: binding = GL_TEXTURE_BINDING_3D; break;
+  case GL_TEXTURE_1D_ARRAY: binding = GL_TEXTURE_BINDING_1D_ARRAY; break;
+  case GL_TEXTURE_2D_ARRAY: binding = GL_TEXTURE_BINDING_2D_ARRAY; break;
+  case GL_TEXTURE_RECTANGLE: binding = GL_TEXTURE_BINDING_RECTANGLE; break;
+  case GL_TEXTURE_2D_MULTISAMPLE: binding = GL_TEXTURE_BINDING_2D_MULTISAMPLE; break;
+  case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: binding = GL_TEXTURE_BINDING_2D_MULTISAMPLE_ARRAY; break;
+  case GL_TEXTURE_CUBE_MAP_ARRAY: binding = GL_TEXTURE_BINDING_CUBE_MAP_ARRAY; break;
+  case GL_TEXTURE_CUBE_MAP:
+  case GL_TEXTURE_CUBE_MAP_POSITIVE_X:
+  case GL_TEXTURE_CUBE_MAP_NEGATIVE_X:
+  case GL_TEXTURE_CUBE_MAP_POSITIVE_Y:
+  case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y:
+  case GL_TEXTURE_CUBE_MAP_POSITIVE_Z:
+  case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z: binding = GL_TEXTURE_BINDING_CUBE_MAP; break;
+  default: return 0;
+  }
+  GLint name = 0;
+  glGetIntegerv(binding, &name);
+  return name;
+}
+
+GLuint boundRenderbuffer() {
+  GLint name = 0;
+  glGetIntegerv(GL_RENDERBUFFER_BINDING, &name);
+  return name;
+}
+
+/*
+ * Size estimates. Drivers pad and may store 3 component formats as 4, which
+ * is what the estimate assumes too.
+ */
+
+size_t TexelBytes(GLenum internalFormat) {
+  switch(internalFormat) {
+  case GL_R8: case GL_R8_SNORM: case GL_R8I: case GL_R8UI: case GL_RED:
+  case GL_STENCIL_INDEX8:
+    return 1;
+  case GL_RG8: case GL_RG8_SNORM: case GL_RG8I: case GL_RG8UI: case GL_RG:
+  case GL_R16: case GL_R16_SNORM: case GL_R16F: case GL_R16I: case GL_R16UI:
+  case GL_RGB565: case GL_RGB5_A1: case GL_RGBA4:
+  case GL_DEPTH_COMPONENT16:
+    return 2;
+  case GL_RGB16: case GL_RGB16_SNORM: case GL_RGB16F: case GL_RGB16I: case GL_RGB16UI:
+  case GL_RGBA16: case GL_RGBA16_SNORM: case GL_RGBA16F: case GL_RGBA16I: case GL_RGBA16UI:
+  case GL_RG32F: case GL_RG32I: case GL_RG32UI:
+  case GL_DEPTH32F_STENCIL8:
+    return 8;
+  case GL_RGB32F: case GL_RGB32I: case GL_RGB32UI:
+  case GL_RGBA32F: case GL_RGBA32I: case GL_RGBA32UI:
+    return 16;
+  default:
+    // RGBA8 and friends, RGB10_A2, R11F_G11F_B10F, RGB9_E5, RG16*, R32*,
+    // 24/32 bit depth (+ stencil) and the unsized RGB/RGBA
+    return 4;
+  }
+}
+
+static size_t levelBytes(GLenum internalFormat, int width, int height) {
+  size_t compressed = CompressedLevelSize(internalFormat, width, height);
+  if(compressed)
+    return compressed;
+  return (size_t) width * height * TexelBytes(internalFormat);
+}
+
+size_t TextureStorageBytes(GLenum target, GLenum internalFormat, int width, int height, int depth, int levels) {
+  size_t layers = depth > 0 ? depth : 1;
+  if(target == GL_TEXTURE_CUBE_MAP)
+    layers = 6;
+  else if(target == GL_TEXTURE_1D_ARRAY) {
+    layers = height > 0 ? height : 1;
+    height = 1;
+  }
+
+  size_t total = 0;
+  for(int level = 0; level < levels; level++) {
+    total += levelBytes(internalFormat, width, height) * layers;
+    width = width > 1 ? width >> 1 : 1;
+    if(target != GL_TEXTURE_1D && target != GL_TEXTURE_1D_ARRAY)
+      height = height > 1 ? height >> 1 : 1;
+    if(target == GL_TEXTURE_3D)
+      layers = layers > 1 ? layers >> 1 : 1;
+  }
+  return total;
+}
+
+/*
+ * Reclamation
+ */
+
+static void deleteGLObj(GLObjectType type, GLuint obj) {
+  switch(type) {
+  case GLOBJECT_TYPE_BUFFER: glDeleteBuffers(1, &obj); break;
+  case GLOBJECT_TYPE_FRAMEBUFFER: glDeleteFramebuffers(1, &obj); break;
+  case GLOBJECT_TYPE_PROGRAM: glDeleteProgram(obj); break;
+  case GLOBJECT_TYPE_RENDERBUFFER: glDeleteRenderbuffers(1, &obj); break;
+  case GLOBJECT_TYPE_SHADER: glDeleteShader(obj); break;
+  case GLOBJECT_TYPE_TEXTURE: glDeleteTextures(1, &obj); break;
+  case GLOBJECT_TYPE_SAMPLER: glDeleteSamplers(1, &obj); break;
+  case GLOBJECT_TYPE_TRANSFORM_FEEDBACK: glDeleteTransformFeedbacks(1, &obj); break;
+  case GLOBJECT_TYPE_VERTEX_ARRAY: glDeleteVertexArrays(1, &obj); break;
+  default: break;
+  }
+}
+
+static void deleteGLObjs(GLObjectType type, const vector<GLuint> &objs) {
+  GLsizei n = (GLsizei) objs.size();
+  if(!n)
+    return;
+  switch(type) {
+  case GLOBJECT_TYPE_BUFFER: glDeleteBuffers(n, &objs[0]); break;
+  case GLOBJECT_TYPE_FRAMEBUFFER: glDeleteFramebuffers(n, &objs[0]); break;
+  case GLOBJECT_TYPE_RENDERBUFFER: glDeleteRenderbuffers(n, &objs[0]); break;
+  case GLOBJECT_TYPE_TEXTURE: glDeleteTextures(n, &objs[0]); break;
+  case GLOBJECT_TYPE_SAMPLER: glDeleteSamplers(n, &objs[0]); break;
+  case GLOBJECT_TYPE_TRANSFORM_FEEDBACK: glDeleteTransformFeedbacks(n, &objs[0]); break;
+  case GLOBJECT_TYPE_VERTEX_ARRAY: glDeleteVertexArrays(n, &objs[0]); break;
+  default:
+    for(GLuint obj : objs)
+      deleteGLObj(type, obj);
+    break;
+  }
+}
+
+uint32_t GLObjSerial(GLObjectType type, GLuint obj) {
+  auto it = globjs.find(objKey(type, obj));
+  return it == globjs.end() ? 0 : it->second.serial;
+}
+
+// gl.glObjectSerial(type, name): the serial of name's current registration,
+// 0 if it isn't registered
+NAN_METHOD(GLObjectSerial) {
+  GLObjectType type = (GLObjectType) Nan::To<int>(info[0]).FromJust();
+  GLuint obj = Nan::To<uint32_t>(info[1]).FromJust();
+  info.GetReturnValue().Set(GLObjSerial(type, obj));
+}
+
+// gl.queueObjectDelete(type, name, serial), from the FinalizationRegistry
+// callback: no GL calls here
+NAN_METHOD(QueueObjectDelete) {
+  QueuedDelete d;
+  d.type = (GLObjectType) Nan::To<int>(info[0]).FromJust();
+  d.obj = Nan::To<uint32_t>(info[1]).FromJust();
+  d.serial = Nan::To<uint32_t>(info[2]).FromJust();
+  if(d.type >= 0 && d.type < GLOBJECT_TYPE_COUNT && d.obj)
+    deleteQueue.push_back(d);
+}
+
+// gl.processObjectDeletes(): deletes the queued objects, batched per type.
+// Must run on the GL thread. Returns the number of objects deleted.
+NAN_METHOD(ProcessObjectDeletes) {
+  vector<GLuint> batches[GLOBJECT_TYPE_COUNT];
+  int deleted = 0;
+
+  for(const QueuedDelete &d : deleteQueue) {
+    auto it = globjs.find(objKey(d.type, d.obj));
+    // explicitly deleted, or deleted and the name reused, since it was queued
+    if(it == globjs.end() || it->second.serial != d.serial)
+      continue;
+    accountBytes(d.type, -(int64_t) it->second.bytes);
+    typeCount[d.type]--;
+    batches[d.type].push_back(d.obj);
+    globjs.erase(it);
+    deleted++;
+  }
+  deleteQueue.clear();
+
+  for(int type = 0; type < GLOBJECT_TYPE_COUNT; type++)
+    deleteGLObjs((GLObjectType) type, batches[type]);
+  if(deleted)
+    checkBudget(GLOBJECT_TYPE_COUNT, 0);
+
+  info.GetReturnValue().Set(deleted);
+}
+
+/*
+ * Accounting
+ */
+
+// gl.getObjectBytes(type, name): the estimated size of one object
+NAN_METHOD(GetObjectBytes) {
+  GLObjectType type = (GLObjectType) marshal::Arg<int>::Unbox(info[0]);
+  GLuint obj = marshal::Arg<GLuint>::Unbox(info[1]);
+  info.GetReturnValue().Set((double) getGLObjBytes(type, obj));
+}
+
+// gl.getMemoryStats(topN): {totalBytes, objectCount, budget, types: [{count,
+// bytes}] indexed by GLObjectType, top: [{type, name, bytes}] largest first}
+NAN_METHOD(GetMemoryStats) {
+  int topN = info[0]->IsUndefined() ? 10 : marshal::Arg<int>::Unbox(info[0]);
+  if(topN < 0)
+    topN = 0;
+
+  Local<Object> stats = Nan::New<Object>();
+  Nan::Set(stats, JS_STR("totalBytes"), JS_FLOAT((double) totalBytes));
+  Nan::Set(stats, JS_STR("objectCount"), JS_FLOAT((double) globjs.size()));
+  Nan::Set(stats, JS_STR("budget"), JS_FLOAT((double) memoryBudget));
+
+  Local<Array> types = Nan::New<Array>(GLOBJECT_TYPE_COUNT);
+  for(int type = 0; type < GLOBJECT_TYPE_COUNT; type++) {
+    Local<Object> entry = Nan::New<Object>();
+    Nan::Set(entry, JS_STR("count"), JS_FLOAT((double) typeCount[type]));
+    Nan::Set(entry, JS_STR("bytes"), JS_FLOAT((double) typeBytes[type]));
+    Nan::Set(types, type, entry);
+  }
+  Nan::Set(stats, JS_STR("types"), types);
+
+  // partial sort of pointers: O(n log topN), no copies of the registry
+  vector<const GLObj *> largest;
+  largest.reserve(globjs.size());
+  for(auto &entry : globjs)
+    if(entry.second.bytes)
+      largest.push_back(&entry.second);
+  size_t n = min(largest.size(), (size_t) topN);
+  partial_sort(largest.begin(), largest.begin() + n, largest.end(),
+               [](const GLObj *a, const GLObj *b) { return a->bytes > b->bytes; });
+
+  Local<Array> top = Nan::New<Array>(n);
+  for(size_t i = 0; i < n; i++) {
+    Local<Object> entry = Nan::New<Object>();
+    Nan::Set(entry, JS_STR("type"), JS_INT(largest[i]->type));
+    Nan::Set(entry, JS_STR("name"), Nan::New<Uint32>(largest[i]->obj));
+    Nan::Set(entry, JS_STR("bytes"), JS_FLOAT((double) largest[i]->bytes));
+    Nan::Set(top, i, entry);
+  }
+  Nan::Set(stats, JS_STR("top"), top);
+
+  info.GetReturnValue().Set(stats);
+}
+
+// gl.setMemoryBudget(bytes, callback(totalBytes, budget, type, name)): 0
+// removes the budget
+NAN_METHOD(SetMemoryBudget) {
+  memoryBudget = (size_t) marshal::Arg<double>::Unbox(info[0]);
+  overBudget = false;
+  delete budgetCallback;
+  budgetCallback = info[1]->IsFunction() ? new Nan::Callback(info[1].As<Function>()) : NULL;
+  checkBudget(GLOBJECT_TYPE_COUNT, 0);
+}
+
+void AtExit() {
+  atExit=true;
+  //glFinish();
+
+  #ifdef LOGGING
+  cout<<"WebGL AtExit() called"<<endl;
+  cout<<"  # objects allocated: "<<globjs.size()<<endl;
+  #endif
+
+  for(auto &entry : globjs) {
+    #ifdef LOGGING
+    cout<<"  Destroying GL object "<<entry.second.obj<<" (type "<<entry.second.type<<")"<<endl;
+    #endif
+    deleteGLObj(entry.second.type, entry.second.obj);
+  }
+
+  globjs.clear();
+  deleteQueue.clear();
+  delete budgetCallback;
+  budgetCallback = NULL;
+}
+
+} // end namespace webgl
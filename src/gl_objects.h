@@ -0,0 +1,86 @@
+/*
+ * gl_objects.h
+ *
+ * Registry of the GL objects created through the bindings. It is what
+ * AtExit deletes, what lets lib/webgl.js reclaim objects whose wrappers were
+ * garbage collected, and where the estimated GPU memory of every object is
+ * kept. That estimate is reported to V8 as external memory, so GC pressure
+ * reflects the GL resources a few small JS wrappers can hold on to.
+ *
+ * Reclamation: lib/webgl.js registers every wrapper returned by a create*
+ * call with a FinalizationRegistry. Finalized wrappers only queue their
+ * object (queueObjectDelete). The glDelete* calls are batched by
+ * processObjectDeletes on the GL thread. Each registration has a serial
+ * number, so a queued delete for a name that was explicitly deleted (and
+ * possibly reused) since is dropped.
+ *
+ * Accounting: the registry keeps running byte and object totals per type,
+ * reported by gl.getMemoryStats(). An optional budget calls back (once per
+ * crossing) when the total estimate exceeds it.
+ */
+
+#ifndef GL_OBJECTS_H_
+#define GL_OBJECTS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common.h"
+#include <GL/glew.h>
+
+namespace webgl {
+
+// must match objectTypes in lib/webgl.js
+enum GLObjectType {
+  GLOBJECT_TYPE_BUFFER,
+  GLOBJECT_TYPE_FRAMEBUFFER,
+  GLOBJECT_TYPE_PROGRAM,
+  GLOBJECT_TYPE_RENDERBUFFER,
+  GLOBJECT_TYPE_SHADER,
+  GLOBJECT_TYPE_TEXTURE,
+  GLOBJECT_TYPE_SAMPLER,
+  GLOBJECT_TYPE_TRANSFORM_FEEDBACK,
+  GLOBJECT_TYPE_VERTEX_ARRAY,
+  GLOBJECT_TYPE_COUNT
+};
+
+void registerGLObj(GLObjectType type, GLuint obj);
+
+// For explicit deletes: forgets obj and releases its external memory. The
+// caller issues the glDelete*.
+void unregisterGLObj(GLObjectType type, GLuint obj);
+
+// Sets the estimated GPU memory held by obj (replacing the previous estimate)
+// and adjusts V8's external memory by the difference. Unregistered objects
+// (0, or names the bindings did not create) are ignored.
+void setGLObjBytes(GLObjectType type, GLuint obj, size_t bytes);
+size_t getGLObjBytes(GLObjectType type, GLuint obj);
+
+// The serial of obj's current registration, 0 if it isn't registered. A name
+// kept across calls is still the same object while its serial is unchanged.
+uint32_t GLObjSerial(GLObjectType type, GLuint obj);
+
+// Names bound to a target, for the entry points that allocate storage
+// through a binding rather than a name.
+GLuint boundBuffer(GLenum target);
+GLuint boundTexture(GLenum target);
+GLuint boundRenderbuffer();
+
+// Estimated bytes of levels mip levels of a texture of the given target.
+// depth is the layer count of array targets and halves per level for
+// GL_TEXTURE_3D; cube maps count all six faces.
+size_t TextureStorageBytes(GLenum target, GLenum internalFormat, int width, int height, int depth, int levels);
+
+// Bytes of a (possibly unsized) renderbuffer or texture format's texel.
+size_t TexelBytes(GLenum internalFormat);
+
+NAN_METHOD(GLObjectSerial);
+NAN_METHOD(QueueObjectDelete);
+NAN_METHOD(ProcessObjectDeletes);
+NAN_METHOD(GetObjectBytes);
+NAN_METHOD(GetMemoryStats);
+NAN_METHOD(SetMemoryBudget);
+
+}
+
+#endif /* GL_OBJECTS_H_ */
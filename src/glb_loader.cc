@@ -0,0 +1,224 @@
+/*
+ * glb_loader.cc
+ *
+ * gl.loadGlb(path, callback)
+ *   callback(err, {json, binary, buffers}): json is the parsed JSON chunk,
+ *   binary a Buffer over the mapped binary chunk (null without one) and
+ *   buffers the buffer name per bufferView, 0 for the views of images and
+ *   of buffers outside the file
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "glb_loader.h"
+#include "gl_objects.h"
+#include "mapped_file.h"
+#include <GL/glew.h>
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+static const uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+static const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+static const uint32_t GLB_CHUNK_BIN = 0x004E4942;  // "BIN\0"
+
+struct GlbLoad {
+  string path;
+  MappedFile *file;
+  size_t jsonOffset, jsonLength;
+  size_t binOffset, binLength;
+  bool hasBin;
+
+  GlbLoad() : file(NULL), jsonOffset(0), jsonLength(0), binOffset(0), binLength(0), hasBin(false) {}
+  ~GlbLoad() {
+    delete file;
+  }
+};
+
+static inline uint32_t readU32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static void unmapGlbBuffer(char *, void *hint) {
+  delete static_cast<MappedFile*>(hint);
+}
+
+// a non-negative integer member of o, or fallback
+static double member(Local<Value> o, const char *key, double fallback) {
+  if(!o->IsObject())
+    return fallback;
+  Local<Value> value = Nan::Get(o.As<Object>(), JS_STR(key)).ToLocalChecked();
+  if(!value->IsNumber())
+    return fallback;
+  double number = Nan::To<double>(value).FromJust();
+  return number >= 0 ? number : fallback;
+}
+
+static Local<Array> arrayMember(Local<Value> o, const char *key) {
+  if(o->IsObject()) {
+    Local<Value> value = Nan::Get(o.As<Object>(), JS_STR(key)).ToLocalChecked();
+    if(value->IsArray())
+      return value.As<Array>();
+  }
+  return Nan::New<Array>();
+}
+
+class GlbLoadWorker : public Nan::AsyncWorker {
+public:
+  GlbLoadWorker(Nan::Callback *callback, GlbLoad *load)
+    : Nan::AsyncWorker(callback, "webgl:loadGlb"), load(load) {}
+
+  ~GlbLoadWorker() {
+    delete load;
+  }
+
+  // Finds the chunks and pages the binary one in, so the uploads on the GL
+  // thread don't wait on the disk.
+  void Execute() {
+    // copy on write: the binary chunk ends up in a Buffer
+    load->file = new MappedFile();
+    if(!load->file->Open(load->path.c_str(), 0, 0, true)) {
+      SetErrorMessage(("loadGlb: cannot open " + load->path).c_str());
+      return;
+    }
+    const uint8_t *data = load->file->Data();
+    size_t size = load->file->Size();
+    if(size < 20 || readU32(data) != GLB_MAGIC || readU32(data + 4) != 2 || readU32(data + 8) > size) {
+      SetErrorMessage(("loadGlb: " + load->path + " is not a glTF 2.0 binary").c_str());
+      return;
+    }
+    size = readU32(data + 8);
+    size_t offset = 12;
+    while(offset + 8 <= size) {
+      size_t length = readU32(data + offset);
+      uint32_t type = readU32(data + offset + 4);
+      offset += 8;
+      if(length > size - offset)
+        break;
+      if(type == GLB_CHUNK_JSON && !load->jsonLength) {
+        load->jsonOffset = offset;
+        load->jsonLength = length;
+      } else if(type == GLB_CHUNK_BIN && !load->hasBin) {
+        load->binOffset = offset;
+        load->binLength = length;
+        load->hasBin = true;
+      }
+      // chunks are 4 byte aligned
+      offset += (length + 3) & ~(size_t) 3;
+    }
+    if(!load->jsonLength) {
+      SetErrorMessage(("loadGlb: " + load->path + " has no JSON chunk").c_str());
+      return;
+    }
+    if(load->binLength) {
+      load->file->Advise(MappedFile::ADVICE_WILLNEED, load->binOffset, load->binLength);
+      load->file->Prefetch(load->binOffset, load->binLength);
+    }
+  }
+
+  void HandleOKCallback() {
+    Nan::HandleScope scope;
+    const char *text = (const char *) load->file->Data() + load->jsonOffset;
+    Local<Value> json;
+    {
+      Nan::TryCatch tryCatch;
+      MaybeLocal<Value> parsed = JSON::Parse(Nan::GetCurrentContext(), JS_STR(text, (int) load->jsonLength));
+      if(parsed.IsEmpty() || !parsed.ToLocalChecked()->IsObject()) {
+        Fail("loadGlb: " + load->path + " has malformed JSON");
+        return;
+      }
+      json = parsed.ToLocalChecked();
+    }
+
+    // only the first buffer can be the binary chunk, and only without a uri
+    Local<Array> buffers = arrayMember(json, "buffers");
+    bool binary = load->hasBin && buffers->Length() > 0;
+    if(binary) {
+      Local<Value> first = Nan::Get(buffers, 0).ToLocalChecked();
+      binary = first->IsObject() && !Nan::Has(first.As<Object>(), JS_STR("uri")).FromJust();
+    }
+
+    Local<Array> views = arrayMember(json, "bufferViews");
+    uint32_t viewCount = views->Length();
+    vector<uint8_t> upload(viewCount, 0);
+    vector<size_t> offsets(viewCount), lengths(viewCount);
+    for(uint32_t i = 0; i < viewCount; i++) {
+      Local<Value> view = Nan::Get(views, i).ToLocalChecked();
+      if(!binary || member(view, "buffer", -1) != 0)
+        continue;
+      double offset = member(view, "byteOffset", 0), length = member(view, "byteLength", 0);
+      if(offset + length > load->binLength) {
+        Fail("loadGlb: bufferView " + to_string(i) + " is outside the binary chunk");
+        return;
+      }
+      offsets[i] = (size_t) offset;
+      lengths[i] = (size_t) length;
+      upload[i] = length > 0;
+    }
+    // images are decoded from the mapping, not uploaded
+    Local<Array> images = arrayMember(json, "images");
+    for(uint32_t i = 0; i < images->Length(); i++) {
+      double view = member(Nan::Get(images, i).ToLocalChecked(), "bufferView", -1);
+      if(view >= 0 && view < viewCount)
+        upload[(size_t) view] = 0;
+    }
+
+    vector<GLuint> names(viewCount, 0);
+    const uint8_t *bin = load->file->Data() + load->binOffset;
+    for(uint32_t i = 0; i < viewCount; i++) {
+      if(!upload[i])
+        continue;
+      glCreateBuffers(1, &names[i]);
+      glNamedBufferStorage(names[i], lengths[i], bin + offsets[i], 0);
+      registerGLObj(GLOBJECT_TYPE_BUFFER, names[i]);
+      setGLObjBytes(GLOBJECT_TYPE_BUFFER, names[i], lengths[i]);
+    }
+    Local<Array> bufferNames = Nan::New<Array>(viewCount);
+    for(uint32_t i = 0; i < viewCount; i++)
+      Nan::Set(bufferNames, i, JS_INT(names[i]));
+
+    Local<Object> result = Nan::New<Object>();
+    Nan::Set(result, JS_STR("json"), json);
+    if(load->binLength) {
+      // the Buffer takes over the mapping
+      Nan::Set(result, JS_STR("binary"), Nan::NewBuffer((char *) load->file->Data() + load->binOffset, load->binLength,
+                                                         unmapGlbBuffer, load->file).ToLocalChecked());
+      load->file = NULL;
+    } else {
+      Nan::Set(result, JS_STR("binary"), Nan::Null());
+    }
+    Nan::Set(result, JS_STR("buffers"), bufferNames);
+    Local<Value> argv[] = { Nan::Null(), result };
+    callback->Call(2, argv, async_resource);
+  }
+
+private:
+  void Fail(const string &message) {
+    Local<Value> argv[] = { Nan::Error(message.c_str()) };
+    callback->Call(1, argv, async_resource);
+  }
+
+  GlbLoad *load;
+};
+
+NAN_METHOD(LoadGlb) {
+  if(info.Length() < 2 || !info[0]->IsString() || !info[1]->IsFunction()) {
+    Nan::ThrowTypeError("Expected loadGlb(path, callback)");
+    return;
+  }
+  Nan::Utf8String path(info[0]);
+  GlbLoad *load = new GlbLoad();
+  load->path = *path;
+
+  Nan::Callback *callback = new Nan::Callback(info[1].As<Function>());
+  Nan::AsyncQueueWorker(new GlbLoadWorker(callback, load));
+}
+
+} // end namespace webgl
@@ -0,0 +1,24 @@
+/*
+ * glb_loader.h
+ *
+ * Binary glTF 2.0 (GLB) loading. The file is memory mapped and its binary
+ * chunk paged in on a worker thread; the JSON chunk is parsed by V8 and every
+ * bufferView holding vertex or index data is uploaded once into an immutable
+ * buffer straight from the mapping. The binary chunk is handed to JS over the
+ * same mapping for the embedded images, which go through the asynchronous
+ * texture path. lib/webgl.js builds the vertex layouts, textures and the
+ * scene description.
+ */
+
+#ifndef GLB_LOADER_H_
+#define GLB_LOADER_H_
+
+#include "common.h"
+
+namespace webgl {
+
+NAN_METHOD(LoadGlb);
+
+}
+
+#endif /* GLB_LOADER_H_ */
@@ -0,0 +1,106 @@
+/*
+ * headless_context.cc
+ *
+ * gl.createHeadlessContext(major, minor, width, height)
+ *   makes a core profile context current on this thread, with a width x
+ *   height pbuffer where surfaceless contexts aren't supported, and loads
+ *   the GL entry points; returns the GL_VERSION string. Throws when no
+ *   context can be created.
+ */
+
+#include <cstring>
+#include <string>
+
+#include "headless_context.h"
+#include <GL/glew.h>
+
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+#ifdef __linux__
+
+static EGLDisplay headlessDisplay() {
+  // surfaceless first: it needs neither X nor a GPU device
+  PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+    (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+  const char *extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if(getPlatformDisplay && extensions && strstr(extensions, "EGL_MESA_platform_surfaceless")) {
+    EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if(display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL))
+      return display;
+  }
+  EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if(display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL))
+    return display;
+  return EGL_NO_DISPLAY;
+}
+
+NAN_METHOD(CreateHeadlessContext) {
+  EGLint major = info[0]->IsUndefined() ? 4 : Nan::To<int32_t>(info[0]).FromJust();
+  EGLint minor = info[1]->IsUndefined() ? 6 : Nan::To<int32_t>(info[1]).FromJust();
+  EGLint width = info[2]->IsUndefined() ? 1 : Nan::To<int32_t>(info[2]).FromJust();
+  EGLint height = info[3]->IsUndefined() ? 1 : Nan::To<int32_t>(info[3]).FromJust();
+
+  EGLDisplay display = headlessDisplay();
+  if(display == EGL_NO_DISPLAY || !eglBindAPI(EGL_OPENGL_API)) {
+    Nan::ThrowError("createHeadlessContext: no EGL display with desktop OpenGL");
+    return;
+  }
+  const EGLint configAttribs[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+    EGL_DEPTH_SIZE, 24, EGL_STENCIL_SIZE, 8,
+    EGL_NONE
+  };
+  EGLConfig config;
+  EGLint configCount = 0;
+  if(!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount < 1) {
+    Nan::ThrowError("createHeadlessContext: no RGBA8 depth24 stencil8 pbuffer config");
+    return;
+  }
+  const EGLint contextAttribs[] = {
+    EGL_CONTEXT_MAJOR_VERSION, major,
+    EGL_CONTEXT_MINOR_VERSION, minor,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+    EGL_NONE
+  };
+  EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+  if(context == EGL_NO_CONTEXT) {
+    Nan::ThrowError(("createHeadlessContext: no OpenGL " + to_string(major) + "." + to_string(minor) + " core context").c_str());
+    return;
+  }
+  if(!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    const EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+    if(surface == EGL_NO_SURFACE || !eglMakeCurrent(display, surface, surface, context)) {
+      Nan::ThrowError("createHeadlessContext: cannot make the context current");
+      return;
+    }
+  }
+  // glewInit also wants a GLX display, the entry points only need a context
+  glewExperimental = GL_TRUE;
+  if(glewContextInit() != GLEW_OK) {
+    Nan::ThrowError("createHeadlessContext: cannot load the OpenGL entry points");
+    return;
+  }
+  info.GetReturnValue().Set(JS_STR((const char *) glGetString(GL_VERSION)));
+}
+
+#else
+
+NAN_METHOD(CreateHeadlessContext) {
+  Nan::ThrowError("createHeadlessContext: only supported on Linux (EGL)");
+}
+
+#endif
+
+} // end namespace webgl
@@ -0,0 +1,20 @@
+/*
+ * headless_context.h
+ *
+ * An OpenGL core context without a window, through EGL (surfaceless on
+ * Mesa, so llvmpipe works without a display), for tools/replay.js and
+ * other offscreen work. Linux only.
+ */
+
+#ifndef HEADLESS_CONTEXT_H_
+#define HEADLESS_CONTEXT_H_
+
+#include "common.h"
+
+namespace webgl {
+
+NAN_METHOD(CreateHeadlessContext);
+
+}
+
+#endif /* HEADLESS_CONTEXT_H_ */
@@ -1,5 +1,7 @@
 #include "image.h"
+#include "mapped_file.h"
 #include <cstdlib>
+#include <memory>
 #include <vector>
 #include <iostream>
 
@@ -38,6 +40,9 @@ void Image::Initialize (Local<Object> target) {
 
   // prototype
   Nan::SetPrototypeMethod(ctor, "save",save);// NODE_SET_PROTOTYPE_METHOD(ctor, "save", save);
+  Nan::SetMethod(ctor, "fromBuffer", FromBuffer);
+  Nan::SetMethod(ctor, "mapFile", MapFile);
+  Nan::SetMethod(ctor, "saveAsync", SaveAsync);
   Local<ObjectTemplate> proto = ctor->PrototypeTemplate();
 
   Nan::SetAccessor(proto,JS_STR("width"), WidthGetter);
@@ -80,17 +85,68 @@ void *Image::GetData () {
   return pixels;
 }
 
-void Image::Load (const char *filename) {
-  this->filename = (char *)filename;
+bool Image::Load (const char *filename) {
+  this->filename = filename;
 
+  // decode straight out of a mapping rather than through stdio: no second
+  // copy in userspace, and the pages are shared with everyone else mapping
+  // the same file
+  MappedFile file;
+  if (!file.Open(filename)) {
+    return false;
+  }
+  file.Advise(MappedFile::ADVICE_SEQUENTIAL);
+  file.Advise(MappedFile::ADVICE_WILLNEED);
+
+  return LoadFromMemory(file.Data(), file.Size(), filename);
+}
+
+bool Image::LoadFromMemory (const BYTE *data, size_t size, const char *nameHint) {
   if (image_bmp) {
     FreeImage_Unload(image_bmp);
+    image_bmp = NULL;
   }
 
-  FREE_IMAGE_FORMAT format = FreeImage_GetFileType(filename, 0);
-  FIBITMAP *tmp = FreeImage_Load(format, filename, 0);
+  FIMEMORY *mem = FreeImage_OpenMemory((BYTE*)data, (DWORD)size);
+  FREE_IMAGE_FORMAT format = FreeImage_GetFileTypeFromMemory(mem, 0);
+  // formats without a signature (e.g. TGA) are only known by their extension
+  if (format == FIF_UNKNOWN && nameHint) {
+    format = FreeImage_GetFIFFromFilename(nameHint);
+  }
+  FIBITMAP *tmp = format == FIF_UNKNOWN ? NULL : FreeImage_LoadFromMemory(format, mem, 0);
+  FreeImage_CloseMemory(mem);
+
+  if (!tmp) {
+    return false;
+  }
   image_bmp = FreeImage_ConvertTo32Bits(tmp);
   FreeImage_Unload(tmp);
+  return image_bmp != NULL;
+}
+
+void Image::SetPixelData (Local<Object> self) {
+  Nan::MaybeLocal<v8::Object> buffer;
+
+  // adjust internal fields
+  size_t num_pixels = FreeImage_GetWidth(image_bmp) * FreeImage_GetHeight(image_bmp);
+  BYTE *pixels = FreeImage_GetBits(image_bmp);
+  size_t num_bytes = num_pixels * 4;
+
+  // FreeImage stores data in BGR
+  // Convert from BGR to RGB
+  for(size_t i = 0; i < num_pixels; i++)
+  {
+    size_t i4=i<<2;
+    BYTE temp = pixels[i4 + 0];
+    pixels[i4 + 0] = pixels[i4 + 2];
+    pixels[i4 + 2] = temp;
+  }
+
+  buffer= Nan::NewBuffer((int)num_bytes);
+
+  std::memcpy(node::Buffer::Data(buffer.ToLocalChecked()),pixels, (int)num_bytes);
+
+  Nan::Set(self, JS_STR("data"), buffer.ToLocalChecked());
 }
 
 NAN_METHOD(Image::New) {
@@ -131,38 +187,21 @@ NAN_GETTER(Image::SrcGetter) {
 
   Image *image = ObjectWrap::Unwrap<Image>(info.This());
 
-  info.GetReturnValue().Set(JS_STR(image->filename));
+  info.GetReturnValue().Set(JS_STR(image->filename.c_str()));
 }
 
 NAN_SETTER(Image::SrcSetter) {
   Nan::HandleScope scope;
-  Nan::MaybeLocal<v8::Object> buffer;
 
   Image *image = ObjectWrap::Unwrap<Image>(info.This());
   //String::Utf8Value filename_s(value->ToString());
   Nan::Utf8String filename_s(value);
-  image->Load(*filename_s);
-
-  // adjust internal fields
-  size_t num_pixels = FreeImage_GetWidth(image->image_bmp) * FreeImage_GetHeight(image->image_bmp);
-  BYTE *pixels = FreeImage_GetBits(image->image_bmp);
-  size_t num_bytes = num_pixels * 4;
-
-  // FreeImage stores data in BGR
-  // Convert from BGR to RGB
-  for(size_t i = 0; i < num_pixels; i++)
-  {
-    size_t i4=i<<2;
-    BYTE temp = pixels[i4 + 0];
-    pixels[i4 + 0] = pixels[i4 + 2];
-    pixels[i4 + 2] = temp;
+  if (!image->Load(*filename_s)) {
+    Nan::ThrowError("Image: unable to load image");
+    return;
   }
 
-  buffer= Nan::NewBuffer((int)num_bytes);
-
-  std::memcpy(node::Buffer::Data(buffer.ToLocalChecked()),pixels, (int)num_bytes);
-
-  Nan::Set(info.This(), JS_STR("data"), buffer.ToLocalChecked());
+  image->SetPixelData(info.This());
 
   // emit event
   Nan::MaybeLocal<Value> emit_v = Nan::Get(info.This(), JS_STR("emit"));//info.This()->Get(Nan::New<String>("emit"));
@@ -183,6 +222,80 @@ NAN_SETTER(Image::SrcSetter) {
     FatalException(info.GetIsolate(),tc);
 }
 
+// Image.fromBuffer(buf): decodes already loaded (or mapped) encoded bytes.
+NAN_METHOD(Image::FromBuffer) {
+  Nan::HandleScope scope;
+
+  if (!info[0]->IsArrayBufferView()) {
+    Nan::ThrowTypeError("Expected Image.fromBuffer(Buffer data)");
+    return;
+  }
+
+  Local<Function> ctor = Local<Function>::New(Isolate::GetCurrent(), constructor_template);
+  Local<Object> self = Nan::NewInstance(ctor).ToLocalChecked();
+  Image *image = ObjectWrap::Unwrap<Image>(self);
+
+  Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(info[0]);
+  const BYTE *data = (const BYTE*)arr->Buffer()->Data() + arr->ByteOffset();
+  if (!image->LoadFromMemory(data, arr->ByteLength())) {
+    Nan::ThrowError("Image.fromBuffer: unable to decode image");
+    return;
+  }
+
+  image->SetPixelData(self);
+  info.GetReturnValue().Set(self);
+}
+
+static void unmapFileBuffer(char *, void *hint) {
+  delete static_cast<MappedFile*>(hint);
+}
+
+// Image.mapFile(path, offset, length, advice): a Buffer over a copy on write
+// mapping of [offset, offset + length) of the file, unmapped when collected.
+// advice: 0 normal, 1 sequential, 2 random, 3 willneed (MappedFile::Advice)
+NAN_METHOD(Image::MapFile) {
+  Nan::HandleScope scope;
+
+  Nan::Utf8String filename(info[0]);
+  // doubles, so offsets into bundles past 4GB survive
+  size_t offset = info.Length() > 1 ? (size_t)Nan::To<double>(info[1]).FromJust() : 0;
+  size_t length = info.Length() > 2 ? (size_t)Nan::To<double>(info[2]).FromJust() : 0;
+  int advice = info.Length() > 3 ? Nan::To<int>(info[3]).FromJust() : MappedFile::ADVICE_NORMAL;
+
+  MappedFile *file = new MappedFile();
+  if (!file->Open(*filename, offset, length, true)) {
+    delete file;
+    Nan::ThrowError("Image.mapFile: unable to map file");
+    return;
+  }
+  if (file->Size() > node::Buffer::kMaxLength) {
+    delete file;
+    Nan::ThrowRangeError("Image.mapFile: range is larger than a Buffer can hold, map a window with offset/length");
+    return;
+  }
+  if (file->Size() == 0) {
+    delete file;
+    info.GetReturnValue().Set(Nan::NewBuffer(0).ToLocalChecked());
+    return;
+  }
+
+  if (advice != MappedFile::ADVICE_NORMAL) {
+    file->Advise((MappedFile::Advice)advice);
+  }
+
+  info.GetReturnValue().Set(Nan::NewBuffer((char*)file->Data(), file->Size(), unmapFileBuffer, file).ToLocalChecked());
+}
+
+// What FreeImage_ConvertFromRawBits may read: bpp it converts from, rows that
+// fit in pitch, pitch * height bytes.
+static bool validRawImage(size_t byteLength, uint32_t width, uint32_t height, uint32_t pitch, uint32_t bpp) {
+  if (bpp != 8 && bpp != 16 && bpp != 24 && bpp != 32)
+    return false;
+  if (width == 0 || height == 0 || pitch < ((uint64_t)width * bpp + 7) / 8)
+    return false;
+  return byteLength >= (size_t)pitch * height;
+}
+
 NAN_METHOD(Image::save) {
   Nan::HandleScope scope;
   //String::Utf8Value filename(info[0]->ToString());
@@ -204,6 +317,11 @@ NAN_METHOD(Image::save) {
   if(info.Length()>7) greenMask=Nan::To<Uint32>(info[7]).ToLocalChecked()->Value();
   if(info.Length()>8) blueMask=Nan::To<Uint32>(info[8]).ToLocalChecked()->Value();
 
+  if(!validRawImage(node::Buffer::Length(info[1]), width, height, pitch, bpp)) {
+    Nan::ThrowRangeError("Image.save: expected bpp 8, 16, 24 or 32, a pitch of at least a row and a buffer of at least pitch * height bytes");
+    return;
+  }
+
   FIBITMAP *image = FreeImage_ConvertFromRawBits(
       (BYTE*)buffer,
       width, height, pitch, bpp,
@@ -219,6 +337,125 @@ NAN_METHOD(Image::save) {
   info.GetReturnValue().Set(Nan::New<Boolean>(ret));
 }
 
+// Everything an Image.saveAsync() call needs on the pool thread. The pixel
+// buffer is pinned, not copied; lib/image.js copies first unless told not to.
+struct ImageSaveJob {
+  std::string filename;
+  FREE_IMAGE_FORMAT format;
+  int flags;
+
+  std::shared_ptr<BackingStore> pinned;
+  BYTE *pixels;
+
+  uint32_t width, height, pitch, bpp;
+  uint32_t redMask, greenMask, blueMask;
+};
+
+class ImageSaveWorker : public Nan::AsyncWorker {
+public:
+  ImageSaveWorker(Nan::Callback *callback, ImageSaveJob *job)
+    : Nan::AsyncWorker(callback, "webgl:Image.saveAsync"), job(job) {}
+
+  ~ImageSaveWorker() {
+    delete job;
+  }
+
+  void Execute() {
+    FIBITMAP *image = FreeImage_ConvertFromRawBits(
+        job->pixels,
+        job->width, job->height, job->pitch, job->bpp,
+        job->redMask, job->greenMask, job->blueMask);
+    if (!image) {
+      SetErrorMessage("Image.saveAsync: unable to convert pixels");
+      return;
+    }
+
+    if(job->format==FIF_JPEG && job->bpp!=24) {
+      FIBITMAP *old=image;
+      image=FreeImage_ConvertTo24Bits(image);
+      FreeImage_Unload(old);
+    }
+
+    // release the pixels as early as possible, they can be large
+    job->pinned.reset();
+
+    if (!image || !FreeImage_Save(job->format, image, job->filename.c_str(), job->flags)) {
+      SetErrorMessage("Image.saveAsync: unable to save image");
+    }
+    if (image) {
+      FreeImage_Unload(image);
+    }
+  }
+
+  void HandleOKCallback() {
+    Nan::HandleScope scope;
+
+    Local<Value> argv[] = { Nan::Null(), JS_BOOL(true) };
+    callback->Call(2, argv, async_resource);
+  }
+
+private:
+  ImageSaveJob *job;
+};
+
+// Image.saveAsync(filename, buffer, width, height, pitch, bpp, redMask, greenMask, blueMask,
+//                 pngCompression, jpegQuality, callback)
+// Same conversion as save(), but encoding and writing run on the thread pool.
+// pngCompression is a zlib level (0-9, -1 for the default), jpegQuality 1-100
+// (0 for the default).
+NAN_METHOD(Image::SaveAsync) {
+  Nan::HandleScope scope;
+
+  if (info.Length() < 12 || !info[1]->IsArrayBufferView() || !info[11]->IsFunction()) {
+    Nan::ThrowTypeError("Expected saveAsync(filename, buffer, width, height, pitch, bpp, redMask, greenMask, blueMask, pngCompression, jpegQuality, callback)");
+    return;
+  }
+
+  Nan::Utf8String filename(info[0]);
+  FREE_IMAGE_FORMAT format = FreeImage_GetFIFFromFilename(*filename);
+  if (format == FIF_UNKNOWN) {
+    Nan::ThrowError("Image.saveAsync: unknown image format");
+    return;
+  }
+
+  ImageSaveJob *job = new ImageSaveJob();
+  job->filename = *filename;
+  job->format = format;
+  job->width = Nan::To<uint32_t>(info[2]).FromJust();
+  job->height = Nan::To<uint32_t>(info[3]).FromJust();
+  job->pitch = Nan::To<uint32_t>(info[4]).FromJust();
+  job->bpp = Nan::To<uint32_t>(info[5]).FromJust();
+  job->redMask = Nan::To<uint32_t>(info[6]).FromJust();
+  job->greenMask = Nan::To<uint32_t>(info[7]).FromJust();
+  job->blueMask = Nan::To<uint32_t>(info[8]).FromJust();
+
+  int pngCompression = Nan::To<int>(info[9]).FromJust();
+  int jpegQuality = Nan::To<int>(info[10]).FromJust();
+  job->flags = 0;
+  if (format == FIF_PNG && pngCompression >= 0) {
+    // FreeImage takes zlib levels 1-9 as is
+    job->flags = pngCompression == 0 ? PNG_Z_NO_COMPRESSION : (pngCompression > 9 ? 9 : pngCompression);
+  }
+  else if (format == FIF_JPEG && jpegQuality > 0) {
+    job->flags = jpegQuality > 100 ? 100 : jpegQuality;
+  }
+
+  Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(info[1]);
+  if (!validRawImage(arr->ByteLength(), job->width, job->height, job->pitch, job->bpp)) {
+    delete job;
+    Nan::ThrowRangeError("Image.saveAsync: expected bpp 8, 16, 24 or 32, a pitch of at least a row and a buffer of at least pitch * height bytes");
+    return;
+  }
+
+  job->pinned = arr->Buffer()->GetBackingStore();
+  job->pixels = (BYTE*)job->pinned->Data() + arr->ByteOffset();
+
+  Nan::Callback *callback = new Nan::Callback(info[11].As<Function>());
+  Nan::AsyncQueueWorker(new ImageSaveWorker(callback, job));
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
 Image::~Image () {
   if (image_bmp) {
     #ifdef LOGGING
@@ -4,6 +4,7 @@
 #include "common.h"
 
 #include <FreeImage.h>
+#include <string>
 
 using namespace v8;
 using namespace node;
@@ -16,7 +17,8 @@ public:
   int GetHeight ();
   int GetPitch ();
   void *GetData ();
-  void Load (const char *filename);
+  bool Load (const char *filename);
+  bool LoadFromMemory (const BYTE *data, size_t size, const char *nameHint = NULL);
 
 protected:
   static NAN_METHOD(New);
@@ -27,14 +29,19 @@ protected:
   static NAN_SETTER(OnloadSetter);
   static NAN_GETTER(PitchGetter);
   static NAN_METHOD(save);
+  static NAN_METHOD(FromBuffer);
+  static NAN_METHOD(MapFile);
+  static NAN_METHOD(SaveAsync);
 
   virtual ~Image ();
 
 private:
   static Persistent<Function> constructor_template;
 
+  void SetPixelData (Local<Object> self);
+
   FIBITMAP *image_bmp;
-  char *filename;
+  std::string filename;
   void *data;
 };
 
@@ -0,0 +1,171 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : data(NULL), size(0), base(NULL), baseSize(0), opened(false) {
+#ifdef _WIN32
+  file = INVALID_HANDLE_VALUE;
+  mapping = NULL;
+#endif
+}
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+// Clamps [offset, offset + length) to a file of fileSize bytes.
+static bool clampRange(size_t fileSize, size_t offset, size_t *length) {
+  if(offset > fileSize)
+    return false;
+  if(*length == 0 || *length > fileSize - offset)
+    *length = fileSize - offset;
+  return true;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const char *filename, size_t offset, size_t length, bool copyOnWrite) {
+  Close();
+
+  file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                     FILE_ATTRIBUTE_NORMAL, NULL);
+  if(file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER fileSize;
+  if(!GetFileSizeEx(file, &fileSize) || !clampRange((size_t) fileSize.QuadPart, offset, &length)) {
+    Close();
+    return false;
+  }
+  opened = true;
+  if(length == 0)
+    return true;
+
+  mapping = CreateFileMappingA(file, NULL, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+  if(!mapping) {
+    Close();
+    return false;
+  }
+
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  unsigned long long start = offset - offset % info.dwAllocationGranularity;
+  baseSize = length + (size_t)(offset - start);
+  base = (uint8_t*) MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ,
+                                  (DWORD)(start >> 32), (DWORD) start, baseSize);
+  if(!base) {
+    Close();
+    return false;
+  }
+  data = base + (offset - start);
+  size = length;
+  return true;
+}
+
+void MappedFile::Close() {
+  if(base) UnmapViewOfFile(base);
+  if(mapping) CloseHandle(mapping);
+  if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+  data = base = NULL;
+  mapping = NULL;
+  file = INVALID_HANDLE_VALUE;
+  size = baseSize = 0;
+  opened = false;
+}
+
+void MappedFile::Advise(Advice advice, size_t offset, size_t length) {
+  // no portable equivalent before Windows 8 (PrefetchVirtualMemory)
+}
+
+#else
+
+bool MappedFile::Open(const char *filename, size_t offset, size_t length, bool copyOnWrite) {
+  Close();
+
+  int fd = open(filename, O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  struct stat st;
+  if(fstat(fd, &st) != 0 || !clampRange((size_t) st.st_size, offset, &length)) {
+    close(fd);
+    return false;
+  }
+  opened = true;
+
+  if(length > 0) {
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t start = offset & ~(page - 1);
+    void *ptr = copyOnWrite ?
+      mmap(NULL, length + (offset - start), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t) start) :
+      mmap(NULL, length + (offset - start), PROT_READ, MAP_SHARED, fd, (off_t) start);
+    if(ptr == MAP_FAILED) {
+      close(fd);
+      opened = false;
+      return false;
+    }
+    base = (uint8_t*) ptr;
+    baseSize = length + (offset - start);
+    data = base + (offset - start);
+    size = length;
+  }
+
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+  return true;
+}
+
+void MappedFile::Close() {
+  if(base) munmap(base, baseSize);
+  data = base = NULL;
+  size = baseSize = 0;
+  opened = false;
+}
+
+void MappedFile::Advise(Advice advice, size_t offset, size_t length) {
+  if(!data || offset >= size)
+    return;
+  if(length == 0 || offset + length > size)
+    length = size - offset;
+
+  // madvise() wants a page aligned start address; the mapping itself is page
+  // aligned, so rounding down never leaves it
+  size_t page = (size_t) sysconf(_SC_PAGESIZE);
+  uint8_t *addr = data + offset;
+  uint8_t *start = (uint8_t*)((uintptr_t) addr & ~(uintptr_t)(page - 1));
+  length += addr - start;
+
+  int flag = MADV_NORMAL;
+  switch(advice) {
+  case ADVICE_SEQUENTIAL: flag = MADV_SEQUENTIAL; break;
+  case ADVICE_RANDOM: flag = MADV_RANDOM; break;
+  case ADVICE_WILLNEED: flag = MADV_WILLNEED; break;
+  case ADVICE_DONTNEED: flag = MADV_DONTNEED; break;
+  default: break;
+  }
+  madvise(start, length, flag);
+}
+
+#endif
+
+void MappedFile::Prefetch(size_t offset, size_t length) {
+  if(!data || offset >= size)
+    return;
+  if(length == 0 || offset + length > size)
+    length = size - offset;
+
+  Advise(ADVICE_WILLNEED, offset, length);
+
+  const size_t page = 4096;
+  volatile uint8_t sink = 0;
+  for(size_t i = 0; i < length; i += page)
+    sink += data[offset + i];
+  sink += data[offset + length - 1];
+}
@@ -0,0 +1,62 @@
+/*
+ * mapped_file.h
+ *
+ * Read-only memory mapping of a whole file, with access pattern hints.
+ */
+
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+class MappedFile {
+public:
+  enum Advice {
+    ADVICE_NORMAL,
+    ADVICE_SEQUENTIAL,
+    ADVICE_RANDOM,
+    ADVICE_WILLNEED,
+    ADVICE_DONTNEED
+  };
+
+  MappedFile();
+  ~MappedFile();
+
+  // Maps [offset, offset + length) of the file; length 0 means to the end, so
+  // windows of files larger than the address space (or a Buffer) work too.
+  // Returns false if the file cannot be opened or mapped, or offset is past
+  // the end. Empty ranges map to a NULL data pointer with a size of 0.
+  // copyOnWrite makes the pages writable without touching the file, for
+  // mappings handed to JS where a write must not crash the process.
+  bool Open(const char *filename, size_t offset = 0, size_t length = 0, bool copyOnWrite = false);
+  void Close();
+
+  uint8_t *Data() const { return data; }
+  size_t Size() const { return size; }
+  bool IsOpen() const { return opened; }
+
+  // madvise() style hint for [offset, offset+length). length 0 means to the end.
+  void Advise(Advice advice, size_t offset = 0, size_t length = 0);
+
+  // Touches every page of the range so later reads (e.g. from the GL thread)
+  // don't fault on disk I/O.
+  void Prefetch(size_t offset = 0, size_t length = 0);
+
+private:
+  MappedFile(const MappedFile&);
+  MappedFile& operator=(const MappedFile&);
+
+  uint8_t *data;
+  size_t size;
+  // the actual mapping, which starts at a page (allocation granularity) boundary
+  uint8_t *base;
+  size_t baseSize;
+  bool opened;
+#ifdef _WIN32
+  void *file;
+  void *mapping;
+#endif
+};
+
+#endif /* MAPPED_FILE_H_ */
@@ -0,0 +1,217 @@
+/*
+ * marshal.h
+ *
+ * Compile time generated argument marshalling for the GL bindings. A binding
+ * whose JS arguments map one to one onto the GL parameters is declared once:
+ *
+ *   GL_BINDING(DrawElements, glDrawElements, GLenum, GLsizei, GLenum, marshal::Offset)
+ *
+ * and the template below expands to a NAN_METHOD that unboxes every argument
+ * with the cheapest conversion for its type and boxes the GL return value.
+ *
+ * - integers take the Smi/Int32 path and only fall back to the generic
+ *   ToInt32/ToUint32 conversion for heap numbers and non numbers
+ * - floats read the Number directly
+ * - typed arrays are read through ArrayBuffer::Data() instead of
+ *   GetBackingStore(), which costs an atomic shared_ptr copy per argument
+ * - V8 already opens a HandleScope around every FunctionCallback and none of
+ *   these allocate handles (return values are set as primitives), so no
+ *   Nan::HandleScope is created
+ *
+ * Conversions that throw (e.g. a Symbol or a throwing valueOf) unbox as 0 and
+ * the exception propagates once the binding returns.
+ */
+
+#ifndef MARSHAL_H_
+#define MARSHAL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "common.h"
+#include <GL/glew.h>
+
+namespace webgl {
+namespace marshal {
+
+// Byte offset into the bound buffer for parameters GL declares as pointers
+// (glDrawElements indices, glVertexAttribPointer pointer). Exact up to 2^53.
+struct Offset {};
+
+// Client memory: a typed array, DataView, ArrayBuffer or null.
+template<typename T> struct Array {};
+
+template<typename T>
+inline T *ArrayData(v8::Local<v8::Value> value, size_t *byteLength = NULL) {
+  uint8_t *data = NULL;
+  size_t length = 0;
+  if(value->IsArrayBufferView()) {
+    v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+    data = (uint8_t *) view->Buffer()->Data() + view->ByteOffset();
+    length = view->ByteLength();
+  }
+  else if(value->IsArrayBuffer()) {
+    v8::Local<v8::ArrayBuffer> buffer = value.As<v8::ArrayBuffer>();
+    data = (uint8_t *) buffer->Data();
+    length = buffer->ByteLength();
+  }
+  else if(value->IsSharedArrayBuffer()) {
+    v8::Local<v8::SharedArrayBuffer> buffer = value.As<v8::SharedArrayBuffer>();
+    data = (uint8_t *) buffer->Data();
+    length = buffer->ByteLength();
+  }
+  if(byteLength)
+    *byteLength = length;
+  return reinterpret_cast<T *>(data);
+}
+
+// Offsets and sizes passed as a Float64Array (exact up to 2^53), a
+// BigInt64Array or a BigUint64Array, converted to GLintptr. Up to N values
+// are converted without allocating. Size() is the number of elements.
+template<size_t N = 32>
+class IntptrArray {
+public:
+  explicit IntptrArray(v8::Local<v8::Value> value) : data(inline_), size(0) {
+    size_t byteLength = 0;
+    const void *values = ArrayData<void>(value, &byteLength);
+    bool isDouble = value->IsFloat64Array();
+    if(!isDouble && !value->IsBigInt64Array() && !value->IsBigUint64Array())
+      return;
+    size = byteLength / 8;
+    if(size > N) {
+      heap.reset(new GLintptr[size]);
+      data = heap.get();
+    }
+    for(size_t i = 0; i < size; i++)
+      data[i] = isDouble ? (GLintptr) ((const double *) values)[i] : (GLintptr) ((const int64_t *) values)[i];
+  }
+
+  const GLintptr *Data() const { return size ? data : NULL; }
+  size_t Size() const { return size; }
+
+private:
+  GLintptr inline_[N];
+  std::unique_ptr<GLintptr[]> heap;
+  GLintptr *data;
+  size_t size;
+};
+
+// Set when a conversion threw (e.g. a throwing valueOf): the JS exception is
+// pending and Call returns without calling into GL.
+inline bool &UnboxFailed() {
+  static thread_local bool failed = false;
+  return failed;
+}
+
+template<typename V>
+inline V FromMaybeOrFail(Nan::Maybe<V> value, V fallback) {
+  if(value.IsNothing()) {
+    UnboxFailed() = true;
+    return fallback;
+  }
+  return value.FromJust();
+}
+
+template<typename T>
+struct Arg {
+  typedef T Type;
+
+  static inline T Unbox(v8::Local<v8::Value> value) {
+    if constexpr (std::is_same<T, GLboolean>::value) {
+      if(value->IsBoolean())
+        return value->IsTrue() ? GL_TRUE : GL_FALSE;
+      return FromMaybeOrFail(Nan::To<bool>(value), false) ? GL_TRUE : GL_FALSE;
+    }
+    else if constexpr (std::is_floating_point<T>::value) {
+      if(value->IsNumber())
+        return (T) value.As<v8::Number>()->Value();
+      return (T) FromMaybeOrFail(Nan::To<double>(value), 0.0);
+    }
+    else if constexpr (sizeof(T) <= 4) {
+      // an Int32 cast to unsigned has the same bits as ToUint32, so both
+      // signednesses share the fast path
+      if(value->IsInt32())
+        return (T) value.As<v8::Int32>()->Value();
+      if constexpr (std::is_signed<T>::value)
+        return (T) FromMaybeOrFail(Nan::To<int32_t>(value), 0);
+      else
+        return (T) FromMaybeOrFail(Nan::To<uint32_t>(value), 0u);
+    }
+    else {
+      // GLintptr, GLsizeiptr, GLint64, GLuint64
+      static_assert(std::is_integral<T>::value, "unsupported GL parameter type");
+      if(value->IsInt32())
+        return (T) value.As<v8::Int32>()->Value();
+      if(value->IsNumber())
+        return (T) value.As<v8::Number>()->Value();
+      if(value->IsBigInt())
+        return (T) value.As<v8::BigInt>()->Int64Value();
+      return (T) FromMaybeOrFail(Nan::To<int64_t>(value), (int64_t) 0);
+    }
+  }
+};
+
+template<>
+struct Arg<Offset> {
+  typedef const void *Type;
+
+  static inline const void *Unbox(v8::Local<v8::Value> value) {
+    return reinterpret_cast<const void *>(Arg<GLintptr>::Unbox(value));
+  }
+};
+
+template<typename T>
+struct Arg<Array<T> > {
+  typedef T *Type;
+
+  static inline T *Unbox(v8::Local<v8::Value> value) {
+    return ArrayData<T>(value);
+  }
+};
+
+template<typename R>
+inline void SetReturn(const Nan::FunctionCallbackInfo<v8::Value> &info, R result) {
+  if constexpr (std::is_same<R, GLboolean>::value)
+    info.GetReturnValue().Set(result != 0);
+  else if constexpr (std::is_floating_point<R>::value)
+    info.GetReturnValue().Set((double) result);
+  else if constexpr (std::is_signed<R>::value)
+    info.GetReturnValue().Set((int32_t) result);
+  else
+    info.GetReturnValue().Set((uint32_t) result);
+}
+
+template<typename... A, typename F, size_t... I>
+inline void Invoke(const Nan::FunctionCallbackInfo<v8::Value> &info, F fn, std::index_sequence<I...>) {
+  // braced initialization unboxes left to right, like the JS arguments
+  UnboxFailed() = false;
+  std::tuple<typename Arg<A>::Type...> args { Arg<A>::Unbox(info[I])... };
+  if(UnboxFailed())
+    return;
+  typedef decltype(std::apply(fn, args)) R;
+  if constexpr (std::is_void<R>::value)
+    std::apply(fn, args);
+  else
+    SetReturn<R>(info, std::apply(fn, args));
+}
+
+template<typename... A, typename F>
+inline void Call(const Nan::FunctionCallbackInfo<v8::Value> &info, F fn) {
+  Invoke<A...>(info, fn, std::index_sequence_for<A...>());
+}
+
+} // end namespace marshal
+} // end namespace webgl
+
+// The lambda defers the lookup of GLEW entry points to call time and lets
+// the compiler inline the whole conversion into the NAN_METHOD.
+#define GL_BINDING(name, function, ...) \
+  NAN_METHOD(name) { \
+    webgl::marshal::Call<__VA_ARGS__>(info, [](auto... args) { return function(args...); }); \
+  }
+
+#endif /* MARSHAL_H_ */
@@ -0,0 +1,295 @@
+/*
+ * matrix_batch.cc
+ *
+ * gl.multiplyMat4(out, a, b, count, outStride, threads): out[i] = a[i] * b[i],
+ *   a or b holding a single matrix is used for every i
+ * gl.composeMat4(out, translations, rotations, scales, count, outStride, threads):
+ *   out[i] = T * R * S from vec3, quaternion (x, y, z, w) and vec3 (or null) arrays
+ * gl.propagateMat4(world, local, parents, count, worldStride): world[i] =
+ *   world[parents[i]] * local[i], or local[i] for parents[i] < 0; parents
+ *   must come before their children
+ * gl.normalMatrices(out, matrices, count, outStride, threads): the inverse
+ *   transpose of the upper 3x3, as 3 columns of 4 floats (the std140 mat3)
+ * gl.invertMat4(out, matrices, count, outStride, threads) -> singular count,
+ *   singular matrices get zeros
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define WEBGL_MATRIX_SSE2
+  #include <emmintrin.h>
+#endif
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "matrix_batch.h"
+#include "marshal.h"
+#include "parallel.h"
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+// matrices per task when working on several threads
+static const int MATRIX_CHUNK = 1024;
+
+// out = a * b, out may be a or b
+static inline void multiply(float *out, const float *a, const float *b) {
+#ifdef WEBGL_MATRIX_SSE2
+  __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+  __m128 columns[4];
+  for(int j = 0; j < 4; j++) {
+    const float *column = b + j * 4;
+    columns[j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(column[0])), _mm_mul_ps(a1, _mm_set1_ps(column[1]))),
+                            _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(column[2])), _mm_mul_ps(a3, _mm_set1_ps(column[3]))));
+  }
+  for(int j = 0; j < 4; j++)
+    _mm_storeu_ps(out + j * 4, columns[j]);
+#else
+  float result[16];
+  for(int j = 0; j < 4; j++) {
+    for(int i = 0; i < 4; i++)
+      result[j * 4 + i] = a[i] * b[j * 4] + a[4 + i] * b[j * 4 + 1] + a[8 + i] * b[j * 4 + 2] + a[12 + i] * b[j * 4 + 3];
+  }
+  memcpy(out, result, sizeof(result));
+#endif
+}
+
+static inline void compose(float *out, const float *t, const float *q, const float *s) {
+  float x = q[0], y = q[1], z = q[2], w = q[3];
+  float sx = s ? s[0] : 1, sy = s ? s[1] : 1, sz = s ? s[2] : 1;
+  float xx = x * x, yy = y * y, zz = z * z;
+  float xy = x * y, xz = x * z, yz = y * z;
+  float wx = w * x, wy = w * y, wz = w * z;
+  out[0] = (1 - 2 * (yy + zz)) * sx;
+  out[1] = 2 * (xy + wz) * sx;
+  out[2] = 2 * (xz - wy) * sx;
+  out[3] = 0;
+  out[4] = 2 * (xy - wz) * sy;
+  out[5] = (1 - 2 * (xx + zz)) * sy;
+  out[6] = 2 * (yz + wx) * sy;
+  out[7] = 0;
+  out[8] = 2 * (xz + wy) * sz;
+  out[9] = 2 * (yz - wx) * sz;
+  out[10] = (1 - 2 * (xx + yy)) * sz;
+  out[11] = 0;
+  out[12] = t[0];
+  out[13] = t[1];
+  out[14] = t[2];
+  out[15] = 1;
+}
+
+static inline void cross(float *out, const float *a, const float *b) {
+  out[0] = a[1] * b[2] - a[2] * b[1];
+  out[1] = a[2] * b[0] - a[0] * b[2];
+  out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// The inverse transpose of the upper 3x3 of m has the columns c1 x c2,
+// c2 x c0 and c0 x c1 over det.
+static inline void normalMatrix(float *out, const float *m) {
+  float columns[3][3];
+  cross(columns[0], m + 4, m + 8);
+  cross(columns[1], m + 8, m);
+  cross(columns[2], m, m + 4);
+  float det = m[0] * columns[0][0] + m[1] * columns[0][1] + m[2] * columns[0][2];
+  float scale = det != 0 ? 1 / det : 0;
+  for(int j = 0; j < 3; j++) {
+    for(int i = 0; i < 3; i++)
+      out[j * 4 + i] = columns[j][i] * scale;
+    out[j * 4 + 3] = 0;
+  }
+}
+
+// returns false (and writes zeros) for a singular matrix
+static inline bool invert(float *out, const float *m) {
+  float b00 = m[0] * m[5] - m[1] * m[4], b01 = m[0] * m[6] - m[2] * m[4];
+  float b02 = m[0] * m[7] - m[3] * m[4], b03 = m[1] * m[6] - m[2] * m[5];
+  float b04 = m[1] * m[7] - m[3] * m[5], b05 = m[2] * m[7] - m[3] * m[6];
+  float b06 = m[8] * m[13] - m[9] * m[12], b07 = m[8] * m[14] - m[10] * m[12];
+  float b08 = m[8] * m[15] - m[11] * m[12], b09 = m[9] * m[14] - m[10] * m[13];
+  float b10 = m[9] * m[15] - m[11] * m[13], b11 = m[10] * m[15] - m[11] * m[14];
+  float det = b00 * b11 - b01 * b10 + b02 * b09 + b03 * b08 - b04 * b07 + b05 * b06;
+  if(det == 0 || !isfinite(det)) {
+    memset(out, 0, 16 * sizeof(float));
+    return false;
+  }
+  float d = 1 / det;
+  float r[16] = {
+    (m[5] * b11 - m[6] * b10 + m[7] * b09) * d,
+    (m[2] * b10 - m[1] * b11 - m[3] * b09) * d,
+    (m[13] * b05 - m[14] * b04 + m[15] * b03) * d,
+    (m[10] * b04 - m[9] * b05 - m[11] * b03) * d,
+    (m[6] * b08 - m[4] * b11 - m[7] * b07) * d,
+    (m[0] * b11 - m[2] * b08 + m[3] * b07) * d,
+    (m[14] * b02 - m[12] * b05 - m[15] * b01) * d,
+    (m[8] * b05 - m[10] * b02 + m[11] * b01) * d,
+    (m[4] * b10 - m[5] * b08 + m[7] * b06) * d,
+    (m[1] * b08 - m[0] * b10 - m[3] * b06) * d,
+    (m[12] * b04 - m[13] * b02 + m[15] * b00) * d,
+    (m[9] * b02 - m[8] * b04 - m[11] * b00) * d,
+    (m[5] * b07 - m[4] * b09 - m[6] * b06) * d,
+    (m[0] * b09 - m[1] * b07 + m[2] * b06) * d,
+    (m[13] * b01 - m[12] * b03 - m[14] * b00) * d,
+    (m[8] * b03 - m[9] * b01 + m[10] * b00) * d
+  };
+  memcpy(out, r, sizeof(r));
+  return true;
+}
+
+// Calls fn(i) for i in [0, count), in chunks over threads threads.
+template <typename Fn>
+static void forEachMatrix(size_t count, int threads, Fn fn) {
+  int chunks = (int) ((count + MATRIX_CHUNK - 1) / MATRIX_CHUNK);
+  if(threads == 1 || chunks <= 1) {
+    for(size_t i = 0; i < count; i++)
+      fn(i);
+    return;
+  }
+  PooledParallelFor(chunks, threads, [&](int chunk) {
+    size_t end = min(count, (size_t) (chunk + 1) * MATRIX_CHUNK);
+    for(size_t i = (size_t) chunk * MATRIX_CHUNK; i < end; i++)
+      fn(i);
+  });
+}
+
+// A Float32Array argument holding at least count entries of floats floats
+// (or, when single is set, exactly one entry, which is then used for all).
+struct FloatArg {
+  float *data;
+  size_t stride;
+};
+
+static bool floatArg(Local<Value> value, size_t count, size_t floats, size_t stride, bool single, bool optional,
+                     FloatArg *arg) {
+  arg->data = NULL;
+  arg->stride = stride;
+  if(optional && value->IsNullOrUndefined())
+    return true;
+  if(!value->IsFloat32Array())
+    return false;
+  size_t byteLength = 0;
+  arg->data = marshal::ArrayData<float>(value, &byteLength);
+  size_t length = byteLength / sizeof(float);
+  if(single && length == floats && count > 1) {
+    arg->stride = 0;
+    return true;
+  }
+  return count == 0 || (arg->data && length >= (count - 1) * stride + floats);
+}
+
+static bool checkArgs(bool ok, const char *name) {
+  if(!ok)
+    Nan::ThrowRangeError((string(name) + ": expected Float32Arrays with an entry per matrix").c_str());
+  return ok;
+}
+
+// floats between output matrices, at least the matrix size so the outputs
+// don't overlap (threads would race on them)
+static bool outStride(Local<Value> value, size_t floats, const char *name, size_t *stride) {
+  *stride = value->IsUndefined() ? floats : marshal::Arg<GLuint>::Unbox(value);
+  if(*stride < floats)
+    Nan::ThrowRangeError((string(name) + ": stride is smaller than a matrix (" + to_string(floats) + " floats)").c_str());
+  return *stride >= floats;
+}
+
+static int threadCount(Local<Value> value) {
+  return value->IsUndefined() ? 1 : Nan::To<int>(value).FromJust();
+}
+
+NAN_METHOD(MultiplyMat4) {
+  size_t count = marshal::Arg<GLuint>::Unbox(info[3]);
+  FloatArg out, a, b;
+  size_t stride;
+  if(!outStride(info[4], 16, "multiplyMat4", &stride))
+    return;
+  if(!checkArgs(floatArg(info[0], count, 16, stride, false, false, &out) &&
+                floatArg(info[1], count, 16, 16, true, false, &a) &&
+                floatArg(info[2], count, 16, 16, true, false, &b), "multiplyMat4"))
+    return;
+  forEachMatrix(count, threadCount(info[5]), [&](size_t i) {
+    multiply(out.data + i * out.stride, a.data + i * a.stride, b.data + i * b.stride);
+  });
+}
+
+NAN_METHOD(ComposeMat4) {
+  size_t count = marshal::Arg<GLuint>::Unbox(info[4]);
+  FloatArg out, t, r, s;
+  size_t stride;
+  if(!outStride(info[5], 16, "composeMat4", &stride))
+    return;
+  if(!checkArgs(floatArg(info[0], count, 16, stride, false, false, &out) &&
+                floatArg(info[1], count, 3, 3, false, false, &t) &&
+                floatArg(info[2], count, 4, 4, false, false, &r) &&
+                floatArg(info[3], count, 3, 3, false, true, &s), "composeMat4"))
+    return;
+  forEachMatrix(count, threadCount(info[6]), [&](size_t i) {
+    compose(out.data + i * out.stride, t.data + i * 3, r.data + i * 4, s.data ? s.data + i * 3 : NULL);
+  });
+}
+
+NAN_METHOD(PropagateMat4) {
+  size_t count = marshal::Arg<GLuint>::Unbox(info[3]);
+  FloatArg world, local;
+  size_t parentsLength = 0;
+  const int32_t *parents = marshal::ArrayData<int32_t>(info[2], &parentsLength);
+  size_t stride;
+  if(!outStride(info[4], 16, "propagateMat4", &stride))
+    return;
+  if(!checkArgs(floatArg(info[0], count, 16, stride, false, false, &world) &&
+                floatArg(info[1], count, 16, 16, false, false, &local) &&
+                info[2]->IsInt32Array() && parentsLength >= count * sizeof(int32_t), "propagateMat4"))
+    return;
+
+  // one pass in order, every parent is final before its children
+  for(size_t i = 0; i < count; i++) {
+    int32_t parent = parents[i];
+    float *w = world.data + i * world.stride;
+    const float *l = local.data + i * 16;
+    if(parent < 0) {
+      memcpy(w, l, 16 * sizeof(float));
+    } else if((size_t) parent < i) {
+      multiply(w, world.data + parent * world.stride, l);
+    } else {
+      Nan::ThrowRangeError("propagateMat4: every parent must come before its children");
+      return;
+    }
+  }
+}
+
+NAN_METHOD(NormalMatrices) {
+  size_t count = marshal::Arg<GLuint>::Unbox(info[2]);
+  FloatArg out, m;
+  size_t stride;
+  if(!outStride(info[3], 12, "normalMatrices", &stride))
+    return;
+  if(!checkArgs(floatArg(info[0], count, 12, stride, false, false, &out) &&
+                floatArg(info[1], count, 16, 16, false, false, &m), "normalMatrices"))
+    return;
+  forEachMatrix(count, threadCount(info[4]), [&](size_t i) {
+    normalMatrix(out.data + i * out.stride, m.data + i * 16);
+  });
+}
+
+NAN_METHOD(InvertMat4) {
+  size_t count = marshal::Arg<GLuint>::Unbox(info[2]);
+  FloatArg out, m;
+  size_t stride;
+  if(!outStride(info[3], 16, "invertMat4", &stride))
+    return;
+  if(!checkArgs(floatArg(info[0], count, 16, stride, false, false, &out) &&
+                floatArg(info[1], count, 16, 16, false, false, &m), "invertMat4"))
+    return;
+  atomic<uint32_t> singular(0);
+  forEachMatrix(count, threadCount(info[4]), [&](size_t i) {
+    if(!invert(out.data + i * out.stride, m.data + i * 16))
+      singular++;
+  });
+  info.GetReturnValue().Set(singular.load());
+}
+
+} // end namespace webgl
@@ -0,0 +1,28 @@
+/*
+ * matrix_batch.h
+ *
+ * Batched mat4 math on Float32Arrays for transform hierarchies: products of
+ * matrix pairs, translation/rotation/scale composition, parent indexed
+ * hierarchy propagation, normal matrices and inverses, a whole array per
+ * call instead of a JS call (and allocation) per object. Matrices are column
+ * major like the GL's, every input array is tightly packed 16 floats per
+ * matrix and outputs take a stride, so results can be written straight into
+ * the matrix slots of interleaved instance or uniform buffer data.
+ */
+
+#ifndef MATRIX_BATCH_H_
+#define MATRIX_BATCH_H_
+
+#include "common.h"
+
+namespace webgl {
+
+NAN_METHOD(MultiplyMat4);
+NAN_METHOD(ComposeMat4);
+NAN_METHOD(PropagateMat4);
+NAN_METHOD(NormalMatrices);
+NAN_METHOD(InvertMat4);
+
+}
+
+#endif /* MATRIX_BATCH_H_ */
@@ -0,0 +1,439 @@
+/*
+ * mesh_optimizer.cc
+ *
+ * gl.analyzeVertexCache(indices, vertexCount, cacheSize) -> {misses, acmr, atvr}
+ * gl.optimizeVertexCache(indices, vertexCount)
+ * gl.optimizeOverdraw(indices, positions, positionStride, vertexCount, threshold)
+ * gl.optimizeVertexFetch(vertices, vertexSize, indices) -> vertices used
+ *
+ * indices are Uint16Arrays or Uint32Arrays and are rewritten in place.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mesh_optimizer.h"
+#include "marshal.h"
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+/*
+ * Analysis
+ */
+
+// FIFO cache simulation: a vertex is cached while fewer than cacheSize
+// misses happened since its own.
+struct FifoCache {
+  vector<size_t> timestamps;
+  size_t timestamp;
+  size_t size;
+
+  FifoCache(size_t vertexCount, size_t size) : timestamps(vertexCount, 0), timestamp(size + 1), size(size) {}
+
+  unsigned access(uint32_t v) {
+    if(timestamp - timestamps[v] > size) {
+      timestamps[v] = timestamp++;
+      return 1;
+    }
+    return 0;
+  }
+
+  unsigned triangle(const uint32_t *t) {
+    return access(t[0]) + access(t[1]) + access(t[2]);
+  }
+
+  void flush() {
+    timestamp += size + 1;
+  }
+};
+
+VertexCacheStats analyzeVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount, unsigned cacheSize) {
+  FifoCache cache(vertexCount, max(3u, cacheSize));
+  VertexCacheStats stats = { 0, 0, 0 };
+  for(size_t i = 0; i + 2 < indexCount; i += 3)
+    stats.misses += cache.triangle(indices + i);
+  stats.acmr = indexCount >= 3 ? (double) stats.misses / (indexCount / 3) : 0;
+  stats.atvr = vertexCount ? (double) stats.misses / vertexCount : 0;
+  return stats;
+}
+
+/*
+ * Vertex cache: Forsyth, "Linear-Speed Vertex Cache Optimisation". Greedily
+ * emits the best scoring triangle among those of the cached vertices; a
+ * vertex scores for its position in a modelled LRU cache and for having few
+ * triangles left, so fans get finished instead of leaving stragglers.
+ */
+
+static const int FORSYTH_CACHE = 32;
+static const int FORSYTH_VALENCE = 32;
+
+struct ForsythScores {
+  float cache[FORSYTH_CACHE];
+  float valence[FORSYTH_VALENCE + 1];
+
+  ForsythScores() {
+    for(int i = 0; i < FORSYTH_CACHE; i++) {
+      // the last triangle's vertices score the same, whatever their order
+      cache[i] = i < 3 ? 0.75f : powf(1 - (float) (i - 3) / (FORSYTH_CACHE - 3), 1.5f);
+    }
+    valence[0] = 0;
+    for(int i = 1; i <= FORSYTH_VALENCE; i++)
+      valence[i] = 2 / sqrtf((float) i);
+  }
+
+  float operator()(int position, uint32_t live) const {
+    if(!live)
+      return -1;
+    return (position >= 0 ? cache[position] : 0) + valence[min<uint32_t>(live, FORSYTH_VALENCE)];
+  }
+};
+
+static const ForsythScores forsythScores;
+
+void optimizeVertexCache(uint32_t *indices, size_t indexCount, size_t vertexCount) {
+  size_t triangleCount = indexCount / 3;
+  if(triangleCount < 2)
+    return;
+
+  // the triangles of every vertex, the first live[v] of them not emitted yet
+  vector<uint32_t> live(vertexCount, 0);
+  for(size_t i = 0; i < triangleCount * 3; i++)
+    live[indices[i]]++;
+  vector<uint32_t> first(vertexCount + 1, 0);
+  for(size_t v = 0; v < vertexCount; v++)
+    first[v + 1] = first[v] + live[v];
+  vector<uint32_t> adjacency(triangleCount * 3);
+  {
+    vector<uint32_t> cursor(first.begin(), first.end() - 1);
+    for(size_t i = 0; i < triangleCount * 3; i++)
+      adjacency[cursor[indices[i]]++] = (uint32_t) (i / 3);
+  }
+
+  vector<float> vertexScore(vertexCount);
+  for(size_t v = 0; v < vertexCount; v++)
+    vertexScore[v] = forsythScores(-1, live[v]);
+  vector<float> triangleScore(triangleCount);
+  size_t best = 0;
+  for(size_t t = 0; t < triangleCount; t++) {
+    const uint32_t *tri = indices + t * 3;
+    triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+    if(triangleScore[t] > triangleScore[best])
+      best = t;
+  }
+
+  vector<uint8_t> emitted(triangleCount, 0);
+  vector<uint32_t> output(triangleCount * 3);
+  uint32_t cache[FORSYTH_CACHE + 3], next[FORSYTH_CACHE + 3];
+  int cached = 0;
+  size_t cursor = 0;
+
+  for(size_t out = 0; out < triangleCount; out++) {
+    if(best == (size_t) -1) {
+      // nothing left around the cache, start over at the first straggler
+      while(emitted[cursor])
+        cursor++;
+      best = cursor;
+    }
+    const uint32_t *tri = indices + best * 3;
+    memcpy(&output[out * 3], tri, 3 * sizeof(uint32_t));
+    emitted[best] = 1;
+
+    for(int k = 0; k < 3; k++) {
+      uint32_t v = tri[k];
+      uint32_t *begin = &adjacency[first[v]], *end = begin + live[v];
+      uint32_t *found = find(begin, end, (uint32_t) best);
+      if(found != end) {
+        *found = end[-1];
+        live[v]--;
+      }
+    }
+
+    // the triangle's vertices move to the front of the cache
+    int count = 0;
+    for(int k = 0; k < 3; k++) {
+      if(find(next, next + count, tri[k]) == next + count)
+        next[count++] = tri[k];
+    }
+    for(int i = 0; i < cached; i++) {
+      if(cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2])
+        next[count++] = cache[i];
+    }
+
+    // rescore, including the vertices that just fell out
+    for(int i = 0; i < count; i++) {
+      uint32_t v = next[i];
+      float score = forsythScores(i < FORSYTH_CACHE ? i : -1, live[v]);
+      float delta = score - vertexScore[v];
+      vertexScore[v] = score;
+      for(uint32_t j = first[v]; j < first[v] + live[v]; j++)
+        triangleScore[adjacency[j]] += delta;
+    }
+
+    best = (size_t) -1;
+    float bestScore = -1;
+    cached = min(count, FORSYTH_CACHE);
+    for(int i = 0; i < cached; i++) {
+      uint32_t v = next[i];
+      for(uint32_t j = first[v]; j < first[v] + live[v]; j++) {
+        if(triangleScore[adjacency[j]] > bestScore) {
+          bestScore = triangleScore[adjacency[j]];
+          best = adjacency[j];
+        }
+      }
+    }
+    memcpy(cache, next, cached * sizeof(uint32_t));
+  }
+
+  memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+/*
+ * Overdraw: Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex
+ * Locality and Reduced Overdraw". The cache ordered triangles are cut into
+ * clusters where the cache runs cold (and, within threshold, more often),
+ * and the clusters are sorted to draw the ones facing out from the middle of
+ * the mesh first, as they tend to occlude the rest.
+ */
+
+static const size_t OVERDRAW_CACHE = 16;
+
+void optimizeOverdraw(uint32_t *indices, size_t indexCount, const float *positions, size_t positionStride,
+                      size_t vertexCount, float threshold) {
+  size_t triangleCount = indexCount / 3;
+  if(triangleCount < 2)
+    return;
+
+  // hard boundaries: triangles that miss the cache with all three vertices
+  FifoCache cache(vertexCount, OVERDRAW_CACHE);
+  vector<size_t> hard;
+  for(size_t t = 0; t < triangleCount; t++) {
+    if(cache.triangle(indices + t * 3) == 3 || t == 0)
+      hard.push_back(t);
+  }
+  hard.push_back(triangleCount);
+
+  // soft boundaries: within a hard cluster, wherever the running ACMR
+  // (from a cold cache) gets down to threshold times the cluster's
+  vector<size_t> clusters;
+  for(size_t c = 0; c + 1 < hard.size(); c++) {
+    size_t begin = hard[c], end = hard[c + 1];
+    cache.flush();
+    size_t misses = 0;
+    for(size_t t = begin; t < end; t++)
+      misses += cache.triangle(indices + t * 3);
+    double clusterThreshold = threshold * (double) misses / (end - begin);
+
+    clusters.push_back(begin);
+    cache.flush();
+    size_t runningMisses = 0, runningTriangles = 0;
+    for(size_t t = begin; t < end; t++) {
+      runningMisses += cache.triangle(indices + t * 3);
+      runningTriangles++;
+      if(t + 1 < end && runningMisses <= clusterThreshold * runningTriangles) {
+        clusters.push_back(t + 1);
+        cache.flush();
+        runningMisses = runningTriangles = 0;
+      }
+    }
+  }
+  clusters.push_back(triangleCount);
+
+  float meshCentroid[3] = { 0, 0, 0 };
+  for(size_t i = 0; i < triangleCount * 3; i++) {
+    const float *p = positions + (size_t) indices[i] * positionStride;
+    for(int k = 0; k < 3; k++)
+      meshCentroid[k] += p[k];
+  }
+  for(int k = 0; k < 3; k++)
+    meshCentroid[k] /= (float) (triangleCount * 3);
+
+  // area weighted centroid and normal of every cluster
+  size_t clusterCount = clusters.size() - 1;
+  vector<pair<float, uint32_t> > keys(clusterCount);
+  for(size_t c = 0; c < clusterCount; c++) {
+    float centroid[3] = { 0, 0, 0 }, normal[3] = { 0, 0, 0 }, area = 0;
+    for(size_t t = clusters[c]; t < clusters[c + 1]; t++) {
+      const float *a = positions + (size_t) indices[t * 3] * positionStride;
+      const float *b = positions + (size_t) indices[t * 3 + 1] * positionStride;
+      const float *d = positions + (size_t) indices[t * 3 + 2] * positionStride;
+      float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] }, e2[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+      float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+      float w = sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      for(int k = 0; k < 3; k++) {
+        centroid[k] += (a[k] + b[k] + d[k]) * (w / 3);
+        normal[k] += n[k];
+      }
+      area += w;
+    }
+    float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    float key = 0;
+    if(area > 0 && length > 0) {
+      for(int k = 0; k < 3; k++)
+        key += (centroid[k] / area - meshCentroid[k]) * (normal[k] / length);
+    }
+    keys[c] = make_pair(-key, (uint32_t) c);
+  }
+  stable_sort(keys.begin(), keys.end(), [](const pair<float, uint32_t> &a, const pair<float, uint32_t> &b) {
+    return a.first < b.first;
+  });
+
+  vector<uint32_t> output;
+  output.reserve(triangleCount * 3);
+  for(size_t i = 0; i < clusterCount; i++) {
+    size_t c = keys[i].second;
+    output.insert(output.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+  }
+  memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+/*
+ * Vertex fetch
+ */
+
+size_t optimizeVertexFetch(void *vertices, size_t vertexSize, size_t vertexCount, uint32_t *indices, size_t indexCount) {
+  vector<uint32_t> remap(vertexCount, ~0u);
+  uint32_t used = 0;
+  for(size_t i = 0; i < indexCount; i++) {
+    uint32_t &to = remap[indices[i]];
+    if(to == ~0u)
+      to = used++;
+    indices[i] = to;
+  }
+  uint32_t next = used;
+  for(size_t v = 0; v < vertexCount; v++) {
+    if(remap[v] == ~0u)
+      remap[v] = next++;
+  }
+
+  vector<uint8_t> source((uint8_t *) vertices, (uint8_t *) vertices + vertexCount * vertexSize);
+  for(size_t v = 0; v < vertexCount; v++)
+    memcpy((uint8_t *) vertices + (size_t) remap[v] * vertexSize, &source[v * vertexSize], vertexSize);
+  return used;
+}
+
+/*
+ * Natives
+ */
+
+// Uint16Array or Uint32Array indices, widened to 32 bits for the optimizers
+// and narrowed back by store().
+struct IndexArg {
+  uint32_t *data;
+  size_t count;
+  uint16_t *narrow;
+  vector<uint32_t> wide;
+
+  bool get(Local<Value> value) {
+    size_t byteLength = 0;
+    narrow = NULL;
+    if(value->IsUint32Array()) {
+      data = marshal::ArrayData<uint32_t>(value, &byteLength);
+      count = byteLength / sizeof(uint32_t);
+      return true;
+    }
+    if(value->IsUint16Array()) {
+      narrow = marshal::ArrayData<uint16_t>(value, &byteLength);
+      count = byteLength / sizeof(uint16_t);
+      wide.assign(narrow, narrow + count);
+      data = wide.data();
+      return true;
+    }
+    return false;
+  }
+
+  // the largest index + 1
+  size_t range() const {
+    uint32_t largest = 0;
+    for(size_t i = 0; i < count; i++)
+      largest = max(largest, data[i]);
+    return count ? (size_t) largest + 1 : 0;
+  }
+
+  void store() {
+    if(narrow) {
+      for(size_t i = 0; i < count; i++)
+        narrow[i] = (uint16_t) data[i];
+    }
+  }
+};
+
+static bool indexArgs(IndexArg &indices, Local<Value> value, size_t vertexCount, const char *name) {
+  if(!indices.get(value)) {
+    Nan::ThrowTypeError((string(name) + ": expected a Uint16Array or Uint32Array of indices").c_str());
+    return false;
+  }
+  if(indices.range() > vertexCount) {
+    Nan::ThrowRangeError((string(name) + ": index out of range").c_str());
+    return false;
+  }
+  return true;
+}
+
+static Local<Object> statsObject(const VertexCacheStats &stats) {
+  Local<Object> result = Nan::New<Object>();
+  Nan::Set(result, JS_STR("misses"), JS_FLOAT((double) stats.misses));
+  Nan::Set(result, JS_STR("acmr"), JS_FLOAT(stats.acmr));
+  Nan::Set(result, JS_STR("atvr"), JS_FLOAT(stats.atvr));
+  return result;
+}
+
+NAN_METHOD(AnalyzeVertexCache) {
+  size_t vertexCount = marshal::Arg<GLuint>::Unbox(info[1]);
+  IndexArg indices;
+  if(!indexArgs(indices, info[0], vertexCount, "analyzeVertexCache"))
+    return;
+  unsigned cacheSize = info[2]->IsUndefined() ? 16 : marshal::Arg<GLuint>::Unbox(info[2]);
+  info.GetReturnValue().Set(statsObject(analyzeVertexCache(indices.data, indices.count, vertexCount, cacheSize)));
+}
+
+NAN_METHOD(OptimizeVertexCache) {
+  size_t vertexCount = marshal::Arg<GLuint>::Unbox(info[1]);
+  IndexArg indices;
+  if(!indexArgs(indices, info[0], vertexCount, "optimizeVertexCache"))
+    return;
+  optimizeVertexCache(indices.data, indices.count, vertexCount);
+  indices.store();
+}
+
+NAN_METHOD(OptimizeOverdraw) {
+  size_t positionStride = max(3u, marshal::Arg<GLuint>::Unbox(info[2]));
+  size_t vertexCount = marshal::Arg<GLuint>::Unbox(info[3]);
+  float threshold = (float) Nan::To<double>(info[4]).FromJust();
+  size_t byteLength = 0;
+  const float *positions = marshal::ArrayData<float>(info[1], &byteLength);
+  if(!info[1]->IsFloat32Array() || (vertexCount && byteLength / sizeof(float) < (vertexCount - 1) * positionStride + 3)) {
+    Nan::ThrowRangeError("optimizeOverdraw: expected a Float32Array with a position per vertex");
+    return;
+  }
+  IndexArg indices;
+  if(!indexArgs(indices, info[0], vertexCount, "optimizeOverdraw"))
+    return;
+  optimizeOverdraw(indices.data, indices.count, positions, positionStride, vertexCount, threshold);
+  indices.store();
+}
+
+NAN_METHOD(OptimizeVertexFetch) {
+  size_t vertexSize = marshal::Arg<GLuint>::Unbox(info[1]);
+  size_t byteLength = 0;
+  void *vertices = marshal::ArrayData<void>(info[0], &byteLength);
+  if(!vertices || !vertexSize) {
+    Nan::ThrowTypeError("optimizeVertexFetch: expected an ArrayBufferView of vertices and the vertex size");
+    return;
+  }
+  size_t vertexCount = byteLength / vertexSize;
+  IndexArg indices;
+  if(!indexArgs(indices, info[2], vertexCount, "optimizeVertexFetch"))
+    return;
+  size_t used = optimizeVertexFetch(vertices, vertexSize, vertexCount, indices.data, indices.count);
+  indices.store();
+  info.GetReturnValue().Set((uint32_t) used);
+}
+
+} // end namespace webgl
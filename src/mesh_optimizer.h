@@ -0,0 +1,56 @@
+/*
+ * mesh_optimizer.h
+ *
+ * Reorders indexed triangle meshes for the GPU: triangles for the
+ * post-transform vertex cache (Forsyth's linear-speed algorithm), then
+ * clusters of them front to back to cut overdraw without giving the cache
+ * gains back, then vertices in the order the indices first use them, so
+ * vertex fetch walks memory linearly. Everything works in place; the stats
+ * are the ACMR (vertex shader runs per triangle) and ATVR (runs per vertex)
+ * of a FIFO cache simulation, to compare before and after.
+ *
+ * The functions work on 32-bit indices and are used by the loaders on their
+ * worker threads; the natives also take Uint16Arrays.
+ */
+
+#ifndef MESH_OPTIMIZER_H_
+#define MESH_OPTIMIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common.h"
+
+namespace webgl {
+
+struct VertexCacheStats {
+  size_t misses;
+  // misses per triangle, 0.5 (every vertex once, in a regular grid) to 3
+  double acmr;
+  // misses per vertex, 1 is ideal
+  double atvr;
+};
+
+VertexCacheStats analyzeVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount, unsigned cacheSize = 16);
+
+void optimizeVertexCache(uint32_t *indices, size_t indexCount, size_t vertexCount);
+
+// Expects cache optimized indices. positions are 3 floats every
+// positionStride floats; threshold is how much worse than the input's the
+// ACMR may get (1.05 allows 5%).
+void optimizeOverdraw(uint32_t *indices, size_t indexCount, const float *positions, size_t positionStride,
+                      size_t vertexCount, float threshold);
+
+// Moves the vertices (vertexSize bytes each) into first use order and
+// rewrites the indices. Returns the number of vertices used; the unused ones
+// end up past it.
+size_t optimizeVertexFetch(void *vertices, size_t vertexSize, size_t vertexCount, uint32_t *indices, size_t indexCount);
+
+NAN_METHOD(AnalyzeVertexCache);
+NAN_METHOD(OptimizeVertexCache);
+NAN_METHOD(OptimizeOverdraw);
+NAN_METHOD(OptimizeVertexFetch);
+
+}
+
+#endif /* MESH_OPTIMIZER_H_ */
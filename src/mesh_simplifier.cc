@@ -0,0 +1,587 @@
+/*
+ * mesh_simplifier.cc
+ *
+ * gl.simplifyLods(indices, positions, positionStride, vertexCount, ratios,
+ *                 attributes, attributeStride, attributeWeights, lockBorder,
+ *                 maxError, callback)
+ *   callback(err, {indices, levels: [{ratio, first, count, error}]}): the
+ *   source triangles and then a level per ratio (of the source triangle
+ *   count) in one Buffer of the input's index type; error is the largest
+ *   collapse error relative to the mesh's extent
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mesh_simplifier.h"
+#include "marshal.h"
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+// how much more border planes weigh than the surface's
+static const double BORDER_WEIGHT = 10;
+
+struct Quadric {
+  // symmetric A, b and c of p'Ap + 2b'p + c, and the total weight
+  double a00, a11, a22, a01, a02, a12;
+  double b0, b1, b2;
+  double c, w;
+
+  void addPlane(const double *n, double d, double weight) {
+    a00 += weight * n[0] * n[0];
+    a11 += weight * n[1] * n[1];
+    a22 += weight * n[2] * n[2];
+    a01 += weight * n[0] * n[1];
+    a02 += weight * n[0] * n[2];
+    a12 += weight * n[1] * n[2];
+    b0 += weight * n[0] * d;
+    b1 += weight * n[1] * d;
+    b2 += weight * n[2] * d;
+    c += weight * d * d;
+    w += weight;
+  }
+
+  void add(const Quadric &q) {
+    a00 += q.a00; a11 += q.a11; a22 += q.a22;
+    a01 += q.a01; a02 += q.a02; a12 += q.a12;
+    b0 += q.b0; b1 += q.b1; b2 += q.b2;
+    c += q.c; w += q.w;
+  }
+
+  // squared distance, averaged over the planes
+  double error(const float *p) const {
+    double x = p[0], y = p[1], z = p[2];
+    double e = a00 * x * x + a11 * y * y + a22 * z * z + 2 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+               2 * (b0 * x + b1 * y + b2 * z) + c;
+    return w > 0 ? fabs(e) / w : 0;
+  }
+};
+
+static inline void sub(double *out, const float *a, const float *b) {
+  out[0] = (double) a[0] - b[0];
+  out[1] = (double) a[1] - b[1];
+  out[2] = (double) a[2] - b[2];
+}
+
+static inline void cross(double *out, const double *a, const double *b) {
+  out[0] = a[1] * b[2] - a[2] * b[1];
+  out[1] = a[2] * b[0] - a[0] * b[2];
+  out[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static inline double dot(const double *a, const double *b) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static inline double normalize(double *v) {
+  double length = sqrt(dot(v, v));
+  if(length > 0) {
+    v[0] /= length;
+    v[1] /= length;
+    v[2] /= length;
+  }
+  return length;
+}
+
+struct SimplifyJob {
+  // input
+  vector<uint32_t> source;
+  vector<float> positions;
+  vector<float> attributes;
+  vector<float> weights;
+  size_t vertexCount;
+  vector<double> ratios;
+  bool lockBorder;
+  double maxError;
+  bool indices32;
+
+  // output
+  vector<uint32_t> indices;
+  struct Level {
+    double ratio;
+    size_t first, count;
+    double error;
+  };
+  vector<Level> levels;
+};
+
+// Works on "positions": vertices with bitwise equal positions are one, the
+// vertices themselves are its wedges, kept apart by their attributes.
+class Simplifier {
+public:
+  explicit Simplifier(SimplifyJob &job) : job(job), error(0) {
+    size_t n = job.vertexCount;
+    // normalized to the unit cube, for the error and the quadrics' precision
+    float low[3] = { INFINITY, INFINITY, INFINITY }, high[3] = { -INFINITY, -INFINITY, -INFINITY };
+    for(size_t v = 0; v < n; v++) {
+      for(int k = 0; k < 3; k++) {
+        low[k] = min(low[k], job.positions[v * 3 + k]);
+        high[k] = max(high[k], job.positions[v * 3 + k]);
+      }
+    }
+    float extent = n ? max(high[0] - low[0], max(high[1] - low[1], high[2] - low[2])) : 0;
+    float scale = extent > 0 ? 1 / extent : 1;
+
+    canonical.resize(n);
+    unordered_map<string, uint32_t> unique;
+    for(size_t v = 0; v < n; v++) {
+      string key((const char *) &job.positions[v * 3], 3 * sizeof(float));
+      auto it = unique.insert(make_pair(key, (uint32_t) points.size() / 3));
+      if(it.second) {
+        for(int k = 0; k < 3; k++)
+          points.push_back((job.positions[v * 3 + k] - low[k]) * scale);
+      }
+      canonical[v] = it.first->second;
+    }
+    size_t pointCount = points.size() / 3;
+    quadrics.assign(pointCount, Quadric());
+    removed.assign(pointCount, 0);
+    touched.assign(pointCount, 0);
+    border.assign(pointCount, 0);
+
+    triangles = job.source;
+    for(size_t t = 0; t < triangles.size(); t += 3) {
+      const float *p0 = point(triangles[t]), *p1 = point(triangles[t + 1]), *p2 = point(triangles[t + 2]);
+      double e1[3], e2[3], normal[3];
+      sub(e1, p1, p0);
+      sub(e2, p2, p0);
+      cross(normal, e1, e2);
+      double area = normalize(normal) / 2;
+      if(area <= 0)
+        continue;
+      double d = -(normal[0] * p0[0] + normal[1] * p0[1] + normal[2] * p0[2]);
+      for(int k = 0; k < 3; k++)
+        quadrics[canonical[triangles[t + k]]].addPlane(normal, d, area);
+    }
+    dropDegenerate();
+    buildAdjacency();
+    addBorderQuadrics();
+  }
+
+  // Collapses until at most target triangles are left, or nothing can be
+  // collapsed within maxError.
+  void simplify(size_t targetTriangles) {
+    while(triangles.size() / 3 > targetTriangles) {
+      if(!pass(triangles.size() / 3 - targetTriangles))
+        break;
+      buildAdjacency();
+    }
+  }
+
+  const vector<uint32_t> &result() const { return triangles; }
+  double relativeError() const { return sqrt(error); }
+
+private:
+  const float *point(uint32_t vertex) const {
+    return &points[(size_t) canonical[vertex] * 3];
+  }
+
+  void dropDegenerate() {
+    size_t out = 0;
+    for(size_t t = 0; t < triangles.size(); t += 3) {
+      uint32_t a = canonical[triangles[t]], b = canonical[triangles[t + 1]], c = canonical[triangles[t + 2]];
+      if(a == b || b == c || a == c)
+        continue;
+      memmove(&triangles[out], &triangles[t], 3 * sizeof(uint32_t));
+      out += 3;
+    }
+    triangles.resize(out);
+  }
+
+  // triangles around every point, and which points are on an open (or non
+  // manifold) edge
+  void buildAdjacency() {
+    size_t pointCount = quadrics.size();
+    first.assign(pointCount + 1, 0);
+    for(size_t i = 0; i < triangles.size(); i++)
+      first[canonical[triangles[i]] + 1]++;
+    for(size_t p = 0; p < pointCount; p++)
+      first[p + 1] += first[p];
+    adjacent.resize(triangles.size());
+    vector<uint32_t> cursor(first.begin(), first.end() - 1);
+    for(size_t i = 0; i < triangles.size(); i++)
+      adjacent[cursor[canonical[triangles[i]]]++] = (uint32_t) (i / 3);
+
+    fill(border.begin(), border.end(), 0);
+    for(size_t p = 0; p < pointCount; p++) {
+      for(uint32_t j = first[p]; j < first[p + 1]; j++) {
+        uint32_t next = nextPoint(adjacent[j], (uint32_t) p);
+        if(edgeCount(next, (uint32_t) p) != 1 || edgeCount((uint32_t) p, next) != 1) {
+          border[p] = 1;
+          border[next] = 1;
+        }
+      }
+    }
+  }
+
+  // the point after p in triangle t's winding
+  uint32_t nextPoint(uint32_t t, uint32_t p) const {
+    for(int k = 0; k < 3; k++) {
+      if(canonical[triangles[t * 3 + k]] == p)
+        return canonical[triangles[t * 3 + (k + 1) % 3]];
+    }
+    return p;
+  }
+
+  // triangles with the directed edge a -> b
+  int edgeCount(uint32_t a, uint32_t b) const {
+    int count = 0;
+    for(uint32_t j = first[a]; j < first[a + 1]; j++)
+      count += nextPoint(adjacent[j], a) == b;
+    return count;
+  }
+
+  bool isBorderEdge(uint32_t a, uint32_t b) const {
+    return edgeCount(a, b) + edgeCount(b, a) == 1;
+  }
+
+  // planes through the open edges, perpendicular to their triangles, keep
+  // the outline in place
+  void addBorderQuadrics() {
+    for(size_t t = 0; t < triangles.size(); t += 3) {
+      for(int k = 0; k < 3; k++) {
+        uint32_t a = canonical[triangles[t + k]], b = canonical[triangles[t + (k + 1) % 3]];
+        if(edgeCount(b, a) != 0)
+          continue;
+        const float *pa = &points[a * 3], *pb = &points[b * 3], *pc = point(triangles[t + (k + 2) % 3]);
+        double edge[3], other[3], normal[3], plane[3];
+        sub(edge, pb, pa);
+        sub(other, pc, pa);
+        cross(normal, edge, other);
+        cross(plane, edge, normal);
+        double length = sqrt(dot(edge, edge));
+        if(normalize(plane) == 0)
+          continue;
+        double d = -(plane[0] * pa[0] + plane[1] * pa[1] + plane[2] * pa[2]);
+        quadrics[a].addPlane(plane, d, length * length * BORDER_WEIGHT);
+        quadrics[b].addPlane(plane, d, length * length * BORDER_WEIGHT);
+      }
+    }
+  }
+
+  double attributeDistance(uint32_t a, uint32_t b) const {
+    size_t count = job.weights.size();
+    const float *x = &job.attributes[(size_t) a * count], *y = &job.attributes[(size_t) b * count];
+    double sum = 0;
+    for(size_t k = 0; k < count; k++)
+      sum += job.weights[k] * (double) (x[k] - y[k]) * (x[k] - y[k]);
+    return sum;
+  }
+
+  // the wedges (vertices) of point p used by its triangles
+  void wedges(uint32_t p, vector<uint32_t> &out) const {
+    out.clear();
+    for(uint32_t j = first[p]; j < first[p + 1]; j++) {
+      for(int k = 0; k < 3; k++) {
+        uint32_t v = triangles[adjacent[j] * 3 + k];
+        if(canonical[v] == p && find(out.begin(), out.end(), v) == out.end())
+          out.push_back(v);
+      }
+    }
+  }
+
+  // The attribute cost of moving a's wedges onto b's closest ones, which
+  // are stored in remap when given.
+  double wedgeCost(uint32_t a, uint32_t b, vector<pair<uint32_t, uint32_t> > *remap) {
+    wedges(a, from);
+    wedges(b, to);
+    double worst = 0;
+    for(size_t i = 0; i < from.size(); i++) {
+      double best = INFINITY;
+      uint32_t closest = to[0];
+      for(size_t j = 0; j < to.size() && best > 0; j++) {
+        double d = job.weights.empty() ? 0 : attributeDistance(from[i], to[j]);
+        if(d < best) {
+          best = d;
+          closest = to[j];
+        }
+      }
+      worst = max(worst, best);
+      if(remap)
+        remap->push_back(make_pair(from[i], closest));
+    }
+    return worst;
+  }
+
+  void neighbours(uint32_t p, vector<uint32_t> &out) const {
+    out.clear();
+    for(uint32_t j = first[p]; j < first[p + 1]; j++) {
+      for(int k = 0; k < 3; k++) {
+        uint32_t q = canonical[triangles[adjacent[j] * 3 + k]];
+        if(q != p && find(out.begin(), out.end(), q) == out.end())
+          out.push_back(q);
+      }
+    }
+  }
+
+  bool collapsible(uint32_t a, uint32_t b) {
+    bool borderEdge = isBorderEdge(a, b);
+    if(border[a]) {
+      if(job.lockBorder || !borderEdge)
+        return false;
+    }
+    // link condition: no more shared neighbours than the edge's triangles,
+    // or the collapse pinches the surface
+    neighbours(a, around);
+    neighbours(b, aroundOther);
+    int shared = 0;
+    for(size_t i = 0; i < around.size(); i++)
+      shared += find(aroundOther.begin(), aroundOther.end(), around[i]) != aroundOther.end();
+    return shared <= (borderEdge ? 1 : 2);
+  }
+
+  // no triangle around a that stays may turn over when a moves to b
+  bool flips(uint32_t a, uint32_t b) const {
+    const float *target = &points[b * 3];
+    for(uint32_t j = first[a]; j < first[a + 1]; j++) {
+      uint32_t t = adjacent[j];
+      const float *p[3], *moved[3];
+      bool hasB = false;
+      for(int k = 0; k < 3; k++) {
+        uint32_t q = canonical[triangles[t * 3 + k]];
+        hasB |= q == b;
+        p[k] = &points[q * 3];
+        moved[k] = q == a ? target : p[k];
+      }
+      if(hasB)
+        continue;
+      double e1[3], e2[3], before[3], after[3];
+      sub(e1, p[1], p[0]);
+      sub(e2, p[2], p[0]);
+      cross(before, e1, e2);
+      sub(e1, moved[1], moved[0]);
+      sub(e2, moved[2], moved[0]);
+      cross(after, e1, e2);
+      if(dot(before, after) <= 0)
+        return true;
+    }
+    return false;
+  }
+
+  // One round of independent collapses, cheapest first. Returns how many.
+  size_t pass(size_t excessTriangles) {
+    size_t pointCount = quadrics.size();
+    struct Candidate {
+      // error is the geometric part of cost
+      double cost, error;
+      uint32_t from, to;
+    };
+    vector<Candidate> candidates;
+    for(uint32_t a = 0; a < pointCount; a++) {
+      if(removed[a] || first[a] == first[a + 1] || (border[a] && job.lockBorder))
+        continue;
+      Candidate best = { INFINITY, 0, a, a };
+      for(uint32_t j = first[a]; j < first[a + 1]; j++) {
+        for(int k = 0; k < 3; k++) {
+          uint32_t b = canonical[triangles[adjacent[j] * 3 + k]];
+          if(b == a || b == best.to)
+            continue;
+          if(border[a] && !isBorderEdge(a, b))
+            continue;
+          Quadric q = quadrics[a];
+          q.add(quadrics[b]);
+          double error = q.error(&points[b * 3]);
+          double cost = error + wedgeCost(a, b, NULL);
+          if(cost < best.cost) {
+            best.cost = cost;
+            best.error = error;
+            best.to = b;
+          }
+        }
+      }
+      if(best.to != a && best.cost <= job.maxError)
+        candidates.push_back(best);
+    }
+    sort(candidates.begin(), candidates.end(), [](const Candidate &x, const Candidate &y) {
+      return x.cost < y.cost;
+    });
+
+    fill(touched.begin(), touched.end(), 0);
+    vector<pair<uint32_t, uint32_t> > remap;
+    size_t collapses = 0, removedTriangles = 0;
+    for(size_t i = 0; i < candidates.size() && removedTriangles < excessTriangles; i++) {
+      uint32_t a = candidates[i].from, b = candidates[i].to;
+      if(touched[a] || touched[b] || !collapsible(a, b) || flips(a, b))
+        continue;
+
+      size_t before = remap.size();
+      wedgeCost(a, b, &remap);
+      for(uint32_t j = first[a]; j < first[a + 1]; j++) {
+        bool hasB = false;
+        for(int k = 0; k < 3; k++) {
+          uint32_t q = canonical[triangles[adjacent[j] * 3 + k]];
+          touched[q] = 1;
+          hasB |= q == b;
+        }
+        removedTriangles += hasB;
+      }
+      touched[b] = 1;
+      quadrics[b].add(quadrics[a]);
+      removed[a] = 1;
+      error = max(error, candidates[i].error);
+      collapses += remap.size() > before;
+    }
+    if(!collapses)
+      return 0;
+
+    // wedges of collapsed points move to the target's; targets were touched,
+    // so nothing is moved twice
+    vector<uint32_t> forward(job.vertexCount);
+    for(size_t v = 0; v < forward.size(); v++)
+      forward[v] = (uint32_t) v;
+    for(size_t i = 0; i < remap.size(); i++)
+      forward[remap[i].first] = remap[i].second;
+    for(size_t i = 0; i < triangles.size(); i++)
+      triangles[i] = forward[triangles[i]];
+    dropDegenerate();
+    return collapses;
+  }
+
+  SimplifyJob &job;
+  vector<uint32_t> canonical;
+  vector<float> points;
+  vector<Quadric> quadrics;
+  vector<uint8_t> removed, touched, border;
+  vector<uint32_t> triangles;
+  vector<uint32_t> first, adjacent;
+  vector<uint32_t> from, to, around, aroundOther;
+  double error;
+};
+
+class SimplifyWorker : public Nan::AsyncWorker {
+public:
+  SimplifyWorker(Nan::Callback *callback, SimplifyJob *job)
+    : Nan::AsyncWorker(callback, "webgl:simplifyLods"), job(job) {}
+
+  ~SimplifyWorker() {
+    delete job;
+  }
+
+  void Execute() {
+    size_t sourceTriangles = job->source.size() / 3;
+    job->indices = job->source;
+    job->levels.push_back(SimplifyJob::Level { 1, 0, job->source.size(), 0 });
+
+    // largest first, each level continues from the previous one
+    vector<double> ratios = job->ratios;
+    sort(ratios.begin(), ratios.end(), greater<double>());
+    Simplifier simplifier(*job);
+    for(size_t i = 0; i < ratios.size(); i++) {
+      simplifier.simplify((size_t) (sourceTriangles * max(0.0, ratios[i])));
+      const vector<uint32_t> &triangles = simplifier.result();
+      job->levels.push_back(SimplifyJob::Level { ratios[i], job->indices.size(), triangles.size(), simplifier.relativeError() });
+      job->indices.insert(job->indices.end(), triangles.begin(), triangles.end());
+    }
+  }
+
+  void HandleOKCallback() {
+    Nan::HandleScope scope;
+    size_t count = job->indices.size();
+    Local<Object> indices;
+    if(job->indices32) {
+      indices = Nan::CopyBuffer((const char *) job->indices.data(), count * sizeof(uint32_t)).ToLocalChecked();
+    } else {
+      vector<uint16_t> narrow(job->indices.begin(), job->indices.end());
+      indices = Nan::CopyBuffer((const char *) narrow.data(), count * sizeof(uint16_t)).ToLocalChecked();
+    }
+
+    Local<Array> levels = Nan::New<Array>((int) job->levels.size());
+    for(size_t i = 0; i < job->levels.size(); i++) {
+      const SimplifyJob::Level &l = job->levels[i];
+      Local<Object> level = Nan::New<Object>();
+      Nan::Set(level, JS_STR("ratio"), JS_FLOAT(l.ratio));
+      Nan::Set(level, JS_STR("first"), JS_FLOAT((double) l.first));
+      Nan::Set(level, JS_STR("count"), JS_FLOAT((double) l.count));
+      Nan::Set(level, JS_STR("error"), JS_FLOAT(l.error));
+      Nan::Set(levels, (uint32_t) i, level);
+    }
+
+    Local<Object> result = Nan::New<Object>();
+    Nan::Set(result, JS_STR("indices"), indices);
+    Nan::Set(result, JS_STR("levels"), levels);
+    Local<Value> argv[] = { Nan::Null(), result };
+    callback->Call(2, argv, async_resource);
+  }
+
+private:
+  SimplifyJob *job;
+};
+
+NAN_METHOD(SimplifyLods) {
+  if(info.Length() < 11 || !info[10]->IsFunction()) {
+    Nan::ThrowTypeError("Expected simplifyLods(indices, positions, positionStride, vertexCount, ratios, attributes, "
+                        "attributeStride, attributeWeights, lockBorder, maxError, callback)");
+    return;
+  }
+  SimplifyJob *job = new SimplifyJob();
+  size_t positionStride = max(3u, marshal::Arg<GLuint>::Unbox(info[2]));
+  job->vertexCount = marshal::Arg<GLuint>::Unbox(info[3]);
+  job->lockBorder = Nan::To<bool>(info[8]).FromJust();
+  double maxError = Nan::To<double>(info[9]).FromJust();
+  // compared with squared errors
+  job->maxError = maxError * maxError;
+
+  size_t byteLength = 0;
+  bool ok = true;
+  if(info[0]->IsUint32Array()) {
+    const uint32_t *indices = marshal::ArrayData<uint32_t>(info[0], &byteLength);
+    job->source.assign(indices, indices + byteLength / sizeof(uint32_t));
+    job->indices32 = true;
+  } else if(info[0]->IsUint16Array()) {
+    const uint16_t *indices = marshal::ArrayData<uint16_t>(info[0], &byteLength);
+    job->source.assign(indices, indices + byteLength / sizeof(uint16_t));
+    job->indices32 = false;
+  } else {
+    ok = false;
+  }
+  job->source.resize(job->source.size() / 3 * 3);
+  for(size_t i = 0; ok && i < job->source.size(); i++)
+    ok = job->source[i] < job->vertexCount;
+
+  const float *positions = marshal::ArrayData<float>(info[1], &byteLength);
+  size_t n = job->vertexCount;
+  ok = ok && info[1]->IsFloat32Array() && (!n || byteLength / sizeof(float) >= (n - 1) * positionStride + 3);
+  if(ok) {
+    job->positions.resize(n * 3);
+    for(size_t v = 0; v < n; v++)
+      memcpy(&job->positions[v * 3], positions + v * positionStride, 3 * sizeof(float));
+  }
+
+  const double *ratios = marshal::ArrayData<double>(info[4], &byteLength);
+  ok = ok && info[4]->IsFloat64Array();
+  if(ok)
+    job->ratios.assign(ratios, ratios + byteLength / sizeof(double));
+
+  if(ok && info[7]->IsFloat32Array()) {
+    const float *weights = marshal::ArrayData<float>(info[7], &byteLength);
+    job->weights.assign(weights, weights + byteLength / sizeof(float));
+    size_t stride = max<size_t>(job->weights.size(), marshal::Arg<GLuint>::Unbox(info[6]));
+    const float *attributes = marshal::ArrayData<float>(info[5], &byteLength);
+    size_t count = job->weights.size();
+    ok = info[5]->IsFloat32Array() && (!n || byteLength / sizeof(float) >= (n - 1) * stride + count);
+    if(ok) {
+      job->attributes.resize(n * count);
+      for(size_t v = 0; v < n; v++)
+        memcpy(&job->attributes[v * count], attributes + v * stride, count * sizeof(float));
+    }
+  }
+
+  if(!ok) {
+    delete job;
+    Nan::ThrowRangeError("simplifyLods: expected Uint16Array or Uint32Array indices below vertexCount, Float32Array "
+                         "positions and attributes for every vertex and Float64Array ratios");
+    return;
+  }
+  Nan::Callback *callback = new Nan::Callback(info[10].As<Function>());
+  Nan::AsyncQueueWorker(new SimplifyWorker(callback, job));
+}
+
+} // end namespace webgl
@@ -0,0 +1,24 @@
+/*
+ * mesh_simplifier.h
+ *
+ * Level of detail chains from indexed triangle meshes, on a worker thread.
+ * Vertices are collapsed onto neighbours in order of quadric error (Garland
+ * and Heckbert) plus the change in their attributes, so seams and UV
+ * islands survive as long as they matter; open borders are only collapsed
+ * along themselves, or not at all when locked. Every level reuses the
+ * source vertices and goes into one index buffer after the source triangles,
+ * so a level is drawn with the same vertex buffer at an index offset.
+ */
+
+#ifndef MESH_SIMPLIFIER_H_
+#define MESH_SIMPLIFIER_H_
+
+#include "common.h"
+
+namespace webgl {
+
+NAN_METHOD(SimplifyLods);
+
+}
+
+#endif /* MESH_SIMPLIFIER_H_ */
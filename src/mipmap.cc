@@ -0,0 +1,234 @@
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define WEBGL_MIPMAP_SSE2
+  #include <emmintrin.h>
+#endif
+
+#include "mipmap.h"
+#include "parallel.h"
+
+namespace webgl {
+
+using namespace std;
+
+int MipLevelCount(int width, int height) {
+  int levels = 1;
+  int size = width > height ? width : height;
+  while(size > 1) {
+    size >>= 1;
+    ++levels;
+  }
+  return levels;
+}
+
+/*
+ * sRGB <-> linear
+ */
+
+struct SRGBTables {
+  float toLinear[256];
+  uint8_t fromLinear[4096];
+
+  SRGBTables() {
+    for(int i = 0; i < 256; i++) {
+      float c = i / 255.0f;
+      toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+    for(int i = 0; i < 4096; i++) {
+      float l = i / 4095.0f;
+      float c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1 / 2.4f) - 0.055f;
+      fromLinear[i] = (uint8_t)(c * 255 + 0.5f);
+    }
+  }
+};
+
+static const SRGBTables &srgbTables() {
+  static const SRGBTables tables;
+  return tables;
+}
+
+/*
+ * Filters. Both are evaluated in destination pixel units, so the same kernel
+ * serves any (including non power of two) reduction.
+ */
+
+static const float pi = 3.14159265358979323846f;
+static const float kaiserRadius = 1.5f;
+static const float kaiserAlpha = 4.0f;
+
+static float besselI0(float x) {
+  float sum = 1, term = 1;
+  float q = x * x / 4;
+  for(int k = 1; k < 20; k++) {
+    term *= q / (k * k);
+    sum += term;
+  }
+  return sum;
+}
+
+static float kaiserKernel(float t) {
+  t = fabsf(t);
+  if(t >= kaiserRadius)
+    return 0;
+  float sinc = t < 1e-5f ? 1 : sinf(pi * t) / (pi * t);
+  float u = t / kaiserRadius;
+  return sinc * besselI0(kaiserAlpha * sqrtf(1 - u * u)) / besselI0(kaiserAlpha);
+}
+
+// Source taps of every destination pixel along one axis.
+struct FilterTaps {
+  int maxTaps;
+  vector<int> index;      // dstSize * maxTaps, clamped to the source
+  vector<float> weight;   // dstSize * maxTaps, normalized, 0 padded
+};
+
+static void buildTaps(int srcSize, int dstSize, MipFilter filter, FilterTaps &taps) {
+  float scale = (float) srcSize / dstSize;
+  float radius = (filter == MIP_FILTER_BOX ? 0.5f : kaiserRadius) * scale;
+
+  taps.maxTaps = (int) ceilf(radius * 2) + 1;
+  taps.index.assign((size_t) dstSize * taps.maxTaps, 0);
+  taps.weight.assign((size_t) dstSize * taps.maxTaps, 0);
+
+  for(int d = 0; d < dstSize; d++) {
+    float center = (d + 0.5f) * scale;
+    int first = (int) floorf(center - radius - 0.5f);
+    int *index = &taps.index[(size_t) d * taps.maxTaps];
+    float *weight = &taps.weight[(size_t) d * taps.maxTaps];
+
+    float sum = 0;
+    for(int k = 0; k < taps.maxTaps; k++) {
+      int s = first + k;
+      float t = (s + 0.5f - center) / scale;
+      float w = filter == MIP_FILTER_BOX ? (fabsf(t) < 0.5f ? 1.0f : 0.0f) : kaiserKernel(t);
+      index[k] = s < 0 ? 0 : (s >= srcSize ? srcSize - 1 : s);
+      weight[k] = w;
+      sum += w;
+    }
+
+    if(sum <= 0) {
+      // can only happen for a box straddling pixel edges; take the nearest
+      int s = (int) center;
+      index[0] = s >= srcSize ? srcSize - 1 : s;
+      weight[0] = 1;
+      for(int k = 1; k < taps.maxTaps; k++)
+        weight[k] = 0;
+    }
+    else {
+      for(int k = 0; k < taps.maxTaps; k++)
+        weight[k] /= sum;
+    }
+  }
+}
+
+// dst = sum of weight[k] * src[index[k] * stride], all pixels as 4 floats.
+static inline void filterPixel(const float *src, size_t stride, const int *index, const float *weight,
+                               int count, float *dst) {
+#ifdef WEBGL_MIPMAP_SSE2
+  __m128 acc = _mm_setzero_ps();
+  for(int k = 0; k < count; k++)
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weight[k]), _mm_loadu_ps(src + index[k] * stride)));
+  _mm_storeu_ps(dst, acc);
+#else
+  float acc[4] = { 0, 0, 0, 0 };
+  for(int k = 0; k < count; k++) {
+    const float *p = src + index[k] * stride;
+    for(int c = 0; c < 4; c++)
+      acc[c] += weight[k] * p[c];
+  }
+  for(int c = 0; c < 4; c++)
+    dst[c] = acc[c];
+#endif
+}
+
+// Separable resample of a 4 float per pixel image.
+static void downsample(const vector<float> &src, int srcWidth, int srcHeight, vector<float> &dst,
+                       int dstWidth, int dstHeight, MipFilter filter, int threads) {
+  FilterTaps tapsX, tapsY;
+  buildTaps(srcWidth, dstWidth, filter, tapsX);
+  buildTaps(srcHeight, dstHeight, filter, tapsY);
+
+  // horizontal pass: every source row, destination width
+  vector<float> tmp((size_t) dstWidth * srcHeight * 4);
+  ParallelFor(srcHeight, threads, [&](int y) {
+    const float *row = &src[(size_t) y * srcWidth * 4];
+    float *out = &tmp[(size_t) y * dstWidth * 4];
+    for(int x = 0; x < dstWidth; x++)
+      filterPixel(row, 4, &tapsX.index[(size_t) x * tapsX.maxTaps], &tapsX.weight[(size_t) x * tapsX.maxTaps],
+                  tapsX.maxTaps, out + x * 4);
+  });
+
+  // vertical pass
+  dst.resize((size_t) dstWidth * dstHeight * 4);
+  size_t stride = (size_t) dstWidth * 4;
+  ParallelFor(dstHeight, threads, [&](int y) {
+    const int *index = &tapsY.index[(size_t) y * tapsY.maxTaps];
+    const float *weight = &tapsY.weight[(size_t) y * tapsY.maxTaps];
+    float *out = &dst[(size_t) y * stride];
+    for(int x = 0; x < dstWidth; x++)
+      filterPixel(&tmp[x * 4], stride, index, weight, tapsY.maxTaps, out + x * 4);
+  });
+}
+
+static void toFloat(const uint8_t *rgba, size_t pixels, bool gammaCorrect, vector<float> &out) {
+  const SRGBTables &tables = srgbTables();
+  out.resize(pixels * 4);
+  for(size_t i = 0; i < pixels * 4; i += 4) {
+    for(int c = 0; c < 3; c++)
+      out[i + c] = gammaCorrect ? tables.toLinear[rgba[i + c]] : rgba[i + c] / 255.0f;
+    out[i + 3] = rgba[i + 3] / 255.0f;
+  }
+}
+
+static inline uint8_t toByte(float v) {
+  v = v < 0 ? 0 : (v > 1 ? 1 : v);
+  return (uint8_t)(v * 255 + 0.5f);
+}
+
+static void fromFloat(const vector<float> &in, bool gammaCorrect, uint8_t *rgba) {
+  const SRGBTables &tables = srgbTables();
+  for(size_t i = 0; i < in.size(); i += 4) {
+    for(int c = 0; c < 3; c++) {
+      if(gammaCorrect) {
+        float v = in[i + c];
+        v = v < 0 ? 0 : (v > 1 ? 1 : v);
+        rgba[i + c] = tables.fromLinear[(int)(v * 4095 + 0.5f)];
+      }
+      else
+        rgba[i + c] = toByte(in[i + c]);
+    }
+    rgba[i + 3] = toByte(in[i + 3]);
+  }
+}
+
+void GenerateMipChain(const uint8_t *rgba, int width, int height, MipFilter filter, bool gammaCorrect,
+                      int threads, vector<MipLevel> &levels) {
+  int count = MipLevelCount(width, height);
+  if(count <= 1)
+    return;
+
+  // each level is filtered from the previous one at full precision, so
+  // rounding errors don't accumulate down the chain
+  vector<float> current, next;
+  toFloat(rgba, (size_t) width * height, gammaCorrect, current);
+
+  for(int level = 1; level < count; level++) {
+    int w = width >> 1 > 0 ? width >> 1 : 1;
+    int h = height >> 1 > 0 ? height >> 1 : 1;
+    downsample(current, width, height, next, w, h, filter, threads);
+
+    MipLevel out;
+    out.width = w;
+    out.height = h;
+    out.rgba.resize((size_t) w * h * 4);
+    fromFloat(next, gammaCorrect, &out.rgba[0]);
+    levels.push_back(out);
+
+    current.swap(next);
+    width = w;
+    height = h;
+  }
+}
+
+} // end namespace webgl
@@ -0,0 +1,40 @@
+/*
+ * mipmap.h
+ *
+ * CPU mip chain generation for RGBA8 images, so texture loaders can upload
+ * complete chains (including block compressed ones, which the GL cannot
+ * mipmap) without a glGenerateMipmap pass on the render thread.
+ */
+
+#ifndef MIPMAP_H_
+#define MIPMAP_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace webgl {
+
+enum MipFilter {
+  MIP_FILTER_BOX,     // 2x2 average, cheapest
+  MIP_FILTER_KAISER   // Kaiser windowed sinc, sharper minification
+};
+
+struct MipLevel {
+  int width;
+  int height;
+  std::vector<uint8_t> rgba;
+};
+
+// Number of levels in a full chain down to 1x1.
+int MipLevelCount(int width, int height);
+
+// Appends levels 1..MipLevelCount-1 of the tightly packed RGBA8 base image to
+// levels. With gammaCorrect the colour channels are treated as sRGB and
+// filtered in linear space; alpha is always linear. threads <= 0 uses every
+// core.
+void GenerateMipChain(const uint8_t *rgba, int width, int height, MipFilter filter, bool gammaCorrect,
+                      int threads, std::vector<MipLevel> &levels);
+
+} // end namespace webgl
+
+#endif /* MIPMAP_H_ */
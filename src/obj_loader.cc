@@ -0,0 +1,993 @@
+/*
+ * obj_loader.cc
+ *
+ * gl.loadObj(path, index32, upload, threads, progress, callback)
+ *   progress(fraction) is called as the stages complete, callback(err, result)
+ *   gets {vertices, indices | vertexBuffer, indexBuffer, vertexCount,
+ *   indexCount, indexType, stride, texcoordOffset, normalOffset, groups,
+ *   materials, bounds, warnings, [optimization]}
+ * gl.loadObj(path, index32, upload, threads, progress, callback, optimize)
+ *   also runs the mesh optimizer on every group, optimization is the
+ *   {before, after} vertex cache stats
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "obj_loader.h"
+#include "gl_objects.h"
+#include "mapped_file.h"
+#include "mesh_optimizer.h"
+#include "parallel.h"
+#include <GL/glew.h>
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+// bytes of OBJ text per parse task
+static const size_t OBJ_CHUNK = 4 << 20;
+
+/*
+ * Number parsing
+ */
+
+static const double powersOf10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool isDigit(char c) {
+  return (unsigned) (c - '0') < 10;
+}
+
+static inline const char *skipSpaces(const char *p, const char *end) {
+  while(p < end && (*p == ' ' || *p == '\t'))
+    p++;
+  return p;
+}
+
+// Decimal floats like strtod (no hex, inf or nan) without the locale and
+// the exact rounding: the result can be off by one in the last bit, which
+// doesn't matter for vertex data.
+static inline const char *parseFloat(const char *p, const char *end, float *out) {
+  p = skipSpaces(p, end);
+  bool negative = false;
+  if(p < end && (*p == '-' || *p == '+'))
+    negative = *p++ == '-';
+
+  uint64_t mantissa = 0;
+  int exponent = 0, digits = 0;
+  for(; p < end && isDigit(*p); p++) {
+    if(digits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      digits += mantissa != 0;
+    } else {
+      exponent++;
+    }
+  }
+  if(p < end && *p == '.') {
+    for(p++; p < end && isDigit(*p); p++) {
+      if(digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits += mantissa != 0;
+        exponent--;
+      }
+    }
+  }
+  if(p < end && (*p == 'e' || *p == 'E')) {
+    p++;
+    bool negativeExponent = false;
+    if(p < end && (*p == '-' || *p == '+'))
+      negativeExponent = *p++ == '-';
+    int e = 0;
+    for(; p < end && isDigit(*p); p++) {
+      if(e < 10000)
+        e = e * 10 + (*p - '0');
+    }
+    exponent += negativeExponent ? -e : e;
+  }
+
+  double value = (double) mantissa;
+  if(exponent < 0)
+    value = exponent >= -22 ? value / powersOf10[-exponent] : value * pow(10.0, exponent);
+  else if(exponent > 0)
+    value = exponent <= 22 ? value * powersOf10[exponent] : value * pow(10.0, exponent);
+  *out = (float) (negative ? -value : value);
+  return p;
+}
+
+// returns NULL if there is no number; values past INT32_MAX stop growing but
+// stay past it
+static inline const char *parseIndex(const char *p, const char *end, int64_t *out) {
+  bool negative = false;
+  if(p < end && (*p == '-' || *p == '+'))
+    negative = *p++ == '-';
+  if(p >= end || !isDigit(*p))
+    return NULL;
+  int64_t value = 0;
+  for(; p < end && isDigit(*p); p++) {
+    if(value <= INT32_MAX)
+      value = value * 10 + (*p - '0');
+  }
+  *out = negative ? -value : value;
+  return p;
+}
+
+static string trimmed(const char *p, const char *end) {
+  p = skipSpaces(p, end);
+  while(end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+    end--;
+  return string(p, end);
+}
+
+static bool startsWith(const char *p, const char *end, const char *keyword) {
+  size_t length = strlen(keyword);
+  return (size_t) (end - p) > length && memcmp(p, keyword, length) == 0 && (p[length] == ' ' || p[length] == '\t');
+}
+
+/*
+ * OBJ parsing
+ */
+
+enum { CORNER_POSITION, CORNER_TEXCOORD, CORNER_NORMAL };
+
+struct ObjChunk {
+  const char *begin;
+  const char *end;
+  vector<float> positions;
+  vector<float> texcoords;
+  vector<float> normals;
+  // position, texcoord, normal per triangle corner, 0 based; -1 for a missing
+  // texcoord or normal
+  vector<int32_t> corners;
+  // corners slots holding negative (relative) OBJ indices, which are only
+  // resolved against this chunk's own counts until the bases are known
+  vector<uint32_t> relative;
+  // (first triangle, usemtl name)
+  vector<pair<uint32_t, string> > materials;
+  vector<string> libraries;
+  string error;
+
+  uint32_t bases[3];
+  uint64_t cornerBase;
+  bool hasTexcoords;
+  bool hasNormals;
+};
+
+static void parseChunk(ObjChunk &chunk) {
+  const char *p = chunk.begin, *end = chunk.end;
+  int32_t faceCorner[3][3];
+  bool faceRelative[3][3];
+
+  while(p < end) {
+    const char *lineEnd = (const char *) memchr(p, '\n', end - p);
+    if(!lineEnd)
+      lineEnd = end;
+    const char *line = skipSpaces(p, lineEnd);
+    p = lineEnd + 1;
+    if(line >= lineEnd)
+      continue;
+
+    if(line[0] == 'v' && line + 1 < lineEnd) {
+      float v[3] = { 0, 0, 0 };
+      if(line[1] == ' ' || line[1] == '\t') {
+        for(int k = 0; k < 3; k++)
+          line = parseFloat(line + (k == 0 ? 1 : 0), lineEnd, &v[k]);
+        chunk.positions.insert(chunk.positions.end(), v, v + 3);
+      } else if(line[1] == 't') {
+        for(int k = 0; k < 2; k++)
+          line = parseFloat(line + (k == 0 ? 2 : 0), lineEnd, &v[k]);
+        chunk.texcoords.insert(chunk.texcoords.end(), v, v + 2);
+      } else if(line[1] == 'n') {
+        for(int k = 0; k < 3; k++)
+          line = parseFloat(line + (k == 0 ? 2 : 0), lineEnd, &v[k]);
+        chunk.normals.insert(chunk.normals.end(), v, v + 3);
+      }
+    } else if(line[0] == 'f' && line + 1 < lineEnd && (line[1] == ' ' || line[1] == '\t')) {
+      const char *q = line + 1;
+      uint32_t counts[3] = { (uint32_t) chunk.positions.size() / 3, (uint32_t) chunk.texcoords.size() / 2,
+                             (uint32_t) chunk.normals.size() / 3 };
+      int n = 0;
+      while(true) {
+        q = skipSpaces(q, lineEnd);
+        if(q >= lineEnd || *q == '\r')
+          break;
+
+        int32_t corner[3] = { -1, -1, -1 };
+        bool relative[3] = { false, false, false };
+        for(int k = 0; k < 3; k++) {
+          if(k > 0) {
+            if(q >= lineEnd || *q != '/')
+              break;
+            q++;
+          }
+          int64_t index;
+          const char *next = parseIndex(q, lineEnd, &index);
+          if(!next) {
+            if(k == 0) {
+              chunk.error = "loadObj: malformed face: " + trimmed(line, lineEnd);
+              return;
+            }
+            continue;
+          }
+          q = next;
+          if(index == 0) {
+            chunk.error = "loadObj: index 0 in face: " + trimmed(line, lineEnd);
+            return;
+          }
+          // corners are int32_t, and no file has this many vertices anyway
+          if(index > INT32_MAX || index < -INT32_MAX) {
+            chunk.error = "loadObj: face index out of range: " + trimmed(line, lineEnd);
+            return;
+          }
+          relative[k] = index < 0;
+          corner[k] = (int32_t) (index < 0 ? counts[k] + index : index - 1);
+        }
+
+        // fan triangulation: (0, n - 1, n)
+        int slot = n < 2 ? n : 2;
+        if(n >= 3) {
+          memcpy(faceCorner[1], faceCorner[2], sizeof(faceCorner[1]));
+          memcpy(faceRelative[1], faceRelative[2], sizeof(faceRelative[1]));
+        }
+        memcpy(faceCorner[slot], corner, sizeof(corner));
+        memcpy(faceRelative[slot], relative, sizeof(relative));
+        if(++n >= 3) {
+          for(int c = 0; c < 3; c++) {
+            for(int k = 0; k < 3; k++) {
+              if(faceRelative[c][k])
+                chunk.relative.push_back((uint32_t) chunk.corners.size());
+              chunk.corners.push_back(faceCorner[c][k]);
+            }
+          }
+        }
+      }
+    } else if(startsWith(line, lineEnd, "usemtl")) {
+      chunk.materials.push_back(make_pair((uint32_t) (chunk.corners.size() / 9), trimmed(line + 6, lineEnd)));
+    } else if(startsWith(line, lineEnd, "mtllib")) {
+      const char *q = line + 6;
+      while(true) {
+        q = skipSpaces(q, lineEnd);
+        const char *nameEnd = q;
+        while(nameEnd < lineEnd && *nameEnd != ' ' && *nameEnd != '\t' && *nameEnd != '\r')
+          nameEnd++;
+        if(nameEnd == q)
+          break;
+        chunk.libraries.push_back(string(q, nameEnd));
+        q = nameEnd;
+      }
+    }
+  }
+}
+
+/*
+ * MTL parsing
+ */
+
+struct ObjMaterial {
+  string name;
+  float ambient[3];
+  float diffuse[3];
+  float specular[3];
+  float emissive[3];
+  float shininess;
+  float opacity;
+  float ior;
+  int illum;
+  // (map name, path relative to the working directory)
+  vector<pair<string, string> > maps;
+
+  explicit ObjMaterial(const string &name) : name(name), shininess(0), opacity(1), ior(1), illum(-1) {
+    for(int k = 0; k < 3; k++) {
+      ambient[k] = 0;
+      diffuse[k] = 0.8f;
+      specular[k] = 0;
+      emissive[k] = 0;
+    }
+  }
+};
+
+static string directoryOf(const string &path) {
+  size_t slash = path.find_last_of("/\\");
+  return slash == string::npos ? string() : path.substr(0, slash + 1);
+}
+
+static const struct { const char *keyword; const char *map; } mtlMaps[] = {
+  { "map_Ka", "ambient" }, { "map_Kd", "diffuse" }, { "map_Ks", "specular" }, { "map_Ke", "emissive" },
+  { "map_Ns", "shininess" }, { "map_d", "opacity" }, { "map_bump", "bump" }, { "map_Bump", "bump" },
+  { "bump", "bump" }, { "norm", "normal" }, { "disp", "displacement" }
+};
+
+static bool parseMtl(const string &path, vector<ObjMaterial> &materials) {
+  MappedFile file;
+  if(!file.Open(path.c_str()))
+    return false;
+  const char *p = (const char *) file.Data(), *end = p + file.Size();
+  string directory = directoryOf(path);
+  ObjMaterial *material = NULL;
+
+  while(p < end) {
+    const char *lineEnd = (const char *) memchr(p, '\n', end - p);
+    if(!lineEnd)
+      lineEnd = end;
+    const char *line = skipSpaces(p, lineEnd);
+    p = lineEnd + 1;
+    if(line >= lineEnd || *line == '#')
+      continue;
+
+    if(startsWith(line, lineEnd, "newmtl")) {
+      materials.push_back(ObjMaterial(trimmed(line + 6, lineEnd)));
+      material = &materials.back();
+      continue;
+    }
+    if(!material)
+      continue;
+
+    float *color = NULL;
+    if(startsWith(line, lineEnd, "Ka")) color = material->ambient;
+    else if(startsWith(line, lineEnd, "Kd")) color = material->diffuse;
+    else if(startsWith(line, lineEnd, "Ks")) color = material->specular;
+    else if(startsWith(line, lineEnd, "Ke")) color = material->emissive;
+    if(color) {
+      const char *q = line + 2;
+      for(int k = 0; k < 3; k++)
+        q = parseFloat(q, lineEnd, &color[k]);
+      continue;
+    }
+
+    if(startsWith(line, lineEnd, "Ns")) {
+      parseFloat(line + 2, lineEnd, &material->shininess);
+    } else if(startsWith(line, lineEnd, "Ni")) {
+      parseFloat(line + 2, lineEnd, &material->ior);
+    } else if(startsWith(line, lineEnd, "d")) {
+      parseFloat(line + 1, lineEnd, &material->opacity);
+    } else if(startsWith(line, lineEnd, "Tr")) {
+      float transparency = 0;
+      parseFloat(line + 2, lineEnd, &transparency);
+      material->opacity = 1 - transparency;
+    } else if(startsWith(line, lineEnd, "illum")) {
+      float illum = 0;
+      parseFloat(line + 5, lineEnd, &illum);
+      material->illum = (int) illum;
+    } else {
+      for(size_t i = 0; i < sizeof(mtlMaps) / sizeof(mtlMaps[0]); i++) {
+        if(!startsWith(line, lineEnd, mtlMaps[i].keyword))
+          continue;
+        // options (-bm 0.5, -clamp on, ...) come first, the file name last
+        string rest = trimmed(line + strlen(mtlMaps[i].keyword), lineEnd);
+        size_t space = rest.find_last_of(" \t");
+        string file = space == string::npos ? rest : rest.substr(space + 1);
+        if(!file.empty())
+          material->maps.push_back(make_pair(string(mtlMaps[i].map), directory + file));
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+/*
+ * Loading
+ */
+
+struct ObjLoad {
+  string path;
+  bool index32;
+  bool upload;
+  bool optimize;
+  int threads;
+
+  vector<float> positions, texcoords, normals;
+  vector<int32_t> corners;
+
+  float *vertices;
+  void *indices;
+  size_t vertexCount;
+  size_t indexCount;
+  bool indices32;
+  int strideFloats;
+  int texcoordOffset;
+  int normalOffset;
+
+  vector<string> materialNames;
+  // index ranges per material, in materialNames order
+  vector<pair<size_t, size_t> > groups;
+  vector<ObjMaterial> materials;
+  vector<string> warnings;
+  float boundsMin[3], boundsMax[3];
+  VertexCacheStats before, after;
+
+  ObjLoad() : index32(false), upload(false), optimize(false), threads(0), vertices(NULL), indices(NULL), vertexCount(0), indexCount(0),
+              indices32(false), strideFloats(3), texcoordOffset(-1), normalOffset(-1) {}
+
+  ~ObjLoad() {
+    free(vertices);
+    free(indices);
+  }
+};
+
+// a deduplicated vertex: its position, texcoord and normal indices
+struct VertexKey {
+  int32_t v, t, n;
+};
+
+static inline uint32_t hashKey(const int32_t *key) {
+  uint32_t h = (uint32_t) key[0] * 0x9E3779B1u;
+  h ^= (uint32_t) key[1] * 0x85EBCA77u + (h << 6) + (h >> 2);
+  h ^= (uint32_t) key[2] * 0xC2B2AE3Du + (h << 6) + (h >> 2);
+  return h ^ (h >> 15);
+}
+
+class ObjLoadWorker : public Nan::AsyncProgressWorkerBase<double> {
+public:
+  ObjLoadWorker(Nan::Callback *callback, Nan::Callback *progress, ObjLoad *load)
+    : Nan::AsyncProgressWorkerBase<double>(callback, "webgl:loadObj"), progress(progress), load(load) {}
+
+  ~ObjLoadWorker() {
+    delete progress;
+    delete load;
+  }
+
+  void Execute(const Nan::AsyncProgressWorkerBase<double>::ExecutionProgress &reporter) {
+    MappedFile file;
+    if(!file.Open(load->path.c_str())) {
+      SetErrorMessage(("loadObj: cannot open " + load->path).c_str());
+      return;
+    }
+    file.Advise(MappedFile::ADVICE_SEQUENTIAL);
+    const char *text = (const char *) file.Data();
+    size_t size = file.Size();
+
+    // chunks end after a newline
+    size_t chunkCount = max<size_t>(1, size / OBJ_CHUNK);
+    vector<ObjChunk> chunks(chunkCount);
+    const char *begin = text;
+    for(size_t i = 0; i < chunkCount; i++) {
+      const char *end = text + size;
+      if(i + 1 < chunkCount) {
+        end = text + (i + 1) * (size / chunkCount);
+        if(end < begin)
+          end = begin;
+        const char *newline = (const char *) memchr(end, '\n', text + size - end);
+        end = newline ? newline + 1 : text + size;
+      }
+      chunks[i].begin = begin;
+      chunks[i].end = end;
+      begin = end;
+    }
+
+    atomic<size_t> parsed(0);
+    ParallelFor((int) chunkCount, load->threads, [&](int i) {
+      parseChunk(chunks[i]);
+      double fraction = 0.6 * (double) (parsed += chunks[i].end - chunks[i].begin) / max<size_t>(1, size);
+      reporter.Send(&fraction, 1);
+    });
+    for(size_t i = 0; i < chunkCount; i++) {
+      if(!chunks[i].error.empty()) {
+        SetErrorMessage(chunks[i].error.c_str());
+        return;
+      }
+    }
+    file.Close();
+
+    if(!resolve(chunks) || !loadMaterials(chunks))
+      return;
+    double fraction = 0.7;
+    reporter.Send(&fraction, 1);
+
+    vector<uint32_t> cornerVertex;
+    vector<VertexKey> vertexKeys;
+    deduplicate(cornerVertex, vertexKeys);
+    fraction = 0.85;
+    reporter.Send(&fraction, 1);
+
+    if(!emit(chunks, cornerVertex, vertexKeys))
+      return;
+    if(load->optimize) {
+      fraction = 0.9;
+      reporter.Send(&fraction, 1);
+      optimize();
+    }
+    if(!narrowIndices())
+      return;
+    fraction = 1;
+    reporter.Send(&fraction, 1);
+  }
+
+  void HandleProgressCallback(const double *data, size_t count) {
+    Nan::HandleScope scope;
+    if(!data || !count || progress->IsEmpty())
+      return;
+    Local<Value> argv[] = { JS_FLOAT(data[count - 1]) };
+    progress->Call(1, argv, async_resource);
+  }
+
+  void HandleOKCallback() {
+    Nan::HandleScope scope;
+    size_t vertexBytes = load->vertexCount * load->strideFloats * sizeof(float);
+    size_t indexBytes = load->indexCount * (load->indices32 ? 4 : 2);
+
+    Local<Object> result = Nan::New<Object>();
+    if(load->upload) {
+      GLuint buffers[2];
+      glCreateBuffers(2, buffers);
+      // empty stores are an error, the arrays are at least one byte
+      glNamedBufferStorage(buffers[0], max<size_t>(1, vertexBytes), load->vertices, 0);
+      glNamedBufferStorage(buffers[1], max<size_t>(1, indexBytes), load->indices, 0);
+      for(int i = 0; i < 2; i++) {
+        registerGLObj(GLOBJECT_TYPE_BUFFER, buffers[i]);
+        setGLObjBytes(GLOBJECT_TYPE_BUFFER, buffers[i], i == 0 ? vertexBytes : indexBytes);
+      }
+      Nan::Set(result, JS_STR("vertexBuffer"), JS_INT(buffers[0]));
+      Nan::Set(result, JS_STR("indexBuffer"), JS_INT(buffers[1]));
+    } else {
+      // the Buffers take over the arrays
+      Nan::Set(result, JS_STR("vertices"), Nan::NewBuffer((char *) load->vertices, vertexBytes, freeArray, NULL).ToLocalChecked());
+      Nan::Set(result, JS_STR("indices"), Nan::NewBuffer((char *) load->indices, indexBytes, freeArray, NULL).ToLocalChecked());
+      load->vertices = NULL;
+      load->indices = NULL;
+    }
+    Nan::Set(result, JS_STR("vertexCount"), JS_FLOAT((double) load->vertexCount));
+    Nan::Set(result, JS_STR("indexCount"), JS_FLOAT((double) load->indexCount));
+    Nan::Set(result, JS_STR("indexType"), JS_INT(load->indices32 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT));
+    Nan::Set(result, JS_STR("stride"), JS_INT(load->strideFloats * (int) sizeof(float)));
+    Nan::Set(result, JS_STR("texcoordOffset"), JS_INT(load->texcoordOffset));
+    Nan::Set(result, JS_STR("normalOffset"), JS_INT(load->normalOffset));
+
+    Local<Array> groups = Nan::New<Array>();
+    for(size_t i = 0, n = 0; i < load->groups.size(); i++) {
+      if(!load->groups[i].second)
+        continue;
+      Local<Object> group = Nan::New<Object>();
+      const string &name = load->materialNames[i];
+      Nan::Set(group, JS_STR("material"), name.empty() ? Local<Value>(Nan::Null()) : Local<Value>(JS_STR(name.c_str())));
+      Nan::Set(group, JS_STR("start"), JS_FLOAT((double) load->groups[i].first));
+      Nan::Set(group, JS_STR("count"), JS_FLOAT((double) load->groups[i].second));
+      Nan::Set(groups, (uint32_t) n++, group);
+    }
+    Nan::Set(result, JS_STR("groups"), groups);
+
+    Local<Array> materials = Nan::New<Array>();
+    for(size_t i = 0; i < load->materials.size(); i++) {
+      const ObjMaterial &m = load->materials[i];
+      Local<Object> material = Nan::New<Object>();
+      Nan::Set(material, JS_STR("name"), JS_STR(m.name.c_str()));
+      Nan::Set(material, JS_STR("ambient"), floatArray(m.ambient, 3));
+      Nan::Set(material, JS_STR("diffuse"), floatArray(m.diffuse, 3));
+      Nan::Set(material, JS_STR("specular"), floatArray(m.specular, 3));
+      Nan::Set(material, JS_STR("emissive"), floatArray(m.emissive, 3));
+      Nan::Set(material, JS_STR("shininess"), JS_FLOAT(m.shininess));
+      Nan::Set(material, JS_STR("opacity"), JS_FLOAT(m.opacity));
+      Nan::Set(material, JS_STR("ior"), JS_FLOAT(m.ior));
+      Nan::Set(material, JS_STR("illum"), JS_INT(m.illum));
+      Local<Object> maps = Nan::New<Object>();
+      for(size_t k = 0; k < m.maps.size(); k++)
+        Nan::Set(maps, JS_STR(m.maps[k].first.c_str()), JS_STR(m.maps[k].second.c_str()));
+      Nan::Set(material, JS_STR("maps"), maps);
+      Nan::Set(materials, (uint32_t) i, material);
+    }
+    Nan::Set(result, JS_STR("materials"), materials);
+
+    Local<Object> bounds = Nan::New<Object>();
+    Nan::Set(bounds, JS_STR("min"), floatArray(load->boundsMin, 3));
+    Nan::Set(bounds, JS_STR("max"), floatArray(load->boundsMax, 3));
+    Nan::Set(result, JS_STR("bounds"), bounds);
+
+    Local<Array> warnings = Nan::New<Array>();
+    for(size_t i = 0; i < load->warnings.size(); i++)
+      Nan::Set(warnings, (uint32_t) i, JS_STR(load->warnings[i].c_str()));
+    Nan::Set(result, JS_STR("warnings"), warnings);
+
+    if(load->optimize) {
+      Local<Object> optimization = Nan::New<Object>();
+      Nan::Set(optimization, JS_STR("before"), statsObject(load->before));
+      Nan::Set(optimization, JS_STR("after"), statsObject(load->after));
+      Nan::Set(result, JS_STR("optimization"), optimization);
+    }
+
+    Local<Value> argv[] = { Nan::Null(), result };
+    callback->Call(2, argv, async_resource);
+  }
+
+private:
+  static void freeArray(char *data, void *) {
+    free(data);
+  }
+
+  static Local<Object> statsObject(const VertexCacheStats &stats) {
+    Local<Object> object = Nan::New<Object>();
+    Nan::Set(object, JS_STR("acmr"), JS_FLOAT(stats.acmr));
+    Nan::Set(object, JS_STR("atvr"), JS_FLOAT(stats.atvr));
+    return object;
+  }
+
+  static Local<Array> floatArray(const float *values, int count) {
+    Local<Array> array = Nan::New<Array>(count);
+    for(int i = 0; i < count; i++)
+      Nan::Set(array, (uint32_t) i, JS_FLOAT(values[i]));
+    return array;
+  }
+
+  // Concatenates the chunks' attributes and corners, resolves relative
+  // indices and checks the ranges.
+  bool resolve(vector<ObjChunk> &chunks) {
+    uint32_t totals[3] = { 0, 0, 0 };
+    uint64_t corners = 0;
+    for(size_t i = 0; i < chunks.size(); i++) {
+      ObjChunk &chunk = chunks[i];
+      chunk.bases[CORNER_POSITION] = totals[CORNER_POSITION];
+      chunk.bases[CORNER_TEXCOORD] = totals[CORNER_TEXCOORD];
+      chunk.bases[CORNER_NORMAL] = totals[CORNER_NORMAL];
+      chunk.cornerBase = corners;
+      totals[CORNER_POSITION] += (uint32_t) (chunk.positions.size() / 3);
+      totals[CORNER_TEXCOORD] += (uint32_t) (chunk.texcoords.size() / 2);
+      totals[CORNER_NORMAL] += (uint32_t) (chunk.normals.size() / 3);
+      corners += chunk.corners.size();
+    }
+    if(corners / 3 > 0xFFFFFFFFu) {
+      SetErrorMessage("loadObj: more than 2^32 face corners");
+      return false;
+    }
+
+    load->positions.resize((size_t) totals[CORNER_POSITION] * 3);
+    load->texcoords.resize((size_t) totals[CORNER_TEXCOORD] * 2);
+    load->normals.resize((size_t) totals[CORNER_NORMAL] * 3);
+    load->corners.resize(corners);
+    ParallelFor((int) chunks.size(), load->threads, [&](int i) {
+      ObjChunk &chunk = chunks[i];
+      copy(chunk.positions.begin(), chunk.positions.end(), load->positions.begin() + (size_t) chunk.bases[CORNER_POSITION] * 3);
+      copy(chunk.texcoords.begin(), chunk.texcoords.end(), load->texcoords.begin() + (size_t) chunk.bases[CORNER_TEXCOORD] * 2);
+      copy(chunk.normals.begin(), chunk.normals.end(), load->normals.begin() + (size_t) chunk.bases[CORNER_NORMAL] * 3);
+      vector<float>().swap(chunk.positions);
+      vector<float>().swap(chunk.texcoords);
+      vector<float>().swap(chunk.normals);
+
+      for(size_t k = 0; k < chunk.relative.size(); k++) {
+        uint32_t slot = chunk.relative[k];
+        chunk.corners[slot] += (int32_t) chunk.bases[slot % 3];
+      }
+
+      chunk.hasTexcoords = chunk.hasNormals = false;
+      int32_t *out = &load->corners[chunk.cornerBase];
+      for(size_t k = 0; k < chunk.corners.size(); k += 3) {
+        const int32_t *c = &chunk.corners[k];
+        if(c[CORNER_POSITION] < 0 || (uint32_t) c[CORNER_POSITION] >= totals[CORNER_POSITION] ||
+           c[CORNER_TEXCOORD] < -1 || (c[CORNER_TEXCOORD] >= 0 && (uint32_t) c[CORNER_TEXCOORD] >= totals[CORNER_TEXCOORD]) ||
+           c[CORNER_NORMAL] < -1 || (c[CORNER_NORMAL] >= 0 && (uint32_t) c[CORNER_NORMAL] >= totals[CORNER_NORMAL])) {
+          chunk.error = "loadObj: face index out of range";
+          break;
+        }
+        chunk.hasTexcoords |= c[CORNER_TEXCOORD] >= 0;
+        chunk.hasNormals |= c[CORNER_NORMAL] >= 0;
+        out[k] = c[0];
+        out[k + 1] = c[1];
+        out[k + 2] = c[2];
+      }
+      vector<int32_t>().swap(chunk.corners);
+    });
+
+    for(size_t i = 0; i < chunks.size(); i++) {
+      if(!chunks[i].error.empty()) {
+        SetErrorMessage(chunks[i].error.c_str());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool loadMaterials(vector<ObjChunk> &chunks) {
+    string directory = directoryOf(load->path);
+    vector<string> loaded;
+    for(size_t i = 0; i < chunks.size(); i++) {
+      for(size_t k = 0; k < chunks[i].libraries.size(); k++) {
+        const string &library = chunks[i].libraries[k];
+        if(find(loaded.begin(), loaded.end(), library) != loaded.end())
+          continue;
+        loaded.push_back(library);
+        if(!parseMtl(directory + library, load->materials))
+          load->warnings.push_back("cannot open material library " + directory + library);
+      }
+    }
+    return true;
+  }
+
+  // Shards the corners by position index range, so equal (position,
+  // texcoord, normal) tuples land in the same shard, and gives each shard's
+  // distinct tuples consecutive vertex numbers in the order they are first
+  // used.
+  void deduplicate(vector<uint32_t> &cornerVertex, vector<VertexKey> &vertexKeys) {
+    size_t cornerCount = load->corners.size() / 3;
+    size_t positionCount = load->positions.size() / 3;
+    int threads = load->threads > 0 ? load->threads : (int) max(1u, thread::hardware_concurrency());
+    size_t shardCount = min<size_t>(max<size_t>(1, positionCount), (size_t) threads * 4);
+    const int32_t *corners = load->corners.data();
+    auto shardOf = [&](size_t corner) {
+      return (size_t) ((uint64_t) corners[corner * 3] * shardCount / max<size_t>(1, positionCount));
+    };
+
+    // counting sort of the corners by shard, in slices for the threads
+    size_t sliceCount = max<size_t>(1, min<size_t>((size_t) threads, cornerCount / 65536));
+    vector<size_t> counts(sliceCount * shardCount, 0);
+    ParallelFor((int) sliceCount, threads, [&](int slice) {
+      size_t begin = cornerCount * slice / sliceCount, end = cornerCount * (slice + 1) / sliceCount;
+      size_t *count = &counts[(size_t) slice * shardCount];
+      for(size_t c = begin; c < end; c++)
+        count[shardOf(c)]++;
+    });
+    vector<size_t> shardBegin(shardCount + 1, 0);
+    vector<size_t> cursors(sliceCount * shardCount);
+    size_t offset = 0;
+    for(size_t shard = 0; shard < shardCount; shard++) {
+      shardBegin[shard] = offset;
+      for(size_t slice = 0; slice < sliceCount; slice++) {
+        cursors[slice * shardCount + shard] = offset;
+        offset += counts[slice * shardCount + shard];
+      }
+    }
+    shardBegin[shardCount] = offset;
+    vector<uint32_t> byShard(cornerCount);
+    ParallelFor((int) sliceCount, threads, [&](int slice) {
+      size_t begin = cornerCount * slice / sliceCount, end = cornerCount * (slice + 1) / sliceCount;
+      size_t *cursor = &cursors[(size_t) slice * shardCount];
+      for(size_t c = begin; c < end; c++)
+        byShard[cursor[shardOf(c)]++] = (uint32_t) c;
+    });
+
+    cornerVertex.resize(cornerCount);
+    vector<vector<VertexKey> > shardKeys(shardCount);
+    ParallelFor((int) shardCount, threads, [&](int shard) {
+      size_t begin = shardBegin[shard], end = shardBegin[shard + 1];
+      size_t capacity = 16;
+      while(capacity < (end - begin) * 2)
+        capacity <<= 1;
+      // open addressing, v == -1 marks a free slot
+      vector<VertexKey> slots(capacity, VertexKey { -1, -1, -1 });
+      vector<uint32_t> ids(capacity);
+      vector<VertexKey> &keys = shardKeys[shard];
+      for(size_t i = begin; i < end; i++) {
+        uint32_t corner = byShard[i];
+        const int32_t *key = corners + (size_t) corner * 3;
+        size_t slot = hashKey(key) & (capacity - 1);
+        while(slots[slot].v != -1 && (slots[slot].v != key[0] || slots[slot].t != key[1] || slots[slot].n != key[2]))
+          slot = (slot + 1) & (capacity - 1);
+        if(slots[slot].v == -1) {
+          slots[slot] = VertexKey { key[0], key[1], key[2] };
+          ids[slot] = (uint32_t) keys.size();
+          keys.push_back(slots[slot]);
+        }
+        cornerVertex[corner] = ids[slot];
+      }
+    });
+
+    vector<uint32_t> vertexBase(shardCount);
+    size_t vertexCount = 0;
+    for(size_t shard = 0; shard < shardCount; shard++) {
+      vertexBase[shard] = (uint32_t) vertexCount;
+      vertexCount += shardKeys[shard].size();
+    }
+    vertexKeys.resize(vertexCount);
+    ParallelFor((int) shardCount, threads, [&](int shard) {
+      for(size_t i = shardBegin[shard]; i < shardBegin[shard + 1]; i++)
+        cornerVertex[byShard[i]] += vertexBase[shard];
+      copy(shardKeys[shard].begin(), shardKeys[shard].end(), vertexKeys.begin() + vertexBase[shard]);
+      vector<VertexKey>().swap(shardKeys[shard]);
+    });
+  }
+
+  // Fills the interleaved vertices and the indices, grouped by material.
+  bool emit(vector<ObjChunk> &chunks, const vector<uint32_t> &cornerVertex, const vector<VertexKey> &vertexKeys) {
+    bool hasTexcoords = false, hasNormals = false;
+    for(size_t i = 0; i < chunks.size(); i++) {
+      hasTexcoords |= chunks[i].hasTexcoords;
+      hasNormals |= chunks[i].hasNormals;
+    }
+    int stride = 3;
+    if(hasTexcoords) {
+      load->texcoordOffset = stride * sizeof(float);
+      stride += 2;
+    }
+    if(hasNormals) {
+      load->normalOffset = stride * sizeof(float);
+      stride += 3;
+    }
+    load->strideFloats = stride;
+    load->vertexCount = vertexKeys.size();
+    load->indexCount = cornerVertex.size();
+    load->indices32 = load->index32 || load->vertexCount > 65536;
+
+    load->vertices = (float *) malloc(max<size_t>(1, load->vertexCount * stride * sizeof(float)));
+    // 32 bits until narrowIndices, the optimizer works on those
+    load->indices = malloc(max<size_t>(1, load->indexCount * 4));
+    if(!load->vertices || !load->indices) {
+      SetErrorMessage("loadObj: out of memory");
+      return false;
+    }
+
+    const float *positions = load->positions.data();
+    const float *texcoords = load->texcoords.data();
+    const float *normals = load->normals.data();
+    int texcoordOffset = load->texcoordOffset / (int) sizeof(float), normalOffset = load->normalOffset / (int) sizeof(float);
+    size_t vertexCount = load->vertexCount;
+    int threads = load->threads;
+    int slices = (int) max<size_t>(1, vertexCount / 65536);
+    ParallelFor(slices, threads, [&](int slice) {
+      size_t begin = vertexCount * slice / slices, end = vertexCount * (slice + 1) / slices;
+      for(size_t i = begin; i < end; i++) {
+        const VertexKey &key = vertexKeys[i];
+        float *out = load->vertices + i * stride;
+        memcpy(out, positions + (size_t) key.v * 3, 3 * sizeof(float));
+        if(texcoordOffset >= 0) {
+          if(key.t >= 0)
+            memcpy(out + texcoordOffset, texcoords + (size_t) key.t * 2, 2 * sizeof(float));
+          else
+            out[texcoordOffset] = out[texcoordOffset + 1] = 0;
+        }
+        if(normalOffset >= 0) {
+          if(key.n >= 0)
+            memcpy(out + normalOffset, normals + (size_t) key.n * 3, 3 * sizeof(float));
+          else
+            out[normalOffset] = out[normalOffset + 1] = out[normalOffset + 2] = 0;
+        }
+      }
+    });
+
+    for(int k = 0; k < 3; k++) {
+      load->boundsMin[k] = vertexCount ? INFINITY : 0;
+      load->boundsMax[k] = vertexCount ? -INFINITY : 0;
+    }
+    for(size_t i = 0; i < vertexCount; i++) {
+      const float *p = load->vertices + i * stride;
+      for(int k = 0; k < 3; k++) {
+        load->boundsMin[k] = min(load->boundsMin[k], p[k]);
+        load->boundsMax[k] = max(load->boundsMax[k], p[k]);
+      }
+    }
+
+    // material of every chunk's triangle runs: (first triangle, material id)
+    unordered_map<string, uint32_t> materialIds;
+    vector<vector<pair<uint32_t, uint32_t> > > runs(chunks.size());
+    uint32_t current = 0;
+    load->materialNames.push_back(string());
+    materialIds[string()] = 0;
+    for(size_t i = 0; i < chunks.size(); i++) {
+      runs[i].push_back(make_pair(0u, current));
+      for(size_t k = 0; k < chunks[i].materials.size(); k++) {
+        const string &name = chunks[i].materials[k].second;
+        auto it = materialIds.find(name);
+        if(it == materialIds.end()) {
+          it = materialIds.insert(make_pair(name, (uint32_t) load->materialNames.size())).first;
+          load->materialNames.push_back(name);
+        }
+        current = it->second;
+        runs[i].push_back(make_pair(chunks[i].materials[k].first, current));
+      }
+    }
+
+    // triangles per chunk and material, then where each chunk writes them
+    size_t materialCount = load->materialNames.size();
+    vector<size_t> triangles(chunks.size() * materialCount, 0);
+    for(size_t i = 0; i < chunks.size(); i++) {
+      uint32_t chunkTriangles = (uint32_t) ((i + 1 < chunks.size() ? chunks[i + 1].cornerBase : load->corners.size()) - chunks[i].cornerBase) / 9;
+      for(size_t r = 0; r < runs[i].size(); r++) {
+        uint32_t end = r + 1 < runs[i].size() ? runs[i][r + 1].first : chunkTriangles;
+        triangles[i * materialCount + runs[i][r].second] += end - runs[i][r].first;
+      }
+    }
+    vector<size_t> cursors(chunks.size() * materialCount);
+    load->groups.resize(materialCount);
+    size_t offset = 0;
+    for(size_t m = 0; m < materialCount; m++) {
+      load->groups[m].first = offset * 3;
+      for(size_t i = 0; i < chunks.size(); i++) {
+        cursors[i * materialCount + m] = offset;
+        offset += triangles[i * materialCount + m];
+      }
+      load->groups[m].second = offset * 3 - load->groups[m].first;
+    }
+
+    uint32_t *indices = (uint32_t *) load->indices;
+    ParallelFor((int) chunks.size(), threads, [&](int i) {
+      uint32_t chunkTriangles = (uint32_t) ((i + 1 < (int) chunks.size() ? chunks[i + 1].cornerBase : load->corners.size()) - chunks[i].cornerBase) / 9;
+      size_t firstCorner = chunks[i].cornerBase / 3;
+      for(size_t r = 0; r < runs[i].size(); r++) {
+        uint32_t end = r + 1 < runs[i].size() ? runs[i][r + 1].first : chunkTriangles;
+        size_t &cursor = cursors[i * materialCount + runs[i][r].second];
+        for(uint32_t t = runs[i][r].first; t < end; t++, cursor++) {
+          for(int c = 0; c < 3; c++)
+            indices[cursor * 3 + c] = cornerVertex[firstCorner + (size_t) t * 3 + c];
+        }
+      }
+    });
+    return true;
+  }
+
+  // Optimizes every group on its own, with its vertices renumbered from 0 so
+  // the optimizer's per vertex arrays only cover the group, then puts the
+  // vertices in first use order.
+  void optimize() {
+    uint32_t *indices = (uint32_t *) load->indices;
+    size_t vertexCount = load->vertexCount;
+    load->before = analyzeVertexCache(indices, load->indexCount, vertexCount);
+
+    vector<uint32_t> local(vertexCount, ~0u), global;
+    vector<float> positions;
+    for(size_t g = 0; g < load->groups.size(); g++) {
+      uint32_t *group = indices + load->groups[g].first;
+      size_t count = load->groups[g].second;
+      if(!count)
+        continue;
+      global.clear();
+      positions.clear();
+      for(size_t i = 0; i < count; i++) {
+        uint32_t &id = local[group[i]];
+        if(id == ~0u) {
+          id = (uint32_t) global.size();
+          global.push_back(group[i]);
+          const float *p = load->vertices + (size_t) group[i] * load->strideFloats;
+          positions.insert(positions.end(), p, p + 3);
+        }
+        group[i] = id;
+      }
+      optimizeVertexCache(group, count, global.size());
+      optimizeOverdraw(group, count, positions.data(), 3, global.size(), 1.05f);
+      for(size_t i = 0; i < count; i++)
+        group[i] = global[group[i]];
+      for(size_t i = 0; i < global.size(); i++)
+        local[global[i]] = ~0u;
+    }
+
+    optimizeVertexFetch(load->vertices, load->strideFloats * sizeof(float), vertexCount, indices, load->indexCount);
+    load->after = analyzeVertexCache(indices, load->indexCount, vertexCount);
+  }
+
+  bool narrowIndices() {
+    if(load->indices32)
+      return true;
+    uint16_t *narrow = (uint16_t *) malloc(max<size_t>(1, load->indexCount * 2));
+    if(!narrow) {
+      SetErrorMessage("loadObj: out of memory");
+      return false;
+    }
+    const uint32_t *wide = (const uint32_t *) load->indices;
+    for(size_t i = 0; i < load->indexCount; i++)
+      narrow[i] = (uint16_t) wide[i];
+    free(load->indices);
+    load->indices = narrow;
+    return true;
+  }
+
+  Nan::Callback *progress;
+  ObjLoad *load;
+};
+
+NAN_METHOD(LoadObj) {
+  if(info.Length() < 6 || !info[5]->IsFunction()) {
+    Nan::ThrowTypeError("Expected loadObj(path, index32, upload, threads, progress, callback)");
+    return;
+  }
+  Nan::Utf8String path(info[0]);
+  ObjLoad *load = new ObjLoad();
+  load->path = *path;
+  load->index32 = Nan::To<bool>(info[1]).FromJust();
+  load->upload = Nan::To<bool>(info[2]).FromJust();
+  load->threads = Nan::To<int>(info[3]).FromJust();
+  load->optimize = info.Length() > 6 && Nan::To<bool>(info[6]).FromJust();
+
+  Nan::Callback *progress = info[4]->IsFunction() ? new Nan::Callback(info[4].As<Function>()) : new Nan::Callback();
+  Nan::Callback *callback = new Nan::Callback(info[5].As<Function>());
+  Nan::AsyncQueueWorker(new ObjLoadWorker(callback, progress, load));
+}
+
+} // end namespace webgl
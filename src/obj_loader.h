@@ -0,0 +1,24 @@
+/*
+ * obj_loader.h
+ *
+ * Wavefront OBJ (and MTL) loading on the thread pool. The file is memory
+ * mapped and split at line boundaries into chunks that are parsed in
+ * parallel; the (position, texcoord, normal) index tuples of the faces are
+ * deduplicated into vertices with per position range hash tables, again in
+ * parallel, and the result is an interleaved vertex array and an index array
+ * with the triangles grouped by material, ready for bufferData or uploaded
+ * straight into buffers.
+ */
+
+#ifndef OBJ_LOADER_H_
+#define OBJ_LOADER_H_
+
+#include "common.h"
+
+namespace webgl {
+
+NAN_METHOD(LoadObj);
+
+}
+
+#endif /* OBJ_LOADER_H_ */
@@ -0,0 +1,99 @@
+/*
+ * parallel.cc
+ *
+ * The worker pool behind PooledParallelFor.
+ */
+
+#include <condition_variable>
+#include <mutex>
+
+#include "parallel.h"
+
+namespace webgl {
+
+using namespace std;
+
+class WorkerPool {
+public:
+  ~WorkerPool() {
+    {
+      lock_guard<mutex> lock(m);
+      stopping = true;
+    }
+    wake.notify_all();
+    for(thread &worker : workers)
+      worker.join();
+  }
+
+  void Run(int count, int threads, const function<void(int)> &fn) {
+    lock_guard<mutex> running(runLock);
+    {
+      lock_guard<mutex> lock(m);
+      while((int) workers.size() < threads - 1) {
+        int index = (int) workers.size();
+        workers.emplace_back([this, index]() { work(index); });
+      }
+      job = &fn;
+      jobCount = count;
+      next = 0;
+      participants = pending = threads - 1;
+      generation++;
+    }
+    wake.notify_all();
+
+    for(int i = next++; i < count; i = next++)
+      fn(i);
+
+    unique_lock<mutex> lock(m);
+    done.wait(lock, [this]() { return pending == 0; });
+    job = NULL;
+  }
+
+private:
+  void work(int index) {
+    uint64_t seen = 0;
+    unique_lock<mutex> lock(m);
+    for(;;) {
+      wake.wait(lock, [&]() { return stopping || generation != seen; });
+      if(stopping)
+        return;
+      seen = generation;
+      // threads beyond the ones this call asked for sit it out
+      if(index >= participants)
+        continue;
+      const function<void(int)> &fn = *job;
+      int count = jobCount;
+      lock.unlock();
+      for(int i = next++; i < count; i = next++)
+        fn(i);
+      lock.lock();
+      if(--pending == 0)
+        done.notify_one();
+    }
+  }
+
+  mutex runLock;
+  mutex m;
+  condition_variable wake, done;
+  vector<thread> workers;
+  const function<void(int)> *job = NULL;
+  int jobCount = 0, participants = 0, pending = 0;
+  atomic<int> next{0};
+  uint64_t generation = 0;
+  bool stopping = false;
+};
+
+void PooledParallelFor(int count, int threads, const function<void(int)> &fn) {
+  static WorkerPool pool;
+  if(threads <= 0)
+    threads = max(1u, thread::hardware_concurrency());
+  threads = min(threads, count);
+  if(threads <= 1) {
+    for(int i = 0; i < count; i++)
+      fn(i);
+    return;
+  }
+  pool.Run(count, threads, fn);
+}
+
+} // end namespace webgl
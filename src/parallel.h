@@ -0,0 +1,52 @@
+/*
+ * parallel.h
+ *
+ * Fork/join helpers. ParallelFor starts and joins its threads on every call,
+ * which is fine for the long running work on libuv pool threads (texture
+ * encoding, mipmap filtering, OBJ parsing). The per frame batches on the JS
+ * thread (culling, matrices, vertex packing) use PooledParallelFor instead,
+ * whose threads are created once and wait between calls.
+ */
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace webgl {
+
+// Calls fn(i) for every i in [0, count) on up to threads threads (<= 0 means
+// one per core), the calling thread included. Items are handed out one at a
+// time, so uneven items balance out.
+template <typename Fn>
+void ParallelFor(int count, int threads, Fn fn) {
+  if(threads <= 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min(threads, count);
+
+  std::atomic<int> next(0);
+  auto work = [&]() {
+    for(int i = next++; i < count; i = next++)
+      fn(i);
+  };
+
+  std::vector<std::thread> pool;
+  for(int i = 1; i < threads; i++)
+    pool.emplace_back(work);
+  work();
+  for(size_t i = 0; i < pool.size(); i++)
+    pool[i].join();
+}
+
+// ParallelFor on a persistent pool: the threads are started by the first
+// call that needs them and reused after. One call runs at a time, concurrent
+// callers wait for it.
+void PooledParallelFor(int count, int threads, const std::function<void(int)> &fn);
+
+} // end namespace webgl
+
+#endif /* PARALLEL_H_ */
@@ -0,0 +1,266 @@
+/*
+ * render_queue.cc
+ *
+ * gl.createBindingGroup(textures, samplers, uniformBuffers, uniformRanges,
+ *                       storageBuffers, storageRanges) -> handle
+ * gl.deleteBindingGroup(handle)
+ * gl.executeRenderQueue(Uint32Array records, count, sort) -> stats
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "render_queue.h"
+#include "render_state.h"
+#include "marshal.h"
+#include <GL/glew.h>
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+// must match renderQueueFields in lib/webgl.js
+enum RenderQueueField {
+  RQ_KEY_LO,
+  RQ_KEY_HI,
+  RQ_VERTEX_ARRAY,
+  RQ_PROGRAM,
+  RQ_RENDER_STATE, // 0 leaves the render state as it is
+  RQ_BINDING_GROUP, // 0 leaves the bindings as they are
+  RQ_MODE,
+  RQ_COUNT,
+  RQ_INDEX_TYPE, // 0 for glDrawArrays*
+  RQ_FIRST, // first vertex, or the low word of the byte offset into the element buffer
+  RQ_INSTANCE_COUNT,
+  RQ_BASE_VERTEX,
+  RQ_BASE_INSTANCE,
+  RQ_FIRST_HI, // the high word of the element buffer offset
+  RQ_STRIDE = 16
+};
+
+struct BufferBindings {
+  vector<GLuint> buffers;
+  // empty to bind whole buffers
+  vector<GLintptr> offsets;
+  vector<GLsizeiptr> sizes;
+};
+
+struct BindingGroup {
+  bool used;
+  vector<GLuint> textures;
+  vector<GLuint> samplers;
+  BufferBindings uniformBuffers;
+  BufferBindings storageBuffers;
+};
+
+static vector<BindingGroup> groups;
+static vector<uint32_t> freeGroups;
+
+static void copyNames(Local<Value> value, vector<GLuint> &names) {
+  names.clear();
+  if(value->IsNullOrUndefined())
+    return;
+  size_t byteLength = 0;
+  const GLuint *data = marshal::ArrayData<GLuint>(value, &byteLength);
+  if(data)
+    names.assign(data, data + byteLength / sizeof(GLuint));
+}
+
+static void copyBuffers(Local<Value> names, Local<Value> ranges, BufferBindings &bindings) {
+  copyNames(names, bindings.buffers);
+  bindings.offsets.clear();
+  bindings.sizes.clear();
+  if(ranges->IsNullOrUndefined())
+    return;
+  size_t byteLength = 0;
+  const double *data = marshal::ArrayData<double>(ranges, &byteLength);
+  if(!data || byteLength / (2 * sizeof(double)) < bindings.buffers.size())
+    return;
+  for(size_t i = 0; i < bindings.buffers.size(); i++) {
+    bindings.offsets.push_back((GLintptr) data[i * 2]);
+    bindings.sizes.push_back((GLsizeiptr) data[i * 2 + 1]);
+  }
+}
+
+static void bindBuffers(GLenum target, const BufferBindings &bindings) {
+  GLsizei count = (GLsizei) bindings.buffers.size();
+  if(!count)
+    return;
+  if(bindings.offsets.empty())
+    glBindBuffersBase(target, 0, count, bindings.buffers.data());
+  else
+    glBindBuffersRange(target, 0, count, bindings.buffers.data(), bindings.offsets.data(), bindings.sizes.data());
+}
+
+static void bindGroup(const BindingGroup &group) {
+  if(!group.textures.empty()) {
+    // createBindingGroup keeps managed (renamed on eviction) textures out
+    glBindTextures(0, (GLsizei) group.textures.size(), group.textures.data());
+  }
+  if(!group.samplers.empty())
+    glBindSamplers(0, (GLsizei) group.samplers.size(), group.samplers.data());
+  bindBuffers(GL_UNIFORM_BUFFER, group.uniformBuffers);
+  bindBuffers(GL_SHADER_STORAGE_BUFFER, group.storageBuffers);
+}
+
+NAN_METHOD(CreateBindingGroup) {
+  uint32_t id;
+  if(freeGroups.empty()) {
+    groups.emplace_back();
+    id = (uint32_t) groups.size();
+  } else {
+    id = freeGroups.back();
+    freeGroups.pop_back();
+  }
+
+  BindingGroup &group = groups[id - 1];
+  group.used = true;
+  copyNames(info[0], group.textures);
+  copyNames(info[1], group.samplers);
+  copyBuffers(info[2], info[3], group.uniformBuffers);
+  copyBuffers(info[4], info[5], group.storageBuffers);
+  info.GetReturnValue().Set(id);
+}
+
+NAN_METHOD(DeleteBindingGroup) {
+  uint32_t id = marshal::Arg<GLuint>::Unbox(info[0]);
+  if(id == 0 || id > groups.size() || !groups[id - 1].used)
+    return;
+  groups[id - 1] = BindingGroup();
+  freeGroups.push_back(id);
+}
+
+// Stable LSD radix sort of (key, index) pairs, a byte per pass; passes in
+// which every key has the same byte are skipped, so keys that only use a few
+// bits sort in a few passes.
+static vector<uint64_t> keys, keysScratch;
+static vector<uint32_t> order, orderScratch;
+
+static void radixSort(size_t count) {
+  uint32_t histograms[8][256];
+  memset(histograms, 0, sizeof(histograms));
+  for(size_t i = 0; i < count; i++) {
+    uint64_t key = keys[i];
+    for(int pass = 0; pass < 8; pass++)
+      histograms[pass][(key >> (pass * 8)) & 0xff]++;
+  }
+
+  keysScratch.resize(count);
+  orderScratch.resize(count);
+  for(int pass = 0; pass < 8; pass++) {
+    uint32_t *histogram = histograms[pass];
+    int shift = pass * 8;
+    if(histogram[(keys[0] >> shift) & 0xff] == count)
+      continue;
+
+    uint32_t sum = 0;
+    for(int digit = 0; digit < 256; digit++) {
+      uint32_t n = histogram[digit];
+      histogram[digit] = sum;
+      sum += n;
+    }
+    for(size_t i = 0; i < count; i++) {
+      uint32_t slot = histogram[(keys[i] >> shift) & 0xff]++;
+      keysScratch[slot] = keys[i];
+      orderScratch[slot] = order[i];
+    }
+    keys.swap(keysScratch);
+    order.swap(orderScratch);
+  }
+}
+
+// Number of vertex array, program, render state and binding group changes
+// when drawing the records in the given order.
+static uint32_t countStateChanges(const uint32_t *records, const uint32_t *drawOrder, size_t count) {
+  uint32_t changes = 0;
+  const uint32_t *previous = NULL;
+  for(size_t i = 0; i < count; i++) {
+    const uint32_t *r = records + (size_t) drawOrder[i] * RQ_STRIDE;
+    for(int field = RQ_VERTEX_ARRAY; field <= RQ_BINDING_GROUP; field++) {
+      if(!previous || r[field] != previous[field])
+        changes++;
+    }
+    previous = r;
+  }
+  return changes;
+}
+
+NAN_METHOD(ExecuteRenderQueue) {
+  size_t byteLength = 0;
+  const uint32_t *records = marshal::ArrayData<uint32_t>(info[0], &byteLength);
+  size_t count = marshal::Arg<GLuint>::Unbox(info[1]);
+  bool sort = Nan::To<bool>(info[2]).FromJust();
+  if(!records || count > byteLength / (RQ_STRIDE * sizeof(uint32_t))) {
+    Nan::ThrowRangeError("executeRenderQueue: count is larger than the record stream");
+    return;
+  }
+
+  order.resize(count);
+  for(size_t i = 0; i < count; i++)
+    order[i] = (uint32_t) i;
+  uint32_t unsortedChanges = countStateChanges(records, order.data(), count);
+
+  if(sort && count > 1) {
+    keys.resize(count);
+    for(size_t i = 0; i < count; i++) {
+      const uint32_t *r = records + i * RQ_STRIDE;
+      keys[i] = ((uint64_t) r[RQ_KEY_HI] << 32) | r[RQ_KEY_LO];
+    }
+    radixSort(count);
+  }
+  uint32_t sortedChanges = sort ? countStateChanges(records, order.data(), count) : unsortedChanges;
+
+  // ~0 so the first draw sets everything
+  uint32_t vertexArray = ~0u, program = ~0u, renderState = ~0u, bindingGroup = ~0u;
+  uint32_t glCalls = 0;
+  for(size_t i = 0; i < count; i++) {
+    const uint32_t *r = records + (size_t) order[i] * RQ_STRIDE;
+    if(r[RQ_VERTEX_ARRAY] != vertexArray) {
+      vertexArray = r[RQ_VERTEX_ARRAY];
+      glBindVertexArray(vertexArray);
+      glCalls++;
+    }
+    if(r[RQ_PROGRAM] != program) {
+      program = r[RQ_PROGRAM];
+      glUseProgram(program);
+      glCalls++;
+    }
+    if(r[RQ_RENDER_STATE] != renderState) {
+      renderState = r[RQ_RENDER_STATE];
+      if(renderState) {
+        int calls = ApplyRenderStateBlock(renderState);
+        if(calls > 0)
+          glCalls += calls;
+      }
+    }
+    if(r[RQ_BINDING_GROUP] != bindingGroup) {
+      bindingGroup = r[RQ_BINDING_GROUP];
+      if(bindingGroup && bindingGroup <= groups.size() && groups[bindingGroup - 1].used) {
+        bindGroup(groups[bindingGroup - 1]);
+        glCalls++;
+      }
+    }
+
+    GLenum mode = r[RQ_MODE];
+    GLsizei drawCount = (GLsizei) r[RQ_COUNT];
+    GLsizei instances = (GLsizei) r[RQ_INSTANCE_COUNT];
+    if(r[RQ_INDEX_TYPE]) {
+      uint64_t offset = ((uint64_t) r[RQ_FIRST_HI] << 32) | r[RQ_FIRST];
+      glDrawElementsInstancedBaseVertexBaseInstance(mode, drawCount, r[RQ_INDEX_TYPE], (const void *) (uintptr_t) offset,
+                                                    instances, (GLint) r[RQ_BASE_VERTEX], r[RQ_BASE_INSTANCE]);
+    } else
+      glDrawArraysInstancedBaseInstance(mode, (GLint) r[RQ_FIRST], drawCount, instances, r[RQ_BASE_INSTANCE]);
+    glCalls++;
+  }
+
+  Local<Object> stats = Nan::New<Object>();
+  Nan::Set(stats, JS_STR("draws"), JS_INT((int) count));
+  Nan::Set(stats, JS_STR("stateChangesUnsorted"), JS_INT(unsortedChanges));
+  Nan::Set(stats, JS_STR("stateChangesSorted"), JS_INT(sortedChanges));
+  Nan::Set(stats, JS_STR("glCalls"), JS_INT(glCalls));
+  info.GetReturnValue().Set(stats);
+}
+
+} // end namespace webgl
@@ -0,0 +1,29 @@
+/*
+ * render_queue.h
+ *
+ * Sorted draw submission. A gl.RenderQueue (lib/webgl.js) appends fixed size
+ * draw records to a Uint32Array: a 64-bit sort key, the vertex array,
+ * program, render state (render_state.h) and binding group to draw with, and
+ * the draw arguments. gl.executeRenderQueue radix sorts the records by key
+ * and issues them, only changing the state that differs from the previous
+ * draw.
+ *
+ * A binding group is the set of textures, samplers, uniform and storage
+ * buffers a draw samples, bound with the multi-bind entry points from unit
+ * (binding point) 0 up.
+ */
+
+#ifndef RENDER_QUEUE_H_
+#define RENDER_QUEUE_H_
+
+#include "common.h"
+
+namespace webgl {
+
+NAN_METHOD(CreateBindingGroup);
+NAN_METHOD(DeleteBindingGroup);
+NAN_METHOD(ExecuteRenderQueue);
+
+}
+
+#endif /* RENDER_QUEUE_H_ */
@@ -0,0 +1,332 @@
+/*
+ * render_state.cc
+ *
+ * gl.createRenderState(Float64Array desc) -> handle
+ * gl.applyRenderState(handle) -> number of GL calls issued
+ * gl.invalidateRenderState(): the next apply sets everything
+ * gl.deleteRenderState(handle)
+ */
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "render_state.h"
+#include <GL/glew.h>
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+// must match renderStateFields in lib/webgl.js
+enum RenderStateField {
+  RS_BLEND,
+  RS_BLEND_EQUATION_RGB,
+  RS_BLEND_EQUATION_ALPHA,
+  RS_BLEND_SRC_RGB,
+  RS_BLEND_DST_RGB,
+  RS_BLEND_SRC_ALPHA,
+  RS_BLEND_DST_ALPHA,
+  RS_BLEND_COLOR, // 4 values
+  RS_DEPTH_TEST = RS_BLEND_COLOR + 4,
+  RS_DEPTH_FUNC,
+  RS_DEPTH_MASK,
+  RS_STENCIL_TEST,
+  RS_STENCIL_FRONT, // func, ref, readMask, writeMask, fail, zfail, zpass
+  RS_STENCIL_BACK = RS_STENCIL_FRONT + 7,
+  RS_CULL_FACE = RS_STENCIL_BACK + 7,
+  RS_CULL_FACE_MODE,
+  RS_FRONT_FACE,
+  RS_COLOR_MASK, // 4 values
+  RS_POLYGON_OFFSET_FILL = RS_COLOR_MASK + 4,
+  RS_POLYGON_OFFSET_FACTOR,
+  RS_POLYGON_OFFSET_UNITS,
+  RS_SCISSOR_TEST,
+  RS_SCISSOR_BOX, // 4 values
+  RS_FIELDS = RS_SCISSOR_BOX + 4
+};
+
+struct StencilFace {
+  GLenum func;
+  GLint ref;
+  GLuint readMask;
+  GLuint writeMask;
+  GLenum fail, zfail, zpass;
+};
+
+// Compared and hashed bytewise, so always zeroed before it is filled.
+struct RenderState {
+  GLboolean blend;
+  GLboolean depthTest;
+  GLboolean depthMask;
+  GLboolean stencilTest;
+  GLboolean cullFace;
+  GLboolean polygonOffsetFill;
+  GLboolean scissorTest;
+  GLboolean colorMask[4];
+  GLenum blendEquation[2];
+  GLenum blendFunc[4];
+  GLfloat blendColor[4];
+  GLenum depthFunc;
+  StencilFace stencil[2];
+  GLenum cullFaceMode;
+  GLenum frontFace;
+  GLfloat polygonOffset[2];
+  GLint scissor[4];
+};
+
+static vector<RenderState> states;
+// handles from createRenderState per block, 0 for a freed slot
+static vector<uint32_t> stateRefs;
+static vector<uint32_t> freeStates;
+static unordered_map<string, uint32_t> stateIds;
+static RenderState current;
+static uint32_t currentId = 0;
+bool renderStateKnown = false;
+
+static void unpackStencilFace(StencilFace &face, const double *v) {
+  face.func = (GLenum) v[0];
+  face.ref = (GLint) v[1];
+  face.readMask = (GLuint) v[2];
+  face.writeMask = (GLuint) v[3];
+  face.fail = (GLenum) v[4];
+  face.zfail = (GLenum) v[5];
+  face.zpass = (GLenum) v[6];
+}
+
+NAN_METHOD(CreateRenderState) {
+  size_t byteLength = 0;
+  const double *v = marshal::ArrayData<double>(info[0], &byteLength);
+  if(!info[0]->IsFloat64Array() || byteLength < RS_FIELDS * sizeof(double)) {
+    Nan::ThrowTypeError("createRenderState: expected a packed render state descriptor");
+    return;
+  }
+
+  RenderState state;
+  memset(&state, 0, sizeof(state));
+  state.blend = v[RS_BLEND] != 0;
+  state.blendEquation[0] = (GLenum) v[RS_BLEND_EQUATION_RGB];
+  state.blendEquation[1] = (GLenum) v[RS_BLEND_EQUATION_ALPHA];
+  state.blendFunc[0] = (GLenum) v[RS_BLEND_SRC_RGB];
+  state.blendFunc[1] = (GLenum) v[RS_BLEND_DST_RGB];
+  state.blendFunc[2] = (GLenum) v[RS_BLEND_SRC_ALPHA];
+  state.blendFunc[3] = (GLenum) v[RS_BLEND_DST_ALPHA];
+  for(int i = 0; i < 4; i++)
+    state.blendColor[i] = (GLfloat) v[RS_BLEND_COLOR + i];
+  state.depthTest = v[RS_DEPTH_TEST] != 0;
+  state.depthFunc = (GLenum) v[RS_DEPTH_FUNC];
+  state.depthMask = v[RS_DEPTH_MASK] != 0;
+  state.stencilTest = v[RS_STENCIL_TEST] != 0;
+  unpackStencilFace(state.stencil[0], v + RS_STENCIL_FRONT);
+  unpackStencilFace(state.stencil[1], v + RS_STENCIL_BACK);
+  state.cullFace = v[RS_CULL_FACE] != 0;
+  state.cullFaceMode = (GLenum) v[RS_CULL_FACE_MODE];
+  state.frontFace = (GLenum) v[RS_FRONT_FACE];
+  for(int i = 0; i < 4; i++)
+    state.colorMask[i] = v[RS_COLOR_MASK + i] != 0;
+  state.polygonOffsetFill = v[RS_POLYGON_OFFSET_FILL] != 0;
+  state.polygonOffset[0] = (GLfloat) v[RS_POLYGON_OFFSET_FACTOR];
+  state.polygonOffset[1] = (GLfloat) v[RS_POLYGON_OFFSET_UNITS];
+  state.scissorTest = v[RS_SCISSOR_TEST] != 0;
+  for(int i = 0; i < 4; i++)
+    state.scissor[i] = (GLint) v[RS_SCISSOR_BOX + i];
+
+  string key((const char *) &state, sizeof(state));
+  auto it = stateIds.find(key);
+  if(it != stateIds.end()) {
+    stateRefs[it->second - 1]++;
+    info.GetReturnValue().Set(it->second);
+    return;
+  }
+  uint32_t id;
+  if(freeStates.empty()) {
+    states.push_back(state);
+    stateRefs.push_back(1);
+    id = (uint32_t) states.size();
+  } else {
+    id = freeStates.back();
+    freeStates.pop_back();
+    states[id - 1] = state;
+    stateRefs[id - 1] = 1;
+  }
+  stateIds[key] = id;
+  info.GetReturnValue().Set(id);
+}
+
+// Equal descriptors share a block, so it is only freed once every handle
+// createRenderState returned for it has been deleted.
+NAN_METHOD(DeleteRenderState) {
+  uint32_t id = marshal::Arg<GLuint>::Unbox(info[0]);
+  if(id == 0 || id > states.size() || !stateRefs[id - 1])
+    return;
+  if(--stateRefs[id - 1])
+    return;
+  const RenderState &state = states[id - 1];
+  stateIds.erase(string((const char *) &state, sizeof(state)));
+  freeStates.push_back(id);
+  // the slot may come back as a different block
+  if(currentId == id)
+    currentId = 0;
+}
+
+static inline void setCapability(GLenum cap, GLboolean enabled) {
+  if(enabled)
+    glEnable(cap);
+  else
+    glDisable(cap);
+}
+
+#define CHANGED(field) (all || memcmp(&next.field, &current.field, sizeof(next.field)) != 0)
+
+// The parameters of a disabled test are left as they are (and so stay in
+// the shadow as they are) unless the whole state is unknown. The write
+// masks are applied regardless, they also affect glClear.
+int ApplyRenderStateBlock(uint32_t id) {
+  if(id == 0 || id > states.size() || !stateRefs[id - 1])
+    return -1;
+  if(renderStateKnown && id == currentId)
+    return 0;
+
+  const RenderState &next = states[id - 1];
+  bool all = !renderStateKnown;
+  int calls = 0;
+
+  if(CHANGED(blend)) {
+    setCapability(GL_BLEND, next.blend);
+    calls++;
+  }
+  if(next.blend || all) {
+    if(CHANGED(blendEquation)) {
+      glBlendEquationSeparate(next.blendEquation[0], next.blendEquation[1]);
+      calls++;
+    }
+    if(CHANGED(blendFunc)) {
+      glBlendFuncSeparate(next.blendFunc[0], next.blendFunc[1], next.blendFunc[2], next.blendFunc[3]);
+      calls++;
+    }
+    if(CHANGED(blendColor)) {
+      glBlendColor(next.blendColor[0], next.blendColor[1], next.blendColor[2], next.blendColor[3]);
+      calls++;
+    }
+    memcpy(current.blendEquation, next.blendEquation, sizeof(next.blendEquation));
+    memcpy(current.blendFunc, next.blendFunc, sizeof(next.blendFunc));
+    memcpy(current.blendColor, next.blendColor, sizeof(next.blendColor));
+  }
+
+  if(CHANGED(depthTest)) {
+    setCapability(GL_DEPTH_TEST, next.depthTest);
+    calls++;
+  }
+  if((next.depthTest || all) && CHANGED(depthFunc)) {
+    glDepthFunc(next.depthFunc);
+    current.depthFunc = next.depthFunc;
+    calls++;
+  }
+  if(CHANGED(depthMask)) {
+    glDepthMask(next.depthMask);
+    calls++;
+  }
+
+  if(CHANGED(stencilTest)) {
+    setCapability(GL_STENCIL_TEST, next.stencilTest);
+    calls++;
+  }
+  // one set of calls for both faces while they match
+  StencilFace *shadow = current.stencil;
+  bool merged = memcmp(&next.stencil[0], &next.stencil[1], sizeof(StencilFace)) == 0 &&
+                (all || memcmp(&shadow[0], &shadow[1], sizeof(StencilFace)) == 0);
+  for(int i = 0; i < (merged ? 1 : 2); i++) {
+    const StencilFace &face = next.stencil[i];
+    GLenum glFace = merged ? GL_FRONT_AND_BACK : (i == 0 ? GL_FRONT : GL_BACK);
+    if((next.stencilTest || all) && (all || face.func != shadow[i].func || face.ref != shadow[i].ref || face.readMask != shadow[i].readMask)) {
+      glStencilFuncSeparate(glFace, face.func, face.ref, face.readMask);
+      calls++;
+    }
+    if((next.stencilTest || all) && (all || face.fail != shadow[i].fail || face.zfail != shadow[i].zfail || face.zpass != shadow[i].zpass)) {
+      glStencilOpSeparate(glFace, face.fail, face.zfail, face.zpass);
+      calls++;
+    }
+    if(all || face.writeMask != shadow[i].writeMask) {
+      glStencilMaskSeparate(glFace, face.writeMask);
+      calls++;
+    }
+  }
+  if(next.stencilTest || all) {
+    memcpy(shadow, next.stencil, sizeof(next.stencil));
+  } else {
+    shadow[0].writeMask = next.stencil[0].writeMask;
+    shadow[1].writeMask = next.stencil[1].writeMask;
+  }
+
+  if(CHANGED(cullFace)) {
+    setCapability(GL_CULL_FACE, next.cullFace);
+    calls++;
+  }
+  if((next.cullFace || all) && CHANGED(cullFaceMode)) {
+    glCullFace(next.cullFaceMode);
+    current.cullFaceMode = next.cullFaceMode;
+    calls++;
+  }
+  if(CHANGED(frontFace)) {
+    glFrontFace(next.frontFace);
+    calls++;
+  }
+
+  if(CHANGED(colorMask)) {
+    glColorMask(next.colorMask[0], next.colorMask[1], next.colorMask[2], next.colorMask[3]);
+    calls++;
+  }
+
+  if(CHANGED(polygonOffsetFill)) {
+    setCapability(GL_POLYGON_OFFSET_FILL, next.polygonOffsetFill);
+    calls++;
+  }
+  if((next.polygonOffsetFill || all) && CHANGED(polygonOffset)) {
+    glPolygonOffset(next.polygonOffset[0], next.polygonOffset[1]);
+    memcpy(current.polygonOffset, next.polygonOffset, sizeof(next.polygonOffset));
+    calls++;
+  }
+
+  if(CHANGED(scissorTest)) {
+    setCapability(GL_SCISSOR_TEST, next.scissorTest);
+    calls++;
+  }
+  if((next.scissorTest || all) && CHANGED(scissor)) {
+    glScissor(next.scissor[0], next.scissor[1], next.scissor[2], next.scissor[3]);
+    memcpy(current.scissor, next.scissor, sizeof(next.scissor));
+    calls++;
+  }
+
+  // the remaining fields are applied unconditionally above
+  current.blend = next.blend;
+  current.depthTest = next.depthTest;
+  current.depthMask = next.depthMask;
+  current.stencilTest = next.stencilTest;
+  current.cullFace = next.cullFace;
+  current.frontFace = next.frontFace;
+  memcpy(current.colorMask, next.colorMask, sizeof(next.colorMask));
+  current.polygonOffsetFill = next.polygonOffsetFill;
+  current.scissorTest = next.scissorTest;
+
+  currentId = id;
+  renderStateKnown = true;
+  return calls;
+}
+
+NAN_METHOD(ApplyRenderState) {
+  int calls = ApplyRenderStateBlock(marshal::Arg<GLuint>::Unbox(info[0]));
+  if(calls < 0) {
+    Nan::ThrowRangeError("applyRenderState: not a render state");
+    return;
+  }
+  info.GetReturnValue().Set(calls);
+}
+
+NAN_METHOD(InvalidateRenderState) {
+  renderStateKnown = false;
+}
+
+} // end namespace webgl
@@ -0,0 +1,46 @@
+/*
+ * render_state.h
+ *
+ * Immutable render state blocks: blending, depth, stencil, culling, color
+ * mask, polygon offset and scissor state in one object. gl.createRenderState
+ * packs a descriptor into a block and returns its handle (equal descriptors
+ * share a handle; gl.deleteRenderState releases one). gl.applyRenderState
+ * compares the block with the one applied last and only issues the GL calls
+ * for what differs, so a material change is one call into the bindings.
+ *
+ * The comparison is against a shadow of the GL state. The entry points that
+ * set any of that state one call at a time (gl.enable, gl.blendFunc, ...)
+ * are bound with GL_STATE_BINDING, which marks the shadow as unknown; the
+ * next applyRenderState then sets everything.
+ */
+
+#ifndef RENDER_STATE_H_
+#define RENDER_STATE_H_
+
+#include "common.h"
+#include "marshal.h"
+
+namespace webgl {
+
+// false once the GL state may differ from the last applied block
+extern bool renderStateKnown;
+
+// GL_BINDING for entry points that change state a render state block covers
+#define GL_STATE_BINDING(name, function, ...) \
+  NAN_METHOD(name) { \
+    webgl::renderStateKnown = false; \
+    webgl::marshal::Call<__VA_ARGS__>(info, [](auto... args) { return function(args...); }); \
+  }
+
+// Applies block id (a handle from createRenderState), returns the number of
+// GL calls issued or -1 if id isn't a render state.
+int ApplyRenderStateBlock(uint32_t id);
+
+NAN_METHOD(CreateRenderState);
+NAN_METHOD(ApplyRenderState);
+NAN_METHOD(InvalidateRenderState);
+NAN_METHOD(DeleteRenderState);
+
+}
+
+#endif /* RENDER_STATE_H_ */
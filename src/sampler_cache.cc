@@ -0,0 +1,170 @@
+/*
+ * sampler_cache.cc
+ *
+ * gl.getSampler(Float64Array desc) -> sampler name, one more reference
+ * gl.releaseSampler(sampler, count) -> true if the sampler was deleted
+ */
+
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+#include "sampler_cache.h"
+#include "gl_objects.h"
+#include "marshal.h"
+#include "texture_encoder.h"
+#include <GL/glew.h>
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+// must match samplerDescFields in lib/webgl.js
+enum SamplerDescField {
+  SAMPLER_MIN_FILTER,
+  SAMPLER_MAG_FILTER,
+  SAMPLER_WRAP_S,
+  SAMPLER_WRAP_T,
+  SAMPLER_WRAP_R,
+  SAMPLER_COMPARE_MODE,
+  SAMPLER_COMPARE_FUNC,
+  SAMPLER_MAX_ANISOTROPY,
+  SAMPLER_MIN_LOD,
+  SAMPLER_MAX_LOD,
+  SAMPLER_LOD_BIAS,
+  SAMPLER_BORDER_R,
+  SAMPLER_BORDER_G,
+  SAMPLER_BORDER_B,
+  SAMPLER_BORDER_A,
+  SAMPLER_DESC_FIELDS
+};
+
+struct SamplerDesc {
+  double values[SAMPLER_DESC_FIELDS];
+
+  bool operator==(const SamplerDesc &other) const {
+    return memcmp(values, other.values, sizeof(values)) == 0;
+  }
+};
+
+struct SamplerDescHash {
+  size_t operator()(const SamplerDesc &desc) const {
+    return (size_t) HashBytes((const uint8_t *) desc.values, sizeof(desc.values));
+  }
+};
+
+struct CachedSampler {
+  GLuint sampler;
+  uint32_t serial;
+  uint32_t refs;
+};
+
+static unordered_map<SamplerDesc, CachedSampler, SamplerDescHash> samplers;
+static unordered_map<GLuint, SamplerDesc> samplerDescs;
+static uint64_t hits = 0;
+static uint64_t misses = 0;
+
+static GLuint createSampler(const SamplerDesc &desc) {
+  const double *v = desc.values;
+  GLuint sampler;
+  glCreateSamplers(1, &sampler);
+  glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, (GLint) v[SAMPLER_MIN_FILTER]);
+  glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, (GLint) v[SAMPLER_MAG_FILTER]);
+  glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, (GLint) v[SAMPLER_WRAP_S]);
+  glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, (GLint) v[SAMPLER_WRAP_T]);
+  glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, (GLint) v[SAMPLER_WRAP_R]);
+  glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_MODE, (GLint) v[SAMPLER_COMPARE_MODE]);
+  glSamplerParameteri(sampler, GL_TEXTURE_COMPARE_FUNC, (GLint) v[SAMPLER_COMPARE_FUNC]);
+  if(v[SAMPLER_MAX_ANISOTROPY] > 1)
+    glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, (GLfloat) v[SAMPLER_MAX_ANISOTROPY]);
+  glSamplerParameterf(sampler, GL_TEXTURE_MIN_LOD, (GLfloat) v[SAMPLER_MIN_LOD]);
+  glSamplerParameterf(sampler, GL_TEXTURE_MAX_LOD, (GLfloat) v[SAMPLER_MAX_LOD]);
+  glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, (GLfloat) v[SAMPLER_LOD_BIAS]);
+  GLfloat border[4] = { (GLfloat) v[SAMPLER_BORDER_R], (GLfloat) v[SAMPLER_BORDER_G],
+                        (GLfloat) v[SAMPLER_BORDER_B], (GLfloat) v[SAMPLER_BORDER_A] };
+  glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, border);
+  return sampler;
+}
+
+NAN_METHOD(GetSampler) {
+  size_t byteLength = 0;
+  const double *values = marshal::ArrayData<double>(info[0], &byteLength);
+  if(!info[0]->IsFloat64Array() || byteLength < sizeof(SamplerDesc)) {
+    Nan::ThrowTypeError("getSampler: expected a packed sampler descriptor");
+    return;
+  }
+  SamplerDesc desc;
+  memcpy(desc.values, values, sizeof(desc.values));
+
+  auto it = samplers.find(desc);
+  // a cached sampler deleted behind the cache's back (deleteSampler, or its
+  // name reclaimed and reused) is replaced
+  if(it != samplers.end() && GLObjSerial(GLOBJECT_TYPE_SAMPLER, it->second.sampler) != it->second.serial) {
+    samplerDescs.erase(it->second.sampler);
+    samplers.erase(it);
+    it = samplers.end();
+  }
+
+  if(it != samplers.end()) {
+    hits++;
+    it->second.refs++;
+    info.GetReturnValue().Set(it->second.sampler);
+    return;
+  }
+
+  misses++;
+  CachedSampler cached;
+  cached.sampler = createSampler(desc);
+  registerGLObj(GLOBJECT_TYPE_SAMPLER, cached.sampler);
+  cached.serial = GLObjSerial(GLOBJECT_TYPE_SAMPLER, cached.sampler);
+  cached.refs = 1;
+  samplers[desc] = cached;
+  samplerDescs[cached.sampler] = desc;
+  info.GetReturnValue().Set(cached.sampler);
+}
+
+// gl.releaseSampler(sampler, count): drops count references (all of them
+// for Infinity) and deletes the sampler with the last one
+NAN_METHOD(ReleaseSampler) {
+  GLuint sampler = marshal::Arg<GLuint>::Unbox(info[0]);
+  double count = marshal::Arg<double>::Unbox(info[1]);
+
+  auto desc = samplerDescs.find(sampler);
+  if(desc == samplerDescs.end()) {
+    info.GetReturnValue().Set(false);
+    return;
+  }
+  auto it = samplers.find(desc->second);
+  CachedSampler &cached = it->second;
+  bool valid = GLObjSerial(GLOBJECT_TYPE_SAMPLER, sampler) == cached.serial;
+  if(valid && count < cached.refs) {
+    cached.refs -= (uint32_t) count;
+    info.GetReturnValue().Set(false);
+    return;
+  }
+
+  if(valid) {
+    glDeleteSamplers(1, &sampler);
+    unregisterGLObj(GLOBJECT_TYPE_SAMPLER, sampler);
+  }
+  samplers.erase(it);
+  samplerDescs.erase(desc);
+  info.GetReturnValue().Set(true);
+}
+
+NAN_METHOD(GetSamplerCacheStats) {
+  uint64_t refs = 0;
+  for(auto &entry : samplers)
+    refs += entry.second.refs;
+
+  Local<Object> stats = Nan::New<Object>();
+  Nan::Set(stats, JS_STR("samplers"), JS_FLOAT((double) samplers.size()));
+  Nan::Set(stats, JS_STR("references"), JS_FLOAT((double) refs));
+  Nan::Set(stats, JS_STR("hits"), JS_FLOAT((double) hits));
+  Nan::Set(stats, JS_STR("misses"), JS_FLOAT((double) misses));
+  info.GetReturnValue().Set(stats);
+}
+
+} // end namespace webgl
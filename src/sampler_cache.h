@@ -0,0 +1,29 @@
+/*
+ * sampler_cache.h
+ *
+ * Shared sampler objects keyed by their parameters. gl.getSampler(desc)
+ * returns the same GL sampler for every equal descriptor, so an app that
+ * samples a hundred textures the same way has one sampler instead of a
+ * hundred (or a hundred sets of texture parameters), and binding code can
+ * compare samplers by identity.
+ *
+ * Cached samplers are reference counted: every getSampler takes a reference,
+ * releaseSampler drops one and the sampler is deleted with the last one.
+ * They are registered like any other GL object, so AtExit deletes them; the
+ * serial of the registration tells whether a cached name is still valid.
+ */
+
+#ifndef SAMPLER_CACHE_H_
+#define SAMPLER_CACHE_H_
+
+#include "common.h"
+
+namespace webgl {
+
+NAN_METHOD(GetSampler);
+NAN_METHOD(ReleaseSampler);
+NAN_METHOD(GetSamplerCacheStats);
+
+}
+
+#endif /* SAMPLER_CACHE_H_ */
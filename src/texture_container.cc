@@ -0,0 +1,544 @@
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+#include "texture_container.h"
+
+namespace webgl {
+
+using namespace std;
+
+// both containers are little endian, as are all the platforms we build on
+static uint32_t read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+static uint64_t read64(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, 8);
+  return v;
+}
+
+static int mipDimension(int size, int level) {
+  int d = size >> level;
+  return d > 0 ? d : 1;
+}
+
+// levels in a full mip chain of a width x height image, 0 when either size is
+// zero or doesn't fit an int
+static uint32_t fullMipChain(uint32_t width, uint32_t height) {
+  if(width == 0 || height == 0 || width > INT_MAX || height > INT_MAX)
+    return 0;
+  uint32_t size = width > height ? width : height, levels = 1;
+  while(size >>= 1)
+    levels++;
+  return levels;
+}
+
+bool GetCompressedFormatInfo(GLenum internalFormat, int *blockWidth, int *blockHeight, int *blockBytes) {
+  *blockWidth = 4;
+  *blockHeight = 4;
+
+  switch(internalFormat) {
+  case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_RED_RGTC1:
+  case GL_COMPRESSED_SIGNED_RED_RGTC1:
+  case GL_COMPRESSED_RGB8_ETC2:
+  case GL_COMPRESSED_SRGB8_ETC2:
+  case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+  case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+  case GL_COMPRESSED_R11_EAC:
+  case GL_COMPRESSED_SIGNED_R11_EAC:
+    *blockBytes = 8;
+    return true;
+
+  case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+  case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+  case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+  case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+  case GL_COMPRESSED_RG_RGTC2:
+  case GL_COMPRESSED_SIGNED_RG_RGTC2:
+  case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+  case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+  case GL_COMPRESSED_RGBA_BPTC_UNORM:
+  case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+  case GL_COMPRESSED_RGBA8_ETC2_EAC:
+  case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+  case GL_COMPRESSED_RG11_EAC:
+  case GL_COMPRESSED_SIGNED_RG11_EAC:
+    *blockBytes = 16;
+    return true;
+  }
+
+  // ASTC: 16 bytes per block, footprint depends on the format
+  static const int astcFootprints[][2] = {
+    {4,4}, {5,4}, {5,5}, {6,5}, {6,6}, {8,5}, {8,6}, {8,8},
+    {10,5}, {10,6}, {10,8}, {10,10}, {12,10}, {12,12}
+  };
+  int astc = -1;
+  if(internalFormat >= GL_COMPRESSED_RGBA_ASTC_4x4_KHR && internalFormat <= GL_COMPRESSED_RGBA_ASTC_12x12_KHR)
+    astc = internalFormat - GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+  else if(internalFormat >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR && internalFormat <= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR)
+    astc = internalFormat - GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
+  if(astc >= 0) {
+    *blockWidth = astcFootprints[astc][0];
+    *blockHeight = astcFootprints[astc][1];
+    *blockBytes = 16;
+    return true;
+  }
+
+  return false;
+}
+
+size_t CompressedLevelSize(GLenum internalFormat, int width, int height) {
+  int bw, bh, bytes;
+  if(!GetCompressedFormatInfo(internalFormat, &bw, &bh, &bytes))
+    return 0;
+  size_t blocksX = (width + bw - 1) / bw;
+  size_t blocksY = (height + bh - 1) / bh;
+  return blocksX * blocksY * bytes;
+}
+
+/*
+ * KTX2
+ */
+
+static const uint8_t ktx2Identifier[12] = {
+  0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+
+static GLenum vkFormatToGL(uint32_t vkFormat) {
+  switch(vkFormat) {
+  case 131: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;          // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+  case 132: return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+  case 133: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+  case 134: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+  case 135: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;         // BC2
+  case 136: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+  case 137: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;         // BC3
+  case 138: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+  case 139: return GL_COMPRESSED_RED_RGTC1;                  // BC4
+  case 140: return GL_COMPRESSED_SIGNED_RED_RGTC1;
+  case 141: return GL_COMPRESSED_RG_RGTC2;                   // BC5
+  case 142: return GL_COMPRESSED_SIGNED_RG_RGTC2;
+  case 143: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;    // BC6H
+  case 144: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+  case 145: return GL_COMPRESSED_RGBA_BPTC_UNORM;            // BC7
+  case 146: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+  case 147: return GL_COMPRESSED_RGB8_ETC2;
+  case 148: return GL_COMPRESSED_SRGB8_ETC2;
+  case 149: return GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+  case 150: return GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2;
+  case 151: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+  case 152: return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+  case 153: return GL_COMPRESSED_R11_EAC;
+  case 154: return GL_COMPRESSED_SIGNED_R11_EAC;
+  case 155: return GL_COMPRESSED_RG11_EAC;
+  case 156: return GL_COMPRESSED_SIGNED_RG11_EAC;
+  }
+  // VK_FORMAT_ASTC_4x4_UNORM_BLOCK .. VK_FORMAT_ASTC_12x12_SRGB_BLOCK alternate UNORM/SRGB
+  if(vkFormat >= 157 && vkFormat <= 184) {
+    uint32_t i = vkFormat - 157;
+    return (i & 1) ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR + (i >> 1)
+                   : GL_COMPRESSED_RGBA_ASTC_4x4_KHR + (i >> 1);
+  }
+  return 0;
+}
+
+static uint32_t glFormatToVk(GLenum internalFormat) {
+  for(uint32_t vkFormat = 131; vkFormat <= 184; vkFormat++)
+    if(vkFormatToGL(vkFormat) == internalFormat)
+      return vkFormat;
+  return 0;
+}
+
+bool ParseKTX2(const uint8_t *data, size_t size, CompressedImage *image, const char **error) {
+  const size_t headerSize = 80;
+  if(size < headerSize || memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)) != 0) {
+    *error = "KTX2: bad file identifier";
+    return false;
+  }
+
+  uint32_t vkFormat = read32(data + 12);
+  uint32_t pixelWidth = read32(data + 20);
+  uint32_t pixelHeight = read32(data + 24);
+  uint32_t pixelDepth = read32(data + 28);
+  uint32_t layerCount = read32(data + 32);
+  uint32_t faceCount = read32(data + 36);
+  uint32_t levelCount = read32(data + 40);
+  uint32_t supercompression = read32(data + 44);
+
+  if(supercompression != 0) {
+    *error = "KTX2: supercompressed (BasisLZ/zstd/zlib) files are not supported";
+    return false;
+  }
+  if(pixelDepth > 1 || layerCount > 1 || faceCount != 1 || pixelHeight == 0) {
+    *error = "KTX2: only single 2D images are supported (no arrays, cube maps or 3D)";
+    return false;
+  }
+  uint32_t maxLevels = fullMipChain(pixelWidth, pixelHeight);
+  if(!maxLevels || levelCount > maxLevels) {
+    *error = "KTX2: bad image size or level count";
+    return false;
+  }
+
+  GLenum internalFormat = vkFormatToGL(vkFormat);
+  if(!internalFormat) {
+    *error = "KTX2: not a block compressed format";
+    return false;
+  }
+
+  // levelCount 0 means "generate mipmaps at load time"; only the base is stored
+  uint32_t storedLevels = levelCount ? levelCount : 1;
+  if(size < headerSize + (size_t) storedLevels * 24) {
+    *error = "KTX2: truncated level index";
+    return false;
+  }
+
+  image->internalFormat = internalFormat;
+  image->width = pixelWidth;
+  image->height = pixelHeight;
+  GetCompressedFormatInfo(internalFormat, &image->blockWidth, &image->blockHeight, &image->blockBytes);
+  image->levels.clear();
+
+  for(uint32_t level = 0; level < storedLevels; level++) {
+    const uint8_t *entry = data + headerSize + level * 24;
+    uint64_t byteOffset = read64(entry);
+    uint64_t byteLength = read64(entry + 8);
+
+    CompressedLevel l;
+    l.width = mipDimension(pixelWidth, level);
+    l.height = mipDimension(pixelHeight, level);
+    l.size = (size_t) byteLength;
+
+    if(byteOffset > size || byteLength > size - byteOffset ||
+       l.size < CompressedLevelSize(internalFormat, l.width, l.height)) {
+      *error = "KTX2: level data out of range";
+      return false;
+    }
+    l.data = data + byteOffset;
+    image->levels.push_back(l);
+  }
+  return true;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+  memcpy(p, &v, 4);
+}
+
+static void put64(uint8_t *p, uint64_t v) {
+  memcpy(p, &v, 8);
+}
+
+// KHR_DF_* values from the Khronos Data Format Specification
+enum {
+  DF_MODEL_BC1A = 128, DF_MODEL_BC2, DF_MODEL_BC3, DF_MODEL_BC4, DF_MODEL_BC5, DF_MODEL_BC6H, DF_MODEL_BC7,
+  DF_MODEL_ETC2 = 161, DF_MODEL_ASTC
+};
+enum { DF_PRIMARIES_BT709 = 1 };
+enum { DF_TRANSFER_LINEAR = 1, DF_TRANSFER_SRGB };
+enum { DF_CHANNEL_COLOR = 0, DF_CHANNEL_BC1A_ALPHAPRESENT = 1, DF_CHANNEL_GREEN = 1, DF_CHANNEL_ETC2_COLOR = 2, DF_CHANNEL_ALPHA = 15 };
+enum { DF_SAMPLE_LINEAR = 1, DF_SAMPLE_SIGNED = 4, DF_SAMPLE_FLOAT = 8 };
+
+struct DFDSample {
+  uint32_t channel;
+  uint32_t bitOffset;
+  uint32_t bitLength;
+};
+
+// The data format descriptor of a compressed vkFormat (dfdTotalSize and one
+// basic descriptor block), a sample per 64 or 128 bit part of a block. The
+// formats come in pairs that differ in the transfer function or the sign; the
+// even vkFormat is the sRGB or signed one.
+static vector<uint8_t> basicDFD(uint32_t vkFormat, const CompressedImage &image) {
+  bool second = (vkFormat & 1) == 0;
+  DFDSample samples[2] = {{DF_CHANNEL_COLOR, 0, 128}, {DF_CHANNEL_COLOR, 64, 64}};
+  int count = 1;
+  uint32_t model;
+  bool srgb = false, sign = false, floating = false;
+
+  switch(vkFormat) {
+  case 131: case 132:
+  case 133: case 134:
+    model = DF_MODEL_BC1A;
+    samples[0].channel = vkFormat >= 133 ? DF_CHANNEL_BC1A_ALPHAPRESENT : DF_CHANNEL_COLOR;
+    samples[0].bitLength = 64;
+    srgb = second;
+    break;
+  case 135: case 136:
+  case 137: case 138:
+    model = vkFormat <= 136 ? DF_MODEL_BC2 : DF_MODEL_BC3;
+    samples[0] = {DF_CHANNEL_ALPHA, 0, 64};
+    count = 2;
+    srgb = second;
+    break;
+  case 139: case 140:
+    model = DF_MODEL_BC4;
+    samples[0].bitLength = 64;
+    sign = second;
+    break;
+  case 141: case 142:
+    model = DF_MODEL_BC5;
+    samples[0].bitLength = 64;
+    samples[1].channel = DF_CHANNEL_GREEN;
+    count = 2;
+    sign = second;
+    break;
+  case 143: case 144:
+    model = DF_MODEL_BC6H;
+    floating = true;
+    sign = second;
+    break;
+  case 145: case 146:
+    model = DF_MODEL_BC7;
+    srgb = second;
+    break;
+  case 147: case 148:
+  case 149: case 150:
+    model = DF_MODEL_ETC2;
+    samples[0] = {DF_CHANNEL_ETC2_COLOR, 0, 64};
+    srgb = second;
+    break;
+  case 151: case 152:
+    model = DF_MODEL_ETC2;
+    samples[0] = {DF_CHANNEL_ALPHA, 0, 64};
+    samples[1].channel = DF_CHANNEL_ETC2_COLOR;
+    count = 2;
+    srgb = second;
+    break;
+  case 153: case 154:
+  case 155: case 156:
+    model = DF_MODEL_ETC2;
+    samples[0].bitLength = 64;
+    samples[1].channel = DF_CHANNEL_GREEN;
+    count = vkFormat >= 155 ? 2 : 1;
+    sign = second;
+    break;
+  default:
+    model = DF_MODEL_ASTC;
+    srgb = second;
+    break;
+  }
+
+  uint32_t blockSize = 24 + 16 * count;
+  vector<uint8_t> dfd(4 + blockSize, 0);
+  uint8_t *p = &dfd[0];
+  put32(p, (uint32_t) dfd.size());
+  put32(p + 4, 0);                                      // vendorId, descriptorType
+  put32(p + 8, 2 | (blockSize << 16));                  // versionNumber, descriptorBlockSize
+  put32(p + 12, model | (DF_PRIMARIES_BT709 << 8) | ((srgb ? DF_TRANSFER_SRGB : DF_TRANSFER_LINEAR) << 16));
+  put32(p + 16, (uint32_t) (image.blockWidth - 1) | ((uint32_t) (image.blockHeight - 1) << 8));
+  put32(p + 20, (uint32_t) image.blockBytes);           // bytesPlane0
+  for(int i = 0; i < count; i++) {
+    uint8_t *sample = p + 28 + i * 16;
+    uint32_t qualifiers = (sign ? DF_SAMPLE_SIGNED : 0) | (floating ? DF_SAMPLE_FLOAT : 0);
+    // alpha is stored linearly in sRGB formats
+    if(srgb && samples[i].channel == DF_CHANNEL_ALPHA)
+      qualifiers |= DF_SAMPLE_LINEAR;
+    put32(sample, samples[i].bitOffset | ((samples[i].bitLength - 1) << 16) | (samples[i].channel << 24) | (qualifiers << 28));
+    // samplePosition is 0 for block compressed formats; sampleLower, sampleUpper
+    if(floating) {
+      put32(sample + 8, sign ? 0xBF800000 : 0);         // -1.0f, 0.0f
+      put32(sample + 12, 0x3F800000);                   // 1.0f
+    } else {
+      put32(sample + 8, sign ? 0x80000000 : 0);
+      put32(sample + 12, sign ? 0x7FFFFFFF : 0xFFFFFFFF);
+    }
+  }
+  return dfd;
+}
+
+bool WriteKTX2(const char *filename, const CompressedImage &image) {
+  uint32_t vkFormat = glFormatToVk(image.internalFormat);
+  if(!vkFormat || image.levels.empty())
+    return false;
+
+  const size_t headerSize = 80;
+  size_t levelCount = image.levels.size();
+  vector<uint8_t> header(headerSize + levelCount * 24, 0);
+
+  memcpy(&header[0], ktx2Identifier, sizeof(ktx2Identifier));
+  put32(&header[12], vkFormat);
+  put32(&header[16], 1);                // typeSize
+  put32(&header[20], image.width);
+  put32(&header[24], image.height);
+  put32(&header[36], 1);                // faceCount
+  put32(&header[40], (uint32_t) levelCount);
+
+  // the data format descriptor follows the level index
+  vector<uint8_t> dfd = basicDFD(vkFormat, image);
+  put32(&header[48], (uint32_t) header.size());   // dfdByteOffset
+  put32(&header[52], (uint32_t) dfd.size());      // dfdByteLength
+  header.insert(header.end(), dfd.begin(), dfd.end());
+
+  // level data goes smallest first, each level aligned to the block size
+  size_t align = image.blockBytes;
+  vector<size_t> offsets(levelCount);
+  size_t offset = header.size();
+  for(size_t i = levelCount; i-- > 0;) {
+    offset = (offset + align - 1) / align * align;
+    offsets[i] = offset;
+    offset += image.levels[i].size;
+  }
+  for(size_t i = 0; i < levelCount; i++) {
+    uint8_t *entry = &header[headerSize + i * 24];
+    put64(entry, offsets[i]);
+    put64(entry + 8, image.levels[i].size);
+    put64(entry + 16, image.levels[i].size);
+  }
+
+  FILE *f = fopen(filename, "wb");
+  if(!f)
+    return false;
+
+  bool ok = fwrite(&header[0], 1, header.size(), f) == header.size();
+  size_t pos = header.size();
+  static const uint8_t zeros[16] = {};
+  for(size_t i = levelCount; ok && i-- > 0;) {
+    ok = fwrite(zeros, 1, offsets[i] - pos, f) == offsets[i] - pos &&
+         fwrite(image.levels[i].data, 1, image.levels[i].size, f) == image.levels[i].size;
+    pos = offsets[i] + image.levels[i].size;
+  }
+  ok = fclose(f) == 0 && ok;
+  return ok;
+}
+
+/*
+ * DDS
+ */
+
+#define DDS_FOURCC(a, b, c, d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+
+static GLenum ddsFourCCToGL(uint32_t fourCC) {
+  switch(fourCC) {
+  case DDS_FOURCC('D','X','T','1'): return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+  case DDS_FOURCC('D','X','T','3'): return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+  case DDS_FOURCC('D','X','T','5'): return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+  case DDS_FOURCC('A','T','I','1'):
+  case DDS_FOURCC('B','C','4','U'): return GL_COMPRESSED_RED_RGTC1;
+  case DDS_FOURCC('B','C','4','S'): return GL_COMPRESSED_SIGNED_RED_RGTC1;
+  case DDS_FOURCC('A','T','I','2'):
+  case DDS_FOURCC('B','C','5','U'): return GL_COMPRESSED_RG_RGTC2;
+  case DDS_FOURCC('B','C','5','S'): return GL_COMPRESSED_SIGNED_RG_RGTC2;
+  }
+  return 0;
+}
+
+static GLenum dxgiFormatToGL(uint32_t dxgiFormat) {
+  switch(dxgiFormat) {
+  case 71: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;          // DXGI_FORMAT_BC1_UNORM
+  case 72: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+  case 74: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;          // BC2
+  case 75: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+  case 77: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;          // BC3
+  case 78: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+  case 80: return GL_COMPRESSED_RED_RGTC1;                   // BC4
+  case 81: return GL_COMPRESSED_SIGNED_RED_RGTC1;
+  case 83: return GL_COMPRESSED_RG_RGTC2;                    // BC5
+  case 84: return GL_COMPRESSED_SIGNED_RG_RGTC2;
+  case 95: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;     // BC6H
+  case 96: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+  case 98: return GL_COMPRESSED_RGBA_BPTC_UNORM;             // BC7
+  case 99: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+  }
+  return 0;
+}
+
+bool ParseDDS(const uint8_t *data, size_t size, CompressedImage *image, const char **error) {
+  // "DDS " + 124 byte DDS_HEADER
+  if(size < 128 || read32(data) != DDS_FOURCC('D','D','S',' ') || read32(data + 4) != 124) {
+    *error = "DDS: bad header";
+    return false;
+  }
+
+  const uint8_t *header = data + 4;
+  uint32_t height = read32(header + 8);
+  uint32_t width = read32(header + 12);
+  uint32_t depth = read32(header + 20);
+  uint32_t mipMapCount = read32(header + 24);
+  uint32_t pfFlags = read32(header + 76);
+  uint32_t fourCC = read32(header + 80);
+  uint32_t caps2 = read32(header + 108);
+
+  const uint32_t DDPF_FOURCC = 0x4;
+  const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+  const uint32_t DDSCAPS2_VOLUME = 0x200000;
+
+  if(!(pfFlags & DDPF_FOURCC)) {
+    *error = "DDS: only block compressed (FourCC) files are supported";
+    return false;
+  }
+  if((caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) || depth > 1) {
+    *error = "DDS: only single 2D images are supported (no cube maps or volumes)";
+    return false;
+  }
+  uint32_t maxLevels = fullMipChain(width, height);
+  if(!maxLevels || mipMapCount > maxLevels) {
+    *error = "DDS: bad image size or level count";
+    return false;
+  }
+
+  size_t offset = 128;
+  GLenum internalFormat;
+  if(fourCC == DDS_FOURCC('D','X','1','0')) {
+    // DDS_HEADER_DXT10 follows the main header
+    if(size < 148) {
+      *error = "DDS: truncated DX10 header";
+      return false;
+    }
+    uint32_t dxgiFormat = read32(data + 128);
+    uint32_t resourceDimension = read32(data + 132);
+    uint32_t arraySize = read32(data + 140);
+    if(resourceDimension != 3 /* D3D10_RESOURCE_DIMENSION_TEXTURE2D */ || arraySize > 1) {
+      *error = "DDS: only single 2D images are supported (no arrays)";
+      return false;
+    }
+    internalFormat = dxgiFormatToGL(dxgiFormat);
+    offset = 148;
+  }
+  else
+    internalFormat = ddsFourCCToGL(fourCC);
+
+  if(!internalFormat) {
+    *error = "DDS: unsupported compression format";
+    return false;
+  }
+
+  image->internalFormat = internalFormat;
+  image->width = width;
+  image->height = height;
+  GetCompressedFormatInfo(internalFormat, &image->blockWidth, &image->blockHeight, &image->blockBytes);
+  image->levels.clear();
+
+  uint32_t levelCount = mipMapCount ? mipMapCount : 1;
+  for(uint32_t level = 0; level < levelCount; level++) {
+    CompressedLevel l;
+    l.width = mipDimension(width, level);
+    l.height = mipDimension(height, level);
+    l.size = CompressedLevelSize(internalFormat, l.width, l.height);
+    if(l.size > size - offset) {
+      *error = "DDS: level data out of range";
+      return false;
+    }
+    l.data = data + offset;
+    offset += l.size;
+    image->levels.push_back(l);
+  }
+  return true;
+}
+
+bool ParseCompressedContainer(const uint8_t *data, size_t size, CompressedImage *image, const char **error) {
+  if(size >= sizeof(ktx2Identifier) && memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)) == 0)
+    return ParseKTX2(data, size, image, error);
+  if(size >= 4 && read32(data) == DDS_FOURCC('D','D','S',' '))
+    return ParseDDS(data, size, image, error);
+  *error = "unknown texture container (expected KTX2 or DDS)";
+  return false;
+}
+
+} // end namespace webgl
@@ -0,0 +1,58 @@
+/*
+ * texture_container.h
+ *
+ * Parsers for block compressed texture containers (KTX2 and DDS). Parsing
+ * never copies: every level points into the caller's (usually mapped) bytes.
+ * A minimal KTX2 writer backs the encoded texture cache.
+ */
+
+#ifndef TEXTURE_CONTAINER_H_
+#define TEXTURE_CONTAINER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+
+namespace webgl {
+
+struct CompressedLevel {
+  const uint8_t *data;
+  size_t size;
+  int width;
+  int height;
+};
+
+struct CompressedImage {
+  GLenum internalFormat;
+  int width;
+  int height;
+  int blockWidth;
+  int blockHeight;
+  int blockBytes;
+  std::vector<CompressedLevel> levels;   // level 0 (largest) first
+};
+
+// Block layout of a compressed GL internal format. Returns false for formats
+// the loaders don't know about.
+bool GetCompressedFormatInfo(GLenum internalFormat, int *blockWidth, int *blockHeight, int *blockBytes);
+
+// Byte size of one level of the given dimensions.
+size_t CompressedLevelSize(GLenum internalFormat, int width, int height);
+
+// On failure these return false and point *error at a static message.
+bool ParseKTX2(const uint8_t *data, size_t size, CompressedImage *image, const char **error);
+bool ParseDDS(const uint8_t *data, size_t size, CompressedImage *image, const char **error);
+
+// Picks the parser from the file magic.
+bool ParseCompressedContainer(const uint8_t *data, size_t size, CompressedImage *image, const char **error);
+
+// Writes image as a KTX2 file that ParseKTX2 can read back. No data format
+// descriptor or key/value data is written, so other tools may reject it; it
+// is meant for caching our own encoder output.
+bool WriteKTX2(const char *filename, const CompressedImage &image);
+
+} // end namespace webgl
+
+#endif /* TEXTURE_CONTAINER_H_ */
@@ -0,0 +1,821 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define WEBGL_ENCODER_SSE2
+  #include <emmintrin.h>
+#endif
+
+#include "texture_encoder.h"
+#include "texture_container.h"
+#include "parallel.h"
+
+namespace webgl {
+
+using namespace std;
+
+// One 4x4 block, split into channels so four pixels can be processed at once.
+struct Block {
+  alignas(16) float r[16];
+  alignas(16) float g[16];
+  alignas(16) float b[16];
+  alignas(16) float a[16];
+  uint8_t rgba[16][4];
+};
+
+static inline float clampf(float v, float lo, float hi) {
+  return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static inline int clampi(int v, int lo, int hi) {
+  return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// Edge blocks of images that aren't a multiple of 4 repeat the last row/column.
+static void loadBlock(const uint8_t *rgba, int width, int height, int bx, int by, Block *blk) {
+  for(int y = 0; y < 4; y++) {
+    int sy = min(by * 4 + y, height - 1);
+    for(int x = 0; x < 4; x++) {
+      int sx = min(bx * 4 + x, width - 1);
+      const uint8_t *p = rgba + ((size_t)sy * width + sx) * 4;
+      int i = y * 4 + x;
+      memcpy(blk->rgba[i], p, 4);
+      blk->r[i] = p[0];
+      blk->g[i] = p[1];
+      blk->b[i] = p[2];
+      blk->a[i] = p[3];
+    }
+  }
+}
+
+// Nearest palette entry for every pixel (alpha only counts if channels == 4).
+// Returns the summed squared error.
+static float selectIndices(const Block &blk, const float (*palette)[4], int count, int channels, uint8_t *indices) {
+#ifdef WEBGL_ENCODER_SSE2
+  __m128 total = _mm_setzero_ps();
+  __m128 alphaMask = channels == 4 ? _mm_castsi128_ps(_mm_set1_epi32(-1)) : _mm_setzero_ps();
+  for(int i = 0; i < 16; i += 4) {
+    __m128 r = _mm_load_ps(blk.r + i);
+    __m128 g = _mm_load_ps(blk.g + i);
+    __m128 b = _mm_load_ps(blk.b + i);
+    __m128 a = _mm_load_ps(blk.a + i);
+    __m128 best = _mm_set1_ps(FLT_MAX);
+    __m128i bestIndex = _mm_setzero_si128();
+    for(int p = 0; p < count; p++) {
+      __m128 dr = _mm_sub_ps(r, _mm_set1_ps(palette[p][0]));
+      __m128 dg = _mm_sub_ps(g, _mm_set1_ps(palette[p][1]));
+      __m128 db = _mm_sub_ps(b, _mm_set1_ps(palette[p][2]));
+      __m128 da = _mm_and_ps(_mm_sub_ps(a, _mm_set1_ps(palette[p][3])), alphaMask);
+      __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)),
+                            _mm_add_ps(_mm_mul_ps(db, db), _mm_mul_ps(da, da)));
+      __m128i less = _mm_castps_si128(_mm_cmplt_ps(d, best));
+      best = _mm_min_ps(d, best);
+      bestIndex = _mm_or_si128(_mm_and_si128(less, _mm_set1_epi32(p)), _mm_andnot_si128(less, bestIndex));
+    }
+    total = _mm_add_ps(total, best);
+    alignas(16) int32_t idx[4];
+    _mm_store_si128((__m128i*)idx, bestIndex);
+    for(int k = 0; k < 4; k++)
+      indices[i + k] = (uint8_t) idx[k];
+  }
+  alignas(16) float sums[4];
+  _mm_store_ps(sums, total);
+  return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+  float total = 0;
+  for(int i = 0; i < 16; i++) {
+    float best = FLT_MAX;
+    int bestIndex = 0;
+    for(int p = 0; p < count; p++) {
+      float dr = blk.r[i] - palette[p][0];
+      float dg = blk.g[i] - palette[p][1];
+      float db = blk.b[i] - palette[p][2];
+      float da = channels == 4 ? blk.a[i] - palette[p][3] : 0;
+      float d = dr * dr + dg * dg + db * db + da * da;
+      if(d < best) {
+        best = d;
+        bestIndex = p;
+      }
+    }
+    total += best;
+    indices[i] = (uint8_t) bestIndex;
+  }
+  return total;
+#endif
+}
+
+// Endpoints along the principal axis of the block's colours (power iteration
+// on the covariance matrix).
+static void principalEndpoints(const Block &blk, int channels, float e0[4], float e1[4]) {
+  const float *ch[4] = { blk.r, blk.g, blk.b, blk.a };
+  float mean[4] = { 0, 0, 0, 0 };
+  for(int c = 0; c < channels; c++) {
+    for(int i = 0; i < 16; i++)
+      mean[c] += ch[c][i];
+    mean[c] /= 16;
+  }
+
+  float cov[4][4] = {};
+  for(int i = 0; i < 16; i++) {
+    float d[4] = { 0, 0, 0, 0 };
+    for(int c = 0; c < channels; c++)
+      d[c] = ch[c][i] - mean[c];
+    for(int c = 0; c < channels; c++)
+      for(int k = c; k < channels; k++)
+        cov[c][k] += d[c] * d[k];
+  }
+  for(int c = 0; c < channels; c++)
+    for(int k = 0; k < c; k++)
+      cov[c][k] = cov[k][c];
+
+  // start from the row with the largest variance
+  int start = 0;
+  for(int c = 1; c < channels; c++)
+    if(cov[c][c] > cov[start][start])
+      start = c;
+  float axis[4] = { 0, 0, 0, 0 };
+  for(int c = 0; c < channels; c++)
+    axis[c] = cov[start][c];
+
+  for(int iter = 0; iter < 8; iter++) {
+    float next[4] = { 0, 0, 0, 0 };
+    float len = 0;
+    for(int c = 0; c < channels; c++) {
+      for(int k = 0; k < channels; k++)
+        next[c] += cov[c][k] * axis[k];
+      len = max(len, fabsf(next[c]));
+    }
+    if(len < 1e-6f)
+      break;
+    for(int c = 0; c < channels; c++)
+      axis[c] = next[c] / len;
+  }
+
+  float len2 = 0;
+  for(int c = 0; c < channels; c++)
+    len2 += axis[c] * axis[c];
+  if(len2 < 1e-12f) {
+    // flat block
+    for(int c = 0; c < 4; c++)
+      e0[c] = e1[c] = mean[c];
+    return;
+  }
+
+  float tmin = FLT_MAX, tmax = -FLT_MAX;
+  for(int i = 0; i < 16; i++) {
+    float t = 0;
+    for(int c = 0; c < channels; c++)
+      t += (ch[c][i] - mean[c]) * axis[c];
+    tmin = min(tmin, t);
+    tmax = max(tmax, t);
+  }
+  for(int c = 0; c < channels; c++) {
+    e0[c] = clampf(mean[c] + axis[c] * tmin / len2, 0, 255);
+    e1[c] = clampf(mean[c] + axis[c] * tmax / len2, 0, 255);
+  }
+  for(int c = channels; c < 4; c++)
+    e0[c] = e1[c] = mean[c];
+}
+
+// Least squares endpoints for fixed indices; weights[i] is how far palette
+// entry i sits from e0 towards e1. Returns false if the system is singular.
+static bool refineEndpoints(const Block &blk, int channels, const uint8_t *indices, const float *weights,
+                            float e0[4], float e1[4]) {
+  const float *ch[4] = { blk.r, blk.g, blk.b, blk.a };
+  float aa = 0, ab = 0, bb = 0;
+  float x[4] = { 0, 0, 0, 0 }, y[4] = { 0, 0, 0, 0 };
+  for(int i = 0; i < 16; i++) {
+    float w = weights[indices[i]];
+    float v = 1 - w;
+    aa += v * v;
+    ab += v * w;
+    bb += w * w;
+    for(int c = 0; c < channels; c++) {
+      x[c] += v * ch[c][i];
+      y[c] += w * ch[c][i];
+    }
+  }
+  float det = aa * bb - ab * ab;
+  if(fabsf(det) < 1e-6f)
+    return false;
+  for(int c = 0; c < channels; c++) {
+    e0[c] = clampf((bb * x[c] - ab * y[c]) / det, 0, 255);
+    e1[c] = clampf((aa * y[c] - ab * x[c]) / det, 0, 255);
+  }
+  return true;
+}
+
+/*
+ * BC1 / BC3 colour
+ */
+
+static uint16_t pack565(const float c[4]) {
+  int r = clampi((int)(c[0] * 31 / 255 + 0.5f), 0, 31);
+  int g = clampi((int)(c[1] * 63 / 255 + 0.5f), 0, 63);
+  int b = clampi((int)(c[2] * 31 / 255 + 0.5f), 0, 31);
+  return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void unpack565(uint16_t c, int out[3]) {
+  int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+  out[0] = (r << 3) | (r >> 2);
+  out[1] = (g << 2) | (g >> 4);
+  out[2] = (b << 3) | (b >> 2);
+}
+
+// palette entry order of the 4 colour mode: c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+static const float bc1Weights[4] = { 0, 1, 1.0f / 3, 2.0f / 3 };
+
+static void bc1Palette(uint16_t c0, uint16_t c1, float palette[4][4]) {
+  int a[3], b[3];
+  unpack565(c0, a);
+  unpack565(c1, b);
+  for(int c = 0; c < 3; c++) {
+    palette[0][c] = (float) a[c];
+    palette[1][c] = (float) b[c];
+    palette[2][c] = (float)((2 * a[c] + b[c]) / 3);
+    palette[3][c] = (float)((a[c] + 2 * b[c]) / 3);
+  }
+  for(int p = 0; p < 4; p++)
+    palette[p][3] = 255;
+}
+
+// Quantizes the endpoints and picks indices, keeping the 4 colour mode
+// (c0 > c1). Returns the block error.
+static float bc1Fit(const Block &blk, const float e0[4], const float e1[4], uint16_t *c0, uint16_t *c1, uint8_t indices[16]) {
+  *c0 = pack565(e0);
+  *c1 = pack565(e1);
+  if(*c0 < *c1)
+    swap(*c0, *c1);
+
+  if(*c0 == *c1) {
+    float palette[4][4];
+    bc1Palette(*c0, *c1, palette);
+    memset(indices, 0, 16);
+    float error = 0;
+    for(int i = 0; i < 16; i++) {
+      float dr = blk.r[i] - palette[0][0], dg = blk.g[i] - palette[0][1], db = blk.b[i] - palette[0][2];
+      error += dr * dr + dg * dg + db * db;
+    }
+    return error;
+  }
+
+  float palette[4][4];
+  bc1Palette(*c0, *c1, palette);
+  return selectIndices(blk, palette, 4, 3, indices);
+}
+
+static void encodeBC1Block(const Block &blk, uint8_t *out) {
+  float e0[4], e1[4];
+  principalEndpoints(blk, 3, e0, e1);
+
+  // pull the endpoints in slightly, the extremes are rarely the best fit
+  for(int c = 0; c < 3; c++) {
+    float inset = (e1[c] - e0[c]) / 16;
+    e0[c] += inset;
+    e1[c] -= inset;
+  }
+
+  uint16_t c0, c1;
+  uint8_t indices[16];
+  float error = bc1Fit(blk, e0, e1, &c0, &c1, indices);
+
+  for(int iter = 0; iter < 2 && error > 0; iter++) {
+    float r0[4], r1[4];
+    if(!refineEndpoints(blk, 3, indices, bc1Weights, r0, r1))
+      break;
+    uint16_t n0, n1;
+    uint8_t nindices[16];
+    float nerror = bc1Fit(blk, r0, r1, &n0, &n1, nindices);
+    if(nerror >= error)
+      break;
+    error = nerror;
+    c0 = n0;
+    c1 = n1;
+    memcpy(indices, nindices, 16);
+  }
+
+  uint32_t bits = 0;
+  for(int i = 0; i < 16; i++)
+    bits |= (uint32_t) indices[i] << (2 * i);
+
+  out[0] = c0 & 0xFF;
+  out[1] = c0 >> 8;
+  out[2] = c1 & 0xFF;
+  out[3] = c1 >> 8;
+  out[4] = bits & 0xFF;
+  out[5] = (bits >> 8) & 0xFF;
+  out[6] = (bits >> 16) & 0xFF;
+  out[7] = bits >> 24;
+}
+
+static void decodeBC1Block(const uint8_t *in, uint8_t out[16][4], bool forceFourColor) {
+  uint16_t c0 = in[0] | (in[1] << 8);
+  uint16_t c1 = in[2] | (in[3] << 8);
+  uint32_t bits = in[4] | (in[5] << 8) | (in[6] << 16) | ((uint32_t) in[7] << 24);
+  int a[3], b[3];
+  unpack565(c0, a);
+  unpack565(c1, b);
+
+  uint8_t palette[4][4];
+  for(int c = 0; c < 3; c++) {
+    palette[0][c] = a[c];
+    palette[1][c] = b[c];
+    if(c0 > c1 || forceFourColor) {
+      palette[2][c] = (2 * a[c] + b[c]) / 3;
+      palette[3][c] = (a[c] + 2 * b[c]) / 3;
+    }
+    else {
+      palette[2][c] = (a[c] + b[c]) / 2;
+      palette[3][c] = 0;
+    }
+  }
+  palette[0][3] = palette[1][3] = palette[2][3] = 255;
+  palette[3][3] = (c0 > c1 || forceFourColor) ? 255 : 0;
+
+  for(int i = 0; i < 16; i++)
+    memcpy(out[i], palette[(bits >> (2 * i)) & 3], 4);
+}
+
+/*
+ * BC3 alpha (BC4 layout)
+ */
+
+static void alphaPalette(int a0, int a1, int palette[8]) {
+  palette[0] = a0;
+  palette[1] = a1;
+  for(int k = 2; k < 8; k++)
+    palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+}
+
+static void encodeAlphaBlock(const Block &blk, uint8_t *out) {
+  int lo = 255, hi = 0;
+  for(int i = 0; i < 16; i++) {
+    lo = min(lo, (int) blk.rgba[i][3]);
+    hi = max(hi, (int) blk.rgba[i][3]);
+  }
+
+  // a0 > a1 selects the 8 value mode
+  out[0] = (uint8_t) hi;
+  out[1] = (uint8_t) lo;
+
+  uint64_t bits = 0;
+  if(hi != lo) {
+    int palette[8];
+    alphaPalette(hi, lo, palette);
+    for(int i = 0; i < 16; i++) {
+      int v = blk.rgba[i][3];
+      int best = 0, bestError = 256;
+      for(int k = 0; k < 8; k++) {
+        int e = abs(palette[k] - v);
+        if(e < bestError) {
+          bestError = e;
+          best = k;
+        }
+      }
+      bits |= (uint64_t) best << (3 * i);
+    }
+  }
+  for(int i = 0; i < 6; i++)
+    out[2 + i] = (uint8_t)(bits >> (8 * i));
+}
+
+static void decodeAlphaBlock(const uint8_t *in, uint8_t out[16][4]) {
+  int a0 = in[0], a1 = in[1];
+  int palette[8];
+  if(a0 > a1)
+    alphaPalette(a0, a1, palette);
+  else {
+    palette[0] = a0;
+    palette[1] = a1;
+    for(int k = 2; k < 6; k++)
+      palette[k] = ((6 - k) * a0 + (k - 1) * a1) / 5;
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+  uint64_t bits = 0;
+  for(int i = 0; i < 6; i++)
+    bits |= (uint64_t) in[2 + i] << (8 * i);
+  for(int i = 0; i < 16; i++)
+    out[i][3] = (uint8_t) palette[(bits >> (3 * i)) & 7];
+}
+
+/*
+ * BC7 mode 6: one subset, RGBA 7.7.7.7 endpoints with a p-bit each, 4 bit indices
+ */
+
+static const int bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static void bc7QuantizeEndpoint(const float e[4], int q[4], int *pbit) {
+  float bestError = FLT_MAX;
+  for(int p = 0; p < 2; p++) {
+    int cand[4];
+    float error = 0;
+    for(int c = 0; c < 4; c++) {
+      cand[c] = clampi((int) floorf((e[c] - p) / 2 + 0.5f), 0, 127);
+      float d = (float)(cand[c] * 2 + p) - e[c];
+      error += d * d;
+    }
+    if(error < bestError) {
+      bestError = error;
+      *pbit = p;
+      memcpy(q, cand, sizeof(cand));
+    }
+  }
+}
+
+static void bc7Palette(const int q0[4], int p0, const int q1[4], int p1, float palette[16][4]) {
+  for(int c = 0; c < 4; c++) {
+    int a = q0[c] * 2 + p0;
+    int b = q1[c] * 2 + p1;
+    for(int k = 0; k < 16; k++)
+      palette[k][c] = (float)(((64 - bc7Weights4[k]) * a + bc7Weights4[k] * b + 32) >> 6);
+  }
+}
+
+static float bc7Fit(const Block &blk, const float e0[4], const float e1[4],
+                    int q0[4], int *p0, int q1[4], int *p1, uint8_t indices[16]) {
+  bc7QuantizeEndpoint(e0, q0, p0);
+  bc7QuantizeEndpoint(e1, q1, p1);
+  float palette[16][4];
+  bc7Palette(q0, *p0, q1, *p1, palette);
+  return selectIndices(blk, palette, 16, 4, indices);
+}
+
+struct BitWriter {
+  uint8_t *out;
+  int pos;
+
+  void Write(uint32_t value, int bits) {
+    for(int i = 0; i < bits; i++, pos++)
+      out[pos >> 3] |= ((value >> i) & 1) << (pos & 7);
+  }
+};
+
+struct BitReader {
+  const uint8_t *in;
+  int pos;
+
+  uint32_t Read(int bits) {
+    uint32_t value = 0;
+    for(int i = 0; i < bits; i++, pos++)
+      value |= ((in[pos >> 3] >> (pos & 7)) & 1) << i;
+    return value;
+  }
+};
+
+static void encodeBC7Block(const Block &blk, uint8_t *out) {
+  float e0[4], e1[4];
+  principalEndpoints(blk, 4, e0, e1);
+
+  float weights[16];
+  for(int k = 0; k < 16; k++)
+    weights[k] = bc7Weights4[k] / 64.0f;
+
+  int q0[4], q1[4], p0, p1;
+  uint8_t indices[16];
+  float error = bc7Fit(blk, e0, e1, q0, &p0, q1, &p1, indices);
+
+  for(int iter = 0; iter < 2 && error > 0; iter++) {
+    float r0[4], r1[4];
+    if(!refineEndpoints(blk, 4, indices, weights, r0, r1))
+      break;
+    int n0[4], n1[4], np0, np1;
+    uint8_t nindices[16];
+    float nerror = bc7Fit(blk, r0, r1, n0, &np0, n1, &np1, nindices);
+    if(nerror >= error)
+      break;
+    error = nerror;
+    memcpy(q0, n0, sizeof(q0));
+    memcpy(q1, n1, sizeof(q1));
+    p0 = np0;
+    p1 = np1;
+    memcpy(indices, nindices, 16);
+  }
+
+  // the anchor index is stored without its top bit, so it must be < 8
+  if(indices[0] >= 8) {
+    for(int c = 0; c < 4; c++)
+      swap(q0[c], q1[c]);
+    swap(p0, p1);
+    for(int i = 0; i < 16; i++)
+      indices[i] = 15 - indices[i];
+  }
+
+  memset(out, 0, 16);
+  BitWriter w = { out, 0 };
+  w.Write(1 << 6, 7);
+  for(int c = 0; c < 4; c++) {
+    w.Write(q0[c], 7);
+    w.Write(q1[c], 7);
+  }
+  w.Write(p0, 1);
+  w.Write(p1, 1);
+  w.Write(indices[0], 3);
+  for(int i = 1; i < 16; i++)
+    w.Write(indices[i], 4);
+}
+
+static bool decodeBC7Block(const uint8_t *in, uint8_t out[16][4]) {
+  if((in[0] & 0x7F) != 0x40) {
+    memset(out, 0, 64);
+    return false;
+  }
+  BitReader r = { in, 7 };
+  int q0[4], q1[4];
+  for(int c = 0; c < 4; c++) {
+    q0[c] = r.Read(7);
+    q1[c] = r.Read(7);
+  }
+  int p0 = r.Read(1), p1 = r.Read(1);
+  float palette[16][4];
+  bc7Palette(q0, p0, q1, p1, palette);
+  for(int i = 0; i < 16; i++) {
+    int index = r.Read(i == 0 ? 3 : 4);
+    for(int c = 0; c < 4; c++)
+      out[i][c] = (uint8_t) palette[index][c];
+  }
+  return true;
+}
+
+/*
+ * ETC2 RGB, individual and differential modes (i.e. plain ETC1 blocks)
+ */
+
+static const int etcModifiers[8][2] = {
+  { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 }
+};
+
+// pixel index codes: 0 = +small, 1 = +large, 2 = -small, 3 = -large
+static inline int etcModifier(int table, int code) {
+  int m = etcModifiers[table][code & 1];
+  return (code & 2) ? -m : m;
+}
+
+// Pixels (as x, y) of the two sub-blocks for flip = 0 (2x4 side by side) and
+// flip = 1 (4x2 on top of each other).
+static void etcSubblockPixels(int flip, int sub, int xs[8], int ys[8]) {
+  int n = 0;
+  for(int y = 0; y < 4; y++)
+    for(int x = 0; x < 4; x++) {
+      bool inSub = flip ? (y / 2 == sub) : (x / 2 == sub);
+      if(inSub) {
+        xs[n] = x;
+        ys[n] = y;
+        n++;
+      }
+    }
+}
+
+// Best modifier table and codes for one sub-block around base.
+static int etcFitSubblock(const Block &blk, const int xs[8], const int ys[8], const int base[3], int *table, uint8_t codes[8]) {
+  int bestError = 0x7FFFFFFF;
+  for(int t = 0; t < 8; t++) {
+    int error = 0;
+    uint8_t cand[8];
+    for(int i = 0; i < 8; i++) {
+      const uint8_t *px = blk.rgba[ys[i] * 4 + xs[i]];
+      int best = 0x7FFFFFFF;
+      for(int code = 0; code < 4; code++) {
+        int m = etcModifier(t, code);
+        int e = 0;
+        for(int c = 0; c < 3; c++) {
+          int d = clampi(base[c] + m, 0, 255) - px[c];
+          e += d * d;
+        }
+        if(e < best) {
+          best = e;
+          cand[i] = (uint8_t) code;
+        }
+      }
+      error += best;
+      if(error >= bestError)
+        break;
+    }
+    if(error < bestError) {
+      bestError = error;
+      *table = t;
+      memcpy(codes, cand, 8);
+    }
+  }
+  return bestError;
+}
+
+static void encodeETC2Block(const Block &blk, uint8_t *out) {
+  uint32_t bestHi = 0, bestLo = 0;
+  int bestError = 0x7FFFFFFF;
+
+  for(int flip = 0; flip < 2; flip++) {
+    int xs[2][8], ys[2][8];
+    float avg[2][3] = {};
+    for(int sub = 0; sub < 2; sub++) {
+      etcSubblockPixels(flip, sub, xs[sub], ys[sub]);
+      for(int i = 0; i < 8; i++)
+        for(int c = 0; c < 3; c++)
+          avg[sub][c] += blk.rgba[ys[sub][i] * 4 + xs[sub][i]][c] / 8.0f;
+    }
+
+    for(int diff = 0; diff < 2; diff++) {
+      int q[2][3], base[2][3];
+      bool valid = true;
+      for(int sub = 0; sub < 2; sub++)
+        for(int c = 0; c < 3; c++) {
+          if(diff) {
+            q[sub][c] = clampi((int)(avg[sub][c] * 31 / 255 + 0.5f), 0, 31);
+            base[sub][c] = (q[sub][c] << 3) | (q[sub][c] >> 2);
+          }
+          else {
+            q[sub][c] = clampi((int)(avg[sub][c] * 15 / 255 + 0.5f), 0, 15);
+            base[sub][c] = q[sub][c] * 17;
+          }
+        }
+      if(diff) {
+        // the second colour is stored as a 3 bit delta from the first
+        for(int c = 0; c < 3; c++) {
+          int d = q[1][c] - q[0][c];
+          if(d < -4 || d > 3)
+            valid = false;
+        }
+      }
+      if(!valid)
+        continue;
+
+      int tables[2];
+      uint8_t codes[2][8];
+      int error = etcFitSubblock(blk, xs[0], ys[0], base[0], &tables[0], codes[0]) +
+                  etcFitSubblock(blk, xs[1], ys[1], base[1], &tables[1], codes[1]);
+      if(error >= bestError)
+        continue;
+      bestError = error;
+
+      uint32_t hi;
+      if(diff)
+        hi = (q[0][0] << 27) | (((q[1][0] - q[0][0]) & 7) << 24) |
+             (q[0][1] << 19) | (((q[1][1] - q[0][1]) & 7) << 16) |
+             (q[0][2] << 11) | (((q[1][2] - q[0][2]) & 7) << 8);
+      else
+        hi = (q[0][0] << 28) | (q[1][0] << 24) | (q[0][1] << 20) | (q[1][1] << 16) |
+             (q[0][2] << 12) | (q[1][2] << 8);
+      hi |= (tables[0] << 5) | (tables[1] << 2) | (diff << 1) | flip;
+
+      // pixel indices are stored column major: bit x * 4 + y
+      uint32_t lo = 0;
+      for(int sub = 0; sub < 2; sub++)
+        for(int i = 0; i < 8; i++) {
+          int bit = xs[sub][i] * 4 + ys[sub][i];
+          lo |= (uint32_t)(codes[sub][i] >> 1) << (16 + bit);
+          lo |= (uint32_t)(codes[sub][i] & 1) << bit;
+        }
+
+      bestHi = hi;
+      bestLo = lo;
+    }
+  }
+
+  // big endian
+  for(int i = 0; i < 4; i++) {
+    out[i] = (uint8_t)(bestHi >> (24 - 8 * i));
+    out[4 + i] = (uint8_t)(bestLo >> (24 - 8 * i));
+  }
+}
+
+static bool decodeETC2Block(const uint8_t *in, uint8_t out[16][4]) {
+  uint32_t hi = ((uint32_t) in[0] << 24) | (in[1] << 16) | (in[2] << 8) | in[3];
+  uint32_t lo = ((uint32_t) in[4] << 24) | (in[5] << 16) | (in[6] << 8) | in[7];
+  int diff = (hi >> 1) & 1;
+  int flip = hi & 1;
+  int tables[2] = { (int)(hi >> 5) & 7, (int)(hi >> 2) & 7 };
+
+  int base[2][3];
+  for(int c = 0; c < 3; c++) {
+    int shift = 27 - 8 * c;
+    if(diff) {
+      int q0 = (hi >> shift) & 31;
+      int d = (hi >> (shift - 3)) & 7;
+      if(d >= 4) d -= 8;
+      int q1 = q0 + d;
+      if(q1 < 0 || q1 > 31) {
+        // T, H or planar mode, never produced by the encoder
+        memset(out, 0, 64);
+        return false;
+      }
+      base[0][c] = (q0 << 3) | (q0 >> 2);
+      base[1][c] = (q1 << 3) | (q1 >> 2);
+    }
+    else {
+      base[0][c] = ((hi >> (28 - 8 * c)) & 15) * 17;
+      base[1][c] = ((hi >> (24 - 8 * c)) & 15) * 17;
+    }
+  }
+
+  for(int y = 0; y < 4; y++)
+    for(int x = 0; x < 4; x++) {
+      int sub = flip ? y / 2 : x / 2;
+      int bit = x * 4 + y;
+      int code = (((lo >> (16 + bit)) & 1) << 1) | ((lo >> bit) & 1);
+      int m = etcModifier(tables[sub], code);
+      uint8_t *px = out[y * 4 + x];
+      for(int c = 0; c < 3; c++)
+        px[c] = (uint8_t) clampi(base[sub][c] + m, 0, 255);
+      px[3] = 255;
+    }
+  return true;
+}
+
+/*
+ * Images
+ */
+
+enum EncoderKind { ENCODER_NONE, ENCODER_BC1, ENCODER_BC3, ENCODER_BC7, ENCODER_ETC2 };
+
+static EncoderKind encoderKind(GLenum internalFormat) {
+  switch(internalFormat) {
+  case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+  case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+    return ENCODER_BC1;
+  case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+  case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    return ENCODER_BC3;
+  case GL_COMPRESSED_RGBA_BPTC_UNORM:
+  case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+    return ENCODER_BC7;
+  case GL_COMPRESSED_RGB8_ETC2:
+  case GL_COMPRESSED_SRGB8_ETC2:
+    return ENCODER_ETC2;
+  }
+  return ENCODER_NONE;
+}
+
+bool IsEncodableFormat(GLenum internalFormat) {
+  return encoderKind(internalFormat) != ENCODER_NONE;
+}
+
+bool EncodeImage(const uint8_t *rgba, int width, int height, GLenum internalFormat, uint8_t *out, int threads) {
+  EncoderKind kind = encoderKind(internalFormat);
+  if(kind == ENCODER_NONE || width <= 0 || height <= 0)
+    return false;
+
+  int blocksX = (width + 3) / 4;
+  int blocksY = (height + 3) / 4;
+  int blockBytes = (kind == ENCODER_BC1 || kind == ENCODER_ETC2) ? 8 : 16;
+
+  ParallelFor(blocksY, threads, [&](int by) {
+    Block blk;
+    uint8_t *dst = out + (size_t) by * blocksX * blockBytes;
+    for(int bx = 0; bx < blocksX; bx++, dst += blockBytes) {
+      loadBlock(rgba, width, height, bx, by, &blk);
+      switch(kind) {
+      case ENCODER_BC1: encodeBC1Block(blk, dst); break;
+      case ENCODER_BC3: encodeAlphaBlock(blk, dst); encodeBC1Block(blk, dst + 8); break;
+      case ENCODER_BC7: encodeBC7Block(blk, dst); break;
+      case ENCODER_ETC2: encodeETC2Block(blk, dst); break;
+      default: break;
+      }
+    }
+  });
+
+  return true;
+}
+
+bool DecodeImage(const uint8_t *data, int width, int height, GLenum internalFormat, uint8_t *rgba) {
+  EncoderKind kind = encoderKind(internalFormat);
+  if(kind == ENCODER_NONE || width <= 0 || height <= 0)
+    return false;
+
+  int blocksX = (width + 3) / 4;
+  int blocksY = (height + 3) / 4;
+  int blockBytes = (kind == ENCODER_BC1 || kind == ENCODER_ETC2) ? 8 : 16;
+  bool ok = true;
+
+  for(int by = 0; by < blocksY; by++)
+    for(int bx = 0; bx < blocksX; bx++) {
+      const uint8_t *src = data + ((size_t) by * blocksX + bx) * blockBytes;
+      uint8_t px[16][4];
+      switch(kind) {
+      case ENCODER_BC1: decodeBC1Block(src, px, false); break;
+      case ENCODER_BC3: decodeBC1Block(src + 8, px, true); decodeAlphaBlock(src, px); break;
+      case ENCODER_BC7: ok &= decodeBC7Block(src, px); break;
+      case ENCODER_ETC2: ok &= decodeETC2Block(src, px); break;
+      default: break;
+      }
+      for(int y = 0; y < 4 && by * 4 + y < height; y++)
+        for(int x = 0; x < 4 && bx * 4 + x < width; x++)
+          memcpy(rgba + ((size_t)(by * 4 + y) * width + bx * 4 + x) * 4, px[y * 4 + x], 4);
+    }
+  return ok;
+}
+
+uint64_t HashBytes(const uint8_t *data, size_t size, uint64_t seed) {
+  uint64_t h = seed;
+  for(size_t i = 0; i < size; i++) {
+    h ^= data[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+} // end namespace webgl
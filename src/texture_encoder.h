@@ -0,0 +1,42 @@
+/*
+ * texture_encoder.h
+ *
+ * CPU block compression of RGBA8 images into BC1, BC3, BC7 and ETC2 RGB, so
+ * that PNG/JPEG assets can be stored in VRAM compressed without an offline
+ * asset pipeline. Blocks are encoded in parallel on several threads; the
+ * inner loops use SSE2 where available.
+ *
+ * The encoders favour speed over the last dB of quality: BC7 only emits
+ * mode 6 blocks and ETC2 only the ETC1 compatible individual/differential
+ * modes.
+ */
+
+#ifndef TEXTURE_ENCODER_H_
+#define TEXTURE_ENCODER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+namespace webgl {
+
+// True for the internal formats EncodeImage can produce (including the sRGB
+// variants, which are encoded the same way).
+bool IsEncodableFormat(GLenum internalFormat);
+
+// Compresses a tightly packed RGBA8 image, rows in upload order. out must
+// hold CompressedLevelSize(internalFormat, width, height) bytes. threads <= 0
+// uses one thread per core.
+bool EncodeImage(const uint8_t *rgba, int width, int height, GLenum internalFormat, uint8_t *out, int threads);
+
+// Inverse of EncodeImage, for measuring quality. Only understands the block
+// modes the encoder emits; returns false if it met any other.
+bool DecodeImage(const uint8_t *data, int width, int height, GLenum internalFormat, uint8_t *rgba);
+
+// 64-bit FNV-1a, used to key the encoded texture cache.
+uint64_t HashBytes(const uint8_t *data, size_t size, uint64_t seed = 14695981039346656037ULL);
+
+} // end namespace webgl
+
+#endif /* TEXTURE_ENCODER_H_ */
@@ -0,0 +1,730 @@
+/*
+ * texture_loader.cc
+ *
+ * gl.texImageFromFile(texture, pathOrBuffer, internalFormat, mipmapMode, gammaCorrect, callback)
+ *
+ * One call goes through three hops:
+ *   1. thread pool: map the file, decode it from memory with FreeImage and
+ *                   convert to 32 bits, and for the
+ *                   CPU mipmap modes filter the whole chain (see mipmap.h)
+ *   2. GL thread:   create and map a pixel unpack buffer of the right size
+ *   3. thread pool: swizzle BGRA -> RGBA (or copy the chain) straight into
+ *                   the mapped buffer
+ *   4. GL thread:   unmap, allocate storage, upload every level from the
+ *                   buffer, or glGenerateTextureMipmap for MIPMAPS_GPU
+ *
+ * gl.compressedTexImageFromFile(texture, path, callback)
+ *
+ * KTX2/DDS files are already in the GPU's format, so there is nothing to
+ * decode: the file is mapped and paged in on the thread pool, and the GL
+ * thread uploads every level straight out of the mapping.
+ *
+ * gl.compressTexImageFromFile(texture, source, internalFormat, mipmapMode, gammaCorrect,
+ *                             cacheDir, threads, callback)
+ *
+ * Decodes a PNG/JPEG/... and block compresses it (and its CPU generated mip
+ * chain) on the thread pool (see texture_encoder.h), then uploads like the
+ * KTX2 path. The result is kept in cacheDir as
+ * <hash of the source bytes>-<format>-<mipmap mode>.ktx2, so later loads of
+ * the same file skip decoding and encoding altogether.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <iostream>
+
+#ifdef _WIN32
+  #include <process.h>
+  #define getpid _getpid
+#else
+  #include <unistd.h>
+#endif
+
+#include "texture_loader.h"
+#include "gl_objects.h"
+#include "texture_container.h"
+#include "texture_encoder.h"
+#include "mapped_file.h"
+#include "mipmap.h"
+#include <FreeImage.h>
+#include <GL/glew.h>
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+// numbers the temporary cache files of this process
+static atomic<unsigned> tmpFileCounter(0);
+
+static bool isCPUMipmapMode(int mode) {
+  return mode == MIPMAPS_BOX || mode == MIPMAPS_KAISER;
+}
+
+// FreeImage stores 32-bit pixels as BGRA with the bottom row first, which is
+// also the row order GL expects. Swap red and blue while copying the
+// (possibly padded) scanlines into a tightly packed RGBA8 buffer.
+static void copyBitmapToRGBA(FIBITMAP *bmp, BYTE *out) {
+  int width = FreeImage_GetWidth(bmp);
+  int height = FreeImage_GetHeight(bmp);
+  int rowBytes = width * 4;
+  for(int y = 0; y < height; y++) {
+    const BYTE *src = FreeImage_GetScanLine(bmp, y);
+    BYTE *dst = out + (size_t)y * rowBytes;
+    for(int x = 0; x < rowBytes; x += 4) {
+      dst[x + 0] = src[x + FI_RGBA_RED];
+      dst[x + 1] = src[x + FI_RGBA_GREEN];
+      dst[x + 2] = src[x + FI_RGBA_BLUE];
+      dst[x + 3] = src[x + FI_RGBA_ALPHA];
+    }
+  }
+}
+
+// Decodes encoded image bytes (usually a file mapping) to a 32-bit bitmap, or
+// NULL. nameHint identifies formats that have no signature.
+static FIBITMAP *decodeImage(const uint8_t *data, size_t size, const string &nameHint) {
+  FIBITMAP *bmp = NULL;
+  FIMEMORY *mem = FreeImage_OpenMemory((BYTE*) data, (DWORD) size);
+  FREE_IMAGE_FORMAT format = FreeImage_GetFileTypeFromMemory(mem, 0);
+  if(format == FIF_UNKNOWN && !nameHint.empty())
+    format = FreeImage_GetFIFFromFilename(nameHint.c_str());
+  if(format != FIF_UNKNOWN) {
+    FIBITMAP *tmp = FreeImage_LoadFromMemory(format, mem, 0);
+    if(tmp) {
+      bmp = FreeImage_ConvertTo32Bits(tmp);
+      FreeImage_Unload(tmp);
+    }
+  }
+  FreeImage_CloseMemory(mem);
+  return bmp;
+}
+
+// Base level plus CPU filtered chain of an RGBA8 image.
+static void buildMipChain(FIBITMAP *bmp, int mipmapMode, bool gammaCorrect, int threads, vector<MipLevel> &levels) {
+  MipLevel base;
+  base.width = FreeImage_GetWidth(bmp);
+  base.height = FreeImage_GetHeight(bmp);
+  base.rgba.resize((size_t) base.width * base.height * 4);
+  copyBitmapToRGBA(bmp, &base.rgba[0]);
+
+  levels.clear();
+  levels.push_back(base);
+  GenerateMipChain(&base.rgba[0], base.width, base.height,
+                   mipmapMode == MIPMAPS_KAISER ? MIP_FILTER_KAISER : MIP_FILTER_BOX,
+                   gammaCorrect, threads, levels);
+}
+
+bool DecodeImageLevels(const uint8_t *data, size_t size, const string &nameHint, int mipmapMode,
+                       bool gammaCorrect, int threads, vector<MipLevel> &levels) {
+  FIBITMAP *bmp = decodeImage(data, size, nameHint);
+  if(!bmp)
+    return false;
+  buildMipChain(bmp, mipmapMode, gammaCorrect, threads, levels);
+  if(!isCPUMipmapMode(mipmapMode))
+    levels.resize(1);
+  FreeImage_Unload(bmp);
+  return true;
+}
+
+// State shared by every hop of a single texImageFromFile() call.
+struct TextureUpload {
+  GLuint texture;
+  GLenum internalFormat;
+  int mipmapMode;
+  bool gammaCorrect;
+
+  string filename;
+  // keeps the bytes of a Buffer source alive while the pool thread reads them
+  shared_ptr<BackingStore> sourceStore;
+  const BYTE *source;
+  size_t sourceSize;
+
+  // either the decoded bitmap, or with a CPU mipmap mode the whole chain
+  FIBITMAP *bmp;
+  vector<MipLevel> mips;
+  int width;
+  int height;
+
+  GLuint pbo;
+  BYTE *mapped;
+
+  TextureUpload() : texture(0), internalFormat(GL_RGBA8), mipmapMode(MIPMAPS_NONE), gammaCorrect(false),
+    source(NULL), sourceSize(0), bmp(NULL), width(0), height(0), pbo(0), mapped(NULL) {}
+
+  size_t StagingSize() const {
+    if(mips.empty())
+      return (size_t) width * height * 4;
+    size_t size = 0;
+    for(size_t i = 0; i < mips.size(); i++)
+      size += mips[i].rgba.size();
+    return size;
+  }
+
+  ~TextureUpload() {
+    if(bmp) FreeImage_Unload(bmp);
+  }
+};
+
+class TextureCopyWorker : public Nan::AsyncWorker {
+public:
+  TextureCopyWorker(Nan::Callback *callback, TextureUpload *upload)
+    : Nan::AsyncWorker(callback, "webgl:texImageFromFile"), upload(upload) {}
+
+  ~TextureCopyWorker() {
+    delete upload;
+  }
+
+  void Execute() {
+    if(upload->bmp) {
+      copyBitmapToRGBA(upload->bmp, upload->mapped);
+      FreeImage_Unload(upload->bmp);
+      upload->bmp = NULL;
+      return;
+    }
+
+    // levels go back to back, largest first
+    BYTE *dst = upload->mapped;
+    for(size_t i = 0; i < upload->mips.size(); i++) {
+      memcpy(dst, &upload->mips[i].rgba[0], upload->mips[i].rgba.size());
+      dst += upload->mips[i].rgba.size();
+    }
+  }
+
+  void HandleOKCallback() {
+    Nan::HandleScope scope;
+
+    if(glUnmapNamedBuffer(upload->pbo) == GL_FALSE) {
+      // the data store was lost while mapped (e.g. a mode switch)
+      glDeleteBuffers(1, &upload->pbo);
+      Local<Value> argv[] = { Nan::Error("texImageFromFile: staging buffer was corrupted") };
+      callback->Call(1, argv, async_resource);
+      return;
+    }
+
+    int levels = upload->mipmapMode == MIPMAPS_NONE ? 1 : MipLevelCount(upload->width, upload->height);
+
+    // textures that already have immutable storage are uploaded into the
+    // levels they have
+    GLint immutable = 0;
+    glGetTextureParameteriv(upload->texture, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+    if(!immutable) {
+      glTextureStorage2D(upload->texture, levels, upload->internalFormat, upload->width, upload->height);
+      setGLObjBytes(GLOBJECT_TYPE_TEXTURE, upload->texture,
+                    TextureStorageBytes(GL_TEXTURE_2D, upload->internalFormat, upload->width, upload->height, 1, levels));
+    }
+    else {
+      GLint immutableLevels = 1;
+      glGetTextureParameteriv(upload->texture, GL_TEXTURE_IMMUTABLE_LEVELS, &immutableLevels);
+      levels = immutableLevels < levels ? immutableLevels : levels;
+    }
+
+    GLint prevUnpackBuffer, prevAlignment, prevRowLength;
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &prevUnpackBuffer);
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &prevAlignment);
+    glGetIntegerv(GL_UNPACK_ROW_LENGTH, &prevRowLength);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload->pbo);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    if(upload->mips.empty())
+      glTextureSubImage2D(upload->texture, 0, 0, 0, upload->width, upload->height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    else {
+      size_t offset = 0;
+      for(int i = 0; i < levels; i++) {
+        const MipLevel &level = upload->mips[i];
+        glTextureSubImage2D(upload->texture, i, 0, 0, level.width, level.height, GL_RGBA, GL_UNSIGNED_BYTE,
+                            (const void*) offset);
+        offset += level.rgba.size();
+      }
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, prevUnpackBuffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, prevAlignment);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, prevRowLength);
+
+    // the GL keeps the buffer alive until the pending upload has consumed it
+    glDeleteBuffers(1, &upload->pbo);
+
+    if(upload->mipmapMode == MIPMAPS_GPU)
+      glGenerateTextureMipmap(upload->texture);
+
+    Local<Object> result = Nan::New<Object>();
+    Nan::Set(result, JS_STR("width"), JS_INT(upload->width));
+    Nan::Set(result, JS_STR("height"), JS_INT(upload->height));
+    Nan::Set(result, JS_STR("levels"), JS_INT(levels));
+
+    Local<Value> argv[] = { Nan::Null(), result };
+    callback->Call(2, argv, async_resource);
+  }
+
+private:
+  TextureUpload *upload;
+};
+
+class TextureDecodeWorker : public Nan::AsyncWorker {
+public:
+  TextureDecodeWorker(Nan::Callback *callback, TextureUpload *upload)
+    : Nan::AsyncWorker(callback, "webgl:texImageFromFile"), upload(upload) {}
+
+  ~TextureDecodeWorker() {
+    delete upload;
+  }
+
+  void Execute() {
+    MappedFile file;
+    if(!upload->source) {
+      if(!file.Open(upload->filename.c_str())) {
+        SetErrorMessage("texImageFromFile: unable to open file");
+        return;
+      }
+      file.Advise(MappedFile::ADVICE_SEQUENTIAL);
+      upload->source = file.Data();
+      upload->sourceSize = file.Size();
+    }
+
+    upload->bmp = decodeImage(upload->source, upload->sourceSize, upload->filename);
+
+    // the encoded bytes are no longer needed
+    upload->sourceStore.reset();
+    upload->source = NULL;
+    file.Close();
+
+    if(!upload->bmp) {
+      SetErrorMessage("texImageFromFile: unable to decode image");
+      return;
+    }
+
+    upload->width = FreeImage_GetWidth(upload->bmp);
+    upload->height = FreeImage_GetHeight(upload->bmp);
+
+    if(isCPUMipmapMode(upload->mipmapMode)) {
+      buildMipChain(upload->bmp, upload->mipmapMode, upload->gammaCorrect, 0, upload->mips);
+      FreeImage_Unload(upload->bmp);
+      upload->bmp = NULL;
+    }
+  }
+
+  void HandleOKCallback() {
+    Nan::HandleScope scope;
+
+    // buffer objects can only be created and mapped on the GL thread
+    GLsizeiptr size = (GLsizeiptr) upload->StagingSize();
+    glCreateBuffers(1, &upload->pbo);
+    glNamedBufferStorage(upload->pbo, size, NULL, GL_MAP_WRITE_BIT);
+    upload->mapped = (BYTE*) glMapNamedBufferRange(upload->pbo, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+    if(!upload->mapped) {
+      glDeleteBuffers(1, &upload->pbo);
+      Local<Value> argv[] = { Nan::Error("texImageFromFile: unable to map staging buffer") };
+      callback->Call(1, argv, async_resource);
+      return;
+    }
+
+    // hand the callback and the upload state over to the copy pass
+    Nan::AsyncQueueWorker(new TextureCopyWorker(callback, upload));
+    callback = NULL;
+    upload = NULL;
+  }
+
+private:
+  TextureUpload *upload;
+};
+
+// Allocates storage for (unless the texture is already immutable) and uploads
+// every level of image. Must run on the GL thread.
+static void uploadCompressedImage(GLuint texture, const CompressedImage &image) {
+  int levels = (int) image.levels.size();
+
+  GLint immutable = 0;
+  glGetTextureParameteriv(texture, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+  if(!immutable) {
+    glTextureStorage2D(texture, levels, image.internalFormat, image.width, image.height);
+    setGLObjBytes(GLOBJECT_TYPE_TEXTURE, texture,
+                  TextureStorageBytes(GL_TEXTURE_2D, image.internalFormat, image.width, image.height, 1, levels));
+  }
+  else {
+    GLint immutableLevels = 1;
+    glGetTextureParameteriv(texture, GL_TEXTURE_IMMUTABLE_LEVELS, &immutableLevels);
+    levels = immutableLevels < levels ? immutableLevels : levels;
+  }
+
+  // the level pointers are client memory, so no unpack buffer may be bound
+  GLint prevUnpackBuffer;
+  glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &prevUnpackBuffer);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  for(int i = 0; i < levels; i++) {
+    const CompressedLevel &level = image.levels[i];
+    glCompressedTextureSubImage2D(texture, i, 0, 0, level.width, level.height,
+                                  image.internalFormat, (GLsizei) level.size, level.data);
+  }
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, prevUnpackBuffer);
+}
+
+static Local<Object> compressedResult(const CompressedImage &image) {
+  Local<Object> result = Nan::New<Object>();
+  Nan::Set(result, JS_STR("width"), JS_INT(image.width));
+  Nan::Set(result, JS_STR("height"), JS_INT(image.height));
+  Nan::Set(result, JS_STR("levels"), JS_INT((int) image.levels.size()));
+  Nan::Set(result, JS_STR("internalFormat"), JS_INT(image.internalFormat));
+  return result;
+}
+
+struct CompressedUpload {
+  GLuint texture;
+  string filename;
+  MappedFile file;
+  CompressedImage image;
+
+  CompressedUpload() : texture(0) {}
+};
+
+class CompressedTextureWorker : public Nan::AsyncWorker {
+public:
+  CompressedTextureWorker(Nan::Callback *callback, CompressedUpload *upload)
+    : Nan::AsyncWorker(callback, "webgl:compressedTexImageFromFile"), upload(upload) {}
+
+  ~CompressedTextureWorker() {
+    delete upload;
+  }
+
+  void Execute() {
+    if(!upload->file.Open(upload->filename.c_str())) {
+      SetErrorMessage("compressedTexImageFromFile: unable to open file");
+      return;
+    }
+
+    const char *error = NULL;
+    if(!ParseCompressedContainer(upload->file.Data(), upload->file.Size(), &upload->image, &error)) {
+      SetErrorMessage(error);
+      return;
+    }
+
+    // fault the level data in here so the GL thread never waits on the disk
+    const CompressedLevel &first = upload->image.levels.front();
+    const CompressedLevel &last = upload->image.levels.back();
+    size_t begin = first.data < last.data ? first.data - upload->file.Data() : last.data - upload->file.Data();
+    upload->file.Advise(MappedFile::ADVICE_SEQUENTIAL);
+    upload->file.Prefetch(begin);
+  }
+
+  void HandleOKCallback() {
+    Nan::HandleScope scope;
+
+    uploadCompressedImage(upload->texture, upload->image);
+
+    // glCompressedTextureSubImage2D has copied the data out of the mapping
+    upload->file.Close();
+
+    Local<Value> argv[] = { Nan::Null(), compressedResult(upload->image) };
+    callback->Call(2, argv, async_resource);
+  }
+
+private:
+  CompressedUpload *upload;
+};
+
+struct EncodeUpload {
+  GLuint texture;
+  GLenum internalFormat;
+  int mipmapMode;
+  bool gammaCorrect;
+  int threads;
+  string cacheDir;
+
+  string filename;
+  shared_ptr<BackingStore> sourceStore;
+  const uint8_t *source;
+  size_t sourceSize;
+  MappedFile sourceFile;
+
+  // level data points either into the cache file or into encoded
+  MappedFile cacheFile;
+  vector<uint8_t> encoded;
+  CompressedImage image;
+  bool cached;
+
+  EncodeUpload() : texture(0), internalFormat(0), mipmapMode(MIPMAPS_NONE), gammaCorrect(false), threads(0),
+    source(NULL), sourceSize(0), cached(false) {}
+};
+
+class TextureEncodeWorker : public Nan::AsyncWorker {
+public:
+  TextureEncodeWorker(Nan::Callback *callback, EncodeUpload *upload)
+    : Nan::AsyncWorker(callback, "webgl:compressTexImageFromFile"), upload(upload) {}
+
+  ~TextureEncodeWorker() {
+    delete upload;
+  }
+
+  void Execute() {
+    if(!upload->source) {
+      if(!upload->sourceFile.Open(upload->filename.c_str())) {
+        SetErrorMessage("compressTexImageFromFile: unable to open file");
+        return;
+      }
+      upload->sourceFile.Advise(MappedFile::ADVICE_SEQUENTIAL);
+      upload->source = upload->sourceFile.Data();
+      upload->sourceSize = upload->sourceFile.Size();
+    }
+
+    string cachePath;
+    if(!upload->cacheDir.empty()) {
+      char name[64];
+      snprintf(name, sizeof(name), "%016llx-%04x-m%d%s.ktx2",
+               (unsigned long long) HashBytes(upload->source, upload->sourceSize), upload->internalFormat,
+               isCPUMipmapMode(upload->mipmapMode) ? upload->mipmapMode : MIPMAPS_NONE,
+               upload->gammaCorrect ? "g" : "");
+      cachePath = upload->cacheDir + "/" + name;
+
+      const char *error = NULL;
+      if(upload->cacheFile.Open(cachePath.c_str()) &&
+         ParseKTX2(upload->cacheFile.Data(), upload->cacheFile.Size(), &upload->image, &error) &&
+         upload->image.internalFormat == upload->internalFormat) {
+        upload->cacheFile.Prefetch();
+        upload->cached = true;
+        releaseSource();
+        return;
+      }
+      // missing or stale: re-encode and overwrite it
+      upload->cacheFile.Close();
+    }
+
+    FIBITMAP *bmp = decodeImage(upload->source, upload->sourceSize, upload->filename);
+    releaseSource();
+
+    if(!bmp) {
+      SetErrorMessage("compressTexImageFromFile: unable to decode image");
+      return;
+    }
+
+    // the GL can't mipmap compressed textures, so any chain is built here
+    vector<MipLevel> mips;
+    buildMipChain(bmp, upload->mipmapMode, upload->gammaCorrect, upload->threads, mips);
+    if(!isCPUMipmapMode(upload->mipmapMode))
+      mips.resize(1);
+    FreeImage_Unload(bmp);
+
+    CompressedImage &image = upload->image;
+    image.internalFormat = upload->internalFormat;
+    image.width = mips[0].width;
+    image.height = mips[0].height;
+    GetCompressedFormatInfo(image.internalFormat, &image.blockWidth, &image.blockHeight, &image.blockBytes);
+
+    vector<size_t> offsets(mips.size());
+    size_t total = 0;
+    for(size_t i = 0; i < mips.size(); i++) {
+      offsets[i] = total;
+      total += CompressedLevelSize(image.internalFormat, mips[i].width, mips[i].height);
+    }
+    upload->encoded.resize(total);
+
+    image.levels.clear();
+    for(size_t i = 0; i < mips.size(); i++) {
+      const MipLevel &mip = mips[i];
+      CompressedLevel level = { &upload->encoded[offsets[i]],
+                                CompressedLevelSize(image.internalFormat, mip.width, mip.height),
+                                mip.width, mip.height };
+      EncodeImage(&mip.rgba[0], mip.width, mip.height, image.internalFormat,
+                  &upload->encoded[offsets[i]], upload->threads);
+      image.levels.push_back(level);
+    }
+
+    if(!cachePath.empty()) {
+      // write under a private name and rename, so concurrent loads never see
+      // a partial file. A failed write only costs the next load an encode.
+      // unique across processes sharing cacheDir
+      char suffix[48];
+      snprintf(suffix, sizeof(suffix), ".%d.%u.tmp", (int) getpid(), tmpFileCounter++);
+      string tmpPath = cachePath + suffix;
+      if(!WriteKTX2(tmpPath.c_str(), image) || rename(tmpPath.c_str(), cachePath.c_str()) != 0)
+        remove(tmpPath.c_str());
+    }
+  }
+
+  void HandleOKCallback() {
+    Nan::HandleScope scope;
+
+    uploadCompressedImage(upload->texture, upload->image);
+
+    Local<Object> result = compressedResult(upload->image);
+    Nan::Set(result, JS_STR("cached"), JS_BOOL(upload->cached));
+
+    Local<Value> argv[] = { Nan::Null(), result };
+    callback->Call(2, argv, async_resource);
+  }
+
+private:
+  void releaseSource() {
+    upload->sourceStore.reset();
+    upload->sourceFile.Close();
+    upload->source = NULL;
+    upload->sourceSize = 0;
+  }
+
+  EncodeUpload *upload;
+};
+
+NAN_METHOD(TexImageFromFile) {
+  Nan::HandleScope scope;
+
+  if(info.Length() < 6 || !info[5]->IsFunction()) {
+    Nan::ThrowTypeError("Expected texImageFromFile(texture, source, internalFormat, mipmapMode, gammaCorrect, callback)");
+    return;
+  }
+
+  TextureUpload *upload = new TextureUpload();
+  upload->texture = Nan::To<uint32_t>(info[0]).FromJust();
+  upload->internalFormat = Nan::To<int>(info[2]).FromJust();
+  upload->mipmapMode = Nan::To<int>(info[3]).FromJust();
+  upload->gammaCorrect = Nan::To<bool>(info[4]).FromJust();
+
+  if(info[1]->IsArrayBufferView()) {
+    Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(info[1]);
+    upload->sourceStore = arr->Buffer()->GetBackingStore();
+    upload->source = (const BYTE*) upload->sourceStore->Data() + arr->ByteOffset();
+    upload->sourceSize = arr->ByteLength();
+  }
+  else if(info[1]->IsString()) {
+    Nan::Utf8String filename(info[1]);
+    upload->filename = *filename;
+  }
+  else {
+    delete upload;
+    Nan::ThrowTypeError("texImageFromFile: source must be a file name or a Buffer");
+    return;
+  }
+
+  Nan::Callback *callback = new Nan::Callback(info[5].As<Function>());
+  Nan::AsyncQueueWorker(new TextureDecodeWorker(callback, upload));
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(CompressedTexImageFromFile) {
+  Nan::HandleScope scope;
+
+  if(info.Length() < 3 || !info[1]->IsString() || !info[2]->IsFunction()) {
+    Nan::ThrowTypeError("Expected compressedTexImageFromFile(texture, path, callback)");
+    return;
+  }
+
+  CompressedUpload *upload = new CompressedUpload();
+  upload->texture = Nan::To<uint32_t>(info[0]).FromJust();
+  Nan::Utf8String filename(info[1]);
+  upload->filename = *filename;
+
+  Nan::Callback *callback = new Nan::Callback(info[2].As<Function>());
+  Nan::AsyncQueueWorker(new CompressedTextureWorker(callback, upload));
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(CompressTexImageFromFile) {
+  Nan::HandleScope scope;
+
+  if(info.Length() < 8 || !info[5]->IsString() || !info[7]->IsFunction()) {
+    Nan::ThrowTypeError("Expected compressTexImageFromFile(texture, source, internalFormat, mipmapMode, gammaCorrect, cacheDir, threads, callback)");
+    return;
+  }
+
+  GLenum internalFormat = Nan::To<int>(info[2]).FromJust();
+  if(!IsEncodableFormat(internalFormat)) {
+    Nan::ThrowTypeError("compressTexImageFromFile: internalFormat must be a BC1, BC3, BC7 or ETC2 RGB format");
+    return;
+  }
+
+  EncodeUpload *upload = new EncodeUpload();
+  upload->texture = Nan::To<uint32_t>(info[0]).FromJust();
+  upload->internalFormat = internalFormat;
+  upload->mipmapMode = Nan::To<int>(info[3]).FromJust();
+  upload->gammaCorrect = Nan::To<bool>(info[4]).FromJust();
+  Nan::Utf8String cacheDir(info[5]);
+  upload->cacheDir = *cacheDir;
+  upload->threads = Nan::To<int>(info[6]).FromJust();
+
+  if(info[1]->IsArrayBufferView()) {
+    Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(info[1]);
+    upload->sourceStore = arr->Buffer()->GetBackingStore();
+    upload->source = (const uint8_t*) upload->sourceStore->Data() + arr->ByteOffset();
+    upload->sourceSize = arr->ByteLength();
+  }
+  else if(info[1]->IsString()) {
+    Nan::Utf8String filename(info[1]);
+    upload->filename = *filename;
+  }
+  else {
+    delete upload;
+    Nan::ThrowTypeError("compressTexImageFromFile: source must be a file name or a Buffer");
+    return;
+  }
+
+  Nan::Callback *callback = new Nan::Callback(info[7].As<Function>());
+  Nan::AsyncQueueWorker(new TextureEncodeWorker(callback, upload));
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+// encodeTexture(rgbaPixels, width, height, internalFormat, threads) -> Buffer
+NAN_METHOD(EncodeTexture) {
+  Nan::HandleScope scope;
+
+  int width = Nan::To<int>(info[1]).FromJust();
+  int height = Nan::To<int>(info[2]).FromJust();
+  GLenum internalFormat = Nan::To<int>(info[3]).FromJust();
+  int threads = Nan::To<int>(info[4]).FromJust();
+
+  if(!info[0]->IsArrayBufferView() || width <= 0 || height <= 0 ||
+     Local<ArrayBufferView>::Cast(info[0])->ByteLength() < (size_t) width * height * 4) {
+    Nan::ThrowTypeError("encodeTexture: expected width * height RGBA8 pixels");
+    return;
+  }
+  if(!IsEncodableFormat(internalFormat)) {
+    Nan::ThrowTypeError("encodeTexture: internalFormat must be a BC1, BC3, BC7 or ETC2 RGB format");
+    return;
+  }
+
+  Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(info[0]);
+  const uint8_t *pixels = (const uint8_t*) arr->Buffer()->Data() + arr->ByteOffset();
+
+  size_t size = CompressedLevelSize(internalFormat, width, height);
+  Local<Object> buffer = Nan::NewBuffer((uint32_t) size).ToLocalChecked();
+  EncodeImage(pixels, width, height, internalFormat, (uint8_t*) node::Buffer::Data(buffer), threads);
+
+  info.GetReturnValue().Set(buffer);
+}
+
+// decodeTexture(blocks, width, height, internalFormat) -> Buffer of RGBA8 pixels
+NAN_METHOD(DecodeTexture) {
+  Nan::HandleScope scope;
+
+  int width = Nan::To<int>(info[1]).FromJust();
+  int height = Nan::To<int>(info[2]).FromJust();
+  GLenum internalFormat = Nan::To<int>(info[3]).FromJust();
+
+  if(!IsEncodableFormat(internalFormat) || width <= 0 || height <= 0 || !info[0]->IsArrayBufferView() ||
+     Local<ArrayBufferView>::Cast(info[0])->ByteLength() < CompressedLevelSize(internalFormat, width, height)) {
+    Nan::ThrowTypeError("decodeTexture: expected a compressed BC1, BC3, BC7 or ETC2 RGB image of width x height");
+    return;
+  }
+
+  Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(info[0]);
+  const uint8_t *data = (const uint8_t*) arr->Buffer()->Data() + arr->ByteOffset();
+
+  Local<Object> buffer = Nan::NewBuffer((uint32_t)((size_t) width * height * 4)).ToLocalChecked();
+  if(!DecodeImage(data, width, height, internalFormat, (uint8_t*) node::Buffer::Data(buffer))) {
+    Nan::ThrowError("decodeTexture: unsupported block mode");
+    return;
+  }
+
+  info.GetReturnValue().Set(buffer);
+}
+
+} // end namespace webgl
@@ -0,0 +1,50 @@
+/*
+ * texture_loader.h
+ *
+ * Asynchronous image file -> GL texture uploads. Decoding runs on the libuv
+ * thread pool, pixels are written straight into a mapped pixel unpack buffer
+ * and never enter the V8 heap. Block compressed KTX2/DDS files are memory
+ * mapped and uploaded level by level without any decoding; other images can
+ * be block compressed on the CPU at load time, with the result cached on disk.
+ */
+
+#ifndef TEXTURE_LOADER_H_
+#define TEXTURE_LOADER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "mipmap.h"
+
+using namespace node;
+using namespace v8;
+
+namespace webgl {
+
+// must match lib/webgl.js
+enum MipmapMode {
+  MIPMAPS_NONE,
+  MIPMAPS_GPU,      // glGenerateTextureMipmap after the upload
+  MIPMAPS_BOX,      // CPU chain, MIP_FILTER_BOX
+  MIPMAPS_KAISER    // CPU chain, MIP_FILTER_KAISER
+};
+
+// Decodes encoded image bytes to RGBA8 levels: the base level, followed by
+// the CPU filtered chain for MIPMAPS_BOX and MIPMAPS_KAISER. nameHint
+// identifies formats that have no signature. Returns false if the bytes
+// can't be decoded. Safe to call from the thread pool.
+bool DecodeImageLevels(const uint8_t *data, size_t size, const std::string &nameHint, int mipmapMode,
+                       bool gammaCorrect, int threads, std::vector<MipLevel> &levels);
+
+NAN_METHOD(TexImageFromFile);
+NAN_METHOD(CompressedTexImageFromFile);
+NAN_METHOD(CompressTexImageFromFile);
+NAN_METHOD(EncodeTexture);
+NAN_METHOD(DecodeTexture);
+
+}
+
+#endif /* TEXTURE_LOADER_H_ */
@@ -0,0 +1,515 @@
+/*
+ * texture_residency.cc
+ *
+ * gl.manageTexture(texture, source, mipmapMode, gammaCorrect) -> id
+ * gl.setTextureResidency(budget, minSize, maxPendingStreams, renamed(id, texture))
+ * gl.endTextureFrame() -> number of textures evicted
+ *
+ * Eviction (GL thread, end of frame):
+ *   the least recently bound textures not used this frame lose their finest
+ *   level in turn, oldest first, until the resident bytes fit the budget.
+ *   No texture drops below minSize texels on its longer side.
+ *
+ * Stream-in (binding an evicted texture):
+ *   1. thread pool: map the source; KTX2/DDS levels are used as they are,
+ *                   other images are decoded, their chain is rebuilt and,
+ *                   for block compressed textures, encoded again
+ *   2. GL thread:   allocate the complete chain and upload every level
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "texture_residency.h"
+#include "texture_loader.h"
+#include "texture_container.h"
+#include "texture_encoder.h"
+#include "gl_objects.h"
+#include "marshal.h"
+#include "mapped_file.h"
+#include "mipmap.h"
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+struct ResidentTexture {
+  uint32_t id;
+  GLuint texture;
+  GLenum internalFormat;
+  // of the complete chain, which starts at level 0
+  int width;
+  int height;
+  int levels;
+  // the finest resident level: the texture currently holds levels base..levels-1
+  int base;
+
+  string source;
+  int mipmapMode;
+  bool gammaCorrect;
+
+  uint64_t lastUsed;
+  bool streaming;
+  // a failed stream-in isn't retried until the texture is managed again
+  bool failed;
+};
+
+size_t residentTextureCount = 0;
+
+static unordered_map<uint32_t, ResidentTexture> residents;
+// element references stay valid across rehashing
+static unordered_map<GLuint, ResidentTexture *> residentsByName;
+static uint32_t residentIdCounter = 0;
+static uint64_t frame = 0;
+
+static size_t budget = 0;
+static int minSize = 32;
+static int maxPendingStreams = 4;
+static Nan::Callback *renameCallback = NULL;
+
+static size_t residentBytes = 0;
+static int pendingStreams = 0;
+static uint64_t evictedLevels = 0;
+static uint64_t evictedBytes = 0;
+static uint64_t streamIns = 0;
+static uint64_t streamedBytes = 0;
+static uint64_t streamErrors = 0;
+
+static inline int levelSize(int size, int level) {
+  size >>= level;
+  return size > 1 ? size : 1;
+}
+
+static size_t storageBytes(const ResidentTexture &t, int base) {
+  return TextureStorageBytes(GL_TEXTURE_2D, t.internalFormat, levelSize(t.width, base), levelSize(t.height, base),
+                             1, t.levels - base);
+}
+
+// the coarsest base eviction may go to
+static int maxBase(const ResidentTexture &t) {
+  int size = t.width > t.height ? t.width : t.height;
+  int base = 0;
+  while(base < t.levels - 1 && (size >> (base + 1)) >= minSize)
+    base++;
+  return base;
+}
+
+static bool hasAnisotropy() {
+#ifdef GLEW_ARB_texture_filter_anisotropic
+  if(GLEW_ARB_texture_filter_anisotropic)
+    return true;
+#endif
+  return GLEW_EXT_texture_filter_anisotropic;
+}
+
+static void copySamplingState(GLuint from, GLuint to) {
+  static const GLenum intParams[] = {
+    GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER,
+    GL_TEXTURE_WRAP_S, GL_TEXTURE_WRAP_T, GL_TEXTURE_WRAP_R,
+    GL_TEXTURE_COMPARE_MODE, GL_TEXTURE_COMPARE_FUNC,
+    GL_TEXTURE_SWIZZLE_R, GL_TEXTURE_SWIZZLE_G, GL_TEXTURE_SWIZZLE_B, GL_TEXTURE_SWIZZLE_A
+  };
+  for(GLenum pname : intParams) {
+    GLint value;
+    glGetTextureParameteriv(from, pname, &value);
+    glTextureParameteri(to, pname, value);
+  }
+  GLfloat value;
+  glGetTextureParameterfv(from, GL_TEXTURE_LOD_BIAS, &value);
+  glTextureParameterf(to, GL_TEXTURE_LOD_BIAS, value);
+  if(hasAnisotropy()) {
+    glGetTextureParameterfv(from, GL_TEXTURE_MAX_ANISOTROPY_EXT, &value);
+    glTextureParameterf(to, GL_TEXTURE_MAX_ANISOTROPY_EXT, value);
+  }
+  GLfloat border[4];
+  glGetTextureParameterfv(from, GL_TEXTURE_BORDER_COLOR, border);
+  glTextureParameterfv(to, GL_TEXTURE_BORDER_COLOR, border);
+}
+
+// New storage for levels base..levels-1 of t, sampled like t.
+static GLuint allocateLevels(const ResidentTexture &t, int base) {
+  GLuint texture;
+  glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+  glTextureStorage2D(texture, t.levels - base, t.internalFormat, levelSize(t.width, base), levelSize(t.height, base));
+  copySamplingState(t.texture, texture);
+  return texture;
+}
+
+static void notifyRename(const ResidentTexture &t, Nan::AsyncResource *resource) {
+  if(!renameCallback)
+    return;
+  Nan::HandleScope scope;
+  Local<Value> argv[] = { Nan::New<Uint32>(t.id), Nan::New<Uint32>(t.texture) };
+  renameCallback->Call(2, argv, resource);
+}
+
+// Swaps t's storage for texture, which holds levels base..levels-1.
+static void replaceTexture(ResidentTexture &t, GLuint texture, int base) {
+  residentBytes -= storageBytes(t, t.base);
+  residentsByName.erase(t.texture);
+  glDeleteTextures(1, &t.texture);
+  unregisterGLObj(GLOBJECT_TYPE_TEXTURE, t.texture);
+
+  t.texture = texture;
+  t.base = base;
+  residentBytes += storageBytes(t, base);
+  residentsByName[texture] = &t;
+  registerGLObj(GLOBJECT_TYPE_TEXTURE, texture);
+  setGLObjBytes(GLOBJECT_TYPE_TEXTURE, texture, storageBytes(t, base));
+}
+
+static void evict(ResidentTexture &t, int base) {
+  GLuint texture = allocateLevels(t, base);
+  for(int level = base; level < t.levels; level++)
+    glCopyImageSubData(t.texture, GL_TEXTURE_2D, level - t.base, 0, 0, 0,
+                       texture, GL_TEXTURE_2D, level - base, 0, 0, 0,
+                       levelSize(t.width, level), levelSize(t.height, level), 1);
+
+  evictedLevels += base - t.base;
+  evictedBytes += storageBytes(t, t.base) - storageBytes(t, base);
+  replaceTexture(t, texture, base);
+}
+
+/*
+ * Stream-in
+ */
+
+struct StreamIn {
+  uint32_t id;
+  string source;
+  GLenum internalFormat;
+  int width;
+  int height;
+  int levels;
+  int mipmapMode;
+  bool gammaCorrect;
+
+  // KTX2/DDS: the levels point into file
+  MappedFile file;
+  CompressedImage image;
+  bool container;
+  // decoded images: RGBA8 levels, or their encoding for compressed formats
+  vector<MipLevel> mips;
+  vector<vector<uint8_t> > encoded;
+
+  StreamIn() : id(0), internalFormat(0), width(0), height(0), levels(0), mipmapMode(MIPMAPS_BOX),
+    gammaCorrect(false), container(false) {}
+};
+
+class TextureStreamWorker : public Nan::AsyncWorker {
+public:
+  TextureStreamWorker(StreamIn *stream)
+    : Nan::AsyncWorker(NULL, "webgl:textureStreamIn"), stream(stream) {}
+
+  ~TextureStreamWorker() {
+    delete stream;
+  }
+
+  void Execute() {
+    if(!stream->file.Open(stream->source.c_str())) {
+      SetErrorMessage("unable to open file");
+      return;
+    }
+
+    const char *error = NULL;
+    if(ParseCompressedContainer(stream->file.Data(), stream->file.Size(), &stream->image, &error)) {
+      const CompressedImage &image = stream->image;
+      if(image.internalFormat != stream->internalFormat || image.width != stream->width ||
+         image.height != stream->height || (int) image.levels.size() < stream->levels) {
+        SetErrorMessage("the file no longer matches the texture");
+        return;
+      }
+      stream->container = true;
+      stream->file.Advise(MappedFile::ADVICE_SEQUENTIAL);
+      stream->file.Prefetch();
+      return;
+    }
+
+    // eviction needs the complete chain, whatever the texture was loaded with
+    int mode = stream->mipmapMode == MIPMAPS_KAISER ? MIPMAPS_KAISER : MIPMAPS_BOX;
+    bool decoded = DecodeImageLevels(stream->file.Data(), stream->file.Size(), stream->source, mode,
+                                     stream->gammaCorrect, 1, stream->mips);
+    stream->file.Close();
+    if(!decoded) {
+      SetErrorMessage("unable to decode image");
+      return;
+    }
+    if(stream->mips[0].width != stream->width || stream->mips[0].height != stream->height ||
+       (int) stream->mips.size() < stream->levels) {
+      SetErrorMessage("the file no longer matches the texture");
+      return;
+    }
+
+    if(CompressedLevelSize(stream->internalFormat, 1, 1)) {
+      if(!IsEncodableFormat(stream->internalFormat)) {
+        SetErrorMessage("the texture's compressed format can't be encoded");
+        return;
+      }
+      stream->encoded.resize(stream->levels);
+      for(int i = 0; i < stream->levels; i++) {
+        const MipLevel &mip = stream->mips[i];
+        stream->encoded[i].resize(CompressedLevelSize(stream->internalFormat, mip.width, mip.height));
+        EncodeImage(&mip.rgba[0], mip.width, mip.height, stream->internalFormat, &stream->encoded[i][0], 1);
+      }
+    }
+  }
+
+  void HandleOKCallback() {
+    pendingStreams--;
+    auto it = residents.find(stream->id);
+    // unmanaged (or deleted) in the meantime
+    if(it == residents.end())
+      return;
+    ResidentTexture &t = it->second;
+    t.streaming = false;
+    if(t.base == 0)
+      return;
+
+    GLuint texture = allocateLevels(t, 0);
+    upload(texture);
+
+    streamIns++;
+    streamedBytes += storageBytes(t, 0) - storageBytes(t, t.base);
+    replaceTexture(t, texture, 0);
+    notifyRename(t, async_resource);
+  }
+
+  void HandleErrorCallback() {
+    pendingStreams--;
+    streamErrors++;
+    auto it = residents.find(stream->id);
+    if(it == residents.end())
+      return;
+    it->second.streaming = false;
+    it->second.failed = true;
+    #ifdef LOGGING
+    cout<<"textureStreamIn "<<stream->source<<": "<<ErrorMessage()<<endl;
+    #endif
+  }
+
+private:
+  // Every level comes from the stream, so no copies out of the old texture
+  // are needed and the coarse levels don't depend on what is resident now.
+  void upload(GLuint texture) {
+    GLint prevUnpackBuffer, prevAlignment, prevRowLength;
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &prevUnpackBuffer);
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &prevAlignment);
+    glGetIntegerv(GL_UNPACK_ROW_LENGTH, &prevRowLength);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    for(int i = 0; i < stream->levels; i++) {
+      if(stream->container) {
+        const CompressedLevel &level = stream->image.levels[i];
+        glCompressedTextureSubImage2D(texture, i, 0, 0, level.width, level.height, stream->internalFormat,
+                                      (GLsizei) level.size, level.data);
+      }
+      else if(!stream->encoded.empty()) {
+        const MipLevel &mip = stream->mips[i];
+        glCompressedTextureSubImage2D(texture, i, 0, 0, mip.width, mip.height, stream->internalFormat,
+                                      (GLsizei) stream->encoded[i].size(), &stream->encoded[i][0]);
+      }
+      else {
+        const MipLevel &mip = stream->mips[i];
+        glTextureSubImage2D(texture, i, 0, 0, mip.width, mip.height, GL_RGBA, GL_UNSIGNED_BYTE, &mip.rgba[0]);
+      }
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, prevUnpackBuffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, prevAlignment);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, prevRowLength);
+  }
+
+  StreamIn *stream;
+};
+
+static void streamIn(ResidentTexture &t) {
+  StreamIn *stream = new StreamIn();
+  stream->id = t.id;
+  stream->source = t.source;
+  stream->internalFormat = t.internalFormat;
+  stream->width = t.width;
+  stream->height = t.height;
+  stream->levels = t.levels;
+  stream->mipmapMode = t.mipmapMode;
+  stream->gammaCorrect = t.gammaCorrect;
+
+  t.streaming = true;
+  pendingStreams++;
+  Nan::AsyncQueueWorker(new TextureStreamWorker(stream));
+}
+
+void TouchResidentTexture(GLuint texture) {
+  auto it = residentsByName.find(texture);
+  if(it == residentsByName.end())
+    return;
+  ResidentTexture &t = *it->second;
+  t.lastUsed = frame;
+  if(t.base > 0 && !t.streaming && !t.failed && pendingStreams < maxPendingStreams)
+    streamIn(t);
+}
+
+static void forget(ResidentTexture &t) {
+  residentBytes -= storageBytes(t, t.base);
+  residentsByName.erase(t.texture);
+  // a pending stream-in finds the id gone and drops its result
+  uint32_t id = t.id;
+  residents.erase(id);
+  residentTextureCount = residents.size();
+}
+
+void ForgetResidentTexture(GLuint texture) {
+  auto it = residentsByName.find(texture);
+  if(it != residentsByName.end())
+    forget(*it->second);
+}
+
+// gl.manageTexture(texture, source, mipmapMode, gammaCorrect) -> id. texture
+// must have immutable 2D storage (e.g. from texImageFromFile) loaded from
+// source.
+NAN_METHOD(ManageTexture) {
+  GLuint texture = marshal::Arg<GLuint>::Unbox(info[0]);
+
+  GLint target = 0, immutable = 0, levels = 0, width = 0, height = 0, internalFormat = 0;
+  glGetTextureParameteriv(texture, GL_TEXTURE_TARGET, &target);
+  glGetTextureParameteriv(texture, GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+  if(target != GL_TEXTURE_2D || !immutable || !info[1]->IsString()) {
+    Nan::ThrowTypeError("manageTexture: expected a 2D texture with immutable storage and its source file");
+    return;
+  }
+  glGetTextureParameteriv(texture, GL_TEXTURE_IMMUTABLE_LEVELS, &levels);
+  glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_WIDTH, &width);
+  glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_HEIGHT, &height);
+  glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+
+  ResidentTexture *t;
+  auto it = residentsByName.find(texture);
+  if(it != residentsByName.end()) {
+    t = it->second;
+    // managed again: its storage is recounted below
+    if(t->base == 0)
+      residentBytes -= storageBytes(*t, 0);
+  } else {
+    uint32_t id = ++residentIdCounter;
+    t = &residents[id];
+    t->id = id;
+    t->texture = texture;
+    t->base = 0;
+    t->streaming = false;
+    residentsByName[texture] = t;
+  }
+
+  Nan::Utf8String source(info[1]);
+  t->source = *source;
+  t->mipmapMode = marshal::Arg<int>::Unbox(info[2]);
+  t->gammaCorrect = marshal::Arg<GLboolean>::Unbox(info[3]);
+  if(t->base == 0) {
+    t->internalFormat = internalFormat;
+    t->width = width;
+    t->height = height;
+    t->levels = levels;
+    residentBytes += storageBytes(*t, 0);
+  }
+  t->lastUsed = frame;
+  t->failed = false;
+  residentTextureCount = residents.size();
+
+  info.GetReturnValue().Set(t->id);
+}
+
+// gl.unmanageTexture(id): the texture keeps whatever levels are resident
+NAN_METHOD(UnmanageTexture) {
+  auto it = residents.find(marshal::Arg<uint32_t>::Unbox(info[0]));
+  if(it != residents.end())
+    forget(it->second);
+}
+
+NAN_METHOD(SetTextureResidency) {
+  budget = (size_t) marshal::Arg<double>::Unbox(info[0]);
+  minSize = marshal::Arg<int>::Unbox(info[1]);
+  maxPendingStreams = marshal::Arg<int>::Unbox(info[2]);
+  if(info[3]->IsFunction()) {
+    delete renameCallback;
+    renameCallback = new Nan::Callback(info[3].As<Function>());
+  }
+}
+
+NAN_METHOD(EndTextureFrame) {
+  int evicted = 0;
+
+  if(budget && residentBytes > budget) {
+    vector<ResidentTexture *> lru;
+    for(auto &entry : residents) {
+      ResidentTexture &t = entry.second;
+      if(t.lastUsed < frame && !t.streaming && t.base < maxBase(t))
+        lru.push_back(&t);
+    }
+    sort(lru.begin(), lru.end(), [](const ResidentTexture *a, const ResidentTexture *b) {
+      return a->lastUsed < b->lastUsed;
+    });
+
+    // one level per texture and pass, so the finest levels go first
+    vector<int> bases(lru.size());
+    for(size_t i = 0; i < lru.size(); i++)
+      bases[i] = lru[i]->base;
+    size_t bytes = residentBytes;
+    bool progress = true;
+    while(bytes > budget && progress) {
+      progress = false;
+      for(size_t i = 0; i < lru.size() && bytes > budget; i++) {
+        if(bases[i] >= maxBase(*lru[i]))
+          continue;
+        bytes -= storageBytes(*lru[i], bases[i]) - storageBytes(*lru[i], bases[i] + 1);
+        bases[i]++;
+        progress = true;
+      }
+    }
+
+    Nan::AsyncResource resource("webgl:endTextureFrame");
+    for(size_t i = 0; i < lru.size(); i++) {
+      if(bases[i] == lru[i]->base)
+        continue;
+      evict(*lru[i], bases[i]);
+      notifyRename(*lru[i], &resource);
+      evicted++;
+    }
+  }
+
+  frame++;
+  info.GetReturnValue().Set(evicted);
+}
+
+NAN_METHOD(GetTextureResidencyStats) {
+  size_t fullBytes = 0;
+  int evictedTextures = 0;
+  for(auto &entry : residents) {
+    fullBytes += storageBytes(entry.second, 0);
+    if(entry.second.base > 0)
+      evictedTextures++;
+  }
+
+  Local<Object> stats = Nan::New<Object>();
+  Nan::Set(stats, JS_STR("textures"), JS_FLOAT((double) residents.size()));
+  Nan::Set(stats, JS_STR("residentBytes"), JS_FLOAT((double) residentBytes));
+  Nan::Set(stats, JS_STR("fullBytes"), JS_FLOAT((double) fullBytes));
+  Nan::Set(stats, JS_STR("budget"), JS_FLOAT((double) budget));
+  Nan::Set(stats, JS_STR("frame"), JS_FLOAT((double) frame));
+  Nan::Set(stats, JS_STR("evictedTextures"), JS_INT(evictedTextures));
+  Nan::Set(stats, JS_STR("evictedLevels"), JS_FLOAT((double) evictedLevels));
+  Nan::Set(stats, JS_STR("evictedBytes"), JS_FLOAT((double) evictedBytes));
+  Nan::Set(stats, JS_STR("streamIns"), JS_FLOAT((double) streamIns));
+  Nan::Set(stats, JS_STR("streamedBytes"), JS_FLOAT((double) streamedBytes));
+  Nan::Set(stats, JS_STR("pendingStreams"), JS_INT(pendingStreams));
+  Nan::Set(stats, JS_STR("streamErrors"), JS_FLOAT((double) streamErrors));
+  info.GetReturnValue().Set(stats);
+}
+
+} // end namespace webgl
@@ -0,0 +1,47 @@
+/*
+ * texture_residency.h
+ *
+ * Keeps the textures loaded from files within a VRAM budget. Managed
+ * textures remember their source file and the frame they were last bound
+ * in. At the end of a frame, while the resident bytes exceed the budget, the
+ * finest mip levels of the least recently used textures are evicted; binding
+ * an evicted texture streams its levels back in from the file on the thread
+ * pool.
+ *
+ * Immutable storage can't shrink, and clamping with GL_TEXTURE_BASE_LEVEL or
+ * a glTextureView keeps all of it allocated. So an eviction allocates a
+ * smaller texture, copies the remaining levels over with glCopyImageSubData
+ * and deletes the old one; a stream-in does the reverse. Either way the
+ * texture's name changes and lib/webgl.js updates its wrapper through the
+ * rename callback. Names held elsewhere (texture units, framebuffer
+ * attachments) go stale, so managed textures are meant to be sampled and
+ * rebound every frame.
+ */
+
+#ifndef TEXTURE_RESIDENCY_H_
+#define TEXTURE_RESIDENCY_H_
+
+#include "common.h"
+#include <GL/glew.h>
+
+namespace webgl {
+
+// Called by the texture binding entry points: marks a managed texture as
+// used this frame and starts streaming in its evicted levels.
+void TouchResidentTexture(GLuint texture);
+
+// Called by DeleteTexture: stops managing a texture that is deleted.
+void ForgetResidentTexture(GLuint texture);
+
+// Number of managed textures, so the bind paths can skip the lookup.
+extern size_t residentTextureCount;
+
+NAN_METHOD(ManageTexture);
+NAN_METHOD(UnmanageTexture);
+NAN_METHOD(SetTextureResidency);
+NAN_METHOD(EndTextureFrame);
+NAN_METHOD(GetTextureResidencyStats);
+
+}
+
+#endif /* TEXTURE_RESIDENCY_H_ */
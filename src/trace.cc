@@ -0,0 +1,232 @@
+/*
+ * trace.cc
+ *
+ * gl.traceOpen(path) -> bool
+ * gl.traceDefine(id, name)
+ * gl.traceCall(id, args) -> call index
+ * gl.traceReturn(index, value)
+ * gl.traceCallback(index, argumentIndex)
+ * gl.traceFrame()
+ * gl.traceClose() -> {calls, frames, blobs, blobBytes, bytes}
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unordered_set>
+
+#include "trace.h"
+#include "marshal.h"
+#include "texture_encoder.h"
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+// nested arrays and objects deeper than this are logged as undefined
+static const int TRACE_MAX_DEPTH = 8;
+
+static FILE *traceFile = NULL;
+static chrono::steady_clock::time_point traceStart;
+static unordered_set<uint64_t> traceBlobs;
+static uint64_t traceCalls = 0, traceFrames = 0, traceBlobBytes = 0, traceBytes = 0;
+
+static inline void write(const void *data, size_t size) {
+  fwrite(data, 1, size, traceFile);
+  traceBytes += size;
+}
+
+template<typename T>
+static inline void write(T value) {
+  write(&value, sizeof(value));
+}
+
+static void writeString(const char *text, size_t length) {
+  write<uint32_t>((uint32_t) length);
+  write(text, length);
+}
+
+static TraceBytesKind bytesKind(Local<Value> value) {
+  if(value->IsInt8Array()) return TRACE_INT8;
+  if(value->IsUint8Array()) return TRACE_UINT8;
+  if(value->IsUint8ClampedArray()) return TRACE_UINT8_CLAMPED;
+  if(value->IsInt16Array()) return TRACE_INT16;
+  if(value->IsUint16Array()) return TRACE_UINT16;
+  if(value->IsInt32Array()) return TRACE_INT32_ARRAY;
+  if(value->IsUint32Array()) return TRACE_UINT32;
+  if(value->IsFloat32Array()) return TRACE_FLOAT32;
+  if(value->IsFloat64Array()) return TRACE_FLOAT64;
+  if(value->IsBigInt64Array()) return TRACE_BIGINT64;
+  if(value->IsBigUint64Array()) return TRACE_BIGUINT64;
+  if(value->IsDataView()) return TRACE_DATA_VIEW;
+  return TRACE_ARRAY_BUFFER;
+}
+
+// Blob records are written before the call record that refers to them, so
+// values are encoded into a separate buffer first.
+static string encoded;
+
+static void encode(const void *data, size_t size) {
+  encoded.append((const char *) data, size);
+}
+
+template<typename T>
+static inline void encode(T value) {
+  encode(&value, sizeof(value));
+}
+
+// The contents go into a blob record the first time they are seen, the
+// value refers to it by hash.
+static void encodeBytes(Local<Value> value) {
+  size_t length = 0;
+  const uint8_t *data = marshal::ArrayData<uint8_t>(value, &length);
+  uint64_t hash = HashBytes(data, length);
+  // the length is part of the key
+  if(traceBlobs.insert(hash ^ (length * 0x9E3779B97F4A7C15ULL)).second) {
+    write<uint8_t>(TRACE_BLOB);
+    write<uint64_t>(hash);
+    write<uint64_t>(length);
+    write(data, length);
+    traceBlobBytes += length;
+  }
+  encode<uint8_t>(TRACE_BYTES);
+  encode<uint8_t>(bytesKind(value));
+  encode<uint64_t>(hash);
+  encode<uint64_t>(length);
+}
+
+static void encodeValue(Local<Value> value, int depth) {
+  if(value->IsInt32()) {
+    encode<uint8_t>(TRACE_INT32);
+    encode<int32_t>(value.As<Int32>()->Value());
+  } else if(value->IsNumber()) {
+    encode<uint8_t>(TRACE_NUMBER);
+    encode<double>(value.As<Number>()->Value());
+  } else if(value->IsBoolean()) {
+    encode<uint8_t>(value->IsTrue() ? TRACE_TRUE : TRACE_FALSE);
+  } else if(value->IsNull()) {
+    encode<uint8_t>(TRACE_NULL);
+  } else if(value->IsString()) {
+    Nan::Utf8String text(value);
+    encode<uint8_t>(TRACE_STRING);
+    encode<uint32_t>((uint32_t) text.length());
+    encode(*text, text.length());
+  } else if(value->IsBigInt()) {
+    encode<uint8_t>(TRACE_BIGINT);
+    encode<int64_t>(value.As<BigInt>()->Int64Value());
+  } else if(value->IsArrayBufferView() || value->IsArrayBuffer() || value->IsSharedArrayBuffer()) {
+    encodeBytes(value);
+  } else if(value->IsFunction()) {
+    encode<uint8_t>(TRACE_FUNCTION);
+  } else if(value->IsArray() && depth < TRACE_MAX_DEPTH) {
+    Local<Array> array = value.As<Array>();
+    encode<uint8_t>(TRACE_ARRAY);
+    encode<uint32_t>(array->Length());
+    for(uint32_t i = 0; i < array->Length(); i++)
+      encodeValue(Nan::Get(array, i).ToLocalChecked(), depth + 1);
+  } else if(value->IsObject() && depth < TRACE_MAX_DEPTH) {
+    Local<Object> object = value.As<Object>();
+    Local<Array> keys = Nan::GetOwnPropertyNames(object).ToLocalChecked();
+    encode<uint8_t>(TRACE_OBJECT);
+    encode<uint32_t>(keys->Length());
+    for(uint32_t i = 0; i < keys->Length(); i++) {
+      Local<Value> key = Nan::Get(keys, i).ToLocalChecked();
+      Nan::Utf8String name(key);
+      encode<uint32_t>((uint32_t) name.length());
+      encode(*name, name.length());
+      encodeValue(Nan::Get(object, key).ToLocalChecked(), depth + 1);
+    }
+  } else {
+    encode<uint8_t>(TRACE_UNDEFINED);
+  }
+}
+
+NAN_METHOD(TraceOpen) {
+  TraceAtExit();
+  Nan::Utf8String path(info[0]);
+  traceFile = fopen(*path, "wb");
+  if(!traceFile) {
+    info.GetReturnValue().Set(false);
+    return;
+  }
+  setvbuf(traceFile, NULL, _IOFBF, 4 << 20);
+  traceStart = chrono::steady_clock::now();
+  traceBlobs.clear();
+  traceCalls = traceFrames = traceBlobBytes = traceBytes = 0;
+  write("NGLTRACE", 8);
+  write<uint32_t>(TRACE_VERSION);
+  info.GetReturnValue().Set(true);
+}
+
+NAN_METHOD(TraceClose) {
+  Local<Object> stats = Nan::New<Object>();
+  Nan::Set(stats, JS_STR("calls"), JS_FLOAT((double) traceCalls));
+  Nan::Set(stats, JS_STR("frames"), JS_FLOAT((double) traceFrames));
+  Nan::Set(stats, JS_STR("blobs"), JS_FLOAT((double) traceBlobs.size()));
+  Nan::Set(stats, JS_STR("blobBytes"), JS_FLOAT((double) traceBlobBytes));
+  Nan::Set(stats, JS_STR("bytes"), JS_FLOAT((double) traceBytes));
+  TraceAtExit();
+  info.GetReturnValue().Set(stats);
+}
+
+NAN_METHOD(TraceDefine) {
+  if(!traceFile)
+    return;
+  Nan::Utf8String name(info[1]);
+  write<uint8_t>(TRACE_DEFINE);
+  write<uint32_t>(Nan::To<uint32_t>(info[0]).FromJust());
+  writeString(*name, name.length());
+}
+
+NAN_METHOD(TraceCall) {
+  if(!traceFile || !info[1]->IsObject())
+    return;
+  Local<Object> args = info[1].As<Object>();
+  uint32_t argc = Nan::To<uint32_t>(Nan::Get(args, JS_STR("length")).ToLocalChecked()).FromMaybe(0);
+  encoded.clear();
+  for(uint32_t i = 0; i < argc; i++)
+    encodeValue(Nan::Get(args, i).ToLocalChecked(), 0);
+  write<uint8_t>(TRACE_CALL);
+  write<uint32_t>(Nan::To<uint32_t>(info[0]).FromJust());
+  write<uint32_t>(argc);
+  write(encoded.data(), encoded.size());
+  info.GetReturnValue().Set(JS_FLOAT((double) traceCalls++));
+}
+
+NAN_METHOD(TraceReturn) {
+  if(!traceFile)
+    return;
+  encoded.clear();
+  encodeValue(info[1], TRACE_MAX_DEPTH);
+  write<uint8_t>(TRACE_RETURN);
+  // call indices are counted in 64 bits, past what a u32 holds in long traces
+  write<uint64_t>((uint64_t) Nan::To<double>(info[0]).FromJust());
+  write(encoded.data(), encoded.size());
+}
+
+NAN_METHOD(TraceCallback) {
+  if(!traceFile)
+    return;
+  write<uint8_t>(TRACE_CALLBACK);
+  write<uint64_t>((uint64_t) Nan::To<double>(info[0]).FromJust());
+  write<uint32_t>(Nan::To<uint32_t>(info[1]).FromJust());
+}
+
+NAN_METHOD(TraceFrame) {
+  if(!traceFile)
+    return;
+  write<uint8_t>(TRACE_FRAME);
+  write<uint64_t>((uint64_t) chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - traceStart).count());
+  traceFrames++;
+}
+
+void TraceAtExit() {
+  if(traceFile) {
+    fclose(traceFile);
+    traceFile = NULL;
+  }
+}
+
+} // end namespace webgl
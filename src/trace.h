@@ -0,0 +1,72 @@
+/*
+ * trace.h
+ *
+ * Call tracing for performance reproduction. With NODE_WEBGL_TRACE set,
+ * lib/webgl.js wraps every native before anything captures it and hands
+ * each call's name and arguments to the recorder here, which appends them
+ * to a compact binary log; typed array contents are stored once per content
+ * hash. Frame markers, return values and the invocations of callbacks (so
+ * asynchronous work lands in the same frame on replay) are logged too.
+ * tools/replay.js replays a log against a headless context with per frame
+ * timings. Without the variable nothing is wrapped.
+ *
+ * Log format (little endian): "NGLTRACE", u32 version, then records of a
+ * u8 TraceRecord and its fields. Values are a u8 TraceValue tag and payload.
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include "common.h"
+
+namespace webgl {
+
+static const uint32_t TRACE_VERSION = 2;
+
+// must match tools/replay.js
+enum TraceRecord {
+  TRACE_DEFINE = 1,   // u32 id, u32 length, name
+  TRACE_CALL = 2,     // u32 id, u32 argc, argc values
+  TRACE_RETURN = 3,   // u64 call index, value
+  TRACE_CALLBACK = 4, // u64 call index, u32 argument index
+  TRACE_FRAME = 5,    // u64 nanoseconds since the trace began
+  TRACE_BLOB = 6      // u64 hash, u64 length, bytes
+};
+
+enum TraceValue {
+  TRACE_UNDEFINED = 0,
+  TRACE_NULL = 1,
+  TRACE_FALSE = 2,
+  TRACE_TRUE = 3,
+  TRACE_INT32 = 4,    // i32
+  TRACE_NUMBER = 5,   // f64
+  TRACE_STRING = 6,   // u32 length, UTF-8
+  TRACE_BIGINT = 7,   // i64
+  TRACE_BYTES = 8,    // u8 TraceBytesKind, u64 hash, u64 length of a blob
+  TRACE_ARRAY = 9,    // u32 count, values
+  TRACE_OBJECT = 10,  // u32 count, (u32 length, key, value)*
+  TRACE_FUNCTION = 11 // a callback, replaced on replay
+};
+
+enum TraceBytesKind {
+  TRACE_ARRAY_BUFFER,
+  TRACE_INT8, TRACE_UINT8, TRACE_UINT8_CLAMPED,
+  TRACE_INT16, TRACE_UINT16, TRACE_INT32_ARRAY, TRACE_UINT32,
+  TRACE_FLOAT32, TRACE_FLOAT64, TRACE_BIGINT64, TRACE_BIGUINT64,
+  TRACE_DATA_VIEW
+};
+
+NAN_METHOD(TraceOpen);
+NAN_METHOD(TraceClose);
+NAN_METHOD(TraceDefine);
+NAN_METHOD(TraceCall);
+NAN_METHOD(TraceReturn);
+NAN_METHOD(TraceCallback);
+NAN_METHOD(TraceFrame);
+
+// flushes and closes an open log
+void TraceAtExit();
+
+}
+
+#endif /* TRACE_H_ */
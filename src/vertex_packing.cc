@@ -0,0 +1,319 @@
+/*
+ * vertex_packing.cc
+ *
+ * gl.packVertices(out, vertexCount, stride, attributes, inputs, threads)
+ *   attributes: Int32Array of (format, components, offset) per attribute,
+ *   inputs: an Array of Float32Arrays, components floats per vertex
+ *
+ * Half floats use F16C when the build targets it and an SSE2 (or scalar)
+ * round to nearest even conversion otherwise.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define WEBGL_PACKING_SSE2
+  #include <emmintrin.h>
+#endif
+#if defined(__F16C__) || defined(__AVX2__)
+  #define WEBGL_PACKING_F16C
+  #include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "vertex_packing.h"
+#include "marshal.h"
+#include "parallel.h"
+
+namespace webgl {
+
+using namespace node;
+using namespace v8;
+using namespace std;
+
+// vertices per task (and per conversion buffer)
+static const size_t PACK_BLOCK = 1024;
+
+struct PackAttribute {
+  PackFormat format;
+  int components;
+  size_t offset;
+  const float *data;
+};
+
+/*
+ * Half floats
+ */
+
+static const uint32_t denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+static inline uint16_t floatToHalf(float value) {
+  uint32_t u;
+  memcpy(&u, &value, sizeof(u));
+  uint32_t sign = (u >> 16) & 0x8000;
+  u &= 0x7FFFFFFF;
+  uint32_t h;
+  if(u >= 0x47800000) {
+    // too large for a half: infinity, NaN stays NaN
+    h = u > 0x7F800000 ? 0x7E00 : 0x7C00;
+  } else if(u < 0x38800000) {
+    // denormal: let the FPU round the mantissa into place
+    float f, magic;
+    memcpy(&f, &u, sizeof(f));
+    memcpy(&magic, &denormMagic, sizeof(magic));
+    f += magic;
+    memcpy(&h, &f, sizeof(h));
+    h -= denormMagic;
+  } else {
+    // rebias the exponent and round the mantissa to nearest even
+    uint32_t odd = (u >> 13) & 1;
+    h = (u + ((uint32_t) (15 - 127) << 23) + 0xFFF + odd) >> 13;
+  }
+  return (uint16_t) (sign | h);
+}
+
+static void toHalf(uint16_t *out, const float *in, size_t n) {
+  size_t i = 0;
+#if defined(WEBGL_PACKING_F16C)
+  for(; i + 4 <= n; i += 4)
+    _mm_storel_epi64((__m128i *) (out + i), _mm_cvtps_ph(_mm_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(WEBGL_PACKING_SSE2)
+  // floatToHalf, 4 at a time
+  const __m128i absMask = _mm_set1_epi32(0x7FFFFFFF), signMask = _mm_set1_epi32(0x8000);
+  const __m128i magic = _mm_set1_epi32(denormMagic), rebias = _mm_set1_epi32((int) (((uint32_t) (15 - 127) << 23) + 0xFFF));
+  const __m128i one = _mm_set1_epi32(1), infinity = _mm_set1_epi32(0x7C00), nan = _mm_set1_epi32(0x7E00);
+  for(; i + 4 <= n; i += 4) {
+    __m128i u = _mm_castps_si128(_mm_loadu_ps(in + i));
+    __m128i sign = _mm_and_si128(_mm_srli_epi32(u, 16), signMask);
+    __m128i a = _mm_and_si128(u, absMask);
+    __m128i odd = _mm_and_si128(_mm_srli_epi32(a, 13), one);
+    __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(a, rebias), odd), 13);
+    __m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(magic))), magic);
+    __m128i large = _mm_cmpgt_epi32(a, _mm_set1_epi32(0x477FFFFF));
+    __m128i small = _mm_cmplt_epi32(a, _mm_set1_epi32(0x38800000));
+    __m128i special = _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi32(a, _mm_set1_epi32(0x7F800000)), nan),
+                                   _mm_andnot_si128(_mm_cmpgt_epi32(a, _mm_set1_epi32(0x7F800000)), infinity));
+    __m128i h = _mm_or_si128(_mm_and_si128(small, denormal), _mm_andnot_si128(small, normal));
+    h = _mm_or_si128(_mm_and_si128(large, special), _mm_andnot_si128(large, h));
+    h = _mm_or_si128(h, sign);
+    // sign extend the low halves so the saturating pack keeps them
+    h = _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+    _mm_storel_epi64((__m128i *) (out + i), _mm_packs_epi32(h, h));
+  }
+#endif
+  for(; i < n; i++)
+    out[i] = floatToHalf(in[i]);
+}
+
+/*
+ * Normalized and integer formats
+ */
+
+// round(clamp(in, low, high) * scale)
+static void toFixed(int32_t *out, const float *in, size_t n, float low, float high, float scale) {
+  size_t i = 0;
+#ifdef WEBGL_PACKING_SSE2
+  __m128 lo = _mm_set1_ps(low), hi = _mm_set1_ps(high), s = _mm_set1_ps(scale);
+  for(; i + 4 <= n; i += 4) {
+    // NaN compares false and comes out of max as lo
+    __m128 x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), lo), hi);
+    _mm_storeu_si128((__m128i *) (out + i), _mm_cvtps_epi32(_mm_mul_ps(x, s)));
+  }
+#endif
+  for(; i < n; i++) {
+    float x = in[i] >= low ? min(in[i], high) : low;
+    out[i] = (int32_t) lrintf(x * scale);
+  }
+}
+
+static inline uint32_t field(float value, int bits) {
+  float max = (float) ((1 << (bits - 1)) - 1);
+  float x = value >= -1 ? min(value, 1.0f) : -1.0f;
+  return (uint32_t) (int32_t) lrintf(x * max) & ((1u << bits) - 1);
+}
+
+static inline uint32_t pack2101010(float x, float y, float z, float w) {
+  return field(x, 10) | field(y, 10) << 10 | field(z, 10) << 20 | field(w, 2) << 30;
+}
+
+// Octahedral: project onto |x| + |y| + |z| = 1 and fold the lower half over
+// the diagonals. The shader decodes with
+//   vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+//   n.xy = n.z < 0.0 ? (1.0 - abs(n.yx)) * sign(n.xy) : n.xy;
+//   n = normalize(n);
+static inline void octahedral(const float *v, float *out) {
+  float sum = fabsf(v[0]) + fabsf(v[1]) + fabsf(v[2]);
+  if(sum == 0 || !isfinite(sum)) {
+    out[0] = out[1] = 0;
+    return;
+  }
+  float x = v[0] / sum, y = v[1] / sum;
+  if(v[2] < 0) {
+    float fx = (1 - fabsf(y)) * (x >= 0 ? 1 : -1);
+    float fy = (1 - fabsf(x)) * (y >= 0 ? 1 : -1);
+    x = fx;
+    y = fy;
+  }
+  out[0] = x;
+  out[1] = y;
+}
+
+/*
+ * Packing
+ */
+
+static void packBlock(uint8_t *out, size_t stride, const PackAttribute &a, size_t begin, size_t end) {
+  size_t count = end - begin, n = count * a.components;
+  const float *in = a.data + begin * a.components;
+  uint8_t *dst = out + begin * stride + a.offset;
+  int c = a.components;
+  // padded to 4 bytes
+  union {
+    uint16_t halves[PACK_BLOCK * 4];
+    int32_t fixed[PACK_BLOCK * 4];
+  } buffer;
+
+  switch(a.format) {
+    case PACK_FLOAT:
+      for(size_t v = 0; v < count; v++)
+        memcpy(dst + v * stride, in + v * c, c * sizeof(float));
+      break;
+
+    case PACK_HALF:
+      toHalf(buffer.halves, in, n);
+      for(size_t v = 0; v < count; v++) {
+        uint16_t *h = (uint16_t *) (dst + v * stride);
+        memcpy(h, buffer.halves + v * c, c * sizeof(uint16_t));
+        if(c & 1)
+          h[c] = 0;
+      }
+      break;
+
+    case PACK_UNORM8:
+    case PACK_SNORM8:
+    case PACK_UINT8:
+      if(a.format == PACK_UNORM8)
+        toFixed(buffer.fixed, in, n, 0, 1, 255);
+      else if(a.format == PACK_SNORM8)
+        toFixed(buffer.fixed, in, n, -1, 1, 127);
+      else
+        toFixed(buffer.fixed, in, n, 0, 255, 1);
+      for(size_t v = 0; v < count; v++) {
+        uint8_t *b = dst + v * stride;
+        int k = 0;
+        for(; k < c; k++)
+          b[k] = (uint8_t) buffer.fixed[v * c + k];
+        for(; k & 3; k++)
+          b[k] = 0;
+      }
+      break;
+
+    case PACK_UNORM16:
+    case PACK_SNORM16:
+    case PACK_UINT16:
+      if(a.format == PACK_UNORM16)
+        toFixed(buffer.fixed, in, n, 0, 1, 65535);
+      else if(a.format == PACK_SNORM16)
+        toFixed(buffer.fixed, in, n, -1, 1, 32767);
+      else
+        toFixed(buffer.fixed, in, n, 0, 65535, 1);
+      for(size_t v = 0; v < count; v++) {
+        uint16_t s[4] = { 0, 0, 0, 0 };
+        for(int k = 0; k < c; k++)
+          s[k] = (uint16_t) buffer.fixed[v * c + k];
+        memcpy(dst + v * stride, s, ((c + 1) & ~1) * sizeof(uint16_t));
+      }
+      break;
+
+    case PACK_SNORM10:
+      for(size_t v = 0; v < count; v++) {
+        const float *x = in + v * c;
+        uint32_t packed = pack2101010(x[0], c > 1 ? x[1] : 0, c > 2 ? x[2] : 0, c > 3 ? (x[3] < 0 ? -1 : 1) : 0);
+        memcpy(dst + v * stride, &packed, sizeof(packed));
+      }
+      break;
+
+    case PACK_OCTAHEDRAL:
+      for(size_t v = 0; v < count; v++) {
+        const float *x = in + v * c;
+        float e[2];
+        octahedral(x, e);
+        uint32_t packed = pack2101010(e[0], e[1], 0, c > 3 ? (x[3] < 0 ? -1 : 1) : 0);
+        memcpy(dst + v * stride, &packed, sizeof(packed));
+      }
+      break;
+
+    default:
+      break;
+  }
+}
+
+// bytes an attribute takes in the vertex, padded to 4
+static size_t packedBytes(PackFormat format, int components) {
+  switch(format) {
+    case PACK_FLOAT: return components * 4;
+    case PACK_HALF: case PACK_UNORM16: case PACK_SNORM16: case PACK_UINT16: return (components + 1) / 2 * 4;
+    case PACK_UNORM8: case PACK_SNORM8: case PACK_UINT8: return 4;
+    default: return 4;
+  }
+}
+
+NAN_METHOD(PackVertices) {
+  size_t outLength = 0;
+  uint8_t *out = marshal::ArrayData<uint8_t>(info[0], &outLength);
+  size_t vertexCount = marshal::Arg<GLuint>::Unbox(info[1]);
+  size_t stride = marshal::Arg<GLuint>::Unbox(info[2]);
+  size_t descLength = 0;
+  const int32_t *desc = marshal::ArrayData<int32_t>(info[3], &descLength);
+  int threads = info[5]->IsUndefined() ? 1 : Nan::To<int>(info[5]).FromJust();
+  if(!out || !info[3]->IsInt32Array() || !info[4]->IsArray()) {
+    Nan::ThrowTypeError("Expected packVertices(ArrayBufferView out, number vertexCount, number stride, Int32Array attributes, Array inputs)");
+    return;
+  }
+  if(vertexCount && outLength < vertexCount * stride) {
+    Nan::ThrowRangeError("packVertices: out is smaller than vertexCount * stride");
+    return;
+  }
+
+  Local<Array> inputs = info[4].As<Array>();
+  size_t attributeCount = descLength / sizeof(int32_t) / 3;
+  vector<PackAttribute> attributes(attributeCount);
+  for(size_t i = 0; i < attributeCount; i++) {
+    PackAttribute &a = attributes[i];
+    int format = desc[i * 3];
+    a.format = (PackFormat) (format >= 0 && format < PACK_FORMAT_COUNT ? format : PACK_FORMAT_COUNT);
+    a.components = desc[i * 3 + 1];
+    a.offset = (size_t) desc[i * 3 + 2];
+    Local<Value> input = Nan::Get(inputs, (uint32_t) i).ToLocalChecked();
+    size_t inputLength = 0;
+    a.data = marshal::ArrayData<float>(input, &inputLength);
+    // 10-10-10-2 formats pack 3 component vectors (and a w sign)
+    int minComponents = a.format == PACK_SNORM10 || a.format == PACK_OCTAHEDRAL ? 3 : 1;
+    if(a.format == PACK_FORMAT_COUNT || a.components < minComponents || a.components > 4 ||
+       a.offset + packedBytes(a.format, a.components) > stride) {
+      Nan::ThrowRangeError("packVertices: bad attribute format, size or offset");
+      return;
+    }
+    if(!input->IsFloat32Array() || inputLength / sizeof(float) < vertexCount * a.components) {
+      Nan::ThrowRangeError("packVertices: expected a Float32Array with size floats per vertex for every attribute");
+      return;
+    }
+  }
+
+  int blocks = (int) ((vertexCount + PACK_BLOCK - 1) / PACK_BLOCK);
+  auto pack = [&](int block) {
+    size_t begin = (size_t) block * PACK_BLOCK, end = min(vertexCount, begin + PACK_BLOCK);
+    for(size_t i = 0; i < attributeCount; i++)
+      packBlock(out, stride, attributes[i], begin, end);
+  };
+  if(threads == 1 || blocks <= 1) {
+    for(int block = 0; block < blocks; block++)
+      pack(block);
+  } else {
+    PooledParallelFor(blocks, threads, pack);
+  }
+}
+
+} // end namespace webgl
@@ -0,0 +1,40 @@
+/*
+ * vertex_packing.h
+ *
+ * Converts per attribute (SoA) Float32Arrays into one interleaved array of
+ * compact GPU formats: half floats for positions and texcoords, octahedral
+ * or plain signed 10-bit normals and tangents in INT_2_10_10_10_REV,
+ * normalized 8 and 16-bit colors and weights, 8 and 16-bit integers for
+ * joint indices. Each attribute is padded to 4 bytes. lib/webgl.js lays the
+ * attributes out and builds the matching gl.createVertexLayout description.
+ */
+
+#ifndef VERTEX_PACKING_H_
+#define VERTEX_PACKING_H_
+
+#include "common.h"
+
+namespace webgl {
+
+// must match packFormats in lib/webgl.js
+enum PackFormat {
+  PACK_FLOAT,
+  PACK_HALF,
+  PACK_UNORM8,
+  PACK_SNORM8,
+  PACK_UNORM16,
+  PACK_SNORM16,
+  PACK_UINT8,
+  PACK_UINT16,
+  // x, y, z and the sign of w as INT_2_10_10_10_REV
+  PACK_SNORM10,
+  // the octahedral encoding of x, y, z in x and y, the sign of w in w
+  PACK_OCTAHEDRAL,
+  PACK_FORMAT_COUNT
+};
+
+NAN_METHOD(PackVertices);
+
+}
+
+#endif /* VERTEX_PACKING_H_ */
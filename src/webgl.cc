@@ -5,6 +5,10 @@
 
 #include "webgl.h"
 #include "image.h"
+#include "marshal.h"
+#include "gl_objects.h"
+#include "texture_residency.h"
+#include "render_state.h"
 #include <node.h>
 #include <node_buffer.h>
 #include <GL/glew.h>
@@ -23,19 +27,6 @@ using namespace v8;
 using namespace std;
 
 // forward declarations
-enum GLObjectType {
-  GLOBJECT_TYPE_BUFFER,
-  GLOBJECT_TYPE_FRAMEBUFFER,
-  GLOBJECT_TYPE_PROGRAM,
-  GLOBJECT_TYPE_RENDERBUFFER,
-  GLOBJECT_TYPE_SHADER,
-  GLOBJECT_TYPE_TEXTURE,
-  GLOBJECT_TYPE_SAMPLER,
-  GLOBJECT_TYPE_TRANSFORM_FEEDBACK,
-};
-
-void registerGLObj(GLObjectType type, GLuint obj);
-void unregisterGLObj(GLuint obj);
 int registerSync(GLsync);
 void unregisterSync(int syncId);
 GLsync getSync(int syncId);
@@ -61,7 +52,7 @@ inline Type* getArrayData(Local<Value> arg, int* num = NULL) {
     else if(arg->IsObject()) {
       Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(arg);
       if(num) *num=arr->ByteLength()/sizeof(Type);
-      data = reinterpret_cast<Type*>((uint8_t*)arr->Buffer()->GetBackingStore()->Data() + arr->ByteOffset());
+      data = reinterpret_cast<Type*>((uint8_t*)arr->Buffer()->Data() + arr->ByteOffset());
     }
     else
       Nan::ThrowError("Bad array argument");
@@ -90,8 +81,22 @@ inline void* getImageData(Local<Value> arg, int& byteSize) {
   return pixels;
 }
 
+// Level 0 of a non immutable texture was (re)specified: that sets the size
+// estimate, until glGenerateMipmap adds the chain. Cube faces are specified
+// one at a time, so each counts for a sixth.
+static void setTextureLevelBytes(GLenum target, size_t bytes) {
+  if(target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)
+    bytes *= 6;
+  setGLObjBytes(GLOBJECT_TYPE_TEXTURE, boundTexture(target), bytes);
+}
+
+static GLenum textureTarget(GLuint texture) {
+  GLint target = GL_TEXTURE_2D;
+  glGetTextureParameteriv(texture, GL_TEXTURE_TARGET, &target);
+  return target;
+}
+
 NAN_METHOD(Init) {
-  Nan::HandleScope scope;
   GLenum err = glewInit();
   if (GLEW_OK != err)
   {
@@ -108,148 +113,21 @@ NAN_METHOD(Init) {
   
 }
 
-NAN_METHOD(Uniform1f) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  float x = (float) Nan::To<double>(info[1]).FromJust();
-
-  glUniform1f(location, x);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Uniform2f) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  float x = (float) Nan::To<double>(info[1]).FromJust();
-  float y = (float) Nan::To<double>(info[2]).FromJust();
-
-  glUniform2f(location, x, y);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Uniform3f) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  float x = (float) Nan::To<double>(info[1]).FromJust();
-  float y = (float) Nan::To<double>(info[2]).FromJust();
-  float z = (float) Nan::To<double>(info[3]).FromJust();
-
-  glUniform3f(location, x, y, z);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Uniform4f) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  float x = (float) Nan::To<double>(info[1]).FromJust();
-  float y = (float) Nan::To<double>(info[2]).FromJust();
-  float z = (float) Nan::To<double>(info[3]).FromJust();
-  float w = (float) Nan::To<double>(info[4]).FromJust();
-
-  glUniform4f(location, x, y, z, w);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Uniform1i) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  int x = Nan::To<int>(info[1]).FromJust();
-
-  glUniform1i(location, x);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Uniform1ui) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  uint x = Nan::To<uint>(info[1]).FromJust();
-
-  glUniform1ui(location, x);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Uniform2i) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  int x = Nan::To<int>(info[1]).FromJust();
-  int y = Nan::To<int>(info[2]).FromJust();
-
-  glUniform2i(location, x, y);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Uniform2ui) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  uint x = Nan::To<uint>(info[1]).FromJust();
-  uint y = Nan::To<uint>(info[2]).FromJust();
-
-  glUniform2ui(location, x, y);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Uniform3i) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  int x = Nan::To<int>(info[1]).FromJust();
-  int y = Nan::To<int>(info[2]).FromJust();
-  int z = Nan::To<int>(info[3]).FromJust();
-
-  glUniform3i(location, x, y, z);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Uniform3ui) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  uint x = Nan::To<uint>(info[1]).FromJust();
-  uint y = Nan::To<uint>(info[2]).FromJust();
-  uint z = Nan::To<uint>(info[3]).FromJust();
-
-  glUniform3ui(location, x, y, z);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Uniform4i) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  int x = Nan::To<int>(info[1]).FromJust();
-  int y = Nan::To<int>(info[2]).FromJust();
-  int z = Nan::To<int>(info[3]).FromJust();
-  int w = Nan::To<int>(info[4]).FromJust();
-
-  glUniform4i(location, x, y, z, w);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Uniform4ui) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
-  uint x = Nan::To<uint>(info[1]).FromJust();
-  uint y = Nan::To<uint>(info[2]).FromJust();
-  uint z = Nan::To<uint>(info[3]).FromJust();
-  uint w = Nan::To<uint>(info[4]).FromJust();
-
-  glUniform4ui(location, x, y, z, w);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(Uniform1f, glUniform1f, GLint, GLfloat)
+GL_BINDING(Uniform2f, glUniform2f, GLint, GLfloat, GLfloat)
+GL_BINDING(Uniform3f, glUniform3f, GLint, GLfloat, GLfloat, GLfloat)
+GL_BINDING(Uniform4f, glUniform4f, GLint, GLfloat, GLfloat, GLfloat, GLfloat)
+GL_BINDING(Uniform1i, glUniform1i, GLint, GLint)
+GL_BINDING(Uniform1ui, glUniform1ui, GLint, GLuint)
+GL_BINDING(Uniform2i, glUniform2i, GLint, GLint, GLint)
+GL_BINDING(Uniform2ui, glUniform2ui, GLint, GLuint, GLuint)
+GL_BINDING(Uniform3i, glUniform3i, GLint, GLint, GLint, GLint)
+GL_BINDING(Uniform3ui, glUniform3ui, GLint, GLuint, GLuint, GLuint)
+GL_BINDING(Uniform4i, glUniform4i, GLint, GLint, GLint, GLint, GLint)
+GL_BINDING(Uniform4ui, glUniform4ui, GLint, GLuint, GLuint, GLuint, GLuint)
 
 NAN_METHOD(Uniform1fv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLfloat *ptr=getArrayData<GLfloat>(info[1],&num);
   glUniform1fv(location, num, ptr);
@@ -257,9 +135,7 @@ NAN_METHOD(Uniform1fv) {
 }
 
 NAN_METHOD(Uniform2fv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLfloat *ptr=getArrayData<GLfloat>(info[1],&num);
   num /= 2;
@@ -269,9 +145,7 @@ NAN_METHOD(Uniform2fv) {
 }
 
 NAN_METHOD(Uniform3fv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLfloat *ptr=getArrayData<GLfloat>(info[1],&num);
   num /= 3;
@@ -281,9 +155,7 @@ NAN_METHOD(Uniform3fv) {
 }
 
 NAN_METHOD(Uniform4fv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLfloat *ptr=getArrayData<GLfloat>(info[1],&num);
   num /= 4;
@@ -293,9 +165,7 @@ NAN_METHOD(Uniform4fv) {
 }
 
 NAN_METHOD(Uniform1iv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLint *ptr=getArrayData<GLint>(info[1],&num);
 
@@ -304,9 +174,7 @@ NAN_METHOD(Uniform1iv) {
 }
 
 NAN_METHOD(Uniform2iv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLint *ptr=getArrayData<GLint>(info[1],&num);
   num /= 2;
@@ -316,9 +184,7 @@ NAN_METHOD(Uniform2iv) {
 }
 
 NAN_METHOD(Uniform3iv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLint *ptr=getArrayData<GLint>(info[1],&num);
   num /= 3;
@@ -327,9 +193,7 @@ NAN_METHOD(Uniform3iv) {
 }
 
 NAN_METHOD(Uniform4iv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLint *ptr=getArrayData<GLint>(info[1],&num);
   num /= 4;
@@ -339,9 +203,7 @@ NAN_METHOD(Uniform4iv) {
 
 
 NAN_METHOD(Uniform1uiv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLuint *ptr=getArrayData<GLuint>(info[1],&num);
 
@@ -350,9 +212,7 @@ NAN_METHOD(Uniform1uiv) {
 }
 
 NAN_METHOD(Uniform2uiv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLuint *ptr=getArrayData<GLuint>(info[1],&num);
   num /= 2;
@@ -362,9 +222,7 @@ NAN_METHOD(Uniform2uiv) {
 }
 
 NAN_METHOD(Uniform3uiv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLuint *ptr=getArrayData<GLuint>(info[1],&num);
   num /= 3;
@@ -373,9 +231,7 @@ NAN_METHOD(Uniform3uiv) {
 }
 
 NAN_METHOD(Uniform4uiv) {
-  Nan::HandleScope scope;
-
-  int location = Nan::To<int>(info[0]).FromJust();
+  int location = marshal::Arg<GLint>::Unbox(info[0]);
   int num=0;
   GLuint *ptr=getArrayData<GLuint>(info[1],&num);
   num /= 4;
@@ -384,10 +240,8 @@ NAN_METHOD(Uniform4uiv) {
 }
 
 NAN_METHOD(PixelStorei) {
-  Nan::HandleScope scope;
-
-  int pname = Nan::To<int>(info[0]).FromJust();
-  int param = Nan::To<int>(info[1]).FromJust();
+  int pname = marshal::Arg<GLint>::Unbox(info[0]);
+  int param = marshal::Arg<GLint>::Unbox(info[1]);
 
   glPixelStorei(pname,param);
 
@@ -395,10 +249,8 @@ NAN_METHOD(PixelStorei) {
 }
 
 NAN_METHOD(BindAttribLocation) {
-  Nan::HandleScope scope;
-
-  int program = Nan::To<int>(info[0]).FromJust();
-  int index = Nan::To<int>(info[1]).FromJust();
+  int program = marshal::Arg<GLint>::Unbox(info[0]);
+  int index = marshal::Arg<GLint>::Unbox(info[1]);
   Nan::Utf8String name(info[2]);
 
   glBindAttribLocation(program, index, *name);
@@ -407,30 +259,12 @@ NAN_METHOD(BindAttribLocation) {
 }
 
 
-NAN_METHOD(GetError) {
-  Nan::HandleScope scope;
-
-  info.GetReturnValue().Set(Nan::New<Integer>(glGetError()));
-}
-
-
-NAN_METHOD(DrawArrays) {
-  Nan::HandleScope scope;
-
-  int mode = Nan::To<int>(info[0]).FromJust();
-  int first = Nan::To<int>(info[1]).FromJust();
-  int count = Nan::To<int>(info[2]).FromJust();
-
-  glDrawArrays(mode, first, count);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(GetError, glGetError)
+GL_BINDING(DrawArrays, glDrawArrays, GLenum, GLint, GLsizei)
 
 NAN_METHOD(UniformMatrix2fv) {
-  Nan::HandleScope scope;
-
-  GLint location = Nan::To<int>(info[0]).FromJust();
-  GLboolean transpose = Nan::To<bool>(info[1]).FromJust();
+  GLint location = marshal::Arg<GLint>::Unbox(info[0]);
+  GLboolean transpose = marshal::Arg<GLboolean>::Unbox(info[1]);
 
   GLsizei count=0;
   GLfloat* data=getArrayData<GLfloat>(info[2],&count);
@@ -445,10 +279,8 @@ NAN_METHOD(UniformMatrix2fv) {
 }
 
 NAN_METHOD(UniformMatrix3fv) {
-  Nan::HandleScope scope;
-
-  GLint location = Nan::To<int>(info[0]).FromJust();
-  GLboolean transpose = Nan::To<bool>(info[1]).FromJust();
+  GLint location = marshal::Arg<GLint>::Unbox(info[0]);
+  GLboolean transpose = marshal::Arg<GLboolean>::Unbox(info[1]);
   GLsizei count=0;
   GLfloat* data=getArrayData<GLfloat>(info[2],&count);
 
@@ -461,10 +293,8 @@ NAN_METHOD(UniformMatrix3fv) {
 }
 
 NAN_METHOD(UniformMatrix4fv) {
-  Nan::HandleScope scope;
-
-  GLint location = Nan::To<int>(info[0]).FromJust();
-  GLboolean transpose = Nan::To<bool>(info[1]).FromJust();
+  GLint location = marshal::Arg<GLint>::Unbox(info[0]);
+  GLboolean transpose = marshal::Arg<GLboolean>::Unbox(info[1]);
   GLsizei count=0;
   GLfloat* data=getArrayData<GLfloat>(info[2],&count);
 
@@ -477,50 +307,41 @@ NAN_METHOD(UniformMatrix4fv) {
 }
 
 NAN_METHOD(GenerateMipmap) {
-  Nan::HandleScope scope;
-
-  GLint target = Nan::To<int>(info[0]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
   glGenerateMipmap(target);
 
-  info.GetReturnValue().Set(Nan::Undefined());
+  // the chain size follows from level 0
+  GLuint texture = boundTexture(target);
+  GLint width = 0, height = 0, depth = 0, internalFormat = 0;
+  glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_WIDTH, &width);
+  glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_HEIGHT, &height);
+  glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_DEPTH, &depth);
+  glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+  int size = width > height ? width : height;
+  if(target == GL_TEXTURE_3D && depth > size)
+    size = depth;
+  int levels = 1;
+  while(size > 1) {
+    size >>= 1;
+    levels++;
+  }
+  setGLObjBytes(GLOBJECT_TYPE_TEXTURE, texture,
+                TextureStorageBytes(target, internalFormat, width, height, depth, levels));
 }
 
 NAN_METHOD(GetAttribLocation) {
-  Nan::HandleScope scope;
-
-  int program = Nan::To<int>(info[0]).FromJust();
+  int program = marshal::Arg<GLint>::Unbox(info[0]);
   Nan::Utf8String name(info[1]);
 
   info.GetReturnValue().Set(Nan::New<Number>(glGetAttribLocation(program, *name)));
 }
 
 
-NAN_METHOD(DepthFunc) {
-  Nan::HandleScope scope;
-
-  glDepthFunc(Nan::To<int>(info[0]).FromJust());
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(Viewport) {
-  Nan::HandleScope scope;
-
-  int x = Nan::To<int>(info[0]).FromJust();
-  int y = Nan::To<int>(info[1]).FromJust();
-  int width = Nan::To<int>(info[2]).FromJust();
-  int height = Nan::To<int>(info[3]).FromJust();
-
-  glViewport(x, y, width, height);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_STATE_BINDING(DepthFunc, glDepthFunc, GLenum)
+GL_BINDING(Viewport, glViewport, GLint, GLint, GLsizei, GLsizei)
 
 NAN_METHOD(CreateShader) {
-  Nan::HandleScope scope;
-
-  GLuint shader=glCreateShader(Nan::To<int>(info[0]).FromJust());
+  GLuint shader=glCreateShader(marshal::Arg<GLenum>::Unbox(info[0]));
   #ifdef LOGGING
   cout<<"createShader "<<shader<<endl;
   #endif
@@ -530,9 +351,7 @@ NAN_METHOD(CreateShader) {
 
 
 NAN_METHOD(ShaderSource) {
-  Nan::HandleScope scope;
-
-  int id = Nan::To<int>(info[0]).FromJust();
+  int id = marshal::Arg<GLint>::Unbox(info[0]);
   Nan::Utf8String code(info[1]);
 
   const char* codes[1];
@@ -545,28 +364,13 @@ NAN_METHOD(ShaderSource) {
 }
 
 
-NAN_METHOD(CompileShader) {
-  Nan::HandleScope scope;
-
-  glCompileShader(Nan::To<int>(info[0]).FromJust());
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(FrontFace) {
-  Nan::HandleScope scope;
-
-  glFrontFace(Nan::To<int>(info[0]).FromJust());
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(CompileShader, glCompileShader, GLuint)
+GL_STATE_BINDING(FrontFace, glFrontFace, GLenum)
 
 
 NAN_METHOD(GetShaderParameter) {
-  Nan::HandleScope scope;
-
-  int shader = Nan::To<int>(info[0]).FromJust();
-  int pname = Nan::To<int>(info[1]).FromJust();
+  int shader = marshal::Arg<GLint>::Unbox(info[0]);
+  int pname = marshal::Arg<GLint>::Unbox(info[1]);
   int value = 0;
   switch (pname) {
   case GL_DELETE_STATUS:
@@ -590,9 +394,7 @@ NAN_METHOD(GetShaderParameter) {
 }
 
 NAN_METHOD(GetShaderInfoLog) {
-  Nan::HandleScope scope;
-
-  int id = Nan::To<int>(info[0]).FromJust();
+  int id = marshal::Arg<GLint>::Unbox(info[0]);
   int Len = 1024;
   char Error[1024];
   glGetShaderInfoLog(id, 1024, &Len, Error);
@@ -602,8 +404,6 @@ NAN_METHOD(GetShaderInfoLog) {
 
 
 NAN_METHOD(CreateProgram) {
-  Nan::HandleScope scope;
-
   GLuint program=glCreateProgram();
   #ifdef LOGGING
   cout<<"createProgram "<<program<<endl;
@@ -613,32 +413,13 @@ NAN_METHOD(CreateProgram) {
 }
 
 
-NAN_METHOD(AttachShader) {
-  Nan::HandleScope scope;
-
-  int program = Nan::To<int>(info[0]).FromJust();
-  int shader = Nan::To<int>(info[1]).FromJust();
-
-  glAttachShader(program, shader);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(LinkProgram) {
-  Nan::HandleScope scope;
-
-  glLinkProgram(Nan::To<int>(info[0]).FromJust());
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(AttachShader, glAttachShader, GLuint, GLuint)
+GL_BINDING(LinkProgram, glLinkProgram, GLuint)
 
 
 NAN_METHOD(GetProgramParameter) {
-  Nan::HandleScope scope;
-
-  int program = Nan::To<int>(info[0]).FromJust();
-  int pname = Nan::To<int>(info[1]).FromJust();
+  int program = marshal::Arg<GLint>::Unbox(info[0]);
+  int pname = marshal::Arg<GLint>::Unbox(info[1]);
 
   int value = 0;
   switch (pname) {
@@ -662,58 +443,21 @@ NAN_METHOD(GetProgramParameter) {
 
 
 NAN_METHOD(GetUniformLocation) {
-  Nan::HandleScope scope;
-
-  int program = Nan::To<int>(info[0]).FromJust();
+  int program = marshal::Arg<GLint>::Unbox(info[0]);
   Nan::Utf8String name(info[1]);
   
   info.GetReturnValue().Set(JS_INT(glGetUniformLocation(program, *name)));
 }
 
 
-NAN_METHOD(ClearColor) {
-  Nan::HandleScope scope;
-
-  float red = (float) Nan::To<double>(info[0]).FromJust();
-  float green = (float) Nan::To<double>(info[1]).FromJust();
-  float blue = (float) Nan::To<double>(info[2]).FromJust();
-  float alpha = (float) Nan::To<double>(info[3]).FromJust();
-
-  glClearColor(red, green, blue, alpha);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(ClearDepth) {
-  Nan::HandleScope scope;
-
-  float depth = (float) Nan::To<double>(info[0]).FromJust();
-
-  glClearDepth(depth);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Disable) {
-  Nan::HandleScope scope;
-
-  glDisable(Nan::To<int>(info[0]).FromJust());
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Enable) {
-  Nan::HandleScope scope;
-
-  glEnable(Nan::To<int>(info[0]).FromJust());
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(ClearColor, glClearColor, GLfloat, GLfloat, GLfloat, GLfloat)
+GL_BINDING(ClearDepth, glClearDepth, GLdouble)
+GL_STATE_BINDING(Disable, glDisable, GLenum)
+GL_STATE_BINDING(Enable, glEnable, GLenum)
 
 
 NAN_METHOD(CreateTexture) {
-  Nan::HandleScope scope;
-
-  int typeTarget = Nan::To<int>(info[0]).FromJust();
+  int typeTarget = marshal::Arg<GLint>::Unbox(info[0]);
 
 
   GLuint texture;
@@ -727,81 +471,41 @@ NAN_METHOD(CreateTexture) {
 
 
 NAN_METHOD(BindTexture) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int texture = info[1]->IsNull() ? 0 : Nan::To<int>(info[1]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLuint texture = marshal::Arg<GLuint>::Unbox(info[1]);
 
   glBindTexture(target, texture);
-  info.GetReturnValue().Set(Nan::Undefined());
+  if(residentTextureCount)
+    TouchResidentTexture(texture);
 }
 
 
 NAN_METHOD(TexImage2D) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int level = Nan::To<int>(info[1]).FromJust();
-  int internalformat = Nan::To<int>(info[2]).FromJust();
-  int width = Nan::To<int>(info[3]).FromJust();
-  int height = Nan::To<int>(info[4]).FromJust();
-  int border = Nan::To<int>(info[5]).FromJust();
-  int format = Nan::To<int>(info[6]).FromJust();
-  int type = Nan::To<int>(info[7]).FromJust();
+  int target = marshal::Arg<GLint>::Unbox(info[0]);
+  int level = marshal::Arg<GLint>::Unbox(info[1]);
+  int internalformat = marshal::Arg<GLint>::Unbox(info[2]);
+  int width = marshal::Arg<GLint>::Unbox(info[3]);
+  int height = marshal::Arg<GLint>::Unbox(info[4]);
+  int border = marshal::Arg<GLint>::Unbox(info[5]);
+  int format = marshal::Arg<GLint>::Unbox(info[6]);
+  int type = marshal::Arg<GLint>::Unbox(info[7]);
   int dataSize;
   void *pixels=getImageData(info[8], dataSize);
 
   glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+  if(level == 0)
+    setTextureLevelBytes(target, TextureStorageBytes(GL_TEXTURE_2D, internalformat, width, height, 1, 1));
 
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
 
-NAN_METHOD(TexParameteri) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int pname = Nan::To<int>(info[1]).FromJust();
-  int param = Nan::To<int>(info[2]).FromJust();
-
-  glTexParameteri(target, pname, param);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(TexParameterf) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int pname = Nan::To<int>(info[1]).FromJust();
-  float param = (float) Nan::To<double>(info[2]).FromJust();
-
-  glTexParameterf(target, pname, param);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(Clear) {
-  Nan::HandleScope scope;
-
-  glClear(Nan::To<int>(info[0]).FromJust());
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(UseProgram) {
-  Nan::HandleScope scope;
-
-  glUseProgram(Nan::To<int>(info[0]).FromJust());
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(TexParameteri, glTexParameteri, GLenum, GLenum, GLint)
+GL_BINDING(TexParameterf, glTexParameterf, GLenum, GLenum, GLfloat)
+GL_BINDING(Clear, glClear, GLbitfield)
+GL_BINDING(UseProgram, glUseProgram, GLuint)
 
 NAN_METHOD(CreateBuffer) {
-  Nan::HandleScope scope;
-
   GLuint buffer;
 
   //cout<<"createBuffer* "<<endl;
@@ -814,20 +518,10 @@ NAN_METHOD(CreateBuffer) {
   info.GetReturnValue().Set(Nan::New<Number>(buffer));
 }
 
-NAN_METHOD(BindBuffer) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int buffer = Nan::To<uint32_t>(info[1]).FromJust();
-  glBindBuffer(target,buffer);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(BindBuffer, glBindBuffer, GLenum, GLuint)
 
 
 NAN_METHOD(CreateFramebuffer) {
-  Nan::HandleScope scope;
-
   GLuint buffer;
   glCreateFramebuffers(1, &buffer);
   #ifdef LOGGING
@@ -838,39 +532,14 @@ NAN_METHOD(CreateFramebuffer) {
 }
 
 
-NAN_METHOD(BindFramebuffer) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int buffer = info[1]->IsNull() ? 0 : Nan::To<int>(info[1]).FromJust();
-
-  glBindFramebuffer(target, buffer);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(FramebufferTexture2D) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int attachment = Nan::To<int>(info[1]).FromJust();
-  int textarget = Nan::To<int>(info[2]).FromJust();
-  int texture = Nan::To<int>(info[3]).FromJust();
-  int level = Nan::To<int>(info[4]).FromJust();
-
-  glFramebufferTexture2D(target, attachment, textarget, texture, level);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(BindFramebuffer, glBindFramebuffer, GLenum, GLuint)
+GL_BINDING(FramebufferTexture2D, glFramebufferTexture2D, GLenum, GLenum, GLenum, GLuint, GLint)
 
 NAN_METHOD(BufferData) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
+  int target = marshal::Arg<GLint>::Unbox(info[0]);
   if(info[1]->IsObject()) {
     Local<Object> obj = Local<Object>::Cast(info[1]);
-    GLenum usage = Nan::To<int>(info[2]).FromJust();
+    GLenum usage = marshal::Arg<GLenum>::Unbox(info[2]);
     
     CHECK_ARRAY_BUFFER(obj);
     
@@ -878,38 +547,38 @@ NAN_METHOD(BufferData) {
             
     int element_size = 1;
     Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(obj);
-    int size = arr->ByteLength() * element_size;
-    void* data = (uint8_t*)arr->Buffer()->GetBackingStore()->Data() + arr->ByteOffset();
+    GLsizeiptr size = arr->ByteLength() * element_size;
+    void* data = (uint8_t*)arr->Buffer()->Data() + arr->ByteOffset();
     
     glBufferData(target, size, data, usage);
+    setGLObjBytes(GLOBJECT_TYPE_BUFFER, boundBuffer(target), size);
   }
   else if(info[1]->IsNumber()) {
-    GLsizeiptr size = Nan::To<uint32_t>(info[1]).FromJust();
-    GLenum usage = Nan::To<int>(info[2]).FromJust();
+    GLsizeiptr size = marshal::Arg<GLsizeiptr>::Unbox(info[1]);
+    GLenum usage = marshal::Arg<GLenum>::Unbox(info[2]);
     glBufferData(target, size, NULL, usage);
+    setGLObjBytes(GLOBJECT_TYPE_BUFFER, boundBuffer(target), size);
   }
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
 
 NAN_METHOD(BufferSubData) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int offset = Nan::To<int>(info[1]).FromJust();
+  int target = marshal::Arg<GLint>::Unbox(info[0]);
+  GLintptr offset = marshal::Arg<GLintptr>::Unbox(info[1]);
   Local<Object> obj = Local<Object>::Cast(info[2]);
-  int srcOffsetBytes = Nan::To<int>(info[3]).FromJust();
-  int lengthBytes = Nan::To<int>(info[4]).FromJust();
+  int srcOffsetBytes = marshal::Arg<GLint>::Unbox(info[3]);
+  int lengthBytes = marshal::Arg<GLint>::Unbox(info[4]);
  // cout<<"offset:"<<offset<<endl;
  // cout<<"srcOffsetBytes:"<<srcOffsetBytes<<endl;
   //cout<<"lengthBytes:"<<lengthBytes<<endl;
 
   int element_size = 1;
   Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(obj);
-  int size = lengthBytes==0?(arr->ByteLength() * element_size):lengthBytes;
+  GLsizeiptr size = lengthBytes==0?(arr->ByteLength() * element_size):lengthBytes;
   //cout<<"size:"<<size<<endl;
   //cout<<"bytelength:"<<arr->ByteLength()<<endl;
-  void* data = (uint8_t*)arr->Buffer()->GetBackingStore()->Data() + arr->ByteOffset() + srcOffsetBytes;
+  void* data = (uint8_t*)arr->Buffer()->Data() + arr->ByteOffset() + srcOffsetBytes;
 
   glBufferSubData(target, offset, size, data);
 
@@ -917,436 +586,49 @@ NAN_METHOD(BufferSubData) {
 }
 
 
-NAN_METHOD(BlendEquation) {
-  Nan::HandleScope scope;
-
-  int mode=Nan::To<int>(info[0]).FromJust();;
-
-  glBlendEquation(mode);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(BlendFunc) {
-  Nan::HandleScope scope;
-
-  int sfactor=Nan::To<int>(info[0]).FromJust();;
-  int dfactor=Nan::To<int>(info[1]).FromJust();;
-
-  glBlendFunc(sfactor,dfactor);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(EnableVertexAttribArray) {
-  Nan::HandleScope scope;
-
-  glEnableVertexAttribArray(Nan::To<int>(info[0]).FromJust());
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(VertexAttribPointer) {
-  Nan::HandleScope scope;
-
-  int indx = Nan::To<int>(info[0]).FromJust();
-  int size = Nan::To<int>(info[1]).FromJust();
-  int type = Nan::To<int>(info[2]).FromJust();
-  int normalized = Nan::To<bool>(info[3]).FromJust();
-  int stride = Nan::To<int>(info[4]).FromJust();
-  long offset = Nan::To<int>(info[5]).FromJust();
-
-  //    printf("VertexAttribPointer %d %d %d %d %d %d\n", indx, size, type, normalized, stride, offset);
-  glVertexAttribPointer(indx, size, type, normalized, stride, (const GLvoid *)offset);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(ActiveTexture) {
-  Nan::HandleScope scope;
-
-  glActiveTexture(Nan::To<int>(info[0]).FromJust());
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(DrawElements) {
-  Nan::HandleScope scope;
-
-  int mode = Nan::To<int>(info[0]).FromJust();
-  int count = Nan::To<int>(info[1]).FromJust();
-  int type = Nan::To<int>(info[2]).FromJust();
-  GLvoid *offset = reinterpret_cast<GLvoid*>(Nan::To<uint32_t>(info[3]).FromJust());
-  glDrawElements(mode, count, type, offset);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-
-NAN_METHOD(Flush) {
-  Nan::HandleScope scope;
-  glFlush();
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Finish) {
-  Nan::HandleScope scope;
-  glFinish();
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(VertexAttrib1f) {
-  Nan::HandleScope scope;
-
-  GLuint indx = Nan::To<int>(info[0]).FromJust();
-  float x = (float) Nan::To<double>(info[1]).FromJust();
-
-  glVertexAttrib1f(indx, x);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(VertexAttrib2f) {
-  Nan::HandleScope scope;
-
-  GLuint indx = Nan::To<int>(info[0]).FromJust();
-  float x = (float) Nan::To<double>(info[1]).FromJust();
-  float y = (float) Nan::To<double>(info[2]).FromJust();
-
-  glVertexAttrib2f(indx, x, y);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(VertexAttrib3f) {
-  Nan::HandleScope scope;
-
-  GLuint indx = Nan::To<int>(info[0]).FromJust();
-  float x = (float) Nan::To<double>(info[1]).FromJust();
-  float y = (float) Nan::To<double>(info[2]).FromJust();
-  float z = (float) Nan::To<double>(info[3]).FromJust();
-
-  glVertexAttrib3f(indx, x, y, z);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(VertexAttrib4f) {
-  Nan::HandleScope scope;
-
-  GLuint indx = Nan::To<int>(info[0]).FromJust();
-  float x = (float) Nan::To<double>(info[1]).FromJust();
-  float y = (float) Nan::To<double>(info[2]).FromJust();
-  float z = (float) Nan::To<double>(info[3]).FromJust();
-  float w = (float) Nan::To<double>(info[4]).FromJust();
-
-  glVertexAttrib4f(indx, x, y, z, w);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(VertexAttrib1fv) {
-  Nan::HandleScope scope;
-
-  int indx = Nan::To<int>(info[0]).FromJust();
-  GLfloat *data = getArrayData<GLfloat>(info[1]);
-  glVertexAttrib1fv(indx, data);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(VertexAttrib2fv) {
-  Nan::HandleScope scope;
-
-  int indx = Nan::To<int>(info[0]).FromJust();
-  GLfloat *data = getArrayData<GLfloat>(info[1]);
-  glVertexAttrib2fv(indx, data);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(VertexAttrib3fv) {
-  Nan::HandleScope scope;
-
-  int indx = Nan::To<int>(info[0]).FromJust();
-  GLfloat *data = getArrayData<GLfloat>(info[1]);
-  glVertexAttrib3fv(indx, data);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(VertexAttrib4fv) {
-  Nan::HandleScope scope;
-
-  int indx = Nan::To<int>(info[0]).FromJust();
-  GLfloat *data = getArrayData<GLfloat>(info[1]);
-  glVertexAttrib4fv(indx, data);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(BlendColor) {
-  Nan::HandleScope scope;
-
-  GLclampf r= (float) Nan::To<double>(info[0]).FromJust();
-  GLclampf g= (float) Nan::To<double>(info[1]).FromJust();
-  GLclampf b= (float) Nan::To<double>(info[2]).FromJust();
-  GLclampf a= (float) Nan::To<double>(info[3]).FromJust();
-
-  glBlendColor(r,g,b,a);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(BlendEquationSeparate) {
-  Nan::HandleScope scope;
-
-  GLenum modeRGB= Nan::To<int>(info[0]).FromJust();
-  GLenum modeAlpha= Nan::To<int>(info[1]).FromJust();
-
-  glBlendEquationSeparate(modeRGB,modeAlpha);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(BlendFuncSeparate) {
-  Nan::HandleScope scope;
-
-  GLenum srcRGB= Nan::To<int>(info[0]).FromJust();
-  GLenum dstRGB= Nan::To<int>(info[1]).FromJust();
-  GLenum srcAlpha= Nan::To<int>(info[2]).FromJust();
-  GLenum dstAlpha= Nan::To<int>(info[3]).FromJust();
-
-  glBlendFuncSeparate(srcRGB,dstRGB,srcAlpha,dstAlpha);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(ClearStencil) {
-  Nan::HandleScope scope;
-
-  GLint s = Nan::To<int>(info[0]).FromJust();
-
-  glClearStencil(s);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(ColorMask) {
-  Nan::HandleScope scope;
-
-  GLboolean r = Nan::To<bool>(info[0]).FromJust();
-  GLboolean g = Nan::To<bool>(info[1]).FromJust();
-  GLboolean b = Nan::To<bool>(info[2]).FromJust();
-  GLboolean a = Nan::To<bool>(info[3]).FromJust();
-
-  glColorMask(r,g,b,a);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(CopyTexImage2D) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLint level = Nan::To<int>(info[1]).FromJust();
-  GLenum internalformat = Nan::To<int>(info[2]).FromJust();
-  GLint x = Nan::To<int>(info[3]).FromJust();
-  GLint y = Nan::To<int>(info[4]).FromJust();
-  GLsizei width = Nan::To<int>(info[5]).FromJust();
-  GLsizei height = Nan::To<int>(info[6]).FromJust();
-  GLint border = Nan::To<int>(info[7]).FromJust();
-
-  glCopyTexImage2D( target, level, internalformat, x, y, width, height, border);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(CopyTexSubImage2D) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLint level = Nan::To<int>(info[1]).FromJust();
-  GLint xoffset = Nan::To<int>(info[2]).FromJust();
-  GLint yoffset = Nan::To<int>(info[3]).FromJust();
-  GLint x = Nan::To<int>(info[4]).FromJust();
-  GLint y = Nan::To<int>(info[5]).FromJust();
-  GLsizei width = Nan::To<int>(info[6]).FromJust();
-  GLsizei height = Nan::To<int>(info[7]).FromJust();
-
-  glCopyTexSubImage2D( target, level, xoffset, yoffset, x, y, width, height);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(CullFace) {
-  Nan::HandleScope scope;
-
-  GLenum mode = Nan::To<int>(info[0]).FromJust();
-
-  glCullFace(mode);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(DepthMask) {
-  Nan::HandleScope scope;
-
-  GLboolean flag = Nan::To<bool>(info[0]).FromJust();
-
-  glDepthMask(flag);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(DepthRange) {
-  Nan::HandleScope scope;
-
-  GLclampf zNear = (float) Nan::To<double>(info[0]).FromJust();
-  GLclampf zFar = (float) Nan::To<double>(info[1]).FromJust();
-
-  glDepthRangef(zNear, zFar);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(DisableVertexAttribArray) {
-  Nan::HandleScope scope;
-
-  GLuint index = Nan::To<int>(info[0]).FromJust();
-
-  glDisableVertexAttribArray(index);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Hint) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLenum mode = Nan::To<int>(info[1]).FromJust();
-
-  glHint(target, mode);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(IsEnabled) {
-  Nan::HandleScope scope;
-
-  GLenum cap = Nan::To<int>(info[0]).FromJust();
-
-  bool ret=glIsEnabled(cap)!=0;
-  info.GetReturnValue().Set(Nan::New<Boolean>(ret));
-}
-
-NAN_METHOD(LineWidth) {
-  Nan::HandleScope scope;
-
-  GLfloat width = (float) Nan::To<double>(info[0]).FromJust();
-
-  glLineWidth(width);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(PolygonOffset) {
-  Nan::HandleScope scope;
-
-  GLfloat factor = (float) Nan::To<double>(info[0]).FromJust();
-  GLfloat units = (float) Nan::To<double>(info[1]).FromJust();
-
-  glPolygonOffset(factor, units);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(SampleCoverage) {
-  Nan::HandleScope scope;
-
-  GLclampf value = (float) Nan::To<double>(info[0]).FromJust();
-  GLboolean invert = Nan::To<bool>(info[1]).FromJust();
-
-  glSampleCoverage(value, invert);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(Scissor) {
-  Nan::HandleScope scope;
-
-  GLint x = Nan::To<int>(info[0]).FromJust();
-  GLint y = Nan::To<int>(info[1]).FromJust();
-  GLsizei width = Nan::To<int>(info[2]).FromJust();
-  GLsizei height = Nan::To<int>(info[3]).FromJust();
-
-  glScissor(x, y, width, height);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(StencilFunc) {
-  Nan::HandleScope scope;
-
-  GLenum func = Nan::To<int>(info[0]).FromJust();
-  GLint ref = Nan::To<int>(info[1]).FromJust();
-  GLuint mask = Nan::To<int>(info[2]).FromJust();
-
-  glStencilFunc(func, ref, mask);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(StencilFuncSeparate) {
-  Nan::HandleScope scope;
-
-  GLenum face = Nan::To<int>(info[0]).FromJust();
-  GLenum func = Nan::To<int>(info[1]).FromJust();
-  GLint ref = Nan::To<int>(info[2]).FromJust();
-  GLuint mask = Nan::To<int>(info[3]).FromJust();
-
-  glStencilFuncSeparate(face, func, ref, mask);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(StencilMask) {
-  Nan::HandleScope scope;
-
-  GLuint mask = Nan::To<uint32_t>(info[0]).FromJust();
-
-  glStencilMask(mask);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(StencilMaskSeparate) {
-  Nan::HandleScope scope;
-
-  GLenum face = Nan::To<int>(info[0]).FromJust();
-  GLuint mask = Nan::To<uint32_t>(info[1]).FromJust();
-
-  glStencilMaskSeparate(face, mask);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(StencilOp) {
-  Nan::HandleScope scope;
-
-  GLenum fail = Nan::To<int>(info[0]).FromJust();
-  GLenum zfail = Nan::To<int>(info[1]).FromJust();
-  GLenum zpass = Nan::To<int>(info[2]).FromJust();
-
-  glStencilOp(fail, zfail, zpass);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(StencilOpSeparate) {
-  Nan::HandleScope scope;
-
-  GLenum face = Nan::To<int>(info[0]).FromJust();
-  GLenum fail = Nan::To<int>(info[1]).FromJust();
-  GLenum zfail = Nan::To<int>(info[2]).FromJust();
-  GLenum zpass = Nan::To<int>(info[3]).FromJust();
-
-  glStencilOpSeparate(face, fail, zfail, zpass);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(BindRenderbuffer) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLuint buffer = info[1]->IsNull() ? 0 : Nan::To<int>(info[1]).FromJust();
-
-  glBindRenderbuffer(target, buffer);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(CreateRenderbuffer) {
-  Nan::HandleScope scope;
+GL_STATE_BINDING(BlendEquation, glBlendEquation, GLenum)
+GL_STATE_BINDING(BlendFunc, glBlendFunc, GLenum, GLenum)
+GL_BINDING(EnableVertexAttribArray, glEnableVertexAttribArray, GLuint)
+GL_BINDING(VertexAttribPointer, glVertexAttribPointer, GLuint, GLint, GLenum, GLboolean, GLsizei, marshal::Offset)
+GL_BINDING(ActiveTexture, glActiveTexture, GLenum)
+GL_BINDING(DrawElements, glDrawElements, GLenum, GLsizei, GLenum, marshal::Offset)
+GL_BINDING(DrawElementsBaseVertex, glDrawElementsBaseVertex, GLenum, GLsizei, GLenum, marshal::Offset, GLint)
+GL_BINDING(Flush, glFlush)
+GL_BINDING(Finish, glFinish)
+GL_BINDING(VertexAttrib1f, glVertexAttrib1f, GLuint, GLfloat)
+GL_BINDING(VertexAttrib2f, glVertexAttrib2f, GLuint, GLfloat, GLfloat)
+GL_BINDING(VertexAttrib3f, glVertexAttrib3f, GLuint, GLfloat, GLfloat, GLfloat)
+GL_BINDING(VertexAttrib4f, glVertexAttrib4f, GLuint, GLfloat, GLfloat, GLfloat, GLfloat)
+GL_BINDING(VertexAttrib1fv, glVertexAttrib1fv, GLuint, marshal::Array<const GLfloat>)
+GL_BINDING(VertexAttrib2fv, glVertexAttrib2fv, GLuint, marshal::Array<const GLfloat>)
+GL_BINDING(VertexAttrib3fv, glVertexAttrib3fv, GLuint, marshal::Array<const GLfloat>)
+GL_BINDING(VertexAttrib4fv, glVertexAttrib4fv, GLuint, marshal::Array<const GLfloat>)
+GL_STATE_BINDING(BlendColor, glBlendColor, GLfloat, GLfloat, GLfloat, GLfloat)
+GL_STATE_BINDING(BlendEquationSeparate, glBlendEquationSeparate, GLenum, GLenum)
+GL_STATE_BINDING(BlendFuncSeparate, glBlendFuncSeparate, GLenum, GLenum, GLenum, GLenum)
+GL_BINDING(ClearStencil, glClearStencil, GLint)
+GL_STATE_BINDING(ColorMask, glColorMask, GLboolean, GLboolean, GLboolean, GLboolean)
+GL_BINDING(CopyTexImage2D, glCopyTexImage2D, GLenum, GLint, GLenum, GLint, GLint, GLsizei, GLsizei, GLint)
+GL_BINDING(CopyTexSubImage2D, glCopyTexSubImage2D, GLenum, GLint, GLint, GLint, GLint, GLint, GLsizei, GLsizei)
+GL_STATE_BINDING(CullFace, glCullFace, GLenum)
+GL_STATE_BINDING(DepthMask, glDepthMask, GLboolean)
+GL_BINDING(DepthRange, glDepthRangef, GLfloat, GLfloat)
+GL_BINDING(DisableVertexAttribArray, glDisableVertexAttribArray, GLuint)
+GL_BINDING(Hint, glHint, GLenum, GLenum)
+GL_BINDING(IsEnabled, glIsEnabled, GLenum)
+GL_BINDING(LineWidth, glLineWidth, GLfloat)
+GL_STATE_BINDING(PolygonOffset, glPolygonOffset, GLfloat, GLfloat)
+GL_BINDING(SampleCoverage, glSampleCoverage, GLfloat, GLboolean)
+GL_STATE_BINDING(Scissor, glScissor, GLint, GLint, GLsizei, GLsizei)
+GL_STATE_BINDING(StencilFunc, glStencilFunc, GLenum, GLint, GLuint)
+GL_STATE_BINDING(StencilFuncSeparate, glStencilFuncSeparate, GLenum, GLenum, GLint, GLuint)
+GL_STATE_BINDING(StencilMask, glStencilMask, GLuint)
+GL_STATE_BINDING(StencilMaskSeparate, glStencilMaskSeparate, GLenum, GLuint)
+GL_STATE_BINDING(StencilOp, glStencilOp, GLenum, GLenum, GLenum)
+GL_STATE_BINDING(StencilOpSeparate, glStencilOpSeparate, GLenum, GLenum, GLenum, GLenum)
+GL_BINDING(BindRenderbuffer, glBindRenderbuffer, GLenum, GLuint)
 
+NAN_METHOD(CreateRenderbuffer) {
   GLuint renderbuffers;
   glCreateRenderbuffers(1,&renderbuffers);
   #ifdef LOGGING
@@ -1357,145 +639,86 @@ NAN_METHOD(CreateRenderbuffer) {
 }
 
 NAN_METHOD(DeleteBuffer) {
-  Nan::HandleScope scope;
-
-  GLuint buffer = Nan::To<uint32_t>(info[0]).FromJust();
+  GLuint buffer = marshal::Arg<GLuint>::Unbox(info[0]);
 
   //cout<<"deleteBuffer:"<<buffer<<endl;
   glDeleteBuffers(1,&buffer);
+  unregisterGLObj(GLOBJECT_TYPE_BUFFER, buffer);
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
 NAN_METHOD(DeleteFramebuffer) {
-  Nan::HandleScope scope;
-
-  GLuint buffer = Nan::To<uint32_t>(info[0]).FromJust();
+  GLuint buffer = marshal::Arg<GLuint>::Unbox(info[0]);
 
   glDeleteFramebuffers(1,&buffer);
+  unregisterGLObj(GLOBJECT_TYPE_FRAMEBUFFER, buffer);
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
 NAN_METHOD(DeleteProgram) {
-  Nan::HandleScope scope;
-
-  GLuint program = Nan::To<uint32_t>(info[0]).FromJust();
+  GLuint program = marshal::Arg<GLuint>::Unbox(info[0]);
 
   glDeleteProgram(program);
+  unregisterGLObj(GLOBJECT_TYPE_PROGRAM, program);
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
 NAN_METHOD(DeleteRenderbuffer) {
-  Nan::HandleScope scope;
-
-  GLuint renderbuffer = Nan::To<uint32_t>(info[0]).FromJust();
+  GLuint renderbuffer = marshal::Arg<GLuint>::Unbox(info[0]);
 
   glDeleteRenderbuffers(1, &renderbuffer);
+  unregisterGLObj(GLOBJECT_TYPE_RENDERBUFFER, renderbuffer);
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
 NAN_METHOD(DeleteShader) {
-  Nan::HandleScope scope;
-
-  GLuint shader = Nan::To<uint32_t>(info[0]).FromJust();
+  GLuint shader = marshal::Arg<GLuint>::Unbox(info[0]);
 
   glDeleteShader(shader);
+  unregisterGLObj(GLOBJECT_TYPE_SHADER, shader);
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
 NAN_METHOD(DeleteTexture) {
-  Nan::HandleScope scope;
-
-  GLuint texture = Nan::To<uint32_t>(info[0]).FromJust();
+  GLuint texture = marshal::Arg<GLuint>::Unbox(info[0]);
 
+  if(residentTextureCount)
+    ForgetResidentTexture(texture);
   glDeleteTextures(1,&texture);
+  unregisterGLObj(GLOBJECT_TYPE_TEXTURE, texture);
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
-NAN_METHOD(DetachShader) {
-  Nan::HandleScope scope;
-
-  GLuint program = Nan::To<uint32_t>(info[0]).FromJust();
-  GLuint shader = Nan::To<uint32_t>(info[1]).FromJust();
-
-  glDetachShader(program, shader);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(FramebufferRenderbuffer) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLenum attachment = Nan::To<int>(info[1]).FromJust();
-  GLenum renderbuffertarget = Nan::To<int>(info[2]).FromJust();
-  GLuint renderbuffer = Nan::To<uint32_t>(info[3]).FromJust();
-
-  glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(DetachShader, glDetachShader, GLuint, GLuint)
+GL_BINDING(FramebufferRenderbuffer, glFramebufferRenderbuffer, GLenum, GLenum, GLenum, GLuint)
 
 NAN_METHOD(GetVertexAttribOffset) {
-  Nan::HandleScope scope;
-
-  GLuint index = Nan::To<uint32_t>(info[0]).FromJust();
-  GLenum pname = Nan::To<int>(info[1]).FromJust();
+  GLuint index = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLenum pname = marshal::Arg<GLenum>::Unbox(info[1]);
   void *ret=NULL;
 
   glGetVertexAttribPointerv(index, pname, &ret);
   info.GetReturnValue().Set(JS_INT(ToGLuint(ret)));
 }
 
-NAN_METHOD(IsBuffer) {
-  Nan::HandleScope scope;
-
-  info.GetReturnValue().Set(Nan::New<Boolean>(glIsBuffer(Nan::To<uint32_t>(info[0]).FromJust())!=0));
-}
-
-NAN_METHOD(IsFramebuffer) {
-  Nan::HandleScope scope;
-
-  info.GetReturnValue().Set(JS_BOOL(glIsFramebuffer(Nan::To<uint32_t>(info[0]).FromJust())!=0));
-}
-
-NAN_METHOD(IsProgram) {
-  Nan::HandleScope scope;
-
-  info.GetReturnValue().Set(JS_BOOL(glIsProgram(Nan::To<uint32_t>(info[0]).FromJust())!=0));
-}
-
-NAN_METHOD(IsRenderbuffer) {
-  Nan::HandleScope scope;
-
-  info.GetReturnValue().Set(JS_BOOL(glIsRenderbuffer( Nan::To<uint32_t>(info[0]).FromJust())!=0));
-}
-
-NAN_METHOD(IsShader) {
-  Nan::HandleScope scope;
-
-  info.GetReturnValue().Set(JS_BOOL(glIsShader(Nan::To<uint32_t>(info[0]).FromJust())!=0));
-}
-
-NAN_METHOD(IsTexture) {
-  Nan::HandleScope scope;
-
-  info.GetReturnValue().Set(JS_BOOL(glIsTexture(Nan::To<uint32_t>(info[0]).FromJust())!=0));
-}
-
+GL_BINDING(IsBuffer, glIsBuffer, GLuint)
+GL_BINDING(IsFramebuffer, glIsFramebuffer, GLuint)
+GL_BINDING(IsProgram, glIsProgram, GLuint)
+GL_BINDING(IsRenderbuffer, glIsRenderbuffer, GLuint)
+GL_BINDING(IsShader, glIsShader, GLuint)
+GL_BINDING(IsTexture, glIsTexture, GLuint)
 NAN_METHOD(RenderbufferStorage) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLenum internalformat = Nan::To<int>(info[1]).FromJust();
-  GLsizei width = Nan::To<uint32_t>(info[2]).FromJust();
-  GLsizei height = Nan::To<uint32_t>(info[3]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLenum internalformat = marshal::Arg<GLenum>::Unbox(info[1]);
+  GLsizei width = marshal::Arg<GLsizei>::Unbox(info[2]);
+  GLsizei height = marshal::Arg<GLsizei>::Unbox(info[3]);
 
   glRenderbufferStorage(target, internalformat, width, height);
-  info.GetReturnValue().Set(Nan::Undefined());
+  setGLObjBytes(GLOBJECT_TYPE_RENDERBUFFER, boundRenderbuffer(), (size_t) width * height * TexelBytes(internalformat));
 }
 
 NAN_METHOD(GetShaderSource) {
-  Nan::HandleScope scope;
-
-  int shader = Nan::To<int>(info[0]).FromJust();
+  int shader = marshal::Arg<GLint>::Unbox(info[0]);
 
   GLint len;
   glGetShaderiv(shader, GL_SHADER_SOURCE_LENGTH, &len);
@@ -1508,25 +731,17 @@ NAN_METHOD(GetShaderSource) {
   info.GetReturnValue().Set(str);
 }
 
-NAN_METHOD(ValidateProgram) {
-  Nan::HandleScope scope;
-
-  glValidateProgram(Nan::To<int>(info[0]).FromJust());
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(ValidateProgram, glValidateProgram, GLuint)
 
 NAN_METHOD(TexSubImage2D) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLint level = Nan::To<int>(info[1]).FromJust();
-  GLint xoffset = Nan::To<int>(info[2]).FromJust();
-  GLint yoffset = Nan::To<int>(info[3]).FromJust();
-  GLsizei width = Nan::To<int>(info[4]).FromJust();
-  GLsizei height = Nan::To<int>(info[5]).FromJust();
-  GLenum format = Nan::To<int>(info[6]).FromJust();
-  GLenum type = Nan::To<int>(info[7]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLint level = marshal::Arg<GLint>::Unbox(info[1]);
+  GLint xoffset = marshal::Arg<GLint>::Unbox(info[2]);
+  GLint yoffset = marshal::Arg<GLint>::Unbox(info[3]);
+  GLsizei width = marshal::Arg<GLsizei>::Unbox(info[4]);
+  GLsizei height = marshal::Arg<GLsizei>::Unbox(info[5]);
+  GLenum format = marshal::Arg<GLenum>::Unbox(info[6]);
+  GLenum type = marshal::Arg<GLenum>::Unbox(info[7]);
   int dataSize;
   void *pixels=getImageData(info[8], dataSize);
 
@@ -1535,21 +750,52 @@ NAN_METHOD(TexSubImage2D) {
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
-NAN_METHOD(ReadPixels) {
-  Nan::HandleScope scope;
+NAN_METHOD(CompressedTexImage2D) {
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLint level = marshal::Arg<GLint>::Unbox(info[1]);
+  GLenum internalformat = marshal::Arg<GLenum>::Unbox(info[2]);
+  GLsizei width = marshal::Arg<GLsizei>::Unbox(info[3]);
+  GLsizei height = marshal::Arg<GLsizei>::Unbox(info[4]);
+  GLint border = marshal::Arg<GLint>::Unbox(info[5]);
+  int dataSize = 0;
+  void *data=getImageData(info[6], dataSize);
+
+  glCompressedTexImage2D(target, level, internalformat, width, height, border, dataSize, data);
+  if(level == 0)
+    setTextureLevelBytes(target, dataSize);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
 
-  GLint x = Nan::To<int>(info[0]).FromJust();
-  GLint y = Nan::To<int>(info[1]).FromJust();
-  GLsizei width = Nan::To<int>(info[2]).FromJust();
-  GLsizei height = Nan::To<int>(info[3]).FromJust();
-  GLenum format = Nan::To<int>(info[4]).FromJust();
-  GLenum type = Nan::To<int>(info[5]).FromJust();
+NAN_METHOD(CompressedTexSubImage2D) {
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLint level = marshal::Arg<GLint>::Unbox(info[1]);
+  GLint xoffset = marshal::Arg<GLint>::Unbox(info[2]);
+  GLint yoffset = marshal::Arg<GLint>::Unbox(info[3]);
+  GLsizei width = marshal::Arg<GLsizei>::Unbox(info[4]);
+  GLsizei height = marshal::Arg<GLsizei>::Unbox(info[5]);
+  GLenum format = marshal::Arg<GLenum>::Unbox(info[6]);
+  int dataSize = 0;
+  void *data=getImageData(info[7], dataSize);
+
+  glCompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, dataSize, data);
+
+  info.GetReturnValue().Set(Nan::Undefined());
+}
+
+NAN_METHOD(ReadPixels) {
+  GLint x = marshal::Arg<GLint>::Unbox(info[0]);
+  GLint y = marshal::Arg<GLint>::Unbox(info[1]);
+  GLsizei width = marshal::Arg<GLsizei>::Unbox(info[2]);
+  GLsizei height = marshal::Arg<GLsizei>::Unbox(info[3]);
+  GLenum format = marshal::Arg<GLenum>::Unbox(info[4]);
+  GLenum type = marshal::Arg<GLenum>::Unbox(info[5]);
 
   //MODIFIED BY LIAM TO SUPPORT WEBGL2 function signature
   if (!info[6]->IsNull()) {
     Local<Object> obj = Local<Object>::Cast(info[6]);
     if (!obj->IsObject()){
-      GLint offset = Nan::To<int>(info[6]).FromJust();
+      GLintptr offset = marshal::Arg<GLintptr>::Unbox(info[6]);
       glReadPixels(x, y, width, height, format, type, (void*)offset);
 
       info.GetReturnValue().Set(Nan::Undefined());
@@ -1566,10 +812,8 @@ NAN_METHOD(ReadPixels) {
 }
 
 NAN_METHOD(GetTexParameter) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLenum pname = Nan::To<int>(info[1]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLenum pname = marshal::Arg<GLenum>::Unbox(info[1]);
 
   GLint param_value=0;
   glGetTexParameteriv(target, pname, &param_value);
@@ -1578,10 +822,8 @@ NAN_METHOD(GetTexParameter) {
 }
 
 NAN_METHOD(GetActiveAttrib) {
-  Nan::HandleScope scope;
-
-  GLuint program = Nan::To<int>(info[0]).FromJust();
-  GLuint index = Nan::To<int>(info[1]).FromJust();
+  GLuint program = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLuint index = marshal::Arg<GLuint>::Unbox(info[1]);
 
   char name[1024];
   GLsizei length=0;
@@ -1598,10 +840,8 @@ NAN_METHOD(GetActiveAttrib) {
 }
 
 NAN_METHOD(GetActiveUniform) {
-  Nan::HandleScope scope;
-
-  GLuint program = Nan::To<int>(info[0]).FromJust();
-  GLuint index = Nan::To<int>(info[1]).FromJust();
+  GLuint program = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLuint index = marshal::Arg<GLuint>::Unbox(info[1]);
 
   char name[1024];
   GLsizei length=0;
@@ -1618,9 +858,7 @@ NAN_METHOD(GetActiveUniform) {
 }
 
 NAN_METHOD(GetAttachedShaders) {
-  Nan::HandleScope scope;
-
-  GLuint program = Nan::To<int>(info[0]).FromJust();
+  GLuint program = marshal::Arg<GLuint>::Unbox(info[0]);
 
   GLuint shaders[1024];
   GLsizei count;
@@ -1634,9 +872,7 @@ NAN_METHOD(GetAttachedShaders) {
 }
 
 NAN_METHOD(GetParameter) {
-  Nan::HandleScope scope;
-
-  GLenum name = Nan::To<int>(info[0]).FromJust();
+  GLenum name = marshal::Arg<GLenum>::Unbox(info[0]);
 
   switch(name) {
   case GL_BLEND:
@@ -1785,10 +1021,8 @@ NAN_METHOD(GetParameter) {
 }
 
 NAN_METHOD(GetBufferParameter) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLenum pname = Nan::To<int>(info[1]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLenum pname = marshal::Arg<GLenum>::Unbox(info[1]);
 
   GLint params;
   glGetBufferParameteriv(target,pname,&params);
@@ -1796,11 +1030,9 @@ NAN_METHOD(GetBufferParameter) {
 }
 
 NAN_METHOD(GetFramebufferAttachmentParameter) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLenum attachment = Nan::To<int>(info[1]).FromJust();
-  GLenum pname = Nan::To<int>(info[2]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLenum attachment = marshal::Arg<GLenum>::Unbox(info[1]);
+  GLenum pname = marshal::Arg<GLenum>::Unbox(info[2]);
 
   GLint params;
   glGetFramebufferAttachmentParameteriv(target,attachment, pname,&params);
@@ -1808,9 +1040,7 @@ NAN_METHOD(GetFramebufferAttachmentParameter) {
 }
 
 NAN_METHOD(GetProgramInfoLog) {
-  Nan::HandleScope scope;
-
-  GLuint program = Nan::To<int>(info[0]).FromJust();
+  GLuint program = marshal::Arg<GLuint>::Unbox(info[0]);
   int Len = 1024;
   char Error[1024];
   glGetProgramInfoLog(program, 1024, &Len, Error);
@@ -1819,10 +1049,8 @@ NAN_METHOD(GetProgramInfoLog) {
 }
 
 NAN_METHOD(GetRenderbufferParameter) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int pname = Nan::To<int>(info[1]).FromJust();
+  int target = marshal::Arg<GLint>::Unbox(info[0]);
+  int pname = marshal::Arg<GLint>::Unbox(info[1]);
   int value = 0;
   glGetRenderbufferParameteriv(target,pname,&value);
 
@@ -1830,10 +1058,8 @@ NAN_METHOD(GetRenderbufferParameter) {
 }
 
 NAN_METHOD(GetUniform) {
-  Nan::HandleScope scope;
-
-  GLuint program = Nan::To<int>(info[0]).FromJust();
-  GLint location = Nan::To<int>(info[1]).FromJust();
+  GLuint program = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLint location = marshal::Arg<GLint>::Unbox(info[1]);
   if(location < 0 ) info.GetReturnValue().Set(Nan::Undefined());
 
   float data[16]; // worst case scenario is 16 floats
@@ -1848,10 +1074,8 @@ NAN_METHOD(GetUniform) {
 }
 
 NAN_METHOD(GetVertexAttrib) {
-  Nan::HandleScope scope;
-
-  GLuint index = Nan::To<int>(info[0]).FromJust();
-  GLuint pname = Nan::To<int>(info[1]).FromJust();
+  GLuint index = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLuint pname = marshal::Arg<GLuint>::Unbox(info[1]);
 
   GLint value=0;
 
@@ -1890,8 +1114,6 @@ NAN_METHOD(GetVertexAttrib) {
 }
 
 NAN_METHOD(GetSupportedExtensions) {
-  Nan::HandleScope scope;
-
   char *extensions=(char*) glGetString(GL_EXTENSIONS);
 
   info.GetReturnValue().Set(JS_STR(extensions));
@@ -1899,8 +1121,6 @@ NAN_METHOD(GetSupportedExtensions) {
 
 // TODO GetExtension(name) return the extension name if found, should be an object...
 NAN_METHOD(GetExtension) {
-  Nan::HandleScope scope;
-
   Nan::Utf8String name(info[0]);
   char *sname=*name;
   char *extensions=(char*) glGetString(GL_EXTENSIONS);
@@ -1913,22 +1133,14 @@ NAN_METHOD(GetExtension) {
   }
 }
 
-NAN_METHOD(CheckFramebufferStatus) {
-  Nan::HandleScope scope;
-
-  GLenum target=Nan::To<int>(info[0]).FromJust();
-
-  info.GetReturnValue().Set(JS_INT((int)glCheckFramebufferStatus(target)));
-}
+GL_BINDING(CheckFramebufferStatus, glCheckFramebufferStatus, GLenum)
 
 
 /*** START OF NEW WRAPPERS ADDED BY LIAM ***/
 
 NAN_METHOD(GetShaderPrecisionFormat) {
-  Nan::HandleScope scope;
-
-  GLenum shaderType = Nan::To<int>(info[0]).FromJust();
-  GLenum precisionType = Nan::To<int>(info[1]).FromJust();
+  GLenum shaderType = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLenum precisionType = marshal::Arg<GLenum>::Unbox(info[1]);
 
  // info.GetReturnValue().Set(JS_INT((int)glCheckFramebufferStatus(shaderType, precisionType)));
 
@@ -1953,31 +1165,27 @@ NAN_METHOD(GetShaderPrecisionFormat) {
 }
 
 NAN_METHOD(TexStorage2D) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLsizei levels = Nan::To<int>(info[1]).FromJust();
-  GLenum internalformat = Nan::To<int>(info[2]).FromJust();
-  GLsizei width = Nan::To<int>(info[3]).FromJust();
-  GLsizei height = Nan::To<int>(info[4]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLsizei levels = marshal::Arg<GLsizei>::Unbox(info[1]);
+  GLenum internalformat = marshal::Arg<GLenum>::Unbox(info[2]);
+  GLsizei width = marshal::Arg<GLsizei>::Unbox(info[3]);
+  GLsizei height = marshal::Arg<GLsizei>::Unbox(info[4]);
 
   glTexStorage2D(target, levels, internalformat, width, height);
-
-  info.GetReturnValue().Set(Nan::Undefined());
+  setGLObjBytes(GLOBJECT_TYPE_TEXTURE, boundTexture(target),
+                TextureStorageBytes(target, internalformat, width, height, 1, levels));
 }
 
 //void gl.getBufferSubData(target, srcByteOffset, ArrayBufferView dstData, optional dstOffset, optional length);
 NAN_METHOD(GetBufferSubData) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLint srcByteOffset = Nan::To<int>(info[1]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLintptr srcByteOffset = marshal::Arg<GLintptr>::Unbox(info[1]);
   
   GLsizei dataSizeBytes = -1;
   void* data = getImageData(info[2], dataSizeBytes);
   
-  GLsizei dstOffset = Nan::To<int>(info[3]).FromJust();
-  GLsizei length = Nan::To<int>(info[4]).FromJust();
+  GLsizei dstOffset = marshal::Arg<GLsizei>::Unbox(info[3]);
+  GLsizei length = marshal::Arg<GLsizei>::Unbox(info[4]);
 
   
   GLsizei remainingBytes = dataSizeBytes - dstOffset;
@@ -1990,17 +1198,14 @@ NAN_METHOD(GetBufferSubData) {
   glGetBufferSubData(target, srcByteOffset, remainingBytes, data);
 }
 NAN_METHOD(DeleteTransformFeedback) {
-  Nan::HandleScope scope;
-
-  GLuint tf = Nan::To<uint32_t>(info[0]).FromJust();
+  GLuint tf = marshal::Arg<GLuint>::Unbox(info[0]);
 
   glDeleteTransformFeedbacks(1,&tf);
+  unregisterGLObj(GLOBJECT_TYPE_TRANSFORM_FEEDBACK, tf);
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
 NAN_METHOD(CreateSampler) {
-  Nan::HandleScope scope;
-
   GLuint sampler;
   glCreateSamplers(1, &sampler);
   #ifdef LOGGING
@@ -2010,57 +1215,17 @@ NAN_METHOD(CreateSampler) {
   info.GetReturnValue().Set(Nan::New<Number>(sampler));
 }
 NAN_METHOD(DeleteSampler) {
-  Nan::HandleScope scope;
-
-  GLuint sampler = Nan::To<int>(info[0]).FromJust();
+  GLuint sampler = marshal::Arg<GLuint>::Unbox(info[0]);
   
   glDeleteSamplers(1,&sampler);
+  unregisterGLObj(GLOBJECT_TYPE_SAMPLER, sampler);
 
   info.GetReturnValue().Set(Nan::Undefined());
 }
-NAN_METHOD(SamplerParameteri) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int pname = Nan::To<int>(info[1]).FromJust();
-  int param = Nan::To<int>(info[2]).FromJust();
-
-  //cout<<"SamplerParameteri"<<target<<","<<pname<<","<<param<<endl;
-  glSamplerParameteri(target, pname, param);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(BlitFramebuffer) {
-  Nan::HandleScope scope;
-
-  int srcX0 = Nan::To<int>(info[0]).FromJust();
-  int srcY0 = Nan::To<int>(info[1]).FromJust();
-  int srcX1 = Nan::To<int>(info[2]).FromJust();
-  int srcY1 = Nan::To<int>(info[3]).FromJust();
-  int dstX0 = Nan::To<int>(info[4]).FromJust();
-  int dstY0 = Nan::To<int>(info[5]).FromJust();
-  int dstX1 = Nan::To<int>(info[6]).FromJust();
-  int dstY1 = Nan::To<int>(info[7]).FromJust();
-  int mask = Nan::To<int>(info[8]).FromJust();
-  int filter = Nan::To<int>(info[9]).FromJust();
-
-
-  glBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(BindSampler) {
-  Nan::HandleScope scope;
-
-  int unit = Nan::To<int>(info[0]).FromJust();
-  int sampler = Nan::To<int>(info[1]).FromJust();
-
-  glBindSampler(unit, sampler);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(SamplerParameteri, glSamplerParameteri, GLuint, GLenum, GLint)
+GL_BINDING(SamplerParameterf, glSamplerParameterf, GLuint, GLenum, GLfloat)
+GL_BINDING(BlitFramebuffer, glBlitFramebuffer, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum)
+GL_BINDING(BindSampler, glBindSampler, GLuint, GLuint)
 
 /*
   Nan::Utf8String code(info[1]);
@@ -2070,9 +1235,7 @@ NAN_METHOD(BindSampler) {
 const GLchar* shaderSrc[] 
 */
 NAN_METHOD(TransformFeedbackVaryings) {
-  Nan::HandleScope scope;
-
-  int program = Nan::To<int>(info[0]).FromJust();
+  int program = marshal::Arg<GLint>::Unbox(info[0]);
   Local<Array> names = Local<Array>::Cast(info[1]);
   char namesArray[names->Length()][1024];
   const GLchar* namePointers[names->Length()];
@@ -2089,7 +1252,7 @@ NAN_METHOD(TransformFeedbackVaryings) {
     cout << "TransformFeedbackVaryings name: "<<namesArray[i]<<" "<<strlen(namesArray[i])<<endl;
   }*/
 
-  int bufferMode = Nan::To<int>(info[2]).FromJust();
+  int bufferMode = marshal::Arg<GLint>::Unbox(info[2]);
   //cout<<"TransformFeedbackVaryings "<<program<<" "<<bufferMode<<endl;
 
   glTransformFeedbackVaryings(program, names->Length(), namePointers, bufferMode);
@@ -2100,10 +1263,8 @@ NAN_METHOD(TransformFeedbackVaryings) {
   info.GetReturnValue().Set(Nan::Undefined());
 }
 NAN_METHOD(GetTransformFeedbackVarying) {
-  Nan::HandleScope scope;
-
-  int program = Nan::To<int>(info[0]).FromJust();
-  int index = Nan::To<int>(info[1]).FromJust();
+  int program = marshal::Arg<GLint>::Unbox(info[0]);
+  int index = marshal::Arg<GLint>::Unbox(info[1]);
 
   int bufSize = 1024;
   char name[bufSize];
@@ -2116,8 +1277,6 @@ NAN_METHOD(GetTransformFeedbackVarying) {
   info.GetReturnValue().Set(JS_STR(name, length)); 
 }
 NAN_METHOD(CreateTransformFeedback) {
-  Nan::HandleScope scope;
-
   GLuint tf;
   glCreateTransformFeedbacks(1, &tf);
   #ifdef LOGGING
@@ -2126,86 +1285,19 @@ NAN_METHOD(CreateTransformFeedback) {
   registerGLObj(GLOBJECT_TYPE_TRANSFORM_FEEDBACK, tf);
   info.GetReturnValue().Set(Nan::New<Number>(tf));
 }
-NAN_METHOD(BindTransformFeedback) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int tf = Nan::To<int>(info[1]).FromJust();
-
-  glBindTransformFeedback(target, tf);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-NAN_METHOD(BindBufferBase) {
-  Nan::HandleScope scope;
-  int target = Nan::To<int>(info[0]).FromJust();
-  int index = Nan::To<int>(info[1]).FromJust();
-  int buffer = Nan::To<int>(info[2]).FromJust();
-
-  glBindBufferBase(target, index, buffer);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-NAN_METHOD(BindBufferRange) {
-  Nan::HandleScope scope;
-
-  int target = Nan::To<int>(info[0]).FromJust();
-  int index = Nan::To<int>(info[1]).FromJust();
-  int buffer = Nan::To<int>(info[2]).FromJust();
-  int offset = Nan::To<int>(info[3]).FromJust();
-  int size = Nan::To<int>(info[4]).FromJust();
-
-  glBindBufferRange(target, index, buffer, offset, size);
-
-  info.GetReturnValue().Set(Nan::Undefined());  
-}
-NAN_METHOD(BeginTransformFeedback) {
-  Nan::HandleScope scope;
-
-  GLenum primitiveMode = Nan::To<int>(info[0]).FromJust();
-
-  glBeginTransformFeedback(primitiveMode);
-
-  info.GetReturnValue().Set(Nan::Undefined());   
-}
-NAN_METHOD(EndTransformFeedback) {
-  Nan::HandleScope scope;
-
-  glEndTransformFeedback();
-
-  info.GetReturnValue().Set(Nan::Undefined());   
-}
-NAN_METHOD(VertexAttribDivisor) {
-  Nan::HandleScope scope;
-
-  int index = Nan::To<int>(info[0]).FromJust();
-  int divisor = Nan::To<int>(info[1]).FromJust();
-  
-  glVertexAttribDivisor(index, divisor);
-
-  info.GetReturnValue().Set(Nan::Undefined());  
-}
-NAN_METHOD(DrawArraysInstanced) {
-  Nan::HandleScope scope;
-
-  int mode = Nan::To<int>(info[0]).FromJust();
-  int first = Nan::To<int>(info[1]).FromJust();
-  int count = Nan::To<int>(info[2]).FromJust();
-  int instanceCount = Nan::To<int>(info[3]).FromJust();
-  
-  glDrawArraysInstanced(mode, first, count, instanceCount);
-
-  info.GetReturnValue().Set(Nan::Undefined());  
-
-}
+GL_BINDING(BindTransformFeedback, glBindTransformFeedback, GLenum, GLuint)
+GL_BINDING(BindBufferBase, glBindBufferBase, GLenum, GLuint, GLuint)
+GL_BINDING(BindBufferRange, glBindBufferRange, GLenum, GLuint, GLuint, GLintptr, GLsizeiptr)
+GL_BINDING(BeginTransformFeedback, glBeginTransformFeedback, GLenum)
+GL_BINDING(EndTransformFeedback, glEndTransformFeedback)
+GL_BINDING(VertexAttribDivisor, glVertexAttribDivisor, GLuint, GLuint)
+GL_BINDING(DrawArraysInstanced, glDrawArraysInstanced, GLenum, GLint, GLsizei, GLsizei)
 /*NAN_METHOD(DrawElementsInstanced) {
-  Nan::HandleScope scope;
-
-  int mode = Nan::To<int>(info[0]).FromJust();
-  int count = Nan::To<int>(info[1]).FromJust();
-  int type = Nan::To<int>(info[2]).FromJust();
-  int first = Nan::To<int>(info[3]).FromJust();
-  int instanceCount = Nan::To<int>(info[4]).FromJust();
+  int mode = marshal::Arg<GLint>::Unbox(info[0]);
+  int count = marshal::Arg<GLint>::Unbox(info[1]);
+  int type = marshal::Arg<GLint>::Unbox(info[2]);
+  int first = marshal::Arg<GLint>::Unbox(info[3]);
+  int instanceCount = marshal::Arg<GLint>::Unbox(info[4]);
   
   glDrawElementsInstanced(mode, count, type, first, instanceCount);
 
@@ -2213,10 +1305,8 @@ NAN_METHOD(DrawArraysInstanced) {
 
 }*/
 NAN_METHOD(FenceSync) {
-   Nan::HandleScope scope;
-
-  int condition = Nan::To<int>(info[0]).FromJust();
-  int flags = Nan::To<int>(info[1]).FromJust();
+  int condition = marshal::Arg<GLint>::Unbox(info[0]);
+  int flags = marshal::Arg<GLint>::Unbox(info[1]);
   
   GLsync sync = glFenceSync(condition, flags);
   int syncId = registerSync(sync);
@@ -2224,9 +1314,7 @@ NAN_METHOD(FenceSync) {
   info.GetReturnValue().Set(Nan::New<Number>(syncId));
 }
 NAN_METHOD(DeleteSync) {
-   Nan::HandleScope scope;
-
-  int syncId = Nan::To<int>(info[0]).FromJust();
+  int syncId = marshal::Arg<GLint>::Unbox(info[0]);
   
   GLsync sync = getSync(syncId);
   glDeleteSync(sync);
@@ -2235,10 +1323,8 @@ NAN_METHOD(DeleteSync) {
   info.GetReturnValue().Set(Nan::Undefined());
 }
 NAN_METHOD(GetSyncParameter) {
-  Nan::HandleScope scope;
-
-  int syncId = Nan::To<int>(info[0]).FromJust();
-  int pname = Nan::To<int>(info[1]).FromJust();
+  int syncId = marshal::Arg<GLint>::Unbox(info[0]);
+  int pname = marshal::Arg<GLint>::Unbox(info[1]);
 
   GLsizei bufSize = 1;
   GLint data[bufSize];
@@ -2251,8 +1337,6 @@ NAN_METHOD(GetSyncParameter) {
   info.GetReturnValue().Set(Nan::New<Number>(data[0]));
 }
 NAN_METHOD(DrawBuffers) {
-  Nan::HandleScope scope;
-
   //int program = Nan::To<int>(info[0]).FromJust();
   Local<Array> attachments = Local<Array>::Cast(info[0]);
   GLenum bufs[attachments->Length()];
@@ -2265,54 +1349,24 @@ NAN_METHOD(DrawBuffers) {
   info.GetReturnValue().Set(Nan::Undefined());
 }
 NAN_METHOD(TexStorage3D) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLsizei levels = Nan::To<int>(info[1]).FromJust();
-  GLenum internalformat = Nan::To<int>(info[2]).FromJust();
-  GLsizei width = Nan::To<int>(info[3]).FromJust();
-  GLsizei height = Nan::To<int>(info[4]).FromJust();
-  GLsizei depth = Nan::To<int>(info[5]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLsizei levels = marshal::Arg<GLsizei>::Unbox(info[1]);
+  GLenum internalformat = marshal::Arg<GLenum>::Unbox(info[2]);
+  GLsizei width = marshal::Arg<GLsizei>::Unbox(info[3]);
+  GLsizei height = marshal::Arg<GLsizei>::Unbox(info[4]);
+  GLsizei depth = marshal::Arg<GLsizei>::Unbox(info[5]);
 
   glTexStorage3D(target, levels, internalformat, width, height, depth);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-
-NAN_METHOD(FramebufferTextureLayer) {
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLenum attachment = Nan::To<int>(info[1]).FromJust();
-  int tex = Nan::To<int>(info[2]).FromJust();
-  int level = Nan::To<int>(info[3]).FromJust();
-  int layer = Nan::To<int>(info[4]).FromJust();
-
-  glFramebufferTextureLayer(target, attachment, tex, level, layer);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
-NAN_METHOD(CopyBufferSubData) {
-  Nan::HandleScope scope;
-
-  //readTarget, writeTarget, readOffset, writeOffset, size
-  GLenum readTarget = Nan::To<int>(info[0]).FromJust();
-  GLenum writeTarget = Nan::To<int>(info[1]).FromJust();
-  int readOffset = Nan::To<int>(info[2]).FromJust();
-  int writeOffset = Nan::To<int>(info[3]).FromJust();
-  int size = Nan::To<int>(info[4]).FromJust();
-
-  glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
-
-  info.GetReturnValue().Set(Nan::Undefined());  
+  setGLObjBytes(GLOBJECT_TYPE_TEXTURE, boundTexture(target),
+                TextureStorageBytes(target, internalformat, width, height, depth, levels));
 }
+GL_BINDING(FramebufferTextureLayer, glFramebufferTextureLayer, GLenum, GLenum, GLuint, GLint, GLint)
+GL_BINDING(CopyBufferSubData, glCopyBufferSubData, GLenum, GLenum, GLintptr, GLintptr, GLsizeiptr)
 NAN_METHOD(ClearBufferfv) {
-  Nan::HandleScope scope;
-
   //readTarget, writeTarget, readOffset, writeOffset, size
-  GLenum buffer = Nan::To<int>(info[0]).FromJust();
-  GLint drawBuffer = Nan::To<int>(info[1]).FromJust();
-  int srcOffset = Nan::To<int>(info[3]).FromJust();
+  GLenum buffer = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLint drawBuffer = marshal::Arg<GLint>::Unbox(info[1]);
+  int srcOffset = marshal::Arg<GLint>::Unbox(info[3]);
 
   int num;
   GLfloat* ptr = getArrayData<GLfloat>(info[2],&num);
@@ -2329,13 +1383,11 @@ NAN_METHOD(ClearBufferfv) {
 
 }
 NAN_METHOD(ClearBufferData) {
-  Nan::HandleScope scope;
-
   //readTarget, writeTarget, readOffset, writeOffset, size
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLenum internalFormat = Nan::To<int>(info[1]).FromJust();
-  GLenum format = Nan::To<int>(info[2]).FromJust();
-  GLenum type = Nan::To<int>(info[3]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLenum internalFormat = marshal::Arg<GLenum>::Unbox(info[1]);
+  GLenum format = marshal::Arg<GLenum>::Unbox(info[2]);
+  GLenum type = marshal::Arg<GLenum>::Unbox(info[3]);
 /*
   cout<<"target:"<<target<<endl;
   cout<<"internalFormat:"<<internalFormat<<endl;
@@ -2346,7 +1398,7 @@ NAN_METHOD(ClearBufferData) {
 */
   Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(info[4]);
   //int size = arr->ByteLength();
-  void* data = (uint8_t*)arr->Buffer()->GetBackingStore()->Data() + arr->ByteOffset();
+  void* data = (uint8_t*)arr->Buffer()->Data() + arr->ByteOffset();
 
   //cout<<"size:"<<size<<endl;
  // cout<<"is null"<<info[4]->IsNull()<<endl;
@@ -2357,13 +1409,11 @@ NAN_METHOD(ClearBufferData) {
 
 }
 NAN_METHOD(ClearNamedBufferData) {
-  Nan::HandleScope scope;
-
   //readTarget, writeTarget, readOffset, writeOffset, size
-  int buf = Nan::To<int>(info[0]).FromJust();
-  GLenum internalFormat = Nan::To<int>(info[1]).FromJust();
-  GLenum format = Nan::To<int>(info[2]).FromJust();
-  GLenum type = Nan::To<int>(info[3]).FromJust();
+  int buf = marshal::Arg<GLint>::Unbox(info[0]);
+  GLenum internalFormat = marshal::Arg<GLenum>::Unbox(info[1]);
+  GLenum format = marshal::Arg<GLenum>::Unbox(info[2]);
+  GLenum type = marshal::Arg<GLenum>::Unbox(info[3]);
 
   //cout<<"target:"<<target<<endl;
  // cout<<"buf:"<<buf<<endl;
@@ -2379,7 +1429,7 @@ NAN_METHOD(ClearNamedBufferData) {
   }else{
     Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(info[4]);
     //int size = arr->ByteLength();
-    void* data = (uint8_t*)arr->Buffer()->GetBackingStore()->Data() + arr->ByteOffset();
+    void* data = (uint8_t*)arr->Buffer()->Data() + arr->ByteOffset();
 
    // cout<<"size:"<<size<<endl;
     //cout<<"is null"<<info[4]->IsNull()<<endl;
@@ -2391,15 +1441,13 @@ NAN_METHOD(ClearNamedBufferData) {
 
 }
 NAN_METHOD(ClearBufferSubData) {
-  Nan::HandleScope scope;
-
   //readTarget, writeTarget, readOffset, writeOffset, size
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLenum internalFormat = Nan::To<int>(info[1]).FromJust();
-  GLint offset = Nan::To<int>(info[2]).FromJust();
-  GLint clearSize = Nan::To<int>(info[3]).FromJust();
-  GLenum format = Nan::To<int>(info[4]).FromJust();
-  GLenum type = Nan::To<int>(info[5]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLenum internalFormat = marshal::Arg<GLenum>::Unbox(info[1]);
+  GLintptr offset = marshal::Arg<GLintptr>::Unbox(info[2]);
+  GLint clearSize = marshal::Arg<GLint>::Unbox(info[3]);
+  GLenum format = marshal::Arg<GLenum>::Unbox(info[4]);
+  GLenum type = marshal::Arg<GLenum>::Unbox(info[5]);
 /*
   cout<<"target:"<<target<<endl;
   cout<<"internalFormat:"<<internalFormat<<endl;
@@ -2412,8 +1460,8 @@ NAN_METHOD(ClearBufferSubData) {
   //void* ptr = getArrayData<BYTE>(info[6],&num);
   int element_size = 1;
   Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(info[6]);
-  int size = arr->ByteLength() * element_size;
-  void* data = (uint8_t*)arr->Buffer()->GetBackingStore()->Data() + arr->ByteOffset();
+  GLsizeiptr size = arr->ByteLength() * element_size;
+  void* data = (uint8_t*)arr->Buffer()->Data() + arr->ByteOffset();
 
   //cout<<"size:"<<size<<endl;
 
@@ -2422,85 +1470,19 @@ NAN_METHOD(ClearBufferSubData) {
   info.GetReturnValue().Set(Nan::Undefined());  
 
 }
-NAN_METHOD(ReadBuffer) {
-  Nan::HandleScope scope;
-  GLenum src = Nan::To<int>(info[0]).FromJust();
-
-  glReadBuffer(src);
-  
-  info.GetReturnValue().Set(Nan::Undefined());    
-}
-NAN_METHOD(VertexAttribIPointer) {
-  Nan::HandleScope scope;
-
-  int indx = Nan::To<int>(info[0]).FromJust();
-  int size = Nan::To<int>(info[1]).FromJust();
-  int type = Nan::To<int>(info[2]).FromJust();
-  int stride = Nan::To<int>(info[3]).FromJust();
-  long offset = Nan::To<int>(info[4]).FromJust();
-
-  //    printf("VertexAttribPointer %d %d %d %d %d %d\n", indx, size, type, normalized, stride, offset);
-  glVertexAttribIPointer(indx, size, type, stride, (const GLvoid *)offset);
-
-  info.GetReturnValue().Set(Nan::Undefined());
-}
+GL_BINDING(ReadBuffer, glReadBuffer, GLenum)
+GL_BINDING(VertexAttribIPointer, glVertexAttribIPointer, GLuint, GLint, GLenum, GLsizei, marshal::Offset)
 
 //START OF OpenGL 4.6 functions
-NAN_METHOD(BindImageTexture) {
-  Nan::HandleScope scope;
-  GLuint unit = Nan::To<int>(info[0]).FromJust();
-  GLuint texture = Nan::To<int>(info[1]).FromJust();
-  GLint level = Nan::To<int>(info[2]).FromJust();
-  GLboolean layered = Nan::To<bool>(info[3]).FromJust();
-  GLint layer = Nan::To<int>(info[4]).FromJust();
-  GLenum access = Nan::To<int>(info[5]).FromJust();
-  GLenum format = Nan::To<int>(info[6]).FromJust();
-
-  glBindImageTexture(unit, texture, level, layered, layer, access, format);
-
-  info.GetReturnValue().Set(Nan::Undefined());  
-}
-NAN_METHOD(DispatchCompute) {
-  Nan::HandleScope scope;
-  GLuint sx = Nan::To<int>(info[0]).FromJust();
-  GLuint sy = Nan::To<int>(info[1]).FromJust();
-  GLuint sz = Nan::To<int>(info[2]).FromJust();
-
-  glDispatchCompute(sx, sy, sz);
-
-  info.GetReturnValue().Set(Nan::Undefined());  
-
-}
-NAN_METHOD(DispatchComputeGroupSize) {
-  Nan::HandleScope scope;
-  GLuint sx = Nan::To<int>(info[0]).FromJust();
-  GLuint sy = Nan::To<int>(info[1]).FromJust();
-  GLuint sz = Nan::To<int>(info[2]).FromJust();
-
-  GLuint wx = Nan::To<int>(info[3]).FromJust();
-  GLuint wy = Nan::To<int>(info[4]).FromJust();
-  GLuint wz = Nan::To<int>(info[5]).FromJust();
-
-  glDispatchComputeGroupSizeARB(sx, sy, sz, wx, wy, wz);
-
-  info.GetReturnValue().Set(Nan::Undefined());  
-
-}
-NAN_METHOD(MemoryBarrier) {
-  Nan::HandleScope scope;
-  GLuint bits = Nan::To<int>(info[0]).FromJust();
-
-  glMemoryBarrier(bits);
-
-  info.GetReturnValue().Set(Nan::Undefined());  
-
-}
+GL_BINDING(BindImageTexture, glBindImageTexture, GLuint, GLuint, GLint, GLboolean, GLint, GLenum, GLenum)
+GL_BINDING(DispatchCompute, glDispatchCompute, GLuint, GLuint, GLuint)
+GL_BINDING(DispatchComputeGroupSize, glDispatchComputeGroupSizeARB, GLuint, GLuint, GLuint, GLuint, GLuint, GLuint)
+GL_BINDING(MemoryBarrier, glMemoryBarrier, GLbitfield)
 NAN_METHOD(ClearTexImage){
-  Nan::HandleScope scope;
-  GLuint tex = Nan::To<int>(info[0]).FromJust();
-  GLuint level = Nan::To<int>(info[1]).FromJust();
-  GLenum format = Nan::To<int>(info[2]).FromJust();
-  GLenum type = Nan::To<int>(info[3]).FromJust();
+  GLuint tex = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLuint level = marshal::Arg<GLuint>::Unbox(info[1]);
+  GLenum format = marshal::Arg<GLenum>::Unbox(info[2]);
+  GLenum type = marshal::Arg<GLenum>::Unbox(info[3]);
   //GLenum data = Nan::To<int>(info[0]).FromJust();
   int dataSize;
   void* data = getImageData(info[4], dataSize);
@@ -2510,44 +1492,18 @@ NAN_METHOD(ClearTexImage){
 
   info.GetReturnValue().Set(Nan::Undefined());    
 }
-NAN_METHOD(CopyImageSubData){
-  Nan::HandleScope scope;
-  GLuint srcTex = Nan::To<int>(info[0]).FromJust();
-  GLenum srcTarget = Nan::To<int>(info[1]).FromJust();
-  GLuint srcLevel = Nan::To<int>(info[2]).FromJust();
-  GLuint srcX = Nan::To<int>(info[3]).FromJust();
-  GLuint srcY = Nan::To<int>(info[4]).FromJust();
-  GLuint srcZ = Nan::To<int>(info[5]).FromJust();
-
-  GLuint dstTex = Nan::To<int>(info[6]).FromJust();
-  GLenum dstTarget = Nan::To<int>(info[7]).FromJust();
-  GLuint dstLevel = Nan::To<int>(info[8]).FromJust();
-  GLuint dstX = Nan::To<int>(info[9]).FromJust();
-  GLuint dstY = Nan::To<int>(info[10]).FromJust();
-  GLuint dstZ = Nan::To<int>(info[11]).FromJust();
-
-  GLuint sizeX = Nan::To<int>(info[12]).FromJust();
-  GLuint sizeY = Nan::To<int>(info[13]).FromJust();
-  GLuint sizeZ = Nan::To<int>(info[14]).FromJust();
-
-  
-  glCopyImageSubData(srcTex, srcTarget, srcLevel, srcX, srcY, srcZ, dstTex, dstTarget, dstLevel, dstX, dstY, dstZ, sizeX, sizeY, sizeZ);
-
-  info.GetReturnValue().Set(Nan::Undefined());    
-}
+GL_BINDING(CopyImageSubData, glCopyImageSubData, GLuint, GLenum, GLint, GLint, GLint, GLint, GLuint, GLenum, GLint, GLint, GLint, GLint, GLsizei, GLsizei, GLsizei)
 NAN_METHOD(GetTextureImage){
-  Nan::HandleScope scope;
- 
-  GLuint tex = Nan::To<int>(info[0]).FromJust();
-  GLint level = Nan::To<int>(info[1]).FromJust();
-  GLenum format = Nan::To<int>(info[2]).FromJust();
-  GLenum type = Nan::To<int>(info[3]).FromJust();
-  GLint bufSize = Nan::To<int>(info[4]).FromJust();
+  GLuint tex = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLint level = marshal::Arg<GLint>::Unbox(info[1]);
+  GLenum format = marshal::Arg<GLenum>::Unbox(info[2]);
+  GLenum type = marshal::Arg<GLenum>::Unbox(info[3]);
+  GLint bufSize = marshal::Arg<GLint>::Unbox(info[4]);
 
   if (!info[5]->IsNull()) {
     Local<Object> obj = Local<Object>::Cast(info[5]);
     if (!obj->IsObject()){
-      GLint offset = Nan::To<int>(info[5]).FromJust();
+      GLintptr offset = marshal::Arg<GLintptr>::Unbox(info[5]);
       glGetTextureImage(tex, level, format, type, bufSize, (void*) offset);
       //glReadPixels(x, y, width, height, format, type, (void*)offset);
 
@@ -2564,11 +1520,9 @@ NAN_METHOD(GetTextureImage){
   info.GetReturnValue().Set(Nan::Undefined());    
 }
 NAN_METHOD(BufferStorage){
-  Nan::HandleScope scope;
-
-  GLenum target = Nan::To<int>(info[0]).FromJust();
-  GLint byteSize = Nan::To<int>(info[1]).FromJust();
-  GLbitfield flags = Nan::To<int>(info[3]).FromJust();
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLsizeiptr byteSize = marshal::Arg<GLsizeiptr>::Unbox(info[1]);
+  GLbitfield flags = marshal::Arg<GLbitfield>::Unbox(info[3]);
 
   /*if (info[2]->IsNull()) {
     glBufferStorage(target, byteSize, NULL, flags);
@@ -2581,13 +1535,15 @@ NAN_METHOD(BufferStorage){
 
     Local<Object> obj = Local<Object>::Cast(info[2]);
     Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(obj);
-    int size = byteSize==0?(arr->ByteLength()):byteSize;
-    void* data = (uint8_t*)arr->Buffer()->GetBackingStore()->Data() + arr->ByteOffset();
+    GLsizeiptr size = byteSize==0?(arr->ByteLength()):byteSize;
+    void* data = (uint8_t*)arr->Buffer()->Data() + arr->ByteOffset();
 
     glBufferStorage(target, size, data, flags);
+    setGLObjBytes(GLOBJECT_TYPE_BUFFER, boundBuffer(target), size);
     //cout << "data buffer storage\n";
   }else{
     glBufferStorage(target, byteSize, NULL, flags);
+    setGLObjBytes(GLOBJECT_TYPE_BUFFER, boundBuffer(target), byteSize);
     //cout << "null buffer storage\n";
   } 
   info.GetReturnValue().Set(Nan::Undefined());    
@@ -2595,11 +1551,9 @@ NAN_METHOD(BufferStorage){
 }
 
 NAN_METHOD(NamedBufferStorage){
-  Nan::HandleScope scope;
-
-  int buf = Nan::To<int>(info[0]).FromJust();
-  GLint byteSize = Nan::To<int>(info[1]).FromJust();
-  GLbitfield flags = Nan::To<int>(info[3]).FromJust();
+  int buf = marshal::Arg<GLint>::Unbox(info[0]);
+  GLsizeiptr byteSize = marshal::Arg<GLsizeiptr>::Unbox(info[1]);
+  GLbitfield flags = marshal::Arg<GLbitfield>::Unbox(info[3]);
 
   /*if (info[2]->IsNull()) {
     glBufferStorage(target, byteSize, NULL, flags);
@@ -2612,13 +1566,15 @@ NAN_METHOD(NamedBufferStorage){
 
     Local<Object> obj = Local<Object>::Cast(info[2]);
     Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(obj);
-    int size = byteSize==0?(arr->ByteLength()):byteSize;
-    void* data = (uint8_t*)arr->Buffer()->GetBackingStore()->Data() + arr->ByteOffset();
+    GLsizeiptr size = byteSize==0?(arr->ByteLength()):byteSize;
+    void* data = (uint8_t*)arr->Buffer()->Data() + arr->ByteOffset();
 
     glNamedBufferStorage(buf, size, data, flags);
+    setGLObjBytes(GLOBJECT_TYPE_BUFFER, buf, size);
     //cout << "data buffer storage\n";
   }else{
     glNamedBufferStorage(buf, byteSize, NULL, flags);
+    setGLObjBytes(GLOBJECT_TYPE_BUFFER, buf, byteSize);
     //cout << "null buffer storage "<<byteSize<<" "<<flags<<endl;
   } 
   info.GetReturnValue().Set(Nan::Undefined());    
@@ -2626,16 +1582,14 @@ NAN_METHOD(NamedBufferStorage){
 }
 
 NAN_METHOD(GetNamedBufferSubData) {
-  Nan::HandleScope scope;
-
-  int buf = Nan::To<int>(info[0]).FromJust();
-  GLint srcByteOffset = Nan::To<int>(info[1]).FromJust();
+  int buf = marshal::Arg<GLint>::Unbox(info[0]);
+  GLintptr srcByteOffset = marshal::Arg<GLintptr>::Unbox(info[1]);
   
   GLsizei dataSizeBytes = -1;
   void* data = getImageData(info[2], dataSizeBytes);
   
-  GLsizei dstOffset = Nan::To<int>(info[3]).FromJust();
-  GLsizei length = Nan::To<int>(info[4]).FromJust();
+  GLsizei dstOffset = marshal::Arg<GLsizei>::Unbox(info[3]);
+  GLsizei length = marshal::Arg<GLsizei>::Unbox(info[4]);
 
   
   GLsizei remainingBytes = dataSizeBytes - dstOffset;
@@ -2660,68 +1614,58 @@ NAN_METHOD(GetNamedBufferSubData) {
 
 
 NAN_METHOD(NamedBufferSubData) {
-  Nan::HandleScope scope;
-
-  int buf = Nan::To<int>(info[0]).FromJust();
-  int offset = Nan::To<int>(info[1]).FromJust();
+  int buf = marshal::Arg<GLint>::Unbox(info[0]);
+  GLintptr offset = marshal::Arg<GLintptr>::Unbox(info[1]);
   Local<Object> obj = Local<Object>::Cast(info[2]);
-  int srcOffsetBytes = Nan::To<int>(info[3]).FromJust();
-  int lengthBytes = Nan::To<int>(info[4]).FromJust();
+  int srcOffsetBytes = marshal::Arg<GLint>::Unbox(info[3]);
+  int lengthBytes = marshal::Arg<GLint>::Unbox(info[4]);
  // cout<<"offset:"<<offset<<endl;
  // cout<<"srcOffsetBytes:"<<srcOffsetBytes<<endl;
   //cout<<"lengthBytes:"<<lengthBytes<<endl;
 
   Local<ArrayBufferView> arr = Local<ArrayBufferView>::Cast(obj);
-  int size = lengthBytes==0?arr->ByteLength():lengthBytes;
+  GLsizeiptr size = lengthBytes==0?arr->ByteLength():lengthBytes;
   //cout<<"size:"<<size<<endl;
   //cout<<"bytelength:"<<arr->ByteLength()<<endl;
-  void* data = (uint8_t*)arr->Buffer()->GetBackingStore()->Data() + arr->ByteOffset() + srcOffsetBytes;
+  void* data = (uint8_t*)arr->Buffer()->Data() + arr->ByteOffset() + srcOffsetBytes;
 
   glNamedBufferSubData(buf, offset, size, data);
 
   info.GetReturnValue().Set(Nan::Undefined());
 }
-NAN_METHOD(TextureStorage2D) {
-  Nan::HandleScope scope;
 
-  int tex = Nan::To<int>(info[0]).FromJust();
-  int levels = Nan::To<int>(info[1]).FromJust();
-  int internalFormat = Nan::To<int>(info[2]).FromJust();
-  int width = Nan::To<int>(info[3]).FromJust();
-  int height = Nan::To<int>(info[4]).FromJust();
-  
+NAN_METHOD(TextureStorage2D) {
+  GLuint tex = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLsizei levels = marshal::Arg<GLsizei>::Unbox(info[1]);
+  GLenum internalFormat = marshal::Arg<GLenum>::Unbox(info[2]);
+  GLsizei width = marshal::Arg<GLsizei>::Unbox(info[3]);
+  GLsizei height = marshal::Arg<GLsizei>::Unbox(info[4]);
 
   glTextureStorage2D(tex, levels, internalFormat, width, height);
-
-  info.GetReturnValue().Set(Nan::Undefined());
+  setGLObjBytes(GLOBJECT_TYPE_TEXTURE, tex, TextureStorageBytes(textureTarget(tex), internalFormat, width, height, 1, levels));
 }
+
 NAN_METHOD(TextureStorage3D) {
-  Nan::HandleScope scope;
-
-  int tex = Nan::To<int>(info[0]).FromJust();
-  int levels = Nan::To<int>(info[1]).FromJust();
-  int internalFormat = Nan::To<int>(info[2]).FromJust();
-  int width = Nan::To<int>(info[3]).FromJust();
-  int height = Nan::To<int>(info[4]).FromJust();
-  int depth = Nan::To<int>(info[5]).FromJust();
-  
+  GLuint tex = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLsizei levels = marshal::Arg<GLsizei>::Unbox(info[1]);
+  GLenum internalFormat = marshal::Arg<GLenum>::Unbox(info[2]);
+  GLsizei width = marshal::Arg<GLsizei>::Unbox(info[3]);
+  GLsizei height = marshal::Arg<GLsizei>::Unbox(info[4]);
+  GLsizei depth = marshal::Arg<GLsizei>::Unbox(info[5]);
 
   glTextureStorage3D(tex, levels, internalFormat, width, height, depth);
-
-  info.GetReturnValue().Set(Nan::Undefined());
+  setGLObjBytes(GLOBJECT_TYPE_TEXTURE, tex, TextureStorageBytes(textureTarget(tex), internalFormat, width, height, depth, levels));
 }
 
 NAN_METHOD(TextureSubImage2D) {
-  Nan::HandleScope scope;
-
-  int tex = Nan::To<int>(info[0]).FromJust();
-  GLint level = Nan::To<int>(info[1]).FromJust();
-  GLint xoffset = Nan::To<int>(info[2]).FromJust();
-  GLint yoffset = Nan::To<int>(info[3]).FromJust();
-  GLsizei width = Nan::To<int>(info[4]).FromJust();
-  GLsizei height = Nan::To<int>(info[5]).FromJust();
-  GLenum format = Nan::To<int>(info[6]).FromJust();
-  GLenum type = Nan::To<int>(info[7]).FromJust();
+  int tex = marshal::Arg<GLint>::Unbox(info[0]);
+  GLint level = marshal::Arg<GLint>::Unbox(info[1]);
+  GLint xoffset = marshal::Arg<GLint>::Unbox(info[2]);
+  GLint yoffset = marshal::Arg<GLint>::Unbox(info[3]);
+  GLsizei width = marshal::Arg<GLsizei>::Unbox(info[4]);
+  GLsizei height = marshal::Arg<GLsizei>::Unbox(info[5]);
+  GLenum format = marshal::Arg<GLenum>::Unbox(info[6]);
+  GLenum type = marshal::Arg<GLenum>::Unbox(info[7]);
   int dataSize;
   void *pixels=getImageData(info[8], dataSize);
 
@@ -2730,41 +1674,224 @@ NAN_METHOD(TextureSubImage2D) {
   info.GetReturnValue().Set(Nan::Undefined());
 }
 
-NAN_METHOD(TextureParameteri) {
-  Nan::HandleScope scope;
+NAN_METHOD(CompressedTextureSubImage2D) {
+  int tex = marshal::Arg<GLint>::Unbox(info[0]);
+  GLint level = marshal::Arg<GLint>::Unbox(info[1]);
+  GLint xoffset = marshal::Arg<GLint>::Unbox(info[2]);
+  GLint yoffset = marshal::Arg<GLint>::Unbox(info[3]);
+  GLsizei width = marshal::Arg<GLsizei>::Unbox(info[4]);
+  GLsizei height = marshal::Arg<GLsizei>::Unbox(info[5]);
+  GLenum format = marshal::Arg<GLenum>::Unbox(info[6]);
+  int dataSize = 0;
+  void *data=getImageData(info[7], dataSize);
 
-  int tex = Nan::To<int>(info[0]).FromJust();
-  int pname = Nan::To<int>(info[1]).FromJust();
-  int param = Nan::To<int>(info[2]).FromJust();
-
-  glTextureParameteri(tex, pname, param);
+  glCompressedTextureSubImage2D(tex, level, xoffset, yoffset, width, height, format, dataSize, data);
 
   info.GetReturnValue().Set(Nan::Undefined());
 }
-NAN_METHOD(TextureParameterf) {
-  Nan::HandleScope scope;
 
-  int tex = Nan::To<int>(info[0]).FromJust();
-  int pname = Nan::To<int>(info[1]).FromJust();
-  float param = Nan::To<double>(info[2]).FromJust();
+GL_BINDING(TextureParameteri, glTextureParameteri, GLuint, GLenum, GLint)
+GL_BINDING(TextureParameterf, glTextureParameterf, GLuint, GLenum, GLfloat)
+
+/*
+ * Multi-bind (ARB_multi_bind, core since 4.4): one crossing per group of
+ * binding points. Names come as a Uint32Array, or null to unbind count
+ * consecutive points; offsets and sizes as a Float64Array or BigInt64Array.
+ * count is clamped to the arrays' lengths.
+ */
+
+// names, or NULL for null; clamps count to the number of names
+static const GLuint *multiBindNames(Local<Value> value, GLsizei *count) {
+  if(value->IsNullOrUndefined())
+    return NULL;
+  size_t byteLength = 0;
+  const GLuint *names = marshal::ArrayData<GLuint>(value, &byteLength);
+  if((size_t) *count > byteLength / sizeof(GLuint))
+    *count = (GLsizei) (byteLength / sizeof(GLuint));
+  return names;
+}
+
+NAN_METHOD(BindTextures) {
+  GLuint first = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLsizei count = marshal::Arg<GLsizei>::Unbox(info[1]);
+  const GLuint *textures = multiBindNames(info[2], &count);
+
+  glBindTextures(first, count, textures);
+  if(residentTextureCount && textures) {
+    for(GLsizei i = 0; i < count; i++)
+      TouchResidentTexture(textures[i]);
+  }
+}
 
-  glTextureParameterf(tex, pname, param);
+NAN_METHOD(BindSamplers) {
+  GLuint first = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLsizei count = marshal::Arg<GLsizei>::Unbox(info[1]);
+  const GLuint *samplers = multiBindNames(info[2], &count);
 
-  info.GetReturnValue().Set(Nan::Undefined());
+  glBindSamplers(first, count, samplers);
 }
 
+NAN_METHOD(BindImageTextures) {
+  GLuint first = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLsizei count = marshal::Arg<GLsizei>::Unbox(info[1]);
+  const GLuint *textures = multiBindNames(info[2], &count);
 
-/*** END OF NEW WRAPPERS ADDED BY LIAM ***/
+  glBindImageTextures(first, count, textures);
+}
+
+NAN_METHOD(BindBuffersBase) {
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLuint first = marshal::Arg<GLuint>::Unbox(info[1]);
+  GLsizei count = marshal::Arg<GLsizei>::Unbox(info[2]);
+  const GLuint *buffers = multiBindNames(info[3], &count);
+
+  glBindBuffersBase(target, first, count, buffers);
+}
+
+NAN_METHOD(BindBuffersRange) {
+  GLenum target = marshal::Arg<GLenum>::Unbox(info[0]);
+  GLuint first = marshal::Arg<GLuint>::Unbox(info[1]);
+  GLsizei count = marshal::Arg<GLsizei>::Unbox(info[2]);
+  const GLuint *buffers = multiBindNames(info[3], &count);
+
+  if(!buffers) {
+    glBindBuffersRange(target, first, count, NULL, NULL, NULL);
+    return;
+  }
+  marshal::IntptrArray<> offsets(info[4]);
+  marshal::IntptrArray<> sizes(info[5]);
+  count = min(count, (GLsizei) min(offsets.Size(), sizes.Size()));
+  glBindBuffersRange(target, first, count, buffers, offsets.Data(), (const GLsizeiptr *) sizes.Data());
+}
 
-struct GLObj {
-  GLObjectType type;
-  GLuint obj;
-  GLObj(GLObjectType type, GLuint obj) {
-    this->type=type;
-    this->obj=obj;
+// binds to the vertex array object that is bound
+NAN_METHOD(BindVertexBuffers) {
+  GLuint first = marshal::Arg<GLuint>::Unbox(info[0]);
+  GLsizei count = marshal::Arg<GLsizei>::Unbox(info[1]);
+  const GLuint *buffers = multiBindNames(info[2], &count);
+
+  if(!buffers) {
+    glBindVertexBuffers(first, count, NULL, NULL, NULL);
+    return;
   }
+  marshal::IntptrArray<> offsets(info[3]);
+  size_t strideBytes = 0;
+  const GLsizei *strides = marshal::ArrayData<GLsizei>(info[4], &strideBytes);
+  count = min(count, (GLsizei) min(offsets.Size(), strideBytes / sizeof(GLsizei)));
+  glBindVertexBuffers(first, count, buffers, offsets.Data(), strides);
+}
+
+/*
+ * Vertex array objects, with the DSA vertex format entry points
+ */
+
+NAN_METHOD(CreateVertexArray) {
+  GLuint vao;
+  glCreateVertexArrays(1, &vao);
+  #ifdef LOGGING
+  cout<<"createVertexArray "<<vao<<endl;
+  #endif
+  registerGLObj(GLOBJECT_TYPE_VERTEX_ARRAY, vao);
+  info.GetReturnValue().Set(Nan::New<Number>(vao));
+}
+
+NAN_METHOD(DeleteVertexArray) {
+  GLuint vao = marshal::Arg<GLuint>::Unbox(info[0]);
+
+  glDeleteVertexArrays(1, &vao);
+  unregisterGLObj(GLOBJECT_TYPE_VERTEX_ARRAY, vao);
+}
+
+GL_BINDING(BindVertexArray, glBindVertexArray, GLuint)
+GL_BINDING(IsVertexArray, glIsVertexArray, GLuint)
+GL_BINDING(EnableVertexArrayAttrib, glEnableVertexArrayAttrib, GLuint, GLuint)
+GL_BINDING(DisableVertexArrayAttrib, glDisableVertexArrayAttrib, GLuint, GLuint)
+GL_BINDING(VertexArrayAttribFormat, glVertexArrayAttribFormat, GLuint, GLuint, GLint, GLenum, GLboolean, GLuint)
+GL_BINDING(VertexArrayAttribIFormat, glVertexArrayAttribIFormat, GLuint, GLuint, GLint, GLenum, GLuint)
+GL_BINDING(VertexArrayAttribLFormat, glVertexArrayAttribLFormat, GLuint, GLuint, GLint, GLenum, GLuint)
+GL_BINDING(VertexArrayAttribBinding, glVertexArrayAttribBinding, GLuint, GLuint, GLuint)
+GL_BINDING(VertexArrayBindingDivisor, glVertexArrayBindingDivisor, GLuint, GLuint, GLuint)
+GL_BINDING(VertexArrayVertexBuffer, glVertexArrayVertexBuffer, GLuint, GLuint, GLuint, GLintptr, GLsizei)
+GL_BINDING(VertexArrayElementBuffer, glVertexArrayElementBuffer, GLuint, GLuint)
+
+// must match the packing in lib/webgl.js createVertexLayout
+enum VertexLayoutKind {
+  VERTEX_LAYOUT_FLOAT,    // glVertexArrayAttribFormat, normalized or converted
+  VERTEX_LAYOUT_INTEGER,  // glVertexArrayAttribIFormat
+  VERTEX_LAYOUT_DOUBLE    // glVertexArrayAttribLFormat
 };
+static const int VERTEX_LAYOUT_ATTRIB_INTS = 7;
+static const int VERTEX_LAYOUT_BINDING_INTS = 2;
+static const int MAX_VERTEX_LAYOUT_BINDINGS = 32;
+
+// createVertexLayout(Int32Array attribs, Int32Array bindings) -> vao
+//   attribs:  [location, size, type, normalized, relativeOffset, binding, kind] per attribute
+//   bindings: [stride, divisor] per binding index (strides are applied when buffers are bound)
+// Builds the whole vertex format in one call.
+NAN_METHOD(CreateVertexLayout) {
+  size_t attribBytes = 0, bindingBytes = 0;
+  const GLint *attribs = marshal::ArrayData<GLint>(info[0], &attribBytes);
+  const GLint *bindings = marshal::ArrayData<GLint>(info[1], &bindingBytes);
+  size_t attribCount = attribBytes / sizeof(GLint) / VERTEX_LAYOUT_ATTRIB_INTS;
+  size_t bindingCount = bindingBytes / sizeof(GLint) / VERTEX_LAYOUT_BINDING_INTS;
+
+  GLuint vao;
+  glCreateVertexArrays(1, &vao);
+  registerGLObj(GLOBJECT_TYPE_VERTEX_ARRAY, vao);
+
+  for(size_t i = 0; i < attribCount; i++) {
+    const GLint *a = attribs + i * VERTEX_LAYOUT_ATTRIB_INTS;
+    GLuint location = a[0];
+    switch(a[6]) {
+    case VERTEX_LAYOUT_INTEGER: glVertexArrayAttribIFormat(vao, location, a[1], a[2], a[4]); break;
+    case VERTEX_LAYOUT_DOUBLE: glVertexArrayAttribLFormat(vao, location, a[1], a[2], a[4]); break;
+    default: glVertexArrayAttribFormat(vao, location, a[1], a[2], a[3] ? GL_TRUE : GL_FALSE, a[4]); break;
+    }
+    glVertexArrayAttribBinding(vao, location, a[5]);
+    glEnableVertexArrayAttrib(vao, location);
+  }
+  for(size_t i = 0; i < bindingCount; i++) {
+    const GLint *b = bindings + i * VERTEX_LAYOUT_BINDING_INTS;
+    if(b[1])
+      glVertexArrayBindingDivisor(vao, (GLuint) i, b[1]);
+  }
+
+  info.GetReturnValue().Set(Nan::New<Number>(vao));
+}
+
+// bindVertexLayout(vao, Uint32Array buffers | null, Float64Array offsets, Int32Array strides, elementBuffer)
+// Attaches buffers to binding indices 0..buffers.length-1 (unless null),
+// the element buffer (unless negative) and binds the VAO, in one crossing.
+// Offsets are doubles so they stay exact past 4GB.
+NAN_METHOD(BindVertexLayout) {
+  GLuint vao = marshal::Arg<GLuint>::Unbox(info[0]);
+
+  if(!info[1]->IsNull()) {
+    size_t bufferBytes = 0, offsetBytes = 0, strideBytes = 0;
+    const GLuint *buffers = marshal::ArrayData<GLuint>(info[1], &bufferBytes);
+    const double *offsets = marshal::ArrayData<double>(info[2], &offsetBytes);
+    const GLsizei *strides = marshal::ArrayData<GLsizei>(info[3], &strideBytes);
+    size_t count = bufferBytes / sizeof(GLuint);
+    count = min(count, offsetBytes / sizeof(double));
+    count = min(count, strideBytes / sizeof(GLsizei));
+    count = min(count, (size_t) MAX_VERTEX_LAYOUT_BINDINGS);
+
+    GLintptr offsets64[MAX_VERTEX_LAYOUT_BINDINGS];
+    for(size_t i = 0; i < count; i++)
+      offsets64[i] = (GLintptr) offsets[i];
+    if(count)
+      glVertexArrayVertexBuffers(vao, 0, (GLsizei) count, buffers, offsets64, strides);
+  }
+
+  GLint elementBuffer = marshal::Arg<GLint>::Unbox(info[4]);
+  if(elementBuffer >= 0)
+    glVertexArrayElementBuffer(vao, elementBuffer);
 
+  glBindVertexArray(vao);
+}
+
+
+/*** END OF NEW WRAPPERS ADDED BY LIAM ***/
 
 map<int, GLsync> syncs;
 int syncIdCounter = 0;
@@ -2782,109 +1909,4 @@ GLsync getSync(int syncId){
   return syncs[syncId];
 }
 
-vector<GLObj*> globjs;
-static bool atExit=false;
-
-void registerGLObj(GLObjectType type, GLuint obj) {
-  globjs.push_back(new GLObj(type,obj));
-}
-
-
-void unregisterGLObj(GLuint obj) {
-  if(atExit) return;
-
-  vector<GLObj*>::iterator it = globjs.begin();
-  while(globjs.size() && it != globjs.end()) {
-    GLObj *globj=*it;
-    if(globj->obj==obj) {
-      delete globj;
-      globjs.erase(it);
-      break;
-    }
-    ++it;
-  }
-}
-
-void AtExit() {
-  atExit=true;
-  //glFinish();
-
-  vector<GLObj*>::iterator it;
-
-  #ifdef LOGGING
-  cout<<"WebGL AtExit() called"<<endl;
-  cout<<"  # objects allocated: "<<globjs.size()<<endl;
-  it = globjs.begin();
-  while(globjs.size() && it != globjs.end()) {
-    GLObj *obj=*it;
-    cout<<"[";
-    switch(obj->type) {
-    case GLOBJECT_TYPE_BUFFER: cout<<"buffer"; break;
-    case GLOBJECT_TYPE_FRAMEBUFFER: cout<<"framebuffer"; break;
-    case GLOBJECT_TYPE_PROGRAM: cout<<"program"; break;
-    case GLOBJECT_TYPE_RENDERBUFFER: cout<<"renderbuffer"; break;
-    case GLOBJECT_TYPE_SHADER: cout<<"shader"; break;
-    case GLOBJECT_TYPE_TEXTURE: cout<<"texture"; break;
-    };
-    cout<<": "<<obj->obj<<"] ";
-    ++it;
-  }
-  cout<<endl;
-  #endif
-
-  it = globjs.begin();
-  while(globjs.size() && it != globjs.end()) {
-    GLObj *globj=*it;
-    GLuint obj=globj->obj;
-
-    switch(globj->type) {
-    case GLOBJECT_TYPE_PROGRAM:
-      #ifdef LOGGING
-      cout<<"  Destroying GL program "<<obj<<endl;
-      #endif
-      glDeleteProgram(obj);
-      break;
-    case GLOBJECT_TYPE_BUFFER:
-      #ifdef LOGGING
-      cout<<"  Destroying GL buffer "<<obj<<endl;
-      #endif
-      glDeleteBuffers(1,&obj);
-      break;
-    case GLOBJECT_TYPE_FRAMEBUFFER:
-      #ifdef LOGGING
-      cout<<"  Destroying GL frame buffer "<<obj<<endl;
-      #endif
-      glDeleteFramebuffers(1,&obj);
-      break;
-    case GLOBJECT_TYPE_RENDERBUFFER:
-      #ifdef LOGGING
-      cout<<"  Destroying GL render buffer "<<obj<<endl;
-      #endif
-      glDeleteRenderbuffers(1,&obj);
-      break;
-    case GLOBJECT_TYPE_SHADER:
-      #ifdef LOGGING
-      cout<<"  Destroying GL shader "<<obj<<endl;
-      #endif
-      glDeleteShader(obj);
-      break;
-    case GLOBJECT_TYPE_TEXTURE:
-      #ifdef LOGGING
-      cout<<"  Destroying GL texture "<<obj<<endl;
-      #endif
-      glDeleteTextures(1,&obj);
-      break;
-    default:
-      #ifdef LOGGING
-      cout<<"  Unknown object "<<obj<<endl;
-      #endif
-      break;
-    }
-    delete globj;
-    ++it;
-  }
-
-  globjs.clear();
-}
-
 } // end namespace webgl
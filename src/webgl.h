@@ -87,6 +87,7 @@ NAN_METHOD(EnableVertexAttribArray);
 NAN_METHOD(VertexAttribPointer);
 NAN_METHOD(ActiveTexture);
 NAN_METHOD(DrawElements);
+NAN_METHOD(DrawElementsBaseVertex);
 NAN_METHOD(Flush);
 NAN_METHOD(Finish);
 
@@ -147,6 +148,8 @@ NAN_METHOD(GetShaderSource);
 NAN_METHOD(ValidateProgram);
 
 NAN_METHOD(TexSubImage2D);
+NAN_METHOD(CompressedTexImage2D);
+NAN_METHOD(CompressedTexSubImage2D);
 NAN_METHOD(ReadPixels);
 NAN_METHOD(GetTexParameter);
 NAN_METHOD(GetActiveAttrib);
@@ -171,6 +174,7 @@ NAN_METHOD(GetBufferSubData);
 NAN_METHOD(DeleteTransformFeedback);
 NAN_METHOD(CreateSampler);
 NAN_METHOD(SamplerParameteri);
+NAN_METHOD(SamplerParameterf);
 NAN_METHOD(BlitFramebuffer);
 NAN_METHOD(BindSampler);
 NAN_METHOD(TransformFeedbackVaryings);
@@ -214,9 +218,33 @@ NAN_METHOD(NamedBufferSubData);
 NAN_METHOD(TextureStorage2D);
 NAN_METHOD(TextureStorage3D);
 NAN_METHOD(TextureSubImage2D);
+NAN_METHOD(CompressedTextureSubImage2D);
 NAN_METHOD(TextureParameteri);
 NAN_METHOD(TextureParameterf);
 
+NAN_METHOD(BindTextures);
+NAN_METHOD(BindSamplers);
+NAN_METHOD(BindImageTextures);
+NAN_METHOD(BindBuffersBase);
+NAN_METHOD(BindBuffersRange);
+NAN_METHOD(BindVertexBuffers);
+
+NAN_METHOD(CreateVertexArray);
+NAN_METHOD(DeleteVertexArray);
+NAN_METHOD(BindVertexArray);
+NAN_METHOD(IsVertexArray);
+NAN_METHOD(EnableVertexArrayAttrib);
+NAN_METHOD(DisableVertexArrayAttrib);
+NAN_METHOD(VertexArrayAttribFormat);
+NAN_METHOD(VertexArrayAttribIFormat);
+NAN_METHOD(VertexArrayAttribLFormat);
+NAN_METHOD(VertexArrayAttribBinding);
+NAN_METHOD(VertexArrayBindingDivisor);
+NAN_METHOD(VertexArrayVertexBuffer);
+NAN_METHOD(VertexArrayElementBuffer);
+NAN_METHOD(CreateVertexLayout);
+NAN_METHOD(BindVertexLayout);
+
 /*** END OF NEW WRAPPERS ADDED BY LIAM ***/
 }
 
@@ -0,0 +1,110 @@
+// Measures the per-call cost of the native bindings (argument unboxing + the GL
+// call) and of the fast and checked JS wrappers in lib/webgl.js on top of them.
+// Every case is a call the driver treats as (nearly) free: location -1
+// uniforms, zero-count draws, rebinding the same object, so the time is
+// dominated by the binding layer.
+//
+//   node test/bench_bindings.js [--save before.json] [--compare before.json]
+//
+// To see the savings of a binding change, run with --save on the old build and
+// with --compare on the new one; the last column is the per-call difference.
+
+var fs = require('fs');
+
+// snapshot the raw natives before lib/webgl.js wraps them
+var native = Object.assign({}, require('bindings')('webgl'));
+
+var WebGL = require('../index'),
+    document = WebGL.document(),
+    log = console.log;
+
+var canvas = document.createElement('canvas');
+var gl = canvas.getContext('webgl');
+
+var args = process.argv.slice(2);
+function option(name) {
+  var i = args.indexOf(name);
+  return i >= 0 ? args[i + 1] : null;
+}
+var savePath = option('--save');
+var comparePath = option('--compare');
+var baseline = comparePath ? JSON.parse(fs.readFileSync(comparePath, 'utf8')) : null;
+
+var minSeconds = 0.25;
+var vec4 = new Float32Array([1, 2, 3, 4]);
+var mat4 = new Float32Array(16);
+var noLocation = new gl.WebGLUniformLocation(-1);
+var buffer = gl.createBuffer();
+var textures = [];
+for (var i = 0; i < 8; i++) textures.push(gl.createTexture(gl.TEXTURE_2D));
+var textureNames = Uint32Array.from(textures, function(t) { return t._; });
+var opaque = gl.createRenderState({ depth: true, cull: true });
+var transparent = gl.createRenderState({ depth: { write: false }, blend: { src: gl.SRC_ALPHA, dst: gl.ONE_MINUS_SRC_ALPHA } });
+var flip = false;
+function setStates(g, transparent) {
+  if (transparent) { g.enable(g.BLEND); g.blendFunc(g.SRC_ALPHA, g.ONE_MINUS_SRC_ALPHA); g.depthMask(false); g.disable(g.CULL_FACE); }
+  else { g.disable(g.BLEND); g.depthMask(true); g.enable(g.CULL_FACE); }
+}
+
+// [name, raw native call, wrapper call on g (gl.fast or gl.checked)]
+var cases = [
+  ['enable (smi)', function() { native.enable(gl.DITHER); }, function(g) { return function() { g.enable(g.DITHER); }; }],
+  ['isEnabled (bool return)', function() { native.isEnabled(gl.DITHER); }, function(g) { return function() { g.isEnabled(g.DITHER); }; }],
+  ['getError (int return)', function() { native.getError(); }, function(g) { return function() { g.getError(); }; }],
+  ['bindBuffer', function() { native.bindBuffer(gl.ARRAY_BUFFER, buffer._); }, function(g) { return function() { g.bindBuffer(g.ARRAY_BUFFER, buffer); }; }],
+  ['viewport (4 smi)', function() { native.viewport(0, 0, 640, 480); }, function(g) { return function() { g.viewport(0, 0, 640, 480); }; }],
+  ['stencilMask (heap number)', function() { native.stencilMask(0xffffffff); }, function(g) { return function() { g.stencilMask(0xffffffff); }; }],
+  ['uniform1i', function() { native.uniform1i(-1, 3); }, function(g) { return function() { g.uniform1i(noLocation, 3); }; }],
+  ['uniform4f (doubles)', function() { native.uniform4f(-1, 0.1, 0.2, 0.3, 0.4); }, function(g) { return function() { g.uniform4f(noLocation, 0.1, 0.2, 0.3, 0.4); }; }],
+  ['uniform4fv (typed array)', function() { native.uniform4fv(-1, vec4); }, function(g) { return function() { g.uniform4fv(noLocation, vec4); }; }],
+  ['uniformMatrix4fv', function() { native.uniformMatrix4fv(-1, false, mat4); }, function(g) { return function() { g.uniformMatrix4fv(noLocation, false, mat4); }; }],
+  ['vertexAttrib4fv', function() { native.vertexAttrib4fv(15, vec4); }, function(g) { return function() { g.vertexAttrib4fv(15, vec4); }; }],
+  ['bindTexture x8 (per unit)', function() { for (var i = 0; i < 8; i++) { native.activeTexture(gl.TEXTURE0 + i); native.bindTexture(gl.TEXTURE_2D, textureNames[i]); } },
+    function(g) { return function() { for (var i = 0; i < 8; i++) { g.activeTexture(g.TEXTURE0 + i); g.bindTexture(g.TEXTURE_2D, textures[i]); } }; }],
+  ['bindTextures (8 units)', function() { native.bindTextures(0, 8, textureNames); }, function(g) { return function() { g.bindTextures(0, 8, textureNames); }; }],
+  ['blend/depth/cull calls', function() { setStates(native, flip = !flip); }, function(g) { return function() { setStates(g, flip = !flip); }; }],
+  ['applyRenderState (diff)', function() { native.applyRenderState((flip = !flip) ? transparent._ : opaque._); },
+    function(g) { return function() { g.applyRenderState((flip = !flip) ? transparent : opaque); }; }],
+  ['drawArrays (count 0)', function() { native.drawArrays(gl.POINTS, 0, 0); }, function(g) { return function() { g.drawArrays(g.POINTS, 0, 0); }; }],
+];
+
+function pad(s, n) {
+  s = String(s);
+  while (s.length < n) s += ' ';
+  return s;
+}
+
+// nanoseconds per call, unrolled by 10 so the loop itself is noise
+function measure(fn) {
+  var calls = 0, start = process.hrtime.bigint(), elapsed;
+  do {
+    for (var i = 0; i < 1000; i++) {
+      fn(); fn(); fn(); fn(); fn(); fn(); fn(); fn(); fn(); fn();
+    }
+    calls += 10000;
+    elapsed = Number(process.hrtime.bigint() - start);
+  } while (elapsed < minSeconds * 1e9);
+  return elapsed / calls;
+}
+
+var results = {};
+log(pad('binding', 28) + pad('native ns', 12) + pad('fast ns', 12) + pad('checked ns', 12) + (baseline ? 'native delta ns' : ''));
+
+cases.forEach(function(c) {
+  measure(c[1]); // warm up the IC and the JIT
+  var raw = measure(c[1]);
+  var fast = measure(c[2](gl.fast));
+  var checked = measure(c[2](gl.checked));
+  results[c[0]] = { native: raw, fast: fast, checked: checked };
+
+  var line = pad(c[0], 28) + pad(raw.toFixed(1), 12) + pad(fast.toFixed(1), 12) + pad(checked.toFixed(1), 12);
+  if (baseline && baseline[c[0]]) {
+    var delta = raw - baseline[c[0]].native;
+    line += (delta > 0 ? '+' : '') + delta.toFixed(1) + ' (' + (100 * delta / baseline[c[0]].native).toFixed(0) + '%)';
+  }
+  log(line);
+});
+
+gl.getError();
+if (savePath) fs.writeFileSync(savePath, JSON.stringify(results, null, 2));
+process.exit(0);
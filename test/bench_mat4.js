@@ -0,0 +1,74 @@
+// Compares the batched native matrix functions with doing the same per
+// object with glMatrix, and checks they agree.
+//
+//   node test/bench_mat4.js [count] [threads]
+
+var fs = require('fs'),
+    gl = require('../lib/webgl'),
+    log = console.log;
+
+eval(fs.readFileSync(__dirname + '/glMatrix-0.9.5.min.js', 'utf8'));
+
+var count = parseInt(process.argv[2]) || 10000;
+var threads = process.argv[3] === undefined ? 1 : parseInt(process.argv[3]);
+var minSeconds = 0.25;
+
+function randomMatrices(n) {
+  var m = new Float32Array(n * 16);
+  for (var i = 0; i < n; i++) {
+    var t = mat4.identity(m.subarray(i * 16, i * 16 + 16));
+    mat4.translate(t, [Math.random() * 10, Math.random() * 10, Math.random() * 10]);
+    mat4.rotate(t, Math.random() * 6, [Math.random(), Math.random(), Math.random() + 0.1]);
+    mat4.scale(t, [0.5 + Math.random(), 0.5 + Math.random(), 0.5 + Math.random()]);
+  }
+  return m;
+}
+
+var a = randomMatrices(count), b = randomMatrices(count);
+var outNative = new Float32Array(count * 16), outJS = new Float32Array(count * 16);
+var parents = new Int32Array(count);
+for (var i = 0; i < count; i++) parents[i] = i === 0 ? -1 : Math.floor(Math.random() * i);
+
+var views = [];
+for (var i = 0; i < count; i++) views.push([a.subarray(i * 16, i * 16 + 16), b.subarray(i * 16, i * 16 + 16), outJS.subarray(i * 16, i * 16 + 16)]);
+
+var cases = [
+  ['multiply', function() { gl.multiplyMat4(outNative, a, b, { threads: threads }); },
+    function() { for (var i = 0; i < count; i++) mat4.multiply(views[i][0], views[i][1], views[i][2]); }],
+  ['invert', function() { gl.invertMat4(outNative, a, { threads: threads }); },
+    function() { for (var i = 0; i < count; i++) mat4.inverse(views[i][0], views[i][2]); }],
+  ['propagate', function() { gl.propagateMat4(outNative, a, parents); },
+    function() {
+      for (var i = 0; i < count; i++) {
+        if (parents[i] < 0) mat4.set(views[i][0], views[i][2]);
+        else mat4.multiply(views[parents[i]][2], views[i][0], views[i][2]);
+      }
+    }],
+];
+
+function pad(s, n) {
+  s = String(s);
+  while (s.length < n) s += ' ';
+  return s;
+}
+
+// milliseconds per call
+function measure(fn) {
+  var calls = 0, start = process.hrtime.bigint(), elapsed;
+  do {
+    fn();
+    calls++;
+    elapsed = Number(process.hrtime.bigint() - start);
+  } while (elapsed < minSeconds * 1e9);
+  return elapsed / calls / 1e6;
+}
+
+log(count + ' matrices, ' + threads + ' thread(s)');
+log(pad('operation', 12) + pad('native ms', 12) + pad('glMatrix ms', 14) + pad('speedup', 10) + 'max error');
+cases.forEach(function(c) {
+  c[1](); c[2]();
+  var error = 0;
+  for (var i = 0; i < outNative.length; i++) error = Math.max(error, Math.abs(outNative[i] - outJS[i]));
+  var native = measure(c[1]), js = measure(c[2]);
+  log(pad(c[0], 12) + pad(native.toFixed(3), 12) + pad(js.toFixed(3), 14) + pad((js / native).toFixed(1) + 'x', 10) + error.toExponential(1));
+});
@@ -0,0 +1,75 @@
+// Benchmarks the CPU texture encoder on the images shipped in test/ and examples/:
+// encode throughput (megapixels per second) and quality (PSNR against the source).
+//
+//   node test/bench_texture_encode.js [threads] [format ...]
+
+var fs = require('fs'),
+    path = require('path'),
+    gl = require('../lib/webgl'),
+    Image = require('../lib/image'),
+    log = console.log;
+
+var threads = parseInt(process.argv[2]) || 0;
+var formats = process.argv.length > 3 ? process.argv.slice(3) : ['bc1', 'bc3', 'bc7', 'etc2'];
+var dirs = [__dirname, path.join(__dirname, '..', 'examples')];
+var minSeconds = 0.5;
+
+// bc1 and etc2 are opaque formats, so their alpha is not scored
+function psnr(a, b, channels) {
+  var se = 0, n = 0;
+  for (var i = 0; i < a.length; i += 4) {
+    for (var c = 0; c < channels; c++) {
+      var d = a[i + c] - b[i + c];
+      se += d * d;
+    }
+    n += channels;
+  }
+  if (se === 0) return Infinity;
+  return 10 * Math.log10(255 * 255 / (se / n));
+}
+
+function pad(s, n) {
+  s = String(s);
+  while (s.length < n) s += ' ';
+  return s;
+}
+
+var images = [];
+dirs.forEach(function(dir) {
+  fs.readdirSync(dir).forEach(function(name) {
+    if (!/\.(png|jpe?g|gif)$/i.test(name)) return;
+    var img = new Image();
+    img.src = path.join(dir, name);
+    images.push({ name: name, width: img.width, height: img.height, data: img.data });
+  });
+});
+
+log('threads: ' + (threads || 'all cores'));
+log(pad('image', 22) + pad('size', 12) + pad('format', 8) + pad('MPix/s', 10) + 'PSNR (dB)');
+
+formats.forEach(function(format) {
+  var channels = (format === 'bc1' || format === 'etc2') ? 3 : 4;
+  var totalPixels = 0, totalSeconds = 0;
+
+  images.forEach(function(img) {
+    var encoded = gl.encodeTexture(img.data, img.width, img.height, format, threads);
+
+    // repeat small images until the timing is meaningful
+    var runs = 0, start = process.hrtime.bigint(), seconds;
+    do {
+      gl.encodeTexture(img.data, img.width, img.height, format, threads);
+      runs++;
+      seconds = Number(process.hrtime.bigint() - start) / 1e9;
+    } while (seconds < minSeconds);
+
+    var pixels = img.width * img.height;
+    totalPixels += pixels * runs;
+    totalSeconds += seconds;
+
+    var decoded = gl.decodeTexture(encoded, img.width, img.height, format);
+    log(pad(img.name, 22) + pad(img.width + 'x' + img.height, 12) + pad(format, 8) +
+        pad((pixels * runs / seconds / 1e6).toFixed(2), 10) + psnr(img.data, decoded, channels).toFixed(2));
+  });
+
+  log(pad('total', 34) + pad(format, 8) + (totalPixels / totalSeconds / 1e6).toFixed(2));
+});
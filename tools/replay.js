@@ -0,0 +1,345 @@
+// Replays a trace recorded with NODE_WEBGL_TRACE (see "Tracing" in
+// lib/webgl.js) against a headless OpenGL context and reports per frame
+// timings, so a slow frame can be profiled without the application.
+//
+//   node tools/replay.js app.trace [--json times.json] [--no-finish]
+//
+// The calls are decoded before the first frame runs and a frame's typed
+// arrays are copied before its timing starts, so the timings are the binding
+// and the driver only. Each frame ends with gl.finish() so the GPU
+// work is counted in the frame that issued it (--no-finish measures the CPU
+// side only). --json writes {frames: [{frame, ms, recordedMs}], ...}.
+// Object names are not translated: a fresh context hands out the same names
+// for the same calls, returned values that differ are reported as divergences.
+// Linux only, any Mesa driver works (MESA_GL_VERSION_OVERRIDE covers llvmpipe).
+
+var fs = require('fs');
+
+if (!process.env.MESA_GL_VERSION_OVERRIDE) process.env.MESA_GL_VERSION_OVERRIDE = '4.6';
+delete process.env.NODE_WEBGL_TRACE;
+
+var args = process.argv.slice(2);
+function option(name) {
+  var i = args.indexOf(name);
+  return i >= 0 ? args[i + 1] : null;
+}
+var tracePath = args[0];
+var jsonPath = option('--json');
+var finish = args.indexOf('--no-finish') < 0;
+if (!tracePath || tracePath.startsWith('--')) {
+  console.error('usage: node tools/replay.js trace [--json times.json] [--no-finish]');
+  process.exit(2);
+}
+
+// must match src/trace.h
+var TRACE_VERSION = 2;
+var TRACE_DEFINE = 1, TRACE_CALL = 2, TRACE_RETURN = 3, TRACE_CALLBACK = 4, TRACE_FRAME = 5, TRACE_BLOB = 6;
+var TRACE_UNDEFINED = 0, TRACE_NULL = 1, TRACE_FALSE = 2, TRACE_TRUE = 3, TRACE_INT32 = 4, TRACE_NUMBER = 5,
+    TRACE_STRING = 6, TRACE_BIGINT = 7, TRACE_BYTES = 8, TRACE_ARRAY = 9, TRACE_OBJECT = 10, TRACE_FUNCTION = 11;
+var bytesKinds = [null, Int8Array, Uint8Array, Uint8ClampedArray, Int16Array, Uint16Array, Int32Array, Uint32Array,
+                  Float32Array, Float64Array, BigInt64Array, BigUint64Array, DataView];
+
+// natives that aren't replayed: context setup is done here, debug messages
+// and the recorder itself don't belong in a measurement
+var skipped = { Init: true, createHeadlessContext: true, debugOutput: true };
+
+var gl = require('bindings')('webgl');
+var version = gl.createHeadlessContext(4, 6);
+
+////////////////////////////////////////////////////////////////////////////////
+// Decoding
+
+var data = fs.readFileSync(tracePath);
+if (data.length < 12 || data.toString('latin1', 0, 8) !== 'NGLTRACE') {
+  console.error(tracePath + ': not a trace');
+  process.exit(1);
+}
+if (data.readUInt32LE(8) !== TRACE_VERSION) {
+  console.error(tracePath + ': trace version ' + data.readUInt32LE(8) + ', this replayer reads ' + TRACE_VERSION);
+  process.exit(1);
+}
+
+var names = [];
+var blobs = new Map();     // hash:length -> Buffer over the file
+var calls = [];            // by call index, null when not replayed
+var frames = [{ ops: [], recordedNs: 0 }];
+var unsupported = {};
+var pos = 12;
+
+// Typed array arguments decode to a reference to their blob. Every call gets
+// its own copy when its frame is prepared: natives write into some of their
+// arguments (readPixels, getBufferSubData, the mesh optimizers, packVertices,
+// ...), which must not change what a later call with the same contents sees.
+function Bytes(kind, key, length) {
+  this.kind = kind;
+  this.key = key;
+  this.length = length;
+}
+
+Bytes.prototype.copy = function() {
+  // a new buffer is also aligned for the element type
+  var buffer = new ArrayBuffer(this.length);
+  new Uint8Array(buffer).set(blobs.get(this.key));
+  var Kind = bytesKinds[this.kind];
+  if (!Kind) return buffer;
+  if (Kind === DataView) return new DataView(buffer);
+  return new Kind(buffer, 0, buffer.byteLength / Kind.BYTES_PER_ELEMENT);
+};
+
+function readString() {
+  var length = data.readUInt32LE(pos);
+  var text = data.toString('utf8', pos + 4, pos + 4 + length);
+  pos += 4 + length;
+  return text;
+}
+
+// Function arguments decode to their position in the call, the callback
+// itself is made when the call is replayed.
+function Callback(argument) { this.argument = argument; }
+
+function readValue(argument) {
+  var tag = data[pos++];
+  switch (tag) {
+    case TRACE_UNDEFINED: return undefined;
+    case TRACE_NULL: return null;
+    case TRACE_FALSE: return false;
+    case TRACE_TRUE: return true;
+    case TRACE_INT32: pos += 4; return data.readInt32LE(pos - 4);
+    case TRACE_NUMBER: pos += 8; return data.readDoubleLE(pos - 8);
+    case TRACE_STRING: return readString();
+    case TRACE_BIGINT: pos += 8; return data.readBigInt64LE(pos - 8);
+    case TRACE_BYTES: {
+      var kind = data[pos];
+      var hash = data.readBigUInt64LE(pos + 1);
+      var length = data.readBigUInt64LE(pos + 9);
+      pos += 17;
+      return new Bytes(kind, hash + ':' + length, Number(length));
+    }
+    case TRACE_ARRAY: {
+      var count = data.readUInt32LE(pos);
+      pos += 4;
+      var array = new Array(count);
+      for (var i = 0; i < count; i++) array[i] = readValue(-1);
+      return array;
+    }
+    case TRACE_OBJECT: {
+      var count = data.readUInt32LE(pos);
+      pos += 4;
+      var object = {};
+      for (var i = 0; i < count; i++) {
+        var key = readString();
+        object[key] = readValue(-1);
+      }
+      return object;
+    }
+    case TRACE_FUNCTION: return argument >= 0 ? new Callback(argument) : undefined;
+    default:
+      throw new Error(tracePath + ': bad value tag ' + tag + ' at byte ' + (pos - 1));
+  }
+}
+
+while (pos < data.length) {
+  var record = data[pos++];
+  var frame = frames[frames.length - 1];
+  if (record === TRACE_DEFINE) {
+    var id = data.readUInt32LE(pos);
+    pos += 4;
+    names[id] = readString();
+  } else if (record === TRACE_CALL) {
+    var name = names[data.readUInt32LE(pos)];
+    var argc = data.readUInt32LE(pos + 4);
+    pos += 8;
+    var callArgs = new Array(argc);
+    for (var i = 0; i < argc; i++) callArgs[i] = readValue(i);
+    var native = gl[name];
+    if (skipped[name] || name.startsWith('trace')) {
+      calls.push(null);
+    } else if (typeof native !== 'function') {
+      unsupported[name] = (unsupported[name] || 0) + 1;
+      calls.push(null);
+    } else {
+      var op = { native: native, name: name, args: callArgs, index: calls.length, returned: undefined, hasReturn: false,
+                 prepare: callArgs.some(function(a) { return a !== null && typeof a === 'object'; }), callArgs: callArgs };
+      calls.push(op);
+      frame.ops.push(op);
+    }
+  } else if (record === TRACE_RETURN) {
+    var call = calls[Number(data.readBigUInt64LE(pos))];
+    pos += 8;
+    var value = readValue(-1);
+    if (call) {
+      call.returned = value;
+      call.hasReturn = true;
+    }
+  } else if (record === TRACE_CALLBACK) {
+    var index = Number(data.readBigUInt64LE(pos));
+    var argument = data.readUInt32LE(pos + 8);
+    pos += 12;
+    if (calls[index]) frame.ops.push({ callback: index + ':' + argument });
+  } else if (record === TRACE_FRAME) {
+    frame.recordedNs = Number(data.readBigUInt64LE(pos));
+    pos += 8;
+    frames.push({ ops: [], recordedNs: 0 });
+  } else if (record === TRACE_BLOB) {
+    var hash = data.readBigUInt64LE(pos);
+    var length = data.readBigUInt64LE(pos + 8);
+    pos += 16;
+    blobs.set(hash + ':' + length, data.subarray(pos, pos + Number(length)));
+    pos += Number(length);
+  } else {
+    throw new Error(tracePath + ': bad record ' + record + ' at byte ' + (pos - 1));
+  }
+}
+// calls after the last swap are replayed as a frame, but not reported
+var tail = frames.pop();
+
+////////////////////////////////////////////////////////////////////////////////
+// Replay
+
+// Callbacks count their invocations; where the recording saw its n-th
+// invocation, the replay waits for it (completions of asynchronous work land
+// in the same frame).
+var invocations = new Map();
+var waiting = null;
+var expected = new Map();
+// how long to wait for a callback that may never come in this replay
+var CALLBACK_TIMEOUT_MS = 10000;
+
+function callback(key) {
+  return function() {
+    invocations.set(key, (invocations.get(key) || 0) + 1);
+    if (waiting && waiting.key === key && invocations.get(key) >= waiting.count) waiting.resolve(true);
+  };
+}
+
+function waitFor(key, count) {
+  if ((invocations.get(key) || 0) >= count) return null;
+  return new Promise(function(resolve) {
+    var timer = setTimeout(function() { resolve(false); }, CALLBACK_TIMEOUT_MS);
+    waiting = { key: key, count: count, resolve: function(value) { clearTimeout(timer); waiting = null; resolve(value); } };
+  });
+}
+
+var divergences = [];
+var missedCallbacks = 0;
+
+function diverged(op, result) {
+  if (divergences.length < 20) divergences.push(op.name + ' (call ' + op.index + ') returned ' + result + ', recorded ' + op.returned);
+  else divergences.push(null);
+}
+
+// runs ops from start until the end or a callback that hasn't happened yet,
+// returns the position to continue from
+function runOps(ops, start) {
+  for (var i = start; i < ops.length; i++) {
+    var op = ops[i];
+    if (op.callback) {
+      var count = (expected.get(op.callback) || 0) + 1;
+      expected.set(op.callback, count);
+      if ((invocations.get(op.callback) || 0) < count) return i;
+      continue;
+    }
+    var result = op.native.apply(gl, op.callArgs);
+    if (op.hasReturn && result !== op.returned && !(result !== result && op.returned !== op.returned)) diverged(op, result);
+  }
+  return ops.length;
+}
+
+function materialize(value, op) {
+  if (value instanceof Bytes) return value.copy();
+  if (value instanceof Callback) return callback(op.index + ':' + value.argument);
+  if (Array.isArray(value)) return value.map(function(v) { return materialize(v, op); });
+  if (value !== null && typeof value === 'object') {
+    var object = {};
+    for (var key in value) object[key] = materialize(value[key], op);
+    return object;
+  }
+  return value;
+}
+
+// the arguments of a frame's calls, made before its timing starts
+function prepareFrame(ops) {
+  ops.forEach(function(op) {
+    if (op.prepare) op.callArgs = op.args.map(function(a) { return materialize(a, op); });
+  });
+}
+
+function releaseFrame(ops) {
+  ops.forEach(function(op) {
+    if (op.prepare) op.callArgs = null;
+  });
+}
+
+async function runFrame(frame) {
+  var ops = frame.ops;
+  prepareFrame(ops);
+  var elapsed = 0n;
+  var start = process.hrtime.bigint();
+  var i = runOps(ops, 0);
+  while (i < ops.length) {
+    // the wait for the event loop isn't the frame's
+    elapsed += process.hrtime.bigint() - start;
+    var key = ops[i].callback;
+    var arrived = await waitFor(key, expected.get(key));
+    if (arrived === false) missedCallbacks++;
+    start = process.hrtime.bigint();
+    i = runOps(ops, i + 1);
+  }
+  if (finish) gl.finish();
+  elapsed += process.hrtime.bigint() - start;
+  releaseFrame(ops);
+  return Number(elapsed) / 1e6;
+}
+
+function nextTurn() {
+  return new Promise(setImmediate);
+}
+
+function percentile(sorted, p) {
+  return sorted[Math.min(sorted.length - 1, Math.floor(p * sorted.length))];
+}
+
+async function replay() {
+  var times = [];
+  var previousNs = 0;
+  for (var f = 0; f < frames.length; f++) {
+    var ms = await runFrame(frames[f]);
+    times.push({ frame: f, ms: ms, recordedMs: (frames[f].recordedNs - previousNs) / 1e6 });
+    previousNs = frames[f].recordedNs;
+    // like the application's loop, lets finished work call back
+    await nextTurn();
+  }
+  if (tail.ops.length) await runFrame(tail);
+
+  var log = console.log;
+  log('replayed ' + tracePath + ' on ' + version);
+  log(calls.length + ' calls, ' + blobs.size + ' blobs, ' + frames.length + ' frames' + (finish ? '' : ' (no finish)'));
+  if (times.length) {
+    var sorted = times.map(function(t) { return t.ms; }).sort(function(a, b) { return a - b; });
+    var total = sorted.reduce(function(sum, ms) { return sum + ms; }, 0);
+    log('frame ms: mean ' + (total / sorted.length).toFixed(3) + ', median ' + percentile(sorted, 0.5).toFixed(3) +
+        ', p95 ' + percentile(sorted, 0.95).toFixed(3) + ', p99 ' + percentile(sorted, 0.99).toFixed(3) +
+        ', max ' + sorted[sorted.length - 1].toFixed(3));
+    log('slowest frames (replay ms / recorded ms):');
+    times.slice().sort(function(a, b) { return b.ms - a.ms; }).slice(0, 5).forEach(function(t) {
+      log('  ' + t.frame + ': ' + t.ms.toFixed(3) + ' / ' + t.recordedMs.toFixed(3));
+    });
+  }
+  var unsupportedNames = Object.keys(unsupported);
+  if (unsupportedNames.length) {
+    log('not replayed (missing from this build): ' + unsupportedNames.map(function(n) { return n + ' x' + unsupported[n]; }).join(', '));
+  }
+  if (divergences.length) {
+    log(divergences.length + ' returned values differ from the recording, the replay may not match:');
+    divergences.filter(Boolean).forEach(function(d) { log('  ' + d); });
+  }
+  if (missedCallbacks) log(missedCallbacks + ' recorded callbacks never came, waited ' + CALLBACK_TIMEOUT_MS + ' ms each');
+  if (jsonPath) {
+    fs.writeFileSync(jsonPath, JSON.stringify({ trace: tracePath, version: version, finish: finish, frames: times }, null, 2));
+  }
+}
+
+replay().catch(function(e) {
+  console.error(e);
+  process.exit(1);
+});